@@ -0,0 +1,108 @@
+//======================================================================
+//! @file   bench_lcd.c
+//! @brief  lcd.c ベンチマーク(LCD転送、縦向きの文字描画)
+//! @note	VRAMへの描画のみのケースはmain/bench.c(実機と共通)
+//! 		Text*は64x64dotのエリアに全角64文字/ASCII128文字を描く(転送なし).
+//! 		Nativeは横向き、Rotate90/270は縦向き(8x8dotずつ転置して描く).
+//======================================================================
+#include <stddef.h>
+
+#include "setup.h"
+#include "lcd.h"
+#include "sim.h"
+#include "benchmark.h"
+
+//----------------------------------------------------------------------
+//! @brief  準備: 全体初期化(LCD初期化を含む)
+//----------------------------------------------------------------------
+static void Setup(void)
+{
+	set_Initialize();
+}
+
+//----------------------------------------------------------------------
+//! @brief  全画面転送
+//----------------------------------------------------------------------
+static void UpdateFull(int iterations)
+{
+	for(int i = 0; i < iterations; i++)
+	{
+		lcd_BeginDrawing();
+		lcd_Cls();
+		lcd_DrawLine(0, 0, 127, 63);
+		lcd_DrawLine(0, 63, 127, 0);
+		lcd_EndDrawing();
+		lcd_Update();
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  1文字分の部分転送
+//----------------------------------------------------------------------
+static void UpdateGlyph(int iterations)
+{
+	Rect area = {40, 16, 8, 8};
+	for(int i = 0; i < iterations; i++)
+	{
+		lcd_BeginDrawing();
+		lcd_Puts(area, (i & 1) ? "A" : "B", Code_Utf8);
+		lcd_EndDrawing();
+		lcd_Update();
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  準備: 全体初期化と表示の向き
+//----------------------------------------------------------------------
+static void SetupRotation(LcdRotation rotation)
+{
+	set_Initialize();
+	lcd_BeginDrawing();
+	lcd_SetRotation(rotation);
+	lcd_EndDrawing();
+}
+
+static void SetupNative(void) { SetupRotation(LcdRotation_0); }
+static void SetupRotate90(void) { SetupRotation(LcdRotation_90); }
+static void SetupRotate270(void) { SetupRotation(LcdRotation_270); }
+
+//----------------------------------------------------------------------
+//! @brief  64x64dotに文字列描画
+//----------------------------------------------------------------------
+static void DrawText(int iterations, const char *text)
+{
+	Rect area = {0, 0, 64, 64};
+	lcd_BeginDrawing();
+	for(int i = 0; i < iterations; i++)
+	{
+		lcd_Puts(area, text, Code_Utf8);
+	}
+	lcd_EndDrawing();
+}
+
+static void TextJapanese(int iterations)
+{
+	DrawText(iterations,
+		"あいうえおかきく" "けこさしすせそた" "ちつてとなにぬね" "のはひふへほまみ"
+		"むめもやゆよらり" "るれろわをんアイ" "ウエオカキクケコ" "サシスセソタチツ");
+}
+
+static void TextAscii(int iterations)
+{
+	DrawText(iterations,
+		"The quick brown " "fox jumps over t" "he lazy dog. 012" "3456789 !\"#$%&'("
+		"ABCDEFGHIJKLMNOP" "QRSTUVWXYZabcdef" "ghijklmnopqrstuv" "wxyz{|}~ The qui");
+}
+
+const Benchmark bench_lcdCases[] =
+{
+	{"UpdateFull", Setup, UpdateFull},
+	{"UpdateGlyph", Setup, UpdateGlyph},
+	{"TextJapaneseNative", SetupNative, TextJapanese},
+	{"TextJapaneseRotate90", SetupRotate90, TextJapanese},
+	{"TextJapaneseRotate270", SetupRotate270, TextJapanese},
+	{"TextAsciiNative", SetupNative, TextAscii},
+	{"TextAsciiRotate90", SetupRotate90, TextAscii},
+	{"TextAsciiRotate270", SetupRotate270, TextAscii},
+	{NULL, NULL, NULL}
+};
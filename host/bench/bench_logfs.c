@@ -0,0 +1,66 @@
+//======================================================================
+//! @file   bench_logfs.c
+//! @brief  大きいログファイルの末尾へのシーク(FAT32とexFATの比較)
+//! @note	64GBのSDXCカードに2GiBのボリュームを作り、1GiBのファイルを1クラスタずつ伸ばした後、
+//! 		末尾セクタの読込(先頭からのシーク+1セクタ読込)を計測する.
+//! 		FAT32は先頭からFAT連鎖をたどるのでFATを2048セクタ読む.
+//! 		exFATの連続ファイル(NoFatChain)は位置からクラスタを計算するのでFATを読まない.
+//! 		ファイルシステムはhost/soak/logfs.cのモデル.実機のFatFsはFF_FS_EXFAT=0なので、exFATはモデルでの見積り.
+//======================================================================
+#include <stddef.h>
+
+#include "diskio.h"
+
+#include "global.h"
+#include "setup.h"
+#include "sim.h"
+#include "logfs.h"
+#include "benchmark.h"
+
+#define VOLUME_SECTOR	8192					// ボリューム先頭(4MiB境界)
+#define VOLUME_SECTORS	(4UL * 1024 * 1024)		// 2GiB
+#define LOG_BYTES		(1UL << 30)				// 1GiB
+
+static LogFile file;
+static uint8_t buffer[LOGFS_SECTOR_SIZE];
+
+//----------------------------------------------------------------------
+//! @brief  準備: SDXCカードをフォーマットして1GiBのファイルを作る
+//----------------------------------------------------------------------
+static void Setup(LogFsType type)
+{
+	SimSdConfig config;
+	sim_SdDefaultConfig(&config);
+	config.sectors = 64UL * 1024 * 1024 * 2;
+	config.auSizeCode = 15;
+	sim_SdInsert(&config);
+	set_Initialize();
+	if(logfs_Format(type, VOLUME_SECTOR, VOLUME_SECTORS) != RET_OK
+	|| logfs_Create("sensor_20240101.csv", &file) != RET_OK
+	|| logfs_Stretch(&file, LOG_BYTES) != RET_OK
+	|| logfs_Sync(&file) != RET_OK)
+	{
+		file.size = 0;
+	}
+}
+
+static void SetupFat32(void) { Setup(LogFs_Fat32); }
+static void SetupExfat(void) { Setup(LogFs_Exfat); }
+
+//----------------------------------------------------------------------
+//! @brief  末尾セクタへのシークと読込
+//----------------------------------------------------------------------
+static void SeekEnd(int iterations)
+{
+	for(int i = 0; i < iterations && file.size > 0; i++)
+	{
+		logfs_Read(&file, file.size - LOGFS_SECTOR_SIZE, buffer);
+	}
+}
+
+const Benchmark bench_logfsCases[] =
+{
+	{"SeekEnd1GFat32", SetupFat32, SeekEnd},
+	{"SeekEnd1GExfat", SetupExfat, SeekEnd},
+	{NULL, NULL, NULL}
+};
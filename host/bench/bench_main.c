@@ -0,0 +1,150 @@
+//======================================================================
+//! @file   bench_main.c
+//! @brief  ホストマイクロベンチマーク実行
+//! @note	使い方: benchmarks [--quick] [--min-time ms] [名前の一部]
+//! 		結果は1ベンチマーク1行のJSONで標準出力へ出す.
+//! 		  ns_per_op        : ホストCPU時間(ドライバ+模擬デバイス)
+//! 		  cycles_per_op    : ホストサイクルカウンタ(bench_GetCycleCount)
+//! 		  bytes_per_op     : ヒープ確保量(pvPortMalloc)
+//! 		  allocs_per_op    : ヒープ確保回数
+//! 		  bus_bytes_per_op : SPI転送量
+//! 		  sim_ns_per_op    : 仮想時計の経過時間(SPIクロックとvTaskDelayから算出)
+//======================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "esp_log.h"
+
+#include "sim.h"
+#include "benchmark.h"
+
+static const struct
+{
+	const char *name;
+	const Benchmark *cases;
+} groups[] =
+{
+	{"lcd", bench_lcdCases},
+	{"logfs", bench_logfsCases},
+	{"sd", bench_sdCases},
+	{"series", bench_seriesCases},
+};
+
+//----------------------------------------------------------------------
+//! @brief  ホスト時刻[ns]
+//----------------------------------------------------------------------
+static uint64_t HostNs(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+//----------------------------------------------------------------------
+//! @brief  1ベンチマーク実行
+//! @param	name		[I]表示名
+//! @param	bench		[I]ベンチマーク
+//! @param	minTimeNs	[I]最低計測時間[ns] 0=1回だけ実行
+//----------------------------------------------------------------------
+static void RunBenchmark(const char *name, const Benchmark *bench, uint64_t minTimeNs)
+{
+	SimHeapStats heapBefore, heapAfter;
+	SimSpiStats spiBefore, spiAfter;
+	uint64_t hostNs, simNs;
+	uint32_t cycles;
+	int iterations = 1;
+
+	for(;;)
+	{
+		sim_Reset();
+		if(bench->setup != NULL)
+		{
+			bench->setup();
+		}
+		sim_GetHeapStats(&heapBefore);
+		sim_GetSpiStats(&spiBefore);
+		simNs = sim_GetTimeNs();
+		hostNs = HostNs();
+		cycles = bench_GetCycleCount();
+
+		bench->run(iterations);
+
+		cycles = bench_GetCycleCount() - cycles;
+		hostNs = HostNs() - hostNs;
+		simNs = sim_GetTimeNs() - simNs;
+		sim_GetHeapStats(&heapAfter);
+		sim_GetSpiStats(&spiAfter);
+
+		if(hostNs >= minTimeNs || iterations >= 100000000)
+		{
+			break;
+		}
+		// 目標時間に届くよう回数を増やす(最大100倍)
+		uint64_t next = (hostNs > 0) ? minTimeNs * 12 / 10 * iterations / hostNs : (uint64_t)iterations * 100;
+		if(next > (uint64_t)iterations * 100)
+		{
+			next = (uint64_t)iterations * 100;
+		}
+		iterations = (next > (uint64_t)iterations) ? (int)next : iterations + 1;
+	}
+
+	printf("{\"name\":\"%s\",\"iterations\":%d,\"ns_per_op\":%.1f,\"cycles_per_op\":%.1f,\"bytes_per_op\":%.1f,\"allocs_per_op\":%.2f,"
+		"\"bus_bytes_per_op\":%.1f,\"sim_ns_per_op\":%.1f}\n",
+		name, iterations,
+		(double)hostNs / iterations,
+		(double)cycles / iterations,
+		(double)(heapAfter.allocBytes - heapBefore.allocBytes) / iterations,
+		(double)(heapAfter.allocCount - heapBefore.allocCount) / iterations,
+		(double)(spiAfter.bytes - spiBefore.bytes) / iterations,
+		(double)simNs / iterations);
+	fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+	uint64_t minTimeNs = 200000000ULL;
+	const char *filter = NULL;
+	char fullName[128];
+
+	for(int i = 1; i < argc; i++)
+	{
+		if(strcmp(argv[i], "--quick") == 0)
+		{
+			minTimeNs = 0;
+		}
+		else if(strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+		{
+			minTimeNs = strtoull(argv[++i], NULL, 10) * 1000000ULL;
+		}
+		else
+		{
+			filter = argv[i];
+		}
+	}
+
+	esp_log_level_set("*", ESP_LOG_ERROR);
+	for(const BenchCase *render = bench_renderCases; render->name != NULL; render++)
+	{
+		const Benchmark bench = {render->name, bench_RenderSetup, bench_RenderRun};
+		snprintf(fullName, sizeof(fullName), "render/%s", render->name);
+		if(filter == NULL || strstr(fullName, filter) != NULL)
+		{
+			bench_renderCase = render;
+			RunBenchmark(fullName, &bench, minTimeNs);
+		}
+	}
+	for(size_t g = 0; g < sizeof(groups) / sizeof(groups[0]); g++)
+	{
+		for(const Benchmark *bench = groups[g].cases; bench->name != NULL; bench++)
+		{
+			snprintf(fullName, sizeof(fullName), "%s/%s", groups[g].name, bench->name);
+			if(filter == NULL || strstr(fullName, filter) != NULL)
+			{
+				RunBenchmark(fullName, bench, minTimeNs);
+			}
+		}
+	}
+	return 0;
+}
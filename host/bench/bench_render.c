@@ -0,0 +1,32 @@
+//======================================================================
+//! @file   bench_render.c
+//! @brief  描画ベンチマーク(main/bench.cのケースをホストで実行)
+//======================================================================
+#include <stddef.h>
+
+#include "setup.h"
+#include "lcd.h"
+#include "benchmark.h"
+
+const BenchCase *bench_renderCase;		// 実行するケース
+
+//----------------------------------------------------------------------
+//! @brief  準備: 全体初期化(LCD初期化を含む)
+//----------------------------------------------------------------------
+void bench_RenderSetup(void)
+{
+	set_Initialize();
+}
+
+//----------------------------------------------------------------------
+//! @brief  bench_renderCaseをiterations回実行
+//----------------------------------------------------------------------
+void bench_RenderRun(int iterations)
+{
+	lcd_BeginDrawing();
+	for(int i = 0; i < iterations; i++)
+	{
+		bench_renderCase->run();
+	}
+	lcd_EndDrawing();
+}
@@ -0,0 +1,127 @@
+//======================================================================
+//! @file   bench_sd.c
+//! @brief  sd.c ベンチマーク(ディスクI/O関数経由)
+//======================================================================
+#include <stddef.h>
+
+#include "diskio.h"
+
+#include "setup.h"
+#include "sd.h"
+#include "sim.h"
+#include "benchmark.h"
+
+static const BYTE pdrv = 0;
+static uint8_t buffer[512 * 64];
+static uint32_t dataSector;			// SeqWrite32k: クラスタ2のセクタ
+
+//----------------------------------------------------------------------
+//! @brief  準備: 全体初期化(SDカード初期化を含む)
+//----------------------------------------------------------------------
+static void Setup(void)
+{
+	for(size_t i = 0; i < sizeof(buffer); i++)
+	{
+		buffer[i] = (uint8_t)i;
+	}
+	set_Initialize();
+}
+
+//----------------------------------------------------------------------
+//! @brief  セクタ読込
+//----------------------------------------------------------------------
+static void Read(int iterations, UINT count)
+{
+	for(int i = 0; i < iterations; i++)
+	{
+		disk_read(pdrv, buffer, (DWORD)(i % 1024) * count, count);
+	}
+}
+
+static void Read1(int iterations) { Read(iterations, 1); }
+static void Read8(int iterations) { Read(iterations, 8); }
+
+//----------------------------------------------------------------------
+//! @brief  セクタ書込
+//----------------------------------------------------------------------
+static void Write(int iterations, UINT count)
+{
+	for(int i = 0; i < iterations; i++)
+	{
+		disk_write(pdrv, buffer, (DWORD)(i % 1024) * count, count);
+	}
+}
+
+static void Write1(int iterations) { Write(iterations, 1); }
+static void Write8(int iterations) { Write(iterations, 8); }
+
+//----------------------------------------------------------------------
+//! @brief  カード初期化(CMD0～ACMD41～CSD/SD_STATUS読込)
+//----------------------------------------------------------------------
+static void Initialize(int iterations)
+{
+	for(int i = 0; i < iterations; i++)
+	{
+		sd_Deinitialize();
+		sd_Initialize();
+		disk_initialize(pdrv);
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  準備: 4GBカード(AU 4MiB, フラッシュのページ16KiB)
+//----------------------------------------------------------------------
+static void SetupPaged(void)
+{
+	SimSdConfig config;
+	sim_SdDefaultConfig(&config);
+	config.sectors = 4UL * 1024 * 1024 * 2;
+	config.pageSectors = 32;
+	config.pageBusyBytes = 700;			// busy確認1回約1.4usで約1ms
+	sim_SdInsert(&config);
+	Setup();
+}
+
+//----------------------------------------------------------------------
+//! @brief  準備: PCでの従来のフォーマット(パーティション先頭63, 予約32, 32KiBクラスタ)
+//----------------------------------------------------------------------
+static void SetupPcLayout(void)
+{
+	SetupPaged();
+	uint32_t fatSectors = ((4UL * 1024 * 1024 * 2 - 63 - 32) / 64 + 2 + 127) / 128;
+	dataSector = 63 + 32 + 2 * fatSectors;
+}
+
+//----------------------------------------------------------------------
+//! @brief  準備: sd_Format()(AU境界合わせ)
+//----------------------------------------------------------------------
+static void SetupAuAligned(void)
+{
+	SdFormat format;
+	SetupPaged();
+	sd_Format(&format);
+	dataSector = format.dataSector;
+}
+
+//----------------------------------------------------------------------
+//! @brief  データ領域へ32KiBずつ順に書込(ファイルへの1クラスタ単位の追記)
+//----------------------------------------------------------------------
+static void SeqWrite32k(int iterations)
+{
+	for(int i = 0; i < iterations; i++)
+	{
+		disk_write(pdrv, buffer, dataSector + (DWORD)(i % 64) * 64, 64);
+	}
+}
+
+const Benchmark bench_sdCases[] =
+{
+	{"Read1", Setup, Read1},
+	{"Read8", Setup, Read8},
+	{"Write1", Setup, Write1},
+	{"Write8", Setup, Write8},
+	{"Initialize", Setup, Initialize},
+	{"SeqWrite32kPcLayout", SetupPcLayout, SeqWrite32k},
+	{"SeqWrite32kAuAligned", SetupAuAligned, SeqWrite32k},
+	{NULL, NULL, NULL}
+};
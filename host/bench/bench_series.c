@@ -0,0 +1,72 @@
+//======================================================================
+//! @file   bench_series.c
+//! @brief  グラフ用時系列データの送信形式(JSONと差分バイナリ)の比較
+//! @note	1分間隔の1万サンプルをSERIES_READ_BLOCKずつ書く(CSVの読込とHTTPの送信は含まない).
+//! 		応答の大きさはJSON約18byte/サンプル, バイナリ2byte/サンプル(test_series.cのBinaryIsCompact).
+//======================================================================
+#include <stddef.h>
+#include <stdint.h>
+
+#include "global.h"
+#include "series.h"
+#include "benchmark.h"
+
+#define SAMPLE_COUNT	10000
+
+static SeriesSample samples[SAMPLE_COUNT];
+static volatile size_t outputBytes;		// 出力の大きさ(最適化で消されないように)
+
+//----------------------------------------------------------------------
+//! @brief  出力先(数えるだけ)
+//----------------------------------------------------------------------
+static int CountBytes(void *context, const void *data, size_t length)
+{
+	outputBytes += length;
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  準備: ゆっくり変わる値を作る
+//----------------------------------------------------------------------
+static void Setup(void)
+{
+	uint32_t random = 1;
+	int value = 400;
+
+	for(int i = 0; i < SAMPLE_COUNT; i++)
+	{
+		random = random * 1103515245 + 12345;
+		value += (int)((random >> 16) % 5) - 2;
+		samples[i].timeS = 1700000000 + i * 60;
+		samples[i].value = (int16_t)value;
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  1万サンプルを書く
+//----------------------------------------------------------------------
+static void Encode(int iterations, SeriesFormat format)
+{
+	SeriesWriter writer;
+
+	for(int i = 0; i < iterations; i++)
+	{
+		series_Begin(&writer, format, 0.0625f, 0.0f, CountBytes, NULL);
+		for(size_t j = 0; j < SAMPLE_COUNT; j += SERIES_READ_BLOCK)
+		{
+			size_t count = (SAMPLE_COUNT - j < SERIES_READ_BLOCK) ? SAMPLE_COUNT - j : SERIES_READ_BLOCK;
+			series_Write(&writer, &samples[j], count);
+		}
+		series_End(&writer);
+	}
+}
+
+static void Json10k(int iterations) { Encode(iterations, Series_Json); }
+static void Binary10k(int iterations) { Encode(iterations, Series_Binary); }
+
+const Benchmark bench_seriesCases[] =
+{
+	{"Json10k", Setup, Json10k},
+	{"Binary10k", Setup, Binary10k},
+	{NULL, NULL, NULL}
+};
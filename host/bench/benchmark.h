@@ -0,0 +1,28 @@
+//======================================================================
+//! @file   benchmark.h
+//! @brief  ホストマイクロベンチマーク
+//======================================================================
+#ifndef _BENCHMARK_H_
+#define _BENCHMARK_H_
+
+#include "bench.h"
+
+typedef struct
+{
+	const char *name;					// ベンチマーク名
+	void (*setup)(void);				// 準備(計測対象外)
+	void (*run)(int iterations);		// 計測対象 iterations回実行
+} Benchmark;
+
+// ベンチマーク一覧(各ファイルで定義, {NULL}で終端)
+extern const Benchmark bench_lcdCases[];
+extern const Benchmark bench_logfsCases[];
+extern const Benchmark bench_sdCases[];
+extern const Benchmark bench_seriesCases[];
+
+// 描画ケース(main/bench.c)の実行
+extern const BenchCase *bench_renderCase;
+void bench_RenderSetup(void);
+void bench_RenderRun(int iterations);
+
+#endif
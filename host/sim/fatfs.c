@@ -0,0 +1,398 @@
+//======================================================================
+//! @file   fatfs.c
+//! @brief  [ホスト模擬] FatFs / ディスクI/O / VFS登録
+//! @note	ドライバ登録とマウント時のディスク初期化・ブートセクタ確認のみ行う.
+//! 		ff_uni2oem()はCP932のうち、かな・英数記号と一部の漢字のみ対応する.
+//! 		VFS登録中はfopen()(-Wl,--wrap=fopen)で同時に開けるファイル数を登録時のmaxFilesに制限する.
+//======================================================================
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "esp_vfs_fat.h"
+#include "diskio_impl.h"
+#include "ff.h"
+
+#include "sim.h"
+#include "simdev.h"
+
+//----- 定義 -----
+#define VFS_FILES_MAX	8				// 模擬するmaxFilesの上限
+
+typedef struct
+{
+	uint16_t unicode;
+	uint16_t sjis;
+} UniToSjis;
+
+static const UniToSjis kanjiTable[] =		// unicode昇順
+{
+	{0x4e2d, 0x9286},		// 中
+	{0x4e86, 0x97b9},		// 了
+	{0x4fdd, 0x95db},		// 保
+	{0x5206, 0x95aa},		// 分
+	{0x5217, 0x97f1},		// 列
+	{0x524a, 0x8ded},		// 削
+	{0x529f, 0x8cf7},		// 功
+	{0x5727, 0x88b3},		// 圧
+	{0x5831, 0x95f1},		// 報
+	{0x5931, 0x8eb8},		// 失
+	{0x59cb, 0x8e6e},		// 始
+	{0x5b57, 0x8e9a},		// 字
+	{0x5b58, 0x91b6},		// 存
+	{0x5b9a, 0x92e8},		// 定
+	{0x5e74, 0x944e},		// 年
+	{0x5ea6, 0x9378},		// 度
+	{0x60c5, 0x8fee},		// 情
+	{0x614b, 0x91d4},		// 態
+	{0x6210, 0x90ac},		// 成
+	{0x63a5, 0x90da},		// 接
+	{0x6557, 0x9473},		// 敗
+	{0x6587, 0x95b6},		// 文
+	{0x65e5, 0x93fa},		// 日
+	{0x6642, 0x8e9e},		// 時
+	{0x66f8, 0x8f91},		// 書
+	{0x6708, 0x8c8e},		// 月
+	{0x672c, 0x967b},		// 本
+	{0x6b8b, 0x8e63},		// 残
+	{0x6c17, 0x8b43},		// 気
+	{0x6c60, 0x9272},		// 池
+	{0x6e29, 0x89b7},		// 温
+	{0x6e7f, 0x8ebc},		// 湿
+	{0x72b6, 0x8ff3},		// 状
+	{0x753b, 0x89e6},		// 画
+	{0x793a, 0x8ea6},		// 示
+	{0x79d2, 0x9562},		// 秒
+	{0x7d42, 0x8f49},		// 終
+	{0x7d9a, 0x91b1},		// 続
+	{0x8868, 0x955c},		// 表
+	{0x8a18, 0x8b4c},		// 記
+	{0x8a2d, 0x90dd},		// 設
+	{0x8a9e, 0x8cea},		// 語
+	{0x8aad, 0x93c7},		// 読
+	{0x8fbc, 0x8d9e},		// 込
+	{0x91cf, 0x97ca},		// 量
+	{0x9332, 0x985e},		// 録
+	{0x958b, 0x8a4a},		// 開
+	{0x9664, 0x8f9c},		// 除
+	{0x96fb, 0x9364},		// 電
+	{0x9762, 0x96ca},		// 面
+};
+
+//----- 変数 -----
+static const ff_diskio_impl_t *s_impls[FF_VOLUMES];		// 登録済ドライバ
+static ff_diskio_impl_t s_implStorage[FF_VOLUMES];		// ドライバの複製
+static char s_vfsPath[16];								// VFS登録パス
+static FATFS *s_vfsFs;									// VFS登録先
+static size_t s_vfsMaxFiles;							// 同時に開けるファイル数
+static FILE *s_vfsFiles[VFS_FILES_MAX];					// VFS登録中に開いたファイル
+static FILE *(*s_vfsOpen)(const char *name, const char *mode);	// VFS登録パス以下を開く処理(NULL=ホストのファイル)
+
+//----- プロトタイプ宣言 -----
+FILE *__real_fopen(const char *path, const char *mode);
+int __real_fclose(FILE *fp);
+
+//----------------------------------------------------------------------
+//! @brief  ディスクI/O模擬状態の初期化
+//----------------------------------------------------------------------
+void simdev_ResetDiskio(void)
+{
+	memset(s_impls, 0, sizeof(s_impls));
+	s_vfsPath[0] = '\0';
+	vPortFree(s_vfsFs);
+	s_vfsFs = NULL;
+	s_vfsMaxFiles = 0;
+	memset(s_vfsFiles, 0, sizeof(s_vfsFiles));
+	s_vfsOpen = NULL;
+}
+
+//----------------------------------------------------------------------
+//! @brief  VFS登録パス以下のファイルの置き先を設定
+//! @param	open	[I]ファイルを開く処理(登録パスの後の名前, モード) NULL=ホストのファイルシステム
+//! @note	長期試験でファームウェアのfopen("/sd/...")を模擬SDカード上のファイルシステムへ向ける.
+//----------------------------------------------------------------------
+void sim_VfsSetOpen(FILE *(*open)(const char *name, const char *mode))
+{
+	s_vfsOpen = open;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ドライバ登録
+//----------------------------------------------------------------------
+void ff_diskio_register(BYTE pdrv, const ff_diskio_impl_t *discioImpl)
+{
+	if(pdrv >= FF_VOLUMES)
+	{
+		return;
+	}
+	if(discioImpl == NULL)
+	{
+		s_impls[pdrv] = NULL;
+		return;
+	}
+	s_implStorage[pdrv] = *discioImpl;
+	s_impls[pdrv] = &s_implStorage[pdrv];
+}
+
+esp_err_t ff_diskio_get_drive(BYTE *outPdrv)
+{
+	for(BYTE i = 0; i < FF_VOLUMES; i++)
+	{
+		if(s_impls[i] == NULL)
+		{
+			*outPdrv = i;
+			return ESP_OK;
+		}
+	}
+	return ESP_ERR_NOT_FOUND;
+}
+
+DSTATUS ff_disk_initialize(BYTE pdrv)
+{
+	return (pdrv < FF_VOLUMES && s_impls[pdrv] != NULL) ? s_impls[pdrv]->init(pdrv) : STA_NOINIT;
+}
+
+DSTATUS ff_disk_status(BYTE pdrv)
+{
+	return (pdrv < FF_VOLUMES && s_impls[pdrv] != NULL) ? s_impls[pdrv]->status(pdrv) : STA_NOINIT;
+}
+
+DRESULT ff_disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
+{
+	return (pdrv < FF_VOLUMES && s_impls[pdrv] != NULL) ? s_impls[pdrv]->read(pdrv, buff, sector, count) : RES_PARERR;
+}
+
+DRESULT ff_disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
+{
+	return (pdrv < FF_VOLUMES && s_impls[pdrv] != NULL) ? s_impls[pdrv]->write(pdrv, buff, sector, count) : RES_PARERR;
+}
+
+DRESULT ff_disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+	return (pdrv < FF_VOLUMES && s_impls[pdrv] != NULL) ? s_impls[pdrv]->ioctl(pdrv, cmd, buff) : RES_PARERR;
+}
+
+//----------------------------------------------------------------------
+//! @brief  VFS登録
+//----------------------------------------------------------------------
+esp_err_t esp_vfs_fat_register(const char *basePath, const char *fatDrive, size_t maxFiles, FATFS **outFs)
+{
+	if(s_vfsFs != NULL)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+	s_vfsFs = pvPortMalloc(sizeof(FATFS));
+	if(s_vfsFs == NULL)
+	{
+		return ESP_ERR_NO_MEM;
+	}
+	memset(s_vfsFs, 0, sizeof(FATFS));
+	snprintf(s_vfsPath, sizeof(s_vfsPath), "%s", basePath);
+	s_vfsMaxFiles = (maxFiles < VFS_FILES_MAX) ? maxFiles : VFS_FILES_MAX;
+	memset(s_vfsFiles, 0, sizeof(s_vfsFiles));
+	*outFs = s_vfsFs;
+	return ESP_OK;
+}
+
+esp_err_t esp_vfs_fat_unregister_path(const char *basePath)
+{
+	if(s_vfsFs == NULL || strcmp(basePath, s_vfsPath) != 0)
+	{
+		return ESP_ERR_INVALID_STATE;
+	}
+	vPortFree(s_vfsFs);
+	s_vfsFs = NULL;
+	s_vfsPath[0] = '\0';
+	s_vfsMaxFiles = 0;
+	memset(s_vfsFiles, 0, sizeof(s_vfsFiles));
+	return ESP_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ファイルを開く(VFSのファイル数制限)
+//! @note	実機のVFS FATはmaxFiles個のFILを登録時に確保し、使い切るとENFILEで失敗する.
+//! 		ホストではファイルはホストのファイルシステムに置くので、VFS登録中に開くファイルをすべて数える.
+//! 		sim_VfsSetOpen()で置き先があれば、登録パス以下はそちらで開く.
+//----------------------------------------------------------------------
+FILE *__wrap_fopen(const char *path, const char *mode)
+{
+	size_t slot;
+	size_t length = strlen(s_vfsPath);
+	FILE *fp;
+
+	if(s_vfsFs == NULL)
+	{
+		return __real_fopen(path, mode);
+	}
+	for(slot = 0; slot < s_vfsMaxFiles && s_vfsFiles[slot] != NULL; slot++)
+	{
+	}
+	if(slot >= s_vfsMaxFiles)
+	{
+		errno = ENFILE;
+		return NULL;
+	}
+	fp = (s_vfsOpen != NULL && strncmp(path, s_vfsPath, length) == 0 && path[length] == '/')
+		? s_vfsOpen(&path[length + 1], mode) : __real_fopen(path, mode);
+	s_vfsFiles[slot] = fp;
+	return fp;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ファイルを閉じる
+//----------------------------------------------------------------------
+int __wrap_fclose(FILE *fp)
+{
+	for(size_t slot = 0; slot < VFS_FILES_MAX; slot++)
+	{
+		if(fp != NULL && s_vfsFiles[slot] == fp)
+		{
+			s_vfsFiles[slot] = NULL;
+		}
+	}
+	return __real_fclose(fp);
+}
+
+//----------------------------------------------------------------------
+//! @brief  マウント
+//! @note	opt=1の場合、ディスク初期化とセクタ0の署名(0x55aa)確認を行う.
+//! 		VBRのファイルシステム名が"EXFAT   "なら、FF_FS_EXFAT=0(実機と同じ)ではマウントできない.
+//----------------------------------------------------------------------
+FRESULT f_mount(FATFS *fs, const TCHAR *path, BYTE opt)
+{
+	if(path == NULL || path[0] < '0' || path[0] >= '0' + FF_VOLUMES || path[1] != ':')
+	{
+		return FR_INVALID_DRIVE;
+	}
+	BYTE pdrv = (BYTE)(path[0] - '0');
+	fs->fs_type = 0;
+	fs->pdrv = pdrv;
+	fs->ssize = FF_MAX_SS;
+	if(opt == 0)
+	{
+		return FR_OK;
+	}
+
+	if(ff_disk_initialize(pdrv) & STA_NOINIT)
+	{
+		return FR_NOT_READY;
+	}
+	if(ff_disk_read(pdrv, fs->win, 0, 1) != RES_OK)
+	{
+		return FR_DISK_ERR;
+	}
+	if(fs->win[510] != 0x55 || fs->win[511] != 0xaa)
+	{
+		return FR_NO_FILESYSTEM;
+	}
+	if(memcmp(&fs->win[3], "EXFAT   ", 8) == 0)
+	{
+#if FF_FS_EXFAT
+		fs->fs_type = FS_EXFAT;
+		return FR_OK;
+#else
+		return FR_NO_FILESYSTEM;
+#endif
+	}
+	fs->fs_type = FS_FAT32;
+	return FR_OK;
+}
+
+FRESULT f_unmount(const TCHAR *path)
+{
+	return FR_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  Unicode → CP932 (一部のみ)
+//! @param	uni		[I]Unicode
+//! @param	cp		[I]コードページ(932のみ)
+//! @return	Shift-JISコード 0=変換不可
+//----------------------------------------------------------------------
+WCHAR ff_uni2oem(DWORD uni, WORD cp)
+{
+	if(cp != 932)
+	{
+		return 0;
+	}
+	if(uni < 0x80)
+	{
+		return (WCHAR)uni;
+	}
+	if(uni >= 0xff61 && uni <= 0xff9f)		// 半角カタカナ
+	{
+		return (WCHAR)(uni - 0xff61 + 0xa1);
+	}
+	if(uni >= 0x3041 && uni <= 0x3093)		// ひらがな
+	{
+		return (WCHAR)(uni - 0x3041 + 0x829f);
+	}
+	if(uni >= 0x30a1 && uni <= 0x30f6)		// カタカナ(0x837fは欠番)
+	{
+		WCHAR sjis = (WCHAR)(uni - 0x30a1 + 0x8340);
+		return (sjis >= 0x837f) ? sjis + 1 : sjis;
+	}
+	if(uni >= 0xff10 && uni <= 0xff19)		// 全角数字
+	{
+		return (WCHAR)(uni - 0xff10 + 0x824f);
+	}
+	if(uni >= 0xff21 && uni <= 0xff3a)		// 全角英大文字
+	{
+		return (WCHAR)(uni - 0xff21 + 0x8260);
+	}
+	if(uni >= 0xff41 && uni <= 0xff5a)		// 全角英小文字
+	{
+		return (WCHAR)(uni - 0xff41 + 0x8281);
+	}
+	switch(uni)
+	{
+	case 0x3000:	return 0x8140;			// 全角スペース
+	case 0x3001:	return 0x8141;			// 、
+	case 0x3002:	return 0x8142;			// 。
+	case 0x30fb:	return 0x8145;			// ・
+	case 0x30fc:	return 0x815b;			// ー
+	case 0x2103:	return 0x818e;			// ℃
+	default:		break;
+	}
+
+	int low = 0;
+	int high = (int)(sizeof(kanjiTable) / sizeof(kanjiTable[0])) - 1;
+	while(low <= high)
+	{
+		int mid = (low + high) / 2;
+		if(kanjiTable[mid].unicode == uni)
+		{
+			return kanjiTable[mid].sjis;
+		}
+		if(kanjiTable[mid].unicode < uni)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid - 1;
+		}
+	}
+	return 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  LFN作業バッファ確保(ffsystem.cと同じくmalloc)
+//! @param	msize	[I]サイズ[byte]
+//! @return	確保した領域
+//----------------------------------------------------------------------
+void *ff_memalloc(UINT msize)
+{
+	return malloc(msize);
+}
+
+//----------------------------------------------------------------------
+//! @brief  LFN作業バッファ解放
+//! @param	mblock	[I]ff_memalloc()で確保した領域
+//----------------------------------------------------------------------
+void ff_memfree(void *mblock)
+{
+	free(mblock);
+}
@@ -0,0 +1,452 @@
+//======================================================================
+//! @file   freertos.c
+//! @brief  [ホスト模擬] FreeRTOS (単一スレッド + 仮想時計)
+//! @note	タスクは生成を記録するだけで実行しない.
+//! 		待ち時間のある処理は仮想時計を進め、期限の来たタイマを呼び出す.
+//======================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/timers.h"
+
+#include "sim.h"
+#include "simdev.h"
+
+//----- 定義 -----
+#define NS_PER_TICK (1000000000ULL / configTICK_RATE_HZ)
+
+struct SimSemaphore
+{
+	int isMutex;					// mutexか
+	UBaseType_t count;				// 取得可能数
+};
+
+struct SimTask
+{
+	char name[16];					// タスク名
+	TaskFunction_t function;		// 関数
+	void *param;					// パラメータ
+	UBaseType_t priority;			// 優先度
+	uint32_t stackDepth;			// スタックサイズ
+	UBaseType_t number;				// タスク番号
+	uint32_t runTimeUs;				// 実行時間(sim_AddTaskRunTime()で設定)
+	struct SimTask *next;			// リスト
+};
+
+struct SimTimer
+{
+	char name[16];					// タイマ名
+	TickType_t period;				// 周期[tick]
+	UBaseType_t autoReload;			// 自動再開
+	void *timerId;					// ID
+	TimerCallbackFunction_t callback;	// コールバック
+	int active;						// 動作中
+	uint64_t expiryNs;				// 満了時刻[ns]
+	struct SimTimer *next;			// リスト
+};
+
+typedef struct
+{
+	size_t size;					// 確保サイズ
+	uint64_t padding;				// 16byte境界合わせ
+} HeapHeader;
+
+//----- 変数 -----
+static uint64_t s_nowNs;			// 仮想時刻[ns]
+static int s_criticalNesting;		// クリティカルセクションのネスト数
+static int s_runningTimers;			// タイマコールバック実行中
+static struct SimTimer *s_timers;	// 全タイマ
+static SimHeapStats s_heap;			// ヒープ統計
+static struct SimTask *s_tasks;		// 全タスク
+static UBaseType_t s_taskNumber;	// 最後に割り当てたタスク番号
+
+//----------------------------------------------------------------------
+//! @brief  RTOS模擬状態の初期化
+//! @note	タイマは停止するが、ファームウェア側がハンドルを持っているため解放しない.
+//----------------------------------------------------------------------
+void simdev_ResetRtos(void)
+{
+	s_nowNs = 0;
+	s_criticalNesting = 0;
+	for(struct SimTimer *timer = s_timers; timer != NULL; timer = timer->next)
+	{
+		timer->active = 0;
+	}
+	while(s_tasks != NULL)
+	{
+		struct SimTask *task = s_tasks;
+		s_tasks = task->next;
+		vPortFree(task);
+	}
+	s_taskNumber = 0;
+	memset(&s_heap, 0, sizeof(s_heap));
+}
+
+//----------------------------------------------------------------------
+//! @brief  仮想時刻取得
+//! @return	仮想時刻[ns]
+//----------------------------------------------------------------------
+uint64_t sim_GetTimeNs(void)
+{
+	return s_nowNs;
+}
+
+//----------------------------------------------------------------------
+//! @brief  仮想時計を進める
+//! @param	ns		[I]進める時間[ns]
+//! @note	途中で期限の来たハードウェアタイマは、その時刻まで進めてから呼ぶ.
+//----------------------------------------------------------------------
+void sim_AdvanceNs(uint64_t ns)
+{
+	uint64_t targetNs = s_nowNs + ns;
+	uint64_t alarmNs;
+
+	while(simdev_HwTimerAlarm(&alarmNs) && alarmNs <= targetNs)
+	{
+		if(s_nowNs < alarmNs)
+		{
+			s_nowNs = alarmNs;
+		}
+		simdev_FireHwTimer();
+	}
+	if(s_nowNs < targetNs)
+	{
+		s_nowNs = targetNs;
+	}
+	simdev_RunTimers();
+}
+
+//----------------------------------------------------------------------
+//! @brief  仮想時計を進める(タイマ呼び出しなし)
+//! @param	ns		[I]進める時間[ns]
+//! @note	転送中など、途中でコールバックを呼べない区間で使う.
+//----------------------------------------------------------------------
+void simdev_AddTimeNs(uint64_t ns)
+{
+	s_nowNs += ns;
+}
+
+//----------------------------------------------------------------------
+//! @brief  期限の来たタイマのコールバック呼び出し
+//----------------------------------------------------------------------
+void simdev_RunTimers(void)
+{
+	if(s_runningTimers)
+	{
+		return;
+	}
+	s_runningTimers = 1;
+	for(struct SimTimer *timer = s_timers; timer != NULL; timer = timer->next)
+	{
+		if(timer->active && timer->expiryNs <= s_nowNs)
+		{
+			if(timer->autoReload)
+			{
+				timer->expiryNs += timer->period * NS_PER_TICK;
+			}
+			else
+			{
+				timer->active = 0;
+			}
+			timer->callback(timer);
+		}
+	}
+	s_runningTimers = 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ヒープ統計取得
+//! @param	stats	[O]統計
+//----------------------------------------------------------------------
+void sim_GetHeapStats(SimHeapStats *stats)
+{
+	*stats = s_heap;
+}
+
+//----------------------------------------------------------------------
+//! @brief  メモリ確保
+//----------------------------------------------------------------------
+void *pvPortMalloc(size_t size)
+{
+	HeapHeader *header = malloc(sizeof(HeapHeader) + size);
+	if(header == NULL)
+	{
+		return NULL;
+	}
+	header->size = size;
+	s_heap.allocCount++;
+	s_heap.allocBytes += size;
+	s_heap.inUseBytes += size;
+	if(s_heap.inUseBytes > s_heap.peakInUseBytes)
+	{
+		s_heap.peakInUseBytes = s_heap.inUseBytes;
+	}
+	return header + 1;
+}
+
+//----------------------------------------------------------------------
+//! @brief  メモリ解放
+//----------------------------------------------------------------------
+void vPortFree(void *p)
+{
+	if(p == NULL)
+	{
+		return;
+	}
+	HeapHeader *header = (HeapHeader *)p - 1;
+	s_heap.freeCount++;
+	s_heap.inUseBytes -= header->size;
+	free(header);
+}
+
+//----------------------------------------------------------------------
+//! @brief  クリティカルセクション
+//----------------------------------------------------------------------
+void vPortEnterCritical(void)
+{
+	s_criticalNesting++;
+}
+
+void vPortExitCritical(void)
+{
+	if(s_criticalNesting <= 0)
+	{
+		fprintf(stderr, "sim: vPortExitCritical without enter\n");
+		abort();
+	}
+	s_criticalNesting--;
+}
+
+//----------------------------------------------------------------------
+//! @brief  タスク生成(記録のみ)
+//----------------------------------------------------------------------
+BaseType_t xTaskCreate(TaskFunction_t function, const char *name, uint32_t stackDepth, void *param, UBaseType_t priority, TaskHandle_t *handle)
+{
+	struct SimTask *task = pvPortMalloc(sizeof(struct SimTask));
+	if(task == NULL)
+	{
+		return pdFAIL;
+	}
+	snprintf(task->name, sizeof(task->name), "%s", name);
+	task->function = function;
+	task->param = param;
+	task->priority = priority;
+	task->stackDepth = stackDepth;
+	task->number = ++s_taskNumber;
+	task->runTimeUs = 0;
+	task->next = s_tasks;
+	s_tasks = task;
+	if(handle != NULL)
+	{
+		*handle = task;
+	}
+	return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+	for(struct SimTask **p = &s_tasks; *p != NULL; p = &(*p)->next)
+	{
+		if(*p == task)
+		{
+			*p = task->next;
+			vPortFree(task);
+			break;
+		}
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  タスク情報
+//! @note	タスクは実行しないので、実行時間はsim_AddTaskRunTime()で与えた値、
+//! 		スタック残量は生成時のサイズになる.
+//----------------------------------------------------------------------
+void sim_AddTaskRunTime(void *task, uint32_t us)
+{
+	((struct SimTask *)task)->runTimeUs += us;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks(void)
+{
+	UBaseType_t count = 0;
+	for(struct SimTask *task = s_tasks; task != NULL; task = task->next)
+	{
+		count++;
+	}
+	return count;
+}
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *taskStatusArray, UBaseType_t arraySize, uint32_t *totalRunTime)
+{
+	UBaseType_t count = 0;
+	for(struct SimTask *task = s_tasks; task != NULL && count < arraySize; task = task->next, count++)
+	{
+		TaskStatus_t *status = &taskStatusArray[count];
+		memset(status, 0, sizeof(*status));
+		status->xHandle = task;
+		status->pcTaskName = task->name;
+		status->xTaskNumber = task->number;
+		status->eCurrentState = eBlocked;
+		status->uxCurrentPriority = status->uxBasePriority = task->priority;
+		status->ulRunTimeCounter = task->runTimeUs;
+		status->usStackHighWaterMark = (uint16_t)task->stackDepth;
+	}
+	if(totalRunTime != NULL)
+	{
+		*totalRunTime = (uint32_t)(s_nowNs / 1000);
+	}
+	return count;
+}
+
+//----------------------------------------------------------------------
+//! @brief  待ち(仮想時計を進める)
+//----------------------------------------------------------------------
+void vTaskDelay(TickType_t ticks)
+{
+	sim_AdvanceNs(ticks * NS_PER_TICK);
+}
+
+//----------------------------------------------------------------------
+//! @brief  実行中タスク(単一スレッドなので常にNULL)
+//----------------------------------------------------------------------
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+	return NULL;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+	return (TickType_t)(s_nowNs / NS_PER_TICK);
+}
+
+//----------------------------------------------------------------------
+//! @brief  セマフォ
+//! @note	単一スレッドなので、無期限待ちで取得できない場合はデッドロックとして停止する.
+//! 		期限付きの待ちは1tickずつ進め、タイマや割込みから与えられたらそこで取得する.
+//----------------------------------------------------------------------
+static SemaphoreHandle_t CreateSemaphore(int isMutex, UBaseType_t count)
+{
+	SemaphoreHandle_t semaphore = pvPortMalloc(sizeof(struct SimSemaphore));
+	if(semaphore != NULL)
+	{
+		semaphore->isMutex = isMutex;
+		semaphore->count = count;
+	}
+	return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+	return CreateSemaphore(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+	return CreateSemaphore(0, 0);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks)
+{
+	if(semaphore->count > 0)
+	{
+		semaphore->count--;
+		return pdTRUE;
+	}
+	if(ticks == portMAX_DELAY)
+	{
+		fprintf(stderr, "sim: deadlock (semaphore %p taken twice)\n", (void *)semaphore);
+		abort();
+	}
+	for(TickType_t i = 0; i < ticks && semaphore->count == 0; i++)
+	{
+		vTaskDelay(1);
+	}
+	if(semaphore->count > 0)
+	{
+		semaphore->count--;
+		return pdTRUE;
+	}
+	return pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+	if(semaphore->isMutex && semaphore->count != 0)
+	{
+		return pdFALSE;
+	}
+	semaphore->count++;
+	return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *higherPriorityTaskWoken)
+{
+	if(higherPriorityTaskWoken != NULL)
+	{
+		*higherPriorityTaskWoken = pdFALSE;
+	}
+	return xSemaphoreGive(semaphore);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore)
+{
+	vPortFree(semaphore);
+}
+
+//----------------------------------------------------------------------
+//! @brief  ソフトウェアタイマ
+//----------------------------------------------------------------------
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t autoReload, void *timerId, TimerCallbackFunction_t callback)
+{
+	struct SimTimer *timer = pvPortMalloc(sizeof(struct SimTimer));
+	if(timer == NULL)
+	{
+		return NULL;
+	}
+	snprintf(timer->name, sizeof(timer->name), "%s", name);
+	timer->period = period;
+	timer->autoReload = autoReload;
+	timer->timerId = timerId;
+	timer->callback = callback;
+	timer->active = 0;
+	timer->expiryNs = 0;
+	timer->next = s_timers;
+	s_timers = timer;
+	return timer;
+}
+
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticks)
+{
+	timer->active = 1;
+	timer->expiryNs = s_nowNs + timer->period * NS_PER_TICK;
+	return pdPASS;
+}
+
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticks)
+{
+	timer->active = 0;
+	return pdPASS;
+}
+
+BaseType_t xTimerDelete(TimerHandle_t timer, TickType_t ticks)
+{
+	for(struct SimTimer **link = &s_timers; *link != NULL; link = &(*link)->next)
+	{
+		if(*link == timer)
+		{
+			*link = timer->next;
+			vPortFree(timer);
+			return pdPASS;
+		}
+	}
+	return pdFAIL;
+}
+
+void *pvTimerGetTimerID(TimerHandle_t timer)
+{
+	return timer->timerId;
+}
@@ -0,0 +1,165 @@
+//======================================================================
+//! @file   gpio.c
+//! @brief  [ホスト模擬] GPIO & ピン機能選択
+//======================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "driver/gpio.h"
+#include "driver/i2c.h"
+
+#include "global.h"
+#include "sim.h"
+#include "simdev.h"
+
+//----- 定義 -----
+static const struct
+{
+	uint32_t reg;					// ピン機能選択レジスタ
+	int gpioNum;					// GPIO番号
+} muxTable[] =
+{
+	{PERIPHS_IO_MUX_GPIO0_U, 0},
+	{PERIPHS_IO_MUX_U0TXD_U, 1},
+	{PERIPHS_IO_MUX_GPIO2_U, 2},
+	{PERIPHS_IO_MUX_U0RXD_U, 3},
+	{PERIPHS_IO_MUX_GPIO4_U, 4},
+	{PERIPHS_IO_MUX_GPIO5_U, 5},
+	{PERIPHS_IO_MUX_MTDI_U, 12},
+	{PERIPHS_IO_MUX_MTCK_U, 13},
+	{PERIPHS_IO_MUX_MTMS_U, 14},
+	{PERIPHS_IO_MUX_MTDO_U, 15},
+};
+
+//----- 変数 -----
+static int s_level[GPIO_NUM_MAX];			// 出力レベル
+static gpio_mode_t s_mode[GPIO_NUM_MAX];	// 入出力設定
+static uint32_t s_function[GPIO_NUM_MAX];	// ピン機能
+
+//----------------------------------------------------------------------
+//! @brief  GPIO模擬状態の初期化
+//----------------------------------------------------------------------
+void simdev_ResetGpio(void)
+{
+	memset(s_mode, 0, sizeof(s_mode));
+	memset(s_function, 0, sizeof(s_function));
+	for(int i = 0; i < GPIO_NUM_MAX; i++)
+	{
+		s_level[i] = 1;				// CSはプルアップされている前提
+	}
+}
+
+int simdev_GpioLevel(int gpioNum)
+{
+	return s_level[gpioNum];
+}
+
+uint32_t simdev_PinFunction(int gpioNum)
+{
+	return s_function[gpioNum];
+}
+
+uint32_t sim_GpioMuxReg(gpio_num_t gpioNum)
+{
+	for(size_t i = 0; i < sizeof(muxTable) / sizeof(muxTable[0]); i++)
+	{
+		if(muxTable[i].gpioNum == (int)gpioNum)
+		{
+			return muxTable[i].reg;
+		}
+	}
+	fprintf(stderr, "sim: no mux register for GPIO%d\n", (int)gpioNum);
+	abort();
+}
+
+void sim_PinFuncSelect(uint32_t reg, uint32_t function)
+{
+	for(size_t i = 0; i < sizeof(muxTable) / sizeof(muxTable[0]); i++)
+	{
+		if(muxTable[i].reg == reg)
+		{
+			s_function[muxTable[i].gpioNum] = function;
+			return;
+		}
+	}
+	fprintf(stderr, "sim: unknown mux register 0x%08x\n", (unsigned)reg);
+	abort();
+}
+
+esp_err_t gpio_config(const gpio_config_t *config)
+{
+	for(int i = 0; i < GPIO_NUM_MAX; i++)
+	{
+		if(config->pin_bit_mask & (1UL << i))
+		{
+			s_mode[i] = config->mode;
+		}
+	}
+	return ESP_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  出力レベル設定
+//! @note	SD CSとLCD CSが同時にLの間はLCDがリセットされる(回路図 *1).
+//! 		1-Wireのピンは模擬デバイスにレベルの変化を伝える.
+//----------------------------------------------------------------------
+esp_err_t gpio_set_level(gpio_num_t gpioNum, uint32_t level)
+{
+	if(gpioNum >= GPIO_NUM_MAX)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+	int wasReset = (s_level[GPIO_SDCS_NUM] == 0 && s_level[GPIO_LCDCS_NUM] == 0);
+	if(gpioNum == GPIO_ONEWIRE_NUM && (level != 0) != s_level[gpioNum])
+	{
+		simdev_OneWireDrive(level != 0);
+	}
+	if(gpioNum == GPIO_SDCS_NUM && level != 0 && s_level[gpioNum] == 0 && !wasReset)
+	{
+		simdev_SdDeselected();
+	}
+	s_level[gpioNum] = (level != 0);
+	int isReset = (s_level[GPIO_SDCS_NUM] == 0 && s_level[GPIO_LCDCS_NUM] == 0);
+	if(isReset && !wasReset)
+	{
+		simdev_LcdHardReset();
+	}
+	return ESP_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  入力レベル
+//! @note	1-Wireのピンは自分の出力とデバイスの出力のワイヤードAND(オープンドレイン).
+//----------------------------------------------------------------------
+int gpio_get_level(gpio_num_t gpioNum)
+{
+	if(gpioNum == GPIO_ONEWIRE_NUM)
+	{
+		return s_level[gpioNum] && simdev_OneWireLevel();
+	}
+	return (gpioNum < GPIO_NUM_MAX) ? s_level[gpioNum] : 0;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpioNum, gpio_mode_t mode)
+{
+	if(gpioNum >= GPIO_NUM_MAX)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+	s_mode[gpioNum] = mode;
+	return ESP_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  I2C (設定を受け付けるだけ)
+//----------------------------------------------------------------------
+esp_err_t i2c_driver_install(i2c_port_t port, i2c_mode_t mode)
+{
+	return ESP_OK;
+}
+
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t *config)
+{
+	return ESP_OK;
+}
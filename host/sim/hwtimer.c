@@ -0,0 +1,108 @@
+//======================================================================
+//! @file   hwtimer.c
+//! @brief  [ホスト模擬] ハードウェアタイマ(FRC1) & ビジーウェイト
+//! @note	期限の来たアラームはsim_AdvanceNs()が期限の時刻でコールバックを呼ぶ.
+//! 		コールバック内のets_delay_us()は仮想時計だけ進める(割込み中なので他のタイマは呼ばない).
+//======================================================================
+#include <stdio.h>
+
+#include "driver/hw_timer.h"
+#include "rom/ets_sys.h"
+
+#include "sim.h"
+#include "simdev.h"
+
+//----- 定義 -----
+#define ONESHOT_MIN_US		10			// 1回のアラームの最小[us](実機のhw_timer_alarm_us()と同じ)
+#define RELOAD_MIN_US		50			// 自動再開の最小[us]
+#define VALUE_MAX_US		0x199999	// 最大[us]
+
+//----- 変数 -----
+static hw_timer_callback_t s_callback;	// コールバック
+static void *s_arg;						// コールバックのパラメータ
+static int s_armed;						// アラーム設定中
+static int s_reload;					// 自動再開
+static uint64_t s_periodNs;				// 周期[ns]
+static uint64_t s_alarmNs;				// 期限[ns]
+
+//----------------------------------------------------------------------
+//! @brief  タイマ模擬状態の初期化(コールバックはファームウェアの設定を残す)
+//----------------------------------------------------------------------
+void simdev_ResetHwTimer(void)
+{
+	s_armed = 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  次の期限
+//! @param	ns		[O]期限[ns]
+//! @return	1=アラーム設定中
+//----------------------------------------------------------------------
+int simdev_HwTimerAlarm(uint64_t *ns)
+{
+	*ns = s_alarmNs;
+	return s_armed && s_callback != NULL;
+}
+
+//----------------------------------------------------------------------
+//! @brief  コールバック呼び出し(割込み)
+//----------------------------------------------------------------------
+void simdev_FireHwTimer(void)
+{
+	if(s_reload)
+	{
+		s_alarmNs += s_periodNs;
+	}
+	else
+	{
+		s_armed = 0;
+	}
+	s_callback(s_arg);
+}
+
+esp_err_t hw_timer_init(hw_timer_callback_t callback, void *arg)
+{
+	s_callback = callback;
+	s_arg = arg;
+	s_armed = 0;
+	return ESP_OK;
+}
+
+esp_err_t hw_timer_deinit(void)
+{
+	s_callback = NULL;
+	s_armed = 0;
+	return ESP_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  アラーム設定(現在の仮想時刻から)
+//! @note	実機と同じ範囲外の値は受け付けない.
+//----------------------------------------------------------------------
+esp_err_t hw_timer_alarm_us(uint32_t value, bool reload)
+{
+	if(value <= (reload ? RELOAD_MIN_US : ONESHOT_MIN_US) || value > VALUE_MAX_US)
+	{
+		fprintf(stderr, "sim: hw_timer_alarm_us(%u) out of range\n", (unsigned)value);
+		return ESP_ERR_INVALID_ARG;
+	}
+	s_periodNs = (uint64_t)value * 1000;
+	s_alarmNs = sim_GetTimeNs() + s_periodNs;
+	s_reload = reload;
+	s_armed = 1;
+	return ESP_OK;
+}
+
+esp_err_t hw_timer_disarm(void)
+{
+	s_armed = 0;
+	return ESP_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ビジーウェイト
+//----------------------------------------------------------------------
+void ets_delay_us(uint32_t us)
+{
+	simdev_AddTimeNs((uint64_t)us * 1000);
+}
@@ -0,0 +1,42 @@
+//======================================================================
+//! @file   diskio.h
+//! @brief  [ホスト模擬] FatFsディスクI/O
+//======================================================================
+#ifndef _DISKIO_H_
+#define _DISKIO_H_
+
+#include "ff.h"
+
+typedef BYTE DSTATUS;
+typedef enum
+{
+	RES_OK = 0,
+	RES_ERROR,
+	RES_WRPRT,
+	RES_NOTRDY,
+	RES_PARERR
+} DRESULT;
+
+#define STA_NOINIT		0x01
+#define STA_NODISK		0x02
+#define STA_PROTECT		0x04
+
+#define CTRL_SYNC			0
+#define GET_SECTOR_COUNT	1
+#define GET_SECTOR_SIZE		2
+#define GET_BLOCK_SIZE		3
+#define CTRL_TRIM			4
+
+DSTATUS ff_disk_initialize(BYTE pdrv);
+DSTATUS ff_disk_status(BYTE pdrv);
+DRESULT ff_disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count);
+DRESULT ff_disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count);
+DRESULT ff_disk_ioctl(BYTE pdrv, BYTE cmd, void *buff);
+
+#define disk_initialize	ff_disk_initialize
+#define disk_status		ff_disk_status
+#define disk_read		ff_disk_read
+#define disk_write		ff_disk_write
+#define disk_ioctl		ff_disk_ioctl
+
+#endif
@@ -0,0 +1,25 @@
+//======================================================================
+//! @file   diskio_impl.h
+//! @brief  [ホスト模擬] ディスクI/O実装の登録
+//======================================================================
+#ifndef _DISKIO_IMPL_H_
+#define _DISKIO_IMPL_H_
+
+#include "esp_err.h"
+#include "diskio.h"
+
+typedef struct
+{
+	DSTATUS (*init)(BYTE pdrv);
+	DSTATUS (*status)(BYTE pdrv);
+	DRESULT (*read)(BYTE pdrv, BYTE *buff, DWORD sector, UINT count);
+	DRESULT (*write)(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count);
+	DRESULT (*ioctl)(BYTE pdrv, BYTE cmd, void *buff);
+} ff_diskio_impl_t;
+
+void ff_diskio_register(BYTE pdrv, const ff_diskio_impl_t *discioImpl);
+esp_err_t ff_diskio_get_drive(BYTE *outPdrv);
+
+#define ff_diskio_unregister(pdrv)	ff_diskio_register((pdrv), NULL)
+
+#endif
@@ -0,0 +1,24 @@
+//======================================================================
+//! @file   adc.h
+//! @brief  [ホスト模擬] ADCドライバ(TOUT)
+//! @note	読込値はsim_SetAdc()で設定する.
+//======================================================================
+#ifndef _ADC_H_
+#define _ADC_H_
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef enum {ADC_READ_TOUT_MODE = 0, ADC_READ_VDD_MODE, ADC_READ_MAX_MODE} adc_mode_t;
+
+typedef struct
+{
+	adc_mode_t mode;
+	uint8_t clk_div;
+} adc_config_t;
+
+esp_err_t adc_init(adc_config_t *config);
+esp_err_t adc_read(uint16_t *data);
+
+#endif
@@ -0,0 +1,92 @@
+//======================================================================
+//! @file   gpio.h
+//! @brief  [ホスト模擬] GPIOドライバ & ピン機能選択
+//======================================================================
+#ifndef _DRIVER_GPIO_H_
+#define _DRIVER_GPIO_H_
+
+#include <stdint.h>
+
+#include "esp_attr.h"
+#include "esp_err.h"
+
+typedef enum
+{
+	GPIO_NUM_0 = 0, GPIO_NUM_1, GPIO_NUM_2, GPIO_NUM_3, GPIO_NUM_4, GPIO_NUM_5,
+	GPIO_NUM_6, GPIO_NUM_7, GPIO_NUM_8, GPIO_NUM_9, GPIO_NUM_10, GPIO_NUM_11,
+	GPIO_NUM_12, GPIO_NUM_13, GPIO_NUM_14, GPIO_NUM_15, GPIO_NUM_16,
+	GPIO_NUM_MAX
+} gpio_num_t;
+
+typedef enum {GPIO_MODE_DISABLE = 0, GPIO_MODE_INPUT, GPIO_MODE_OUTPUT, GPIO_MODE_OUTPUT_OD} gpio_mode_t;
+typedef enum {GPIO_PULLUP_DISABLE = 0, GPIO_PULLUP_ENABLE} gpio_pullup_t;
+typedef enum {GPIO_PULLDOWN_DISABLE = 0, GPIO_PULLDOWN_ENABLE} gpio_pulldown_t;
+typedef enum {GPIO_INTR_DISABLE = 0, GPIO_INTR_POSEDGE, GPIO_INTR_NEGEDGE, GPIO_INTR_ANYEDGE, GPIO_INTR_LOW_LEVEL, GPIO_INTR_HIGH_LEVEL} gpio_int_type_t;
+
+typedef struct
+{
+	uint32_t pin_bit_mask;
+	gpio_mode_t mode;
+	gpio_pullup_t pull_up_en;
+	gpio_pulldown_t pull_down_en;
+	gpio_int_type_t intr_type;
+} gpio_config_t;
+
+#define GPIO_Pin_0		(1UL << 0)
+#define GPIO_Pin_1		(1UL << 1)
+#define GPIO_Pin_2		(1UL << 2)
+#define GPIO_Pin_3		(1UL << 3)
+#define GPIO_Pin_4		(1UL << 4)
+#define GPIO_Pin_5		(1UL << 5)
+#define GPIO_Pin_6		(1UL << 6)
+#define GPIO_Pin_7		(1UL << 7)
+#define GPIO_Pin_8		(1UL << 8)
+#define GPIO_Pin_9		(1UL << 9)
+#define GPIO_Pin_10		(1UL << 10)
+#define GPIO_Pin_11		(1UL << 11)
+#define GPIO_Pin_12		(1UL << 12)
+#define GPIO_Pin_13		(1UL << 13)
+#define GPIO_Pin_14		(1UL << 14)
+#define GPIO_Pin_15		(1UL << 15)
+#define GPIO_Pin_16		(1UL << 16)
+#define GPIO_Pin_All	(0x1ffffUL)
+
+// ピン機能選択レジスタ(アドレスは実機と同じ値)
+#define PERIPHS_IO_MUX			0x60000800UL
+#define PERIPHS_IO_MUX_MTDI_U	(PERIPHS_IO_MUX + 0x04)
+#define PERIPHS_IO_MUX_MTCK_U	(PERIPHS_IO_MUX + 0x08)
+#define PERIPHS_IO_MUX_MTMS_U	(PERIPHS_IO_MUX + 0x0c)
+#define PERIPHS_IO_MUX_MTDO_U	(PERIPHS_IO_MUX + 0x10)
+#define PERIPHS_IO_MUX_U0RXD_U	(PERIPHS_IO_MUX + 0x14)
+#define PERIPHS_IO_MUX_U0TXD_U	(PERIPHS_IO_MUX + 0x18)
+#define PERIPHS_IO_MUX_GPIO0_U	(PERIPHS_IO_MUX + 0x34)
+#define PERIPHS_IO_MUX_GPIO2_U	(PERIPHS_IO_MUX + 0x38)
+#define PERIPHS_IO_MUX_GPIO4_U	(PERIPHS_IO_MUX + 0x3c)
+#define PERIPHS_IO_MUX_GPIO5_U	(PERIPHS_IO_MUX + 0x40)
+#define PAD_XPD_DCDC_CONF		(0x60000700UL + 0xa0)
+
+#define FUNC_GPIO0			0
+#define FUNC_GPIO2			0
+#define FUNC_GPIO4			0
+#define FUNC_GPIO5			0
+#define FUNC_GPIO12			3
+#define FUNC_GPIO13			3
+#define FUNC_GPIO14			3
+#define FUNC_GPIO15			3
+#define FUNC_HSPIQ_MISO		2
+#define FUNC_HSPID_MOSI		2
+#define FUNC_HSPI_CLK		2
+#define FUNC_HSPI_CS0		2
+
+uint32_t sim_GpioMuxReg(gpio_num_t gpioNum);
+void sim_PinFuncSelect(uint32_t reg, uint32_t function);
+
+#define PERIPHS_GPIO_MUX_REG(gpioNum)	sim_GpioMuxReg(gpioNum)
+#define PIN_FUNC_SELECT(reg, function)	sim_PinFuncSelect((reg), (function))
+
+esp_err_t gpio_config(const gpio_config_t *config);
+esp_err_t gpio_set_level(gpio_num_t gpioNum, uint32_t level);
+int gpio_get_level(gpio_num_t gpioNum);
+esp_err_t gpio_set_direction(gpio_num_t gpioNum, gpio_mode_t mode);
+
+#endif
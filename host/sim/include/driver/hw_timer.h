@@ -0,0 +1,21 @@
+//======================================================================
+//! @file   hw_timer.h
+//! @brief  [ホスト模擬] ハードウェアタイマ(FRC1)
+//! @note	コールバックは仮想時計が期限に達したときに呼ぶ(割込み相当).
+//======================================================================
+#ifndef _DRIVER_HW_TIMER_H_
+#define _DRIVER_HW_TIMER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef void (*hw_timer_callback_t)(void *arg);
+
+esp_err_t hw_timer_init(hw_timer_callback_t callback, void *arg);
+esp_err_t hw_timer_deinit(void);
+esp_err_t hw_timer_alarm_us(uint32_t value, bool reload);
+esp_err_t hw_timer_disarm(void);
+
+#endif
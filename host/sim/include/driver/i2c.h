@@ -0,0 +1,26 @@
+//======================================================================
+//! @file   i2c.h
+//! @brief  [ホスト模擬] I2Cドライバ
+//======================================================================
+#ifndef _DRIVER_I2C_H_
+#define _DRIVER_I2C_H_
+
+#include "driver/gpio.h"
+
+typedef enum {I2C_NUM_0 = 0, I2C_NUM_MAX} i2c_port_t;
+typedef enum {I2C_MODE_MASTER, I2C_MODE_MAX} i2c_mode_t;
+
+typedef struct
+{
+	i2c_mode_t mode;
+	gpio_num_t sda_io_num;
+	gpio_pullup_t sda_pullup_en;
+	gpio_num_t scl_io_num;
+	gpio_pullup_t scl_pullup_en;
+	uint32_t clk_stretch_tick;
+} i2c_config_t;
+
+esp_err_t i2c_driver_install(i2c_port_t port, i2c_mode_t mode);
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t *config);
+
+#endif
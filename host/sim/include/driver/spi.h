@@ -0,0 +1,116 @@
+//======================================================================
+//! @file   spi.h
+//! @brief  [ホスト模擬] SPIドライバ
+//! @note	転送内容はCS状態に応じてSDカード/LCDパネルの模擬デバイスへ渡される.
+//======================================================================
+#ifndef _DRIVER_SPI_H_
+#define _DRIVER_SPI_H_
+
+#include <stdint.h>
+
+#include "esp_attr.h"
+#include "esp_err.h"
+
+typedef enum {CSPI_HOST = 0, HSPI_HOST, SPI_NUM_MAX} spi_host_t;
+typedef enum {SPI_MASTER_MODE, SPI_SLAVE_MODE} spi_mode_t;
+
+typedef enum
+{
+	SPI_2MHz_DIV  = 40,
+	SPI_4MHz_DIV  = 20,
+	SPI_5MHz_DIV  = 16,
+	SPI_8MHz_DIV  = 10,
+	SPI_10MHz_DIV = 8,
+	SPI_16MHz_DIV = 5,
+	SPI_20MHz_DIV = 4,
+	SPI_40MHz_DIV = 2,
+	SPI_80MHz_DIV = 1,
+} spi_clk_div_t;
+
+#define SPI_CPOL_LOW			0
+#define SPI_CPOL_HIGH			1
+#define SPI_CPHA_LOW			0
+#define SPI_CPHA_HIGH			1
+#define SPI_BIT_ORDER_MSB_FIRST	1
+#define SPI_BIT_ORDER_LSB_FIRST	0
+#define SPI_BYTE_ORDER_MSB_FIRST	1
+#define SPI_BYTE_ORDER_LSB_FIRST	0
+
+typedef union
+{
+	struct
+	{
+		uint32_t cpol:          1;
+		uint32_t cpha:          1;
+		uint32_t bit_tx_order:  1;
+		uint32_t bit_rx_order:  1;
+		uint32_t byte_tx_order: 1;
+		uint32_t byte_rx_order: 1;
+		uint32_t mosi_en:       1;
+		uint32_t miso_en:       1;
+		uint32_t cs_en:         1;
+		uint32_t reserved9:    23;
+	};
+	uint32_t val;
+} spi_interface_t;
+
+typedef union
+{
+	struct
+	{
+		uint32_t read_buffer:  1;
+		uint32_t write_buffer: 1;
+		uint32_t read_status:  1;
+		uint32_t write_status: 1;
+		uint32_t trans_done:   1;
+		uint32_t reserved5:   27;
+	};
+	uint32_t val;
+} spi_intr_enable_t;
+
+#define SPI_MASTER_DEFAULT_INTR_ENABLE	0x10
+
+enum
+{
+	SPI_INIT_EVENT = 0,
+	SPI_TRANS_START_EVENT,
+	SPI_TRANS_DONE_EVENT,
+	SPI_DEINIT_EVENT
+};
+
+typedef void (*spi_event_callback_t)(int event, void *arg);
+
+typedef struct
+{
+	spi_interface_t interface;
+	spi_intr_enable_t intr_enable;
+	spi_event_callback_t event_cb;
+	spi_mode_t mode;
+	spi_clk_div_t clk_div;
+} spi_config_t;
+
+typedef struct
+{
+	uint16_t *cmd;
+	uint32_t *addr;
+	uint32_t *mosi;
+	uint32_t *miso;
+	union
+	{
+		struct
+		{
+			uint32_t cmd:   5;
+			uint32_t addr:  7;
+			uint32_t mosi: 10;
+			uint32_t miso: 10;
+		};
+		uint32_t val;
+	} bits;
+} spi_trans_t;
+
+esp_err_t spi_init(spi_host_t host, spi_config_t *config);
+esp_err_t spi_set_interface(spi_host_t host, spi_interface_t *interface);
+esp_err_t spi_set_clk_div(spi_host_t host, spi_clk_div_t *clkDiv);
+esp_err_t spi_trans(spi_host_t host, spi_trans_t *trans);
+
+#endif
@@ -0,0 +1,18 @@
+//======================================================================
+//! @file   uart.h
+//! @brief  [ホスト模擬] UARTドライバ
+//! @note	受信データはないので、コンソールはconsole_Execute()を直接呼んで試験する.
+//======================================================================
+#ifndef _UART_H_
+#define _UART_H_
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+typedef enum {UART_NUM_0 = 0, UART_NUM_1, UART_NUM_MAX} uart_port_t;
+typedef void *QueueHandle_t;
+
+esp_err_t uart_driver_install(uart_port_t uartNum, int rxBufferSize, int txBufferSize, int queueSize, QueueHandle_t *uartQueue);
+int uart_read_bytes(uart_port_t uartNum, uint8_t *buf, uint32_t length, TickType_t ticksToWait);
+
+#endif
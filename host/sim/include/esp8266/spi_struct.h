@@ -0,0 +1,30 @@
+//======================================================================
+//! @file   spi_struct.h
+//! @brief  [ホスト模擬] SPIレジスタ
+//! @note	クロック設定のみ模擬する.転送時間の計算に使用される.
+//======================================================================
+#ifndef _ESP8266_SPI_STRUCT_H_
+#define _ESP8266_SPI_STRUCT_H_
+
+#include <stdint.h>
+
+typedef struct
+{
+	union
+	{
+		struct
+		{
+			uint32_t clkcnt_l:       6;
+			uint32_t clkcnt_h:       6;
+			uint32_t clkcnt_n:       6;
+			uint32_t clkdiv_pre:    13;
+			uint32_t clk_equ_sysclk: 1;
+		};
+		uint32_t val;
+	} clock;
+} spi_dev_t;
+
+extern volatile spi_dev_t SPI0;
+extern volatile spi_dev_t SPI1;
+
+#endif
@@ -0,0 +1,12 @@
+//======================================================================
+//! @file   esp_attr.h
+//! @brief  [ホスト模擬] 配置属性
+//======================================================================
+#ifndef _ESP_ATTR_H_
+#define _ESP_ATTR_H_
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+
+#endif
@@ -0,0 +1,37 @@
+//======================================================================
+//! @file   esp_err.h
+//! @brief  [ホスト模擬] エラーコード
+//======================================================================
+#ifndef _ESP_ERR_H_
+#define _ESP_ERR_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+typedef int32_t esp_err_t;
+
+#define ESP_OK							0
+#define ESP_FAIL						-1
+#define ESP_ERR_NO_MEM					0x101
+#define ESP_ERR_INVALID_ARG				0x102
+#define ESP_ERR_INVALID_STATE			0x103
+#define ESP_ERR_INVALID_SIZE			0x104
+#define ESP_ERR_NOT_FOUND				0x105
+#define ESP_ERR_TIMEOUT					0x107
+#define ESP_ERR_NVS_NO_FREE_PAGES		0x110d
+#define ESP_ERR_NVS_NEW_VERSION_FOUND	0x1110
+
+#define ESP_ERROR_CHECK(x)															\
+	do																				\
+	{																				\
+		esp_err_t err_rc_ = (x);													\
+		if(err_rc_ != ESP_OK)														\
+		{																			\
+			fprintf(stderr, "ESP_ERROR_CHECK failed: 0x%x at %s:%d\n",				\
+				(unsigned)err_rc_, __FILE__, __LINE__);								\
+			abort();																\
+		}																			\
+	} while(0)
+
+#endif
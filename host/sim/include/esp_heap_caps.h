@@ -0,0 +1,18 @@
+//======================================================================
+//! @file   esp_heap_caps.h
+//! @brief  [ホスト模擬] ヒープ領域別情報
+//! @note	模擬ヒープは全てDRAM(バイトアクセス可能)扱い.
+//======================================================================
+#ifndef _ESP_HEAP_CAPS_H_
+#define _ESP_HEAP_CAPS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MALLOC_CAP_32BIT	(1 << 1)
+#define MALLOC_CAP_8BIT		(1 << 2)
+#define MALLOC_CAP_DMA		(1 << 3)
+
+size_t heap_caps_get_free_size(uint32_t caps);
+
+#endif
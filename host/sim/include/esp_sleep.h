@@ -0,0 +1,17 @@
+//======================================================================
+//! @file   esp_sleep.h
+//! @brief  [ホスト模擬] ディープスリープ
+//! @note	実機のesp_deep_sleep()は戻らないが、ホストでは要求を記録して戻る.
+//! 		起床はsim_DeepSleepWake()で行う.
+//======================================================================
+#ifndef _ESP_SLEEP_H_
+#define _ESP_SLEEP_H_
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+void esp_deep_sleep(uint64_t time_in_us);
+esp_err_t esp_deep_sleep_set_rf_option(uint8_t option);
+
+#endif
@@ -0,0 +1,35 @@
+//======================================================================
+//! @file   esp_system.h
+//! @brief  [ホスト模擬] システム情報
+//======================================================================
+#ifndef _ESP_SYSTEM_H_
+#define _ESP_SYSTEM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// リセット要因
+typedef enum
+{
+	ESP_RST_UNKNOWN = 0,
+	ESP_RST_POWERON,
+	ESP_RST_EXT,
+	ESP_RST_SW,
+	ESP_RST_PANIC,
+	ESP_RST_INT_WDT,
+	ESP_RST_TASK_WDT,
+	ESP_RST_WDT,
+	ESP_RST_DEEPSLEEP,
+	ESP_RST_BROWNOUT,
+	ESP_RST_SDIO,
+} esp_reset_reason_t;
+
+uint32_t esp_get_free_heap_size(void);
+uint32_t esp_get_minimum_free_heap_size(void);
+esp_reset_reason_t esp_reset_reason(void);
+
+// RTCメモリ(4byteブロック単位のアドレス.64以降がユーザー領域512byte)
+bool system_rtc_mem_read(int src_addr, void *des_addr, int save_size);
+bool system_rtc_mem_write(int des_addr, const void *src_addr, int save_size);
+
+#endif
@@ -0,0 +1,12 @@
+//======================================================================
+//! @file   esp_timer.h
+//! @brief  [ホスト模擬] 高分解能タイマ
+//======================================================================
+#ifndef _ESP_TIMER_H_
+#define _ESP_TIMER_H_
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);		// 仮想時刻[us]
+
+#endif
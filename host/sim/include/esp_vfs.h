@@ -0,0 +1,10 @@
+//======================================================================
+//! @file   esp_vfs.h
+//! @brief  [ホスト模擬] VFS
+//======================================================================
+#ifndef _ESP_VFS_H_
+#define _ESP_VFS_H_
+
+#include "esp_err.h"
+
+#endif
@@ -0,0 +1,16 @@
+//======================================================================
+//! @file   esp_vfs_fat.h
+//! @brief  [ホスト模擬] FatFsのVFS登録
+//======================================================================
+#ifndef _ESP_VFS_FAT_H_
+#define _ESP_VFS_FAT_H_
+
+#include <stddef.h>
+
+#include "esp_err.h"
+#include "ff.h"
+
+esp_err_t esp_vfs_fat_register(const char *basePath, const char *fatDrive, size_t maxFiles, FATFS **outFs);
+esp_err_t esp_vfs_fat_unregister_path(const char *basePath);
+
+#endif
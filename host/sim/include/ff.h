@@ -0,0 +1,77 @@
+//======================================================================
+//! @file   ff.h
+//! @brief  [ホスト模擬] FatFs API
+//! @note	型と定数はFatFs R0.13系に合わせる.
+//! 		ファイルシステム処理はマウント時のディスク初期化とブートセクタ確認のみ模擬する.
+//======================================================================
+#ifndef _FF_H_
+#define _FF_H_
+
+#include <stdint.h>
+
+typedef unsigned int	UINT;
+typedef unsigned char	BYTE;
+typedef uint16_t		WORD;
+typedef uint32_t		DWORD;
+typedef uint64_t		QWORD;
+typedef WORD			WCHAR;
+typedef char			TCHAR;
+typedef DWORD			FSIZE_t;		// FF_FS_EXFAT=0(実機のffconf.hと同じ)
+
+#define FF_CODE_PAGE	932
+#define FF_VOLUMES		2
+#define FF_MAX_SS		512
+#define FF_MIN_SS		512
+#define FF_USE_LFN		3			// CONFIG_FATFS_LFN_HEAP
+#define FF_MAX_LFN		255
+#define FF_FS_EXFAT		0			// SDKのffconf.hで固定(menuconfigの項目なし)
+
+// FATFS.fs_type
+#define FS_FAT12		1
+#define FS_FAT16		2
+#define FS_FAT32		3
+#define FS_EXFAT		4
+
+typedef enum
+{
+	FR_OK = 0,
+	FR_DISK_ERR,
+	FR_INT_ERR,
+	FR_NOT_READY,
+	FR_NO_FILE,
+	FR_NO_PATH,
+	FR_INVALID_NAME,
+	FR_DENIED,
+	FR_EXIST,
+	FR_INVALID_OBJECT,
+	FR_WRITE_PROTECTED,
+	FR_INVALID_DRIVE,
+	FR_NOT_ENABLED,
+	FR_NO_FILESYSTEM,
+	FR_MKFS_ABORTED,
+	FR_TIMEOUT,
+	FR_LOCKED,
+	FR_NOT_ENOUGH_CORE,
+	FR_TOO_MANY_OPEN_FILES,
+	FR_INVALID_PARAMETER
+} FRESULT;
+
+typedef struct
+{
+	BYTE fs_type;		// 0=未マウント
+	BYTE pdrv;			// 物理ドライブ番号
+	WORD ssize;			// セクタサイズ
+	DWORD n_fatent;		// 未使用
+	BYTE win[FF_MAX_SS];
+} FATFS;
+
+FRESULT f_mount(FATFS *fs, const TCHAR *path, BYTE opt);
+FRESULT f_unmount(const TCHAR *path);
+
+WCHAR ff_uni2oem(DWORD uni, WORD cp);
+#if FF_USE_LFN == 3
+void *ff_memalloc(UINT msize);
+void ff_memfree(void *mblock);
+#endif
+
+#endif
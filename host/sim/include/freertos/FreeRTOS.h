@@ -0,0 +1,39 @@
+//======================================================================
+//! @file   FreeRTOS.h
+//! @brief  [ホスト模擬] FreeRTOS基本定義
+//! @note	ホスト上では単一スレッドで動作し、時間は仮想時計(sim.h)で進む.
+//======================================================================
+#ifndef _FREERTOS_H_
+#define _FREERTOS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_attr.h"
+
+typedef int32_t BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint8_t StackType_t;				// ESP8266のスタックサイズ指定はbyte単位
+
+#define configTICK_RATE_HZ		100
+#define configMAX_PRIORITIES	15
+#define configMINIMAL_STACK_SIZE	768
+#define configUSE_TRACE_FACILITY	1
+#define configGENERATE_RUN_TIME_STATS	1
+
+#define pdFALSE					((BaseType_t)0)
+#define pdTRUE					((BaseType_t)1)
+#define pdPASS					pdTRUE
+#define pdFAIL					pdFALSE
+#define portMAX_DELAY			((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS		((TickType_t)1000 / configTICK_RATE_HZ)
+#define portTICK_RATE_MS		portTICK_PERIOD_MS
+#define pdMS_TO_TICKS(ms)		((TickType_t)(((TickType_t)(ms) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000))
+
+void vPortEnterCritical(void);
+void vPortExitCritical(void);
+void *pvPortMalloc(size_t size);
+void vPortFree(void *p);
+
+#endif
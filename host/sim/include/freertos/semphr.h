@@ -0,0 +1,20 @@
+//======================================================================
+//! @file   semphr.h
+//! @brief  [ホスト模擬] FreeRTOSセマフォ
+//======================================================================
+#ifndef _SEMPHR_H_
+#define _SEMPHR_H_
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct SimSemaphore *SemaphoreHandle_t;
+typedef SemaphoreHandle_t xSemaphoreHandle;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *higherPriorityTaskWoken);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+
+#endif
@@ -0,0 +1,19 @@
+//======================================================================
+//! @file   timers.h
+//! @brief  [ホスト模擬] FreeRTOSソフトウェアタイマ
+//======================================================================
+#ifndef _TIMERS_H_
+#define _TIMERS_H_
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct SimTimer *TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t timer);
+
+TimerHandle_t xTimerCreate(const char *name, TickType_t period, UBaseType_t autoReload, void *timerId, TimerCallbackFunction_t callback);
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticks);
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticks);
+BaseType_t xTimerDelete(TimerHandle_t timer, TickType_t ticks);
+void *pvTimerGetTimerID(TimerHandle_t timer);
+
+#endif
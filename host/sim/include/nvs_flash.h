@@ -0,0 +1,13 @@
+//======================================================================
+//! @file   nvs_flash.h
+//! @brief  [ホスト模擬] NVS
+//======================================================================
+#ifndef _NVS_FLASH_H_
+#define _NVS_FLASH_H_
+
+#include "esp_err.h"
+
+esp_err_t nvs_flash_init(void);
+esp_err_t nvs_flash_erase(void);
+
+#endif
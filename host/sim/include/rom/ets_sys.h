@@ -0,0 +1,12 @@
+//======================================================================
+//! @file   ets_sys.h
+//! @brief  [ホスト模擬] ROM関数
+//======================================================================
+#ifndef _ROM_ETS_SYS_H_
+#define _ROM_ETS_SYS_H_
+
+#include <stdint.h>
+
+void ets_delay_us(uint32_t us);			// ビジーウェイト(仮想時計を進める. タイマは呼ばない)
+
+#endif
@@ -0,0 +1,110 @@
+//======================================================================
+//! @file   lcdpanel.c
+//! @brief  [ホスト模擬] LCDパネル(ST7565系コントローラ 132x65)
+//! @note	RS=Lでコマンド、RS=Hで表示RAMへのデータ書込として扱う.
+//======================================================================
+#include <string.h>
+
+#include "sim.h"
+#include "simdev.h"
+
+//----- 変数 -----
+static uint8_t s_ram[SIM_LCD_PAGES + 1][SIM_LCD_COLUMNS];	// 表示RAM(page8はアイコン行)
+static int s_page;							// ページアドレス
+static int s_column;						// カラムアドレス
+static int s_pendingVolume;					// 電子ボリューム値待ち
+static SimLcdStats s_stats;					// 統計
+
+//----------------------------------------------------------------------
+//! @brief  LCD模擬状態の初期化
+//----------------------------------------------------------------------
+void simdev_ResetLcd(void)
+{
+	memset(s_ram, 0, sizeof(s_ram));
+	memset(&s_stats, 0, sizeof(s_stats));
+	s_page = 0;
+	s_column = 0;
+	s_pendingVolume = 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ハードウェアリセット
+//! @note	表示RAMの内容は保持される.
+//----------------------------------------------------------------------
+void simdev_LcdHardReset(void)
+{
+	s_stats.resets++;
+	s_stats.displayOn = 0;
+	s_page = 0;
+	s_column = 0;
+	s_pendingVolume = 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  1byte受信
+//! @param	data	[I]受信データ
+//! @param	isData	[I]!0=データ(RS=H), 0=コマンド(RS=L)
+//----------------------------------------------------------------------
+void simdev_LcdWrite(uint8_t data, int isData)
+{
+	if(isData)
+	{
+		s_stats.dataBytes++;
+		if(s_page <= SIM_LCD_PAGES && s_column < SIM_LCD_COLUMNS)
+		{
+			s_ram[s_page][s_column] = data;
+			s_column++;
+		}
+		return;
+	}
+
+	s_stats.commandBytes++;
+	if(s_pendingVolume)
+	{
+		s_pendingVolume = 0;		// 電子ボリューム値(表示内容には影響しない)
+	}
+	else if(data <= 0x0f)
+	{
+		s_column = (s_column & 0xf0) | data;
+	}
+	else if(data <= 0x1f)
+	{
+		s_column = (s_column & 0x0f) | ((data & 0x0f) << 4);
+	}
+	else if((data & 0xf0) == 0xb0)
+	{
+		s_page = data & 0x0f;
+	}
+	else if(data == 0x81)
+	{
+		s_pendingVolume = 1;
+	}
+	else if(data == 0xae || data == 0xaf)
+	{
+		s_stats.displayOn = data & 0x01;
+	}
+	else if(data == 0xe2)
+	{
+		simdev_LcdHardReset();
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  表示RAM参照
+//! @param	page	[I]ページ(0～7)
+//! @param	column	[I]カラム(0～131)
+//! @return	表示データ(bit0が上)
+//----------------------------------------------------------------------
+uint8_t sim_LcdRam(int page, int column)
+{
+	if(page < 0 || page > SIM_LCD_PAGES || column < 0 || column >= SIM_LCD_COLUMNS)
+	{
+		return 0;
+	}
+	return s_ram[page][column];
+}
+
+void sim_LcdGetStats(SimLcdStats *stats)
+{
+	*stats = s_stats;
+}
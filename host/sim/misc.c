@@ -0,0 +1,130 @@
+//======================================================================
+//! @file   misc.c
+//! @brief  [ホスト模擬] ログ・NVS・Wi-Fi(スタブ) & 模擬環境全体の初期化
+//======================================================================
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "nvs_flash.h"
+#include "driver/uart.h"
+
+#include "wifi.h"
+#include "sim.h"
+#include "simdev.h"
+
+//----- 変数 -----
+static esp_log_level_t s_logLevel = ESP_LOG_WARN;	// 出力するログレベル
+
+//----------------------------------------------------------------------
+//! @brief  模擬環境全体の初期化
+//! @note	時計・GPIO・1-Wire・SPI・ディスクI/O・LCD・RTCメモリを初期状態にし、デフォルトのSDカードを挿入する.
+//----------------------------------------------------------------------
+void sim_Reset(void)
+{
+	simdev_ResetRtos();
+	simdev_ResetHwTimer();
+	simdev_ResetGpio();
+	simdev_ResetOneWire();
+	simdev_ResetSpi();
+	simdev_ResetDiskio();
+	simdev_ResetLcd();
+	simdev_ResetSd();
+	simdev_ResetSleep();
+}
+
+//----------------------------------------------------------------------
+//! @brief  ログ
+//! @note	タグ別の設定はせず、"*"の設定を全体に適用する.
+//----------------------------------------------------------------------
+void esp_log_level_set(const char *tag, esp_log_level_t level)
+{
+	if(strcmp(tag, "*") == 0)
+	{
+		s_logLevel = level;
+	}
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+	static const char letters[] = "NEWIDV";
+	if(level > s_logLevel)
+	{
+		return;
+	}
+	va_list args;
+	va_start(args, format);
+	fprintf(stderr, "%c (%llu) %s: ", letters[level], (unsigned long long)(sim_GetTimeNs() / 1000000), tag);
+	vfprintf(stderr, format, args);
+	fputc('\n', stderr);
+	va_end(args);
+}
+
+//----------------------------------------------------------------------
+//! @brief  NVS
+//----------------------------------------------------------------------
+esp_err_t nvs_flash_init(void)
+{
+	return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+	return ESP_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  Wi-Fi初期化(スタブ)
+//! @note	wifi.cはホストでは構築しない.set_Initialize()から呼ばれるため用意する.
+//----------------------------------------------------------------------
+int wifi_Initialize(void)
+{
+	return 1;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ヒープ残量(SIM_HEAP_SIZEからpvPortMalloc使用量を引いた値)
+//----------------------------------------------------------------------
+uint32_t esp_get_free_heap_size(void)
+{
+	SimHeapStats stats;
+	sim_GetHeapStats(&stats);
+	return (uint32_t)(SIM_HEAP_SIZE - stats.inUseBytes);
+}
+
+uint32_t esp_get_minimum_free_heap_size(void)
+{
+	SimHeapStats stats;
+	sim_GetHeapStats(&stats);
+	return (uint32_t)(SIM_HEAP_SIZE - stats.peakInUseBytes);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+	return esp_get_free_heap_size();
+}
+
+//----------------------------------------------------------------------
+//! @brief  高分解能タイマ(仮想時計, 起動からの時間)
+//----------------------------------------------------------------------
+int64_t esp_timer_get_time(void)
+{
+	return (int64_t)((sim_GetTimeNs() - simdev_BootTimeNs()) / 1000);
+}
+
+//----------------------------------------------------------------------
+//! @brief  UART(受信データなし)
+//----------------------------------------------------------------------
+esp_err_t uart_driver_install(uart_port_t uartNum, int rxBufferSize, int txBufferSize, int queueSize, QueueHandle_t *uartQueue)
+{
+	return ESP_OK;
+}
+
+int uart_read_bytes(uart_port_t uartNum, uint8_t *buf, uint32_t length, TickType_t ticksToWait)
+{
+	return 0;
+}
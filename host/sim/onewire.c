@@ -0,0 +1,445 @@
+//======================================================================
+//! @file   onewire.c
+//! @brief  [ホスト模擬] 1-Wireバス & 温度センサー(DS18B20)
+//! @note	GPIO2のレベルの変化を仮想時刻で受け、パルス幅からリセット・書込0/1・読取りを判定する.
+//! 		対応コマンド: Search ROM, Match ROM, Skip ROM, Convert T, Read Scratchpad.
+//! 		読取りスロットのデバイス出力は立下りから15us(データ有効の最小)だけLにする.
+//======================================================================
+#include <string.h>
+
+#include "sim.h"
+#include "simdev.h"
+
+//----- 定義 -----
+#define FAMILY_DS18B20		0x28
+#define RESET_MIN_NS		480000		// リセットパルスの最小
+#define PRESENCE_WAIT_NS	30000		// 解放からプレゼンスパルスまで(15～60us)
+#define PRESENCE_NS			120000		// プレゼンスパルス(60～240us)
+#define SLOT_MIN_NS			60000		// タイムスロットの最小
+#define RECOVERY_MIN_NS		1000		// スロット間の回復時間の最小
+#define WRITE1_MAX_NS		15000		// 書込1のLの最大(読取りスロットも同じ)
+#define WRITE0_MAX_NS		120000		// 書込0のLの最大
+#define DATA_VALID_NS		15000		// 読取りスロットのデバイス出力
+#define CONVERT_NS			750000000ULL	// 12bit変換時間
+#define POWER_ON_RAW		0x0550		// 電源投入時の温度レジスタ(85℃)
+
+// バスの状態
+typedef enum
+{
+	Bus_Idle,				// リセット待ち
+	Bus_RomCommand,			// ROMコマンド受信中
+	Bus_MatchRom,			// Match ROMのROM受信中
+	Bus_SearchRom,			// Search ROM中
+	Bus_Function,			// 機能コマンド受信中
+	Bus_Converting,			// 変換中(読取りスロットに0=変換中, 1=完了を返す)
+	Bus_ReadScratchpad,		// スクラッチパッド送信中
+} BusState;
+
+// センサー
+typedef struct
+{
+	uint8_t rom[8];			// ROM (family, serial×6, CRC)
+	int16_t raw;			// 温度(1/16℃)
+	int16_t temperature;	// 温度レジスタ
+	uint64_t convertEndNs;	// 変換完了時刻 0=変換していない
+	int corruptReads;		// 壊して返す読出しの残り回数
+	int selected;			// 選択中(Search ROMでは参加中)
+} Probe;
+
+//----- 変数 -----
+static Probe s_probes[SIM_ONEWIRE_PROBES];
+static int s_probeCount;
+static int s_masterLevel;					// マスタの出力
+static uint64_t s_fallNs;					// 直前の立下り
+static uint64_t s_riseNs;					// 直前の立上り
+static int s_inSlot;						// 直前の立下りはタイムスロット
+static int s_afterReset;					// 直前の立上りはリセットパルスの終わり
+static uint64_t s_presenceNs;				// プレゼンスパルス開始 0=なし
+static BusState s_state;
+static uint32_t s_bitCount;					// 状態内のビット数
+static uint8_t s_data[9];					// 受信/送信データ
+static int s_sending;						// このスロットはデバイスが送る
+static int s_sendLow;						// このスロットでデバイスがLにする
+static SimOneWireStats s_stats;
+
+static void Transmit(void);
+static void Received(int bit);
+static void Sent(void);
+static void Select(int (*match)(const Probe *probe));
+static int SelectAll(const Probe *probe);
+static int MatchRom(const Probe *probe);
+static int RomBit(const Probe *probe, uint32_t bit);
+static uint8_t Crc8(const uint8_t *data, size_t length);
+
+//----------------------------------------------------------------------
+//! @brief  1-Wire模擬状態の初期化(センサーを外す)
+//----------------------------------------------------------------------
+void simdev_ResetOneWire(void)
+{
+	memset(s_probes, 0, sizeof(s_probes));
+	s_probeCount = 0;
+	s_masterLevel = 1;
+	s_fallNs = 0;
+	s_riseNs = 0;
+	s_inSlot = 0;
+	s_afterReset = 0;
+	s_presenceNs = 0;
+	s_state = Bus_Idle;
+	s_sending = 0;
+	memset(&s_stats, 0, sizeof(s_stats));
+}
+
+//----------------------------------------------------------------------
+//! @brief  センサーを繋ぐ
+//! @param	serial	[I]シリアル番号(下位48bit)
+//! @param	raw		[I]温度(1/16℃)
+//! @return	番号 -1=満杯
+//----------------------------------------------------------------------
+int sim_OneWireAddProbe(uint64_t serial, int16_t raw)
+{
+	if(s_probeCount >= SIM_ONEWIRE_PROBES)
+	{
+		return -1;
+	}
+	Probe *probe = &s_probes[s_probeCount];
+	probe->rom[0] = FAMILY_DS18B20;
+	for(int i = 0; i < 6; i++)
+	{
+		probe->rom[1 + i] = (uint8_t)(serial >> (8 * i));
+	}
+	probe->rom[7] = Crc8(probe->rom, 7);
+	probe->raw = raw;
+	probe->temperature = POWER_ON_RAW;
+	return s_probeCount++;
+}
+
+void sim_OneWireSetTemperature(int index, int16_t raw)
+{
+	s_probes[index].raw = raw;
+}
+
+//----------------------------------------------------------------------
+//! @brief  スクラッチパッドの読出しをcount回壊す(温度の最下位bitを反転, CRCはそのまま)
+//----------------------------------------------------------------------
+void sim_OneWireCorruptReads(int index, int count)
+{
+	s_probes[index].corruptReads = count;
+}
+
+void sim_OneWireGetRom(int index, uint8_t rom[8])
+{
+	memcpy(rom, s_probes[index].rom, 8);
+}
+
+void sim_OneWireGetStats(SimOneWireStats *stats)
+{
+	*stats = s_stats;
+}
+
+//----------------------------------------------------------------------
+//! @brief  マスタの出力レベルの変化
+//! @param	level	[I]新しいレベル
+//----------------------------------------------------------------------
+void simdev_OneWireDrive(int level)
+{
+	uint64_t nowNs = sim_GetTimeNs();
+
+	s_masterLevel = level;
+	if(!level)
+	{
+		// 立下り: タイムスロットの開始(リセットならそれも判定は立上りで)
+		if(s_inSlot && (nowNs - s_fallNs < SLOT_MIN_NS || nowNs - s_riseNs < RECOVERY_MIN_NS))
+		{
+			s_stats.timingErrors++;
+		}
+		if(s_afterReset && nowNs - s_riseNs < RESET_MIN_NS)
+		{
+			s_stats.timingErrors++;				// プレゼンスの期間を待たなかった
+		}
+		s_afterReset = 0;
+		s_fallNs = nowNs;
+		s_inSlot = (s_state != Bus_Idle);
+		Transmit();
+		return;
+	}
+
+	// 立上り: Lの長さで判定
+	uint64_t lowNs = nowNs - s_fallNs;
+	s_riseNs = nowNs;
+	if(lowNs >= RESET_MIN_NS)
+	{
+		s_stats.resets++;
+		s_inSlot = 0;
+		s_afterReset = 1;
+		s_state = Bus_RomCommand;
+		s_bitCount = 0;
+		memset(s_data, 0, sizeof(s_data));
+		s_presenceNs = (s_probeCount > 0) ? nowNs + PRESENCE_WAIT_NS : 0;
+		return;
+	}
+	if(s_state == Bus_Idle)
+	{
+		return;
+	}
+	s_stats.slots++;
+	if(lowNs < WRITE1_MAX_NS)
+	{
+		if(s_sending)
+		{
+			Sent();
+		}
+		else
+		{
+			Received(1);
+		}
+	}
+	else if(lowNs >= SLOT_MIN_NS && lowNs <= WRITE0_MAX_NS && !s_sending)
+	{
+		Received(0);
+	}
+	else
+	{
+		s_stats.timingErrors++;
+		s_state = Bus_Idle;
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  バスのレベル(デバイス側)
+//! @return	0=デバイスがLにしている
+//----------------------------------------------------------------------
+int simdev_OneWireLevel(void)
+{
+	uint64_t nowNs = sim_GetTimeNs();
+
+	if(s_presenceNs != 0 && nowNs >= s_presenceNs && nowNs < s_presenceNs + PRESENCE_NS)
+	{
+		return 0;
+	}
+	if(s_sending && s_inSlot)
+	{
+		if(nowNs - s_fallNs >= DATA_VALID_NS)
+		{
+			s_stats.lateSamples++;
+			return 1;
+		}
+		return !s_sendLow;
+	}
+	return 1;
+}
+
+//----------------------------------------------------------------------
+//! @brief  このスロットでデバイスが送るビットを決める
+//----------------------------------------------------------------------
+void Transmit(void)
+{
+	uint64_t nowNs = sim_GetTimeNs();
+
+	s_sending = 0;
+	s_sendLow = 0;
+	for(int i = 0; i < s_probeCount; i++)
+	{
+		Probe *probe = &s_probes[i];
+		if(!probe->selected)
+		{
+			continue;
+		}
+		if(probe->convertEndNs != 0 && nowNs >= probe->convertEndNs)
+		{
+			probe->temperature = probe->raw;
+			probe->convertEndNs = 0;
+		}
+		switch(s_state)
+		{
+		case Bus_SearchRom:
+			if(s_bitCount % 3 < 2)
+			{
+				int bit = RomBit(probe, s_bitCount / 3) ^ (s_bitCount % 3);
+				s_sending = 1;
+				s_sendLow |= !bit;
+			}
+			break;
+		case Bus_Converting:
+			s_sending = 1;
+			s_sendLow |= (probe->convertEndNs != 0);
+			break;
+		case Bus_ReadScratchpad:
+			s_sending = 1;
+			s_sendLow |= !((s_data[s_bitCount / 8] >> (s_bitCount % 8)) & 1);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  マスタから1bit受けた
+//----------------------------------------------------------------------
+void Received(int bit)
+{
+	if(s_state == Bus_SearchRom)
+	{
+		// 方向ビット: 違うROMのセンサーは抜ける
+		uint32_t romBit = s_bitCount / 3;
+		for(int i = 0; i < s_probeCount; i++)
+		{
+			s_probes[i].selected &= (RomBit(&s_probes[i], romBit) == bit);
+		}
+		if(++s_bitCount == 64 * 3)
+		{
+			s_state = Bus_Idle;
+		}
+		return;
+	}
+	if(s_state != Bus_RomCommand && s_state != Bus_MatchRom && s_state != Bus_Function)
+	{
+		s_state = Bus_Idle;						// 受け付けない書込み
+		return;
+	}
+	s_data[s_bitCount / 8] |= (uint8_t)(bit << (s_bitCount % 8));
+	s_bitCount++;
+
+	if(s_state == Bus_MatchRom)
+	{
+		if(s_bitCount == 64)
+		{
+			Select(MatchRom);
+			s_state = Bus_Function;
+			s_bitCount = 0;
+			memset(s_data, 0, sizeof(s_data));
+		}
+		return;
+	}
+	if(s_bitCount < 8)
+	{
+		return;
+	}
+
+	uint8_t command = s_data[0];
+	s_bitCount = 0;
+	memset(s_data, 0, sizeof(s_data));
+	if(s_state == Bus_RomCommand)
+	{
+		switch(command)
+		{
+		case 0xcc:								// Skip ROM
+			Select(SelectAll);
+			s_state = Bus_Function;
+			break;
+		case 0x55:								// Match ROM
+			s_state = Bus_MatchRom;
+			break;
+		case 0xf0:								// Search ROM
+			Select(SelectAll);
+			s_state = Bus_SearchRom;
+			break;
+		default:
+			s_state = Bus_Idle;
+			break;
+		}
+		return;
+	}
+
+	// 機能コマンド
+	uint64_t nowNs = sim_GetTimeNs();
+	s_state = Bus_Idle;
+	for(int i = 0; i < s_probeCount; i++)
+	{
+		Probe *probe = &s_probes[i];
+		if(!probe->selected)
+		{
+			continue;
+		}
+		if(command == 0x44)						// Convert T
+		{
+			probe->convertEndNs = nowNs + CONVERT_NS;
+			s_stats.conversions++;
+			s_state = Bus_Converting;
+		}
+		else if(command == 0xbe)				// Read Scratchpad(複数選択ならワイヤードAND)
+		{
+			uint8_t scratchpad[9] = {0, 0, 0x4b, 0x46, 0x7f, 0xff, 0x0c, 0x10, 0};
+			if(probe->convertEndNs != 0 && nowNs >= probe->convertEndNs)
+			{
+				probe->temperature = probe->raw;
+				probe->convertEndNs = 0;
+			}
+			scratchpad[0] = (uint8_t)probe->temperature;
+			scratchpad[1] = (uint8_t)((uint16_t)probe->temperature >> 8);
+			scratchpad[8] = Crc8(scratchpad, 8);
+			if(probe->corruptReads > 0)
+			{
+				probe->corruptReads--;
+				scratchpad[0] ^= 1;
+			}
+			for(int j = 0; j < 9; j++)
+			{
+				s_data[j] = (s_state == Bus_ReadScratchpad) ? (s_data[j] & scratchpad[j]) : scratchpad[j];
+			}
+			s_state = Bus_ReadScratchpad;
+		}
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  デバイスが1bit送った
+//----------------------------------------------------------------------
+void Sent(void)
+{
+	if(s_state == Bus_SearchRom || s_state == Bus_ReadScratchpad)
+	{
+		s_bitCount++;
+	}
+	if(s_state == Bus_ReadScratchpad && s_bitCount == 9 * 8)
+	{
+		s_state = Bus_Idle;
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  センサーの選択
+//----------------------------------------------------------------------
+void Select(int (*match)(const Probe *probe))
+{
+	for(int i = 0; i < s_probeCount; i++)
+	{
+		s_probes[i].selected = match(&s_probes[i]);
+	}
+}
+
+int SelectAll(const Probe *probe)
+{
+	return 1;
+}
+
+int MatchRom(const Probe *probe)
+{
+	return memcmp(probe->rom, s_data, 8) == 0;
+}
+
+int RomBit(const Probe *probe, uint32_t bit)
+{
+	return (probe->rom[bit / 8] >> (bit % 8)) & 1;
+}
+
+//----------------------------------------------------------------------
+//! @brief  1-WireのCRC8 (x^8 + x^5 + x^4 + 1, LSBから)
+//----------------------------------------------------------------------
+uint8_t Crc8(const uint8_t *data, size_t length)
+{
+	uint8_t crc = 0;
+
+	for(size_t i = 0; i < length; i++)
+	{
+		uint8_t byte = data[i];
+		for(int bit = 0; bit < 8; bit++)
+		{
+			uint8_t mix = (crc ^ byte) & 1;
+			crc >>= 1;
+			crc ^= mix ? 0x8c : 0;
+			byte >>= 1;
+		}
+	}
+	return crc;
+}
@@ -0,0 +1,767 @@
+//======================================================================
+//! @file   sdcard.c
+//! @brief  [ホスト模擬] SDカード(SPIモード)
+//! @note	CS=Lの間、SPI転送1byteごとにsimdev_SdExchange()が呼ばれる.
+//! 		コマンド受信、R1/R1b/R2/R3/R7レスポンス、シングル/マルチブロックの
+//! 		読込・書込、CSD/SD_STATUS読込を模擬する.
+//! 		記憶領域は64KiB単位で書込時に確保するので、大容量カードも扱える.
+//! 		sim_SdSetFaults()で書込後ビジー/読込遅延の長期化、CRCエラー、無応答を
+//! 		シード付き乱数で発生させる.ビジー中(時間指定分)は受信データを無視する.
+//! 		pageSectorsを指定すると、1回の書込コマンドがまたいだページごとにbusyを足す
+//! 		(ページ境界に合っていない書込はページを余分に書き直すことになる).
+//======================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+#include "simdev.h"
+
+//----- 定義 -----
+#define SECTOR_SIZE			512
+#define CHUNK_SECTORS		128						// 記憶領域の確保単位[sector]
+#define OUT_QUEUE_SIZE		2048					// 出力キューサイズ(2のべき乗)
+
+// R1
+#define R1_IDLE				0x01
+#define R1_ILLEGAL			0x04
+#define R1_CRC_ERROR		0x08
+#define R1_ADDRESS_ERROR	0x20
+#define R1_PARAM_ERROR		0x40
+
+// トークン
+#define TOKEN_START_BLOCK	0xfe
+#define TOKEN_START_MULTI	0xfc
+#define TOKEN_STOP_MULTI	0xfd
+#define DATA_ACCEPTED		0x05
+#define DATA_CRC_ERROR		0x0b
+#define PPM					1000000UL
+
+typedef enum
+{
+	State_Command,				// コマンド待ち
+	State_WaitToken,			// 書込データトークン待ち
+	State_WriteData,			// 書込データ受信中
+} State;
+
+//----- 変数 -----
+static SimSdConfig s_config;				// カード設定
+static SimSdStats s_stats;					// 統計
+static uint8_t **s_chunks;					// 記憶領域
+static uint32_t s_chunkCount;				// 記憶領域のチャンク数
+static uint32_t **s_writeCounts;			// セクタごとの書込回数(チャンク単位で確保)
+
+static State s_state;						// 受信状態
+static int s_ready;							// 初期化完了(idle解除)
+static int s_appCmd;						// CMD55受信直後
+static uint16_t s_initRemain;				// idle解除までのACMD41回数
+static uint8_t s_cmd[6];					// 受信中コマンド
+static int s_cmdLength;						// 受信済コマンド長
+
+static uint8_t s_outQueue[OUT_QUEUE_SIZE];	// 出力キュー
+static uint32_t s_outHead, s_outTail;		// 出力キュー位置
+static uint32_t s_busyBytes;				// 残りbusyバイト数
+
+static int s_streaming;						// CMD18読込中
+static uint32_t s_streamSector;				// CMD18次セクタ
+static int s_multiWrite;					// CMD25書込中
+static uint32_t s_writeSector;				// 書込セクタ
+static uint32_t s_writePage;				// 書込コマンド中に最後に書いたページ
+static uint8_t s_writeBuffer[SECTOR_SIZE + 2];	// 書込データ(+CRC)
+static int s_writeLength;					// 書込データ受信数
+
+static SimSdFaults s_faults;				// 障害発生設定
+static uint32_t s_random;					// 障害発生用乱数(xorshift32)
+static uint64_t s_busyUntilNs;				// 書込ビジーの終了時刻(障害)
+static int s_holdPending;					// 出力保留の予約あり
+static uint32_t s_holdPosition;				// 出力保留を始める出力キュー位置
+static uint64_t s_holdNs;					// 出力保留時間[ns]
+static uint64_t s_holdUntilNs;				// 出力保留の終了時刻
+
+static const uint8_t zeroSector[SECTOR_SIZE];
+
+static void ResetCard(void);
+static void HandleCommand(void);
+static void PushOut(uint8_t data);
+static void PushBlock(const uint8_t *data, int length);
+static void PushSector(uint32_t sector);
+static uint8_t CalcCrc7(const uint8_t *data, int length);
+static uint16_t CalcCrc16(const uint8_t *data, int length);
+static void SetBits(uint8_t *reg, int regBytes, int msb, int lsb, uint32_t value);
+static int InjectFault(uint32_t ppm);
+static uint64_t StallNs(uint32_t minUs, uint32_t maxUs);
+
+//----------------------------------------------------------------------
+//! @brief  デフォルト設定取得 (SDHC 64MiB, AU 4MiB)
+//! @param	config	[O]設定
+//----------------------------------------------------------------------
+void sim_SdDefaultConfig(SimSdConfig *config)
+{
+	config->type = SimSd_Sdhc;
+	config->sectors = 64 * 1024 * 2;
+	config->auSizeCode = 9;
+	config->initIdleCount = 3;
+	config->readLatencyBytes = 4;
+	config->writeBusyBytes = 16;
+	config->pageSectors = 0;
+	config->pageBusyBytes = 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  カード挿入
+//! @param	config	[I]設定
+//! @note	記憶内容は消去される.
+//----------------------------------------------------------------------
+void sim_SdInsert(const SimSdConfig *config)
+{
+	sim_SdRemove();
+	s_config = *config;
+	s_chunkCount = (config->sectors + CHUNK_SECTORS - 1) / CHUNK_SECTORS;
+	s_chunks = calloc(s_chunkCount, sizeof(uint8_t *));
+	s_writeCounts = calloc(s_chunkCount, sizeof(uint32_t *));
+	memset(&s_stats, 0, sizeof(s_stats));
+	ResetCard();
+}
+
+//----------------------------------------------------------------------
+//! @brief  カード抜去
+//----------------------------------------------------------------------
+void sim_SdRemove(void)
+{
+	for(uint32_t i = 0; i < s_chunkCount; i++)
+	{
+		free(s_chunks[i]);
+		free(s_writeCounts[i]);
+	}
+	free(s_chunks);
+	free(s_writeCounts);
+	s_chunks = NULL;
+	s_writeCounts = NULL;
+	s_chunkCount = 0;
+	s_config.type = SimSd_None;
+	ResetCard();
+}
+
+//----------------------------------------------------------------------
+//! @brief  SDカード模擬状態の初期化(デフォルトカードを挿入)
+//----------------------------------------------------------------------
+void simdev_ResetSd(void)
+{
+	SimSdConfig config;
+	sim_SdSetFaults(NULL);
+	sim_SdDefaultConfig(&config);
+	sim_SdInsert(&config);
+}
+
+//----------------------------------------------------------------------
+//! @brief  セクタデータ参照
+//! @param	sector	[I]セクタ番号
+//! @return	セクタデータ(512byte) 範囲外=NULL
+//----------------------------------------------------------------------
+uint8_t *sim_SdSector(uint32_t sector)
+{
+	if(sector >= s_config.sectors || s_chunks == NULL)
+	{
+		return NULL;
+	}
+	uint8_t **chunk = &s_chunks[sector / CHUNK_SECTORS];
+	if(*chunk == NULL)
+	{
+		*chunk = calloc(CHUNK_SECTORS, SECTOR_SIZE);
+	}
+	return *chunk + (sector % CHUNK_SECTORS) * SECTOR_SIZE;
+}
+
+void sim_SdGetStats(SimSdStats *stats)
+{
+	*stats = s_stats;
+}
+
+//----------------------------------------------------------------------
+//! @brief  セクタの書込回数
+//! @param	sector	[I]セクタ番号
+//! @return	カード挿入からの書込回数
+//----------------------------------------------------------------------
+uint32_t sim_SdGetWriteCount(uint32_t sector)
+{
+	if(sector >= s_config.sectors || s_writeCounts == NULL || s_writeCounts[sector / CHUNK_SECTORS] == NULL)
+	{
+		return 0;
+	}
+	return s_writeCounts[sector / CHUNK_SECTORS][sector % CHUNK_SECTORS];
+}
+
+//----------------------------------------------------------------------
+//! @brief  書込回数の多いセクタ
+//! @param	hot			[O]セクタと書込回数(書込回数の降順, 同数はセクタ番号順)
+//! @param	maxCount	[I]hotの要素数
+//! @return	格納した数
+//----------------------------------------------------------------------
+int sim_SdGetHotSectors(SimSdHotSector *hot, int maxCount)
+{
+	int count = 0;
+	for(uint32_t c = 0; c < s_chunkCount; c++)
+	{
+		for(uint32_t i = 0; s_writeCounts[c] != NULL && i < CHUNK_SECTORS; i++)
+		{
+			uint32_t writes = s_writeCounts[c][i];
+			if(writes == 0 || (count == maxCount && writes <= hot[count - 1].writes))
+			{
+				continue;
+			}
+			// 挿入ソート(maxCountは小さい前提)
+			int j = (count < maxCount) ? count++ : count - 1;
+			for(; j > 0 && hot[j - 1].writes < writes; j--)
+			{
+				hot[j] = hot[j - 1];
+			}
+			hot[j].sector = c * CHUNK_SECTORS + i;
+			hot[j].writes = writes;
+		}
+	}
+	return count;
+}
+
+//----------------------------------------------------------------------
+//! @brief  障害発生設定
+//! @param	faults	[I]設定 NULL=障害なし
+//! @note	乱数はfaults->seedで初期化するので、同じ設定なら同じ順序で障害が起きる.
+//----------------------------------------------------------------------
+void sim_SdSetFaults(const SimSdFaults *faults)
+{
+	memset(&s_faults, 0, sizeof(s_faults));
+	if(faults != NULL)
+	{
+		s_faults = *faults;
+	}
+	s_random = (s_faults.seed != 0) ? s_faults.seed : 1;
+}
+
+//----------------------------------------------------------------------
+//! @brief  CS=H
+//! @note	受信途中のコマンドと出力待ちのデータは破棄する.busyは継続する.
+//----------------------------------------------------------------------
+void simdev_SdDeselected(void)
+{
+	s_cmdLength = 0;
+	s_outHead = s_outTail = 0;
+	s_streaming = 0;
+	s_holdPending = 0;
+	s_holdUntilNs = 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  1byte交換
+//! @param	in		[I]カードへの入力(MOSI)
+//! @return	カードからの出力(MISO)
+//----------------------------------------------------------------------
+uint8_t simdev_SdExchange(uint8_t in)
+{
+	if(s_config.type == SimSd_None)
+	{
+		return 0xff;
+	}
+
+	//----- 出力 -----
+	const uint64_t now = sim_GetTimeNs();
+	uint8_t out;
+	if(s_holdPending && s_outHead == s_holdPosition)
+	{
+		s_holdPending = 0;
+		s_holdUntilNs = now + s_holdNs;
+	}
+	if(now < s_holdUntilNs)
+	{
+		out = 0xff;
+	}
+	else if(s_outHead != s_outTail)
+	{
+		out = s_outQueue[s_outHead];
+		s_outHead = (s_outHead + 1) & (OUT_QUEUE_SIZE - 1);
+	}
+	else if(s_busyBytes > 0)
+	{
+		out = 0x00;
+		s_busyBytes--;
+	}
+	else if(now < s_busyUntilNs)
+	{
+		return 0x00;		// 内部処理中は入力を受け付けない
+	}
+	else
+	{
+		out = 0xff;
+	}
+	if(s_streaming && s_outHead == s_outTail && !s_holdPending)
+	{
+		PushSector(s_streamSector++);
+	}
+
+	//----- 入力 -----
+	switch(s_state)
+	{
+	case State_WaitToken:
+		if(in == TOKEN_START_BLOCK || (s_multiWrite && in == TOKEN_START_MULTI))
+		{
+			s_state = State_WriteData;
+			s_writeLength = 0;
+		}
+		else if(s_multiWrite && in == TOKEN_STOP_MULTI)
+		{
+			s_multiWrite = 0;
+			s_state = State_Command;
+			PushOut(0xff);
+			s_busyBytes = s_config.writeBusyBytes;
+		}
+		else if((in & 0xc0) == 0x40)
+		{
+			s_state = State_Command;
+			s_cmd[0] = in;
+			s_cmdLength = 1;
+		}
+		break;
+
+	case State_WriteData:
+		s_writeBuffer[s_writeLength++] = in;
+		if(s_writeLength == SECTOR_SIZE + 2)
+		{
+			if(InjectFault(s_faults.crcErrorPpm))
+			{
+				PushOut(DATA_CRC_ERROR);
+				s_stats.injectedCrcErrors++;
+				s_multiWrite = 0;
+				s_state = State_Command;
+				break;
+			}
+			uint8_t *dest = sim_SdSector(s_writeSector);
+			if(dest != NULL)
+			{
+				memcpy(dest, s_writeBuffer, SECTOR_SIZE);
+				s_stats.sectorsWritten++;
+				uint32_t **counts = &s_writeCounts[s_writeSector / CHUNK_SECTORS];
+				if(*counts == NULL)
+				{
+					*counts = calloc(CHUNK_SECTORS, sizeof(uint32_t));
+				}
+				(*counts)[s_writeSector % CHUNK_SECTORS]++;
+			}
+			PushOut(DATA_ACCEPTED);
+			s_busyBytes = s_config.writeBusyBytes;
+			if(s_config.pageSectors != 0 && s_writeSector / s_config.pageSectors != s_writePage)
+			{
+				s_writePage = s_writeSector / s_config.pageSectors;
+				s_busyBytes += s_config.pageBusyBytes;
+				s_stats.pagesProgrammed++;
+			}
+			if(InjectFault(s_faults.writeStallPpm))
+			{
+				uint64_t stallNs = StallNs(s_faults.writeStallMinUs, s_faults.writeStallMaxUs);
+				s_busyUntilNs = now + stallNs;
+				s_stats.injectedStalls++;
+				s_stats.injectedStallNs += stallNs;
+			}
+			s_writeSector++;
+			s_state = s_multiWrite ? State_WaitToken : State_Command;
+		}
+		break;
+
+	case State_Command:
+	default:
+		if(s_cmdLength == 0)
+		{
+			if((in & 0xc0) == 0x40)
+			{
+				s_cmd[s_cmdLength++] = in;
+			}
+		}
+		else
+		{
+			s_cmd[s_cmdLength++] = in;
+			if(s_cmdLength == sizeof(s_cmd))
+			{
+				s_cmdLength = 0;
+				HandleCommand();
+			}
+		}
+		break;
+	}
+
+	return out;
+}
+
+//----------------------------------------------------------------------
+//! @brief  カード状態初期化
+//----------------------------------------------------------------------
+void ResetCard(void)
+{
+	s_state = State_Command;
+	s_ready = 0;
+	s_appCmd = 0;
+	s_initRemain = s_config.initIdleCount;
+	s_cmdLength = 0;
+	s_outHead = s_outTail = 0;
+	s_busyBytes = 0;
+	s_busyUntilNs = 0;
+	s_streaming = 0;
+	s_multiWrite = 0;
+	s_holdPending = 0;
+	s_holdUntilNs = 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  コマンド処理
+//----------------------------------------------------------------------
+void HandleCommand(void)
+{
+	const uint8_t index = s_cmd[0] & 0x3f;
+	const uint32_t arg = ((uint32_t)s_cmd[1] << 24) | ((uint32_t)s_cmd[2] << 16) | ((uint32_t)s_cmd[3] << 8) | s_cmd[4];
+	const int isApp = s_appCmd;
+	const int isSdhc = (s_config.type == SimSd_Sdhc);
+	const uint32_t sector = isSdhc ? arg : arg / SECTOR_SIZE;
+	uint8_t r1 = s_ready ? 0x00 : R1_IDLE;
+
+	s_stats.commands++;
+	s_appCmd = 0;
+
+	// 実行中の読込はどのコマンドでも中断する
+	if(s_streaming)
+	{
+		s_streaming = 0;
+		s_outHead = s_outTail = 0;
+	}
+
+	// CMD0/CMD8はCRC必須
+	if((index == 0 || index == 8) && (CalcCrc7(s_cmd, 5) << 1 | 0x01) != s_cmd[5])
+	{
+		PushOut(0xff);
+		PushOut(r1 | R1_CRC_ERROR);
+		return;
+	}
+
+	PushOut(0xff);		// Ncr
+
+	// 読込/書込コマンドに応答しない(ホストはタイムアウトする)
+	if(s_ready && (index == 17 || index == 18 || index == 24 || index == 25) && InjectFault(s_faults.timeoutPpm))
+	{
+		s_stats.injectedTimeouts++;
+		return;
+	}
+
+	switch(index)
+	{
+	case 0:				// GO_IDLE_STATE
+		ResetCard();
+		PushOut(0xff);
+		PushOut(R1_IDLE);
+		break;
+
+	case 8:				// SEND_IF_COND
+		PushOut(r1);
+		PushOut(0x00);
+		PushOut(0x00);
+		PushOut((uint8_t)(arg >> 8) & 0x0f);
+		PushOut((uint8_t)arg);
+		break;
+
+	case 55:			// APP_CMD
+		s_appCmd = 1;
+		PushOut(r1);
+		break;
+
+	case 41:			// SD_SEND_OP_COND (ACMD41)
+		if(!isApp)
+		{
+			PushOut(r1 | R1_ILLEGAL);
+			s_stats.illegalCommands++;
+			break;
+		}
+		if(!s_ready)
+		{
+			if(s_initRemain > 0)
+			{
+				s_initRemain--;
+			}
+			s_ready = (s_initRemain == 0);
+		}
+		PushOut(s_ready ? 0x00 : R1_IDLE);
+		break;
+
+	case 58:			// READ_OCR
+		PushOut(r1);
+		PushOut(0x80 | ((isSdhc && s_ready) ? 0x40 : 0x00));
+		PushOut(0xff);
+		PushOut(0x80);
+		PushOut(0x00);
+		break;
+
+	case 16:			// SET_BLOCKLEN
+		PushOut((arg == SECTOR_SIZE) ? r1 : (r1 | R1_PARAM_ERROR));
+		break;
+
+	case 9:				// SEND_CSD
+	{
+		uint8_t csd[16] = {0};
+		if(isSdhc)
+		{
+			SetBits(csd, 16, 127, 126, 1);									// CSD_STRUCTURE = 2.0
+			SetBits(csd, 16, 69, 48, s_config.sectors / 1024 - 1);			// C_SIZE
+		}
+		else
+		{
+			SetBits(csd, 16, 127, 126, 0);									// CSD_STRUCTURE = 1.0
+			SetBits(csd, 16, 83, 80, 9);									// READ_BL_LEN = 512
+			SetBits(csd, 16, 73, 62, s_config.sectors / 512 - 1);			// C_SIZE
+			SetBits(csd, 16, 49, 47, 7);									// C_SIZE_MULT = x512
+			SetBits(csd, 16, 45, 39, 127);									// SECTOR_SIZE = 128
+		}
+		PushOut(r1);
+		PushOut(0xff);
+		PushOut(TOKEN_START_BLOCK);
+		PushBlock(csd, sizeof(csd));
+		break;
+	}
+
+	case 13:			// SEND_STATUS / SD_STATUS (ACMD13)
+		PushOut(r1);
+		PushOut(0x00);
+		if(isApp)
+		{
+			uint8_t status[64] = {0};
+			status[10] = (uint8_t)(s_config.auSizeCode << 4);				// AU_SIZE [431:428]
+			PushOut(0xff);
+			PushOut(TOKEN_START_BLOCK);
+			PushBlock(status, sizeof(status));
+		}
+		break;
+
+	case 17:			// READ_SINGLE_BLOCK
+	case 18:			// READ_MULTIPLE_BLOCK
+		if(!s_ready)
+		{
+			PushOut(r1 | R1_ILLEGAL);
+			s_stats.illegalCommands++;
+		}
+		else if(sector >= s_config.sectors || (!isSdhc && (arg % SECTOR_SIZE) != 0))
+		{
+			PushOut(R1_ADDRESS_ERROR);
+		}
+		else
+		{
+			PushOut(r1);
+			PushSector(sector);
+			if(index == 18)
+			{
+				s_streaming = 1;
+				s_streamSector = sector + 1;
+			}
+		}
+		break;
+
+	case 12:			// STOP_TRANSMISSION
+		PushOut(0xff);		// stuff byte
+		PushOut(r1);
+		s_busyBytes = 2;
+		break;
+
+	case 23:			// SET_WR_BLK_ERASE_COUNT (ACMD23)
+		PushOut(r1);
+		break;
+
+	case 24:			// WRITE_BLOCK
+	case 25:			// WRITE_MULTIPLE_BLOCK
+		if(!s_ready)
+		{
+			PushOut(r1 | R1_ILLEGAL);
+			s_stats.illegalCommands++;
+		}
+		else if(sector >= s_config.sectors || (!isSdhc && (arg % SECTOR_SIZE) != 0))
+		{
+			PushOut(R1_ADDRESS_ERROR);
+		}
+		else
+		{
+			PushOut(r1);
+			s_state = State_WaitToken;
+			s_multiWrite = (index == 25);
+			s_writeSector = sector;
+			s_writePage = UINT32_MAX;
+		}
+		break;
+
+	default:
+		PushOut(r1 | R1_ILLEGAL);
+		s_stats.illegalCommands++;
+		break;
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  出力キューへ追加
+//----------------------------------------------------------------------
+void PushOut(uint8_t data)
+{
+	uint32_t next = (s_outTail + 1) & (OUT_QUEUE_SIZE - 1);
+	if(next == s_outHead)
+	{
+		fprintf(stderr, "sim: sd output queue overflow\n");
+		abort();
+	}
+	s_outQueue[s_outTail] = data;
+	s_outTail = next;
+}
+
+//----------------------------------------------------------------------
+//! @brief  データブロック(データ+CRC16)を出力キューへ追加
+//----------------------------------------------------------------------
+void PushBlock(const uint8_t *data, int length)
+{
+	for(int i = 0; i < length; i++)
+	{
+		PushOut(data[i]);
+	}
+	uint16_t crc = CalcCrc16(data, length);
+	PushOut((uint8_t)(crc >> 8));
+	PushOut((uint8_t)crc);
+}
+
+//----------------------------------------------------------------------
+//! @brief  セクタ読込データを出力キューへ追加
+//! @param	sector	[I]セクタ番号
+//----------------------------------------------------------------------
+void PushSector(uint32_t sector)
+{
+	if(sector >= s_config.sectors)
+	{
+		s_streaming = 0;
+		return;
+	}
+	const uint8_t *data = zeroSector;
+	uint8_t **chunk = &s_chunks[sector / CHUNK_SECTORS];
+	if(*chunk != NULL)
+	{
+		data = *chunk + (sector % CHUNK_SECTORS) * SECTOR_SIZE;
+	}
+	if(InjectFault(s_faults.readStallPpm))
+	{
+		s_holdPending = 1;
+		s_holdPosition = s_outTail;
+		s_holdNs = StallNs(s_faults.readStallMinUs, s_faults.readStallMaxUs);
+		s_stats.injectedStalls++;
+		s_stats.injectedStallNs += s_holdNs;
+	}
+	for(int i = 0; i < s_config.readLatencyBytes; i++)
+	{
+		PushOut(0xff);
+	}
+	PushOut(TOKEN_START_BLOCK);
+	if(InjectFault(s_faults.crcErrorPpm))
+	{
+		// データ化けはCRC16の不一致として現れる
+		for(int i = 0; i < SECTOR_SIZE; i++)
+		{
+			PushOut(data[i]);
+		}
+		uint16_t crc = (uint16_t)~CalcCrc16(data, SECTOR_SIZE);
+		PushOut((uint8_t)(crc >> 8));
+		PushOut((uint8_t)crc);
+		s_stats.injectedCrcErrors++;
+	}
+	else
+	{
+		PushBlock(data, SECTOR_SIZE);
+	}
+	s_stats.sectorsRead++;
+}
+
+//----------------------------------------------------------------------
+//! @brief  CRC7計算
+//----------------------------------------------------------------------
+uint8_t CalcCrc7(const uint8_t *data, int length)
+{
+	uint8_t crc = 0;
+	for(int i = 0; i < length; i++)
+	{
+		uint8_t value = data[i];
+		for(int bit = 0; bit < 8; bit++)
+		{
+			crc <<= 1;
+			if((value ^ crc) & 0x80)
+			{
+				crc ^= 0x09;
+			}
+			value <<= 1;
+		}
+	}
+	return crc & 0x7f;
+}
+
+//----------------------------------------------------------------------
+//! @brief  CRC16(CCITT)計算
+//----------------------------------------------------------------------
+uint16_t CalcCrc16(const uint8_t *data, int length)
+{
+	uint16_t crc = 0;
+	for(int i = 0; i < length; i++)
+	{
+		crc ^= (uint16_t)data[i] << 8;
+		for(int bit = 0; bit < 8; bit++)
+		{
+			crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+		}
+	}
+	return crc;
+}
+
+//----------------------------------------------------------------------
+//! @brief  レジスタ[msb:lsb]へ値を設定(先頭バイトが最上位)
+//----------------------------------------------------------------------
+void SetBits(uint8_t *reg, int regBytes, int msb, int lsb, uint32_t value)
+{
+	for(int bit = lsb; bit <= msb; bit++)
+	{
+		int index = regBytes - 1 - bit / 8;
+		uint8_t mask = (uint8_t)(1 << (bit % 8));
+		if(value & (1UL << (bit - lsb)))
+		{
+			reg[index] |= mask;
+		}
+		else
+		{
+			reg[index] &= (uint8_t)~mask;
+		}
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  障害発生判定
+//! @param	ppm		[I]発生確率[ppm]
+//! @return	!0=発生
+//----------------------------------------------------------------------
+int InjectFault(uint32_t ppm)
+{
+	if(ppm == 0)
+	{
+		return 0;
+	}
+	s_random ^= s_random << 13;
+	s_random ^= s_random >> 17;
+	s_random ^= s_random << 5;
+	return (s_random % PPM) < ppm;
+}
+
+//----------------------------------------------------------------------
+//! @brief  遅延時間決定(minUs〜maxUsの一様分布)
+//! @return	遅延時間[ns]
+//----------------------------------------------------------------------
+uint64_t StallNs(uint32_t minUs, uint32_t maxUs)
+{
+	uint32_t us = minUs;
+	if(maxUs > minUs)
+	{
+		s_random ^= s_random << 13;
+		s_random ^= s_random >> 17;
+		s_random ^= s_random << 5;
+		us += s_random % (maxUs - minUs + 1);
+	}
+	return (uint64_t)us * 1000;
+}
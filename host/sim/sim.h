@@ -0,0 +1,147 @@
+//======================================================================
+//! @file   sim.h
+//! @brief  ホスト模擬環境の制御
+//! @note	テスト/ベンチマークから模擬デバイスの状態を設定・参照する.
+//! 		時間は仮想時計で、SPI転送とvTaskDelay()の分だけ進む.
+//======================================================================
+#ifndef _SIM_H_
+#define _SIM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+//----- 全体 -----
+void sim_Reset(void);
+
+//----- 仮想時計 -----
+uint64_t sim_GetTimeNs(void);
+void sim_AdvanceNs(uint64_t ns);
+
+//----- ヒープ -----
+typedef struct
+{
+	uint32_t allocCount;		// 確保回数
+	uint32_t freeCount;			// 解放回数
+	uint64_t allocBytes;		// 確保バイト数累計
+	int64_t inUseBytes;			// 使用中バイト数
+	int64_t peakInUseBytes;		// 使用中バイト数の最大値
+} SimHeapStats;
+
+#define SIM_HEAP_SIZE	(48 * 1024)		// esp_get_free_heap_size()等の計算に使うヒープ容量
+
+void sim_GetHeapStats(SimHeapStats *stats);
+
+//----- タスク -----
+void sim_AddTaskRunTime(void *task, uint32_t us);
+
+//----- SPIバス -----
+typedef struct
+{
+	uint32_t transactions;		// spi_trans()呼び出し回数
+	uint64_t bytes;				// 転送バイト数(cmd+addr+mosi+miso)
+	uint64_t busyNs;			// 転送に要した仮想時間[ns]
+} SimSpiStats;
+
+void sim_GetSpiStats(SimSpiStats *stats);
+void sim_SetSpiOverheadNs(uint32_t ns);
+uint32_t sim_GetSpiClockHz(void);
+
+//----- SDカード -----
+typedef enum {SimSd_None, SimSd_Sdhc, SimSd_Sdsc} SimSdType;
+typedef struct
+{
+	SimSdType type;				// カード種別
+	uint32_t sectors;			// 容量[sector]
+	uint8_t auSizeCode;			// SD_STATUS AU_SIZE (SDHC) 9=4MiB
+	uint16_t initIdleCount;		// ACMD41がidleを返す回数
+	uint16_t readLatencyBytes;	// 読込トークンまでの0xffバイト数
+	uint16_t writeBusyBytes;	// 書込後のbusyバイト数
+	uint16_t pageSectors;		// フラッシュの書込単位(ページ)[sector] 0=模擬しない
+	uint16_t pageBusyBytes;		// 1コマンドで書くページ1つごとに足すbusyバイト数
+} SimSdConfig;
+
+typedef struct
+{
+	uint32_t commands;			// 受信コマンド数
+	uint32_t sectorsRead;		// 読込セクタ数
+	uint32_t sectorsWritten;	// 書込セクタ数
+	uint32_t pagesProgrammed;	// 書いたページ数(pageSectors>0のとき)
+	uint32_t illegalCommands;	// 不正コマンド数
+	uint32_t injectedStalls;	// 発生させたビジー/読込遅延の回数
+	uint64_t injectedStallNs;	// 発生させたビジー/読込遅延の合計[ns]
+	uint32_t injectedCrcErrors;	// 発生させたCRCエラー数(書込=応答0x0b, 読込=CRC16不一致)
+	uint32_t injectedTimeouts;	// 応答しなかった読込/書込コマンド数
+} SimSdStats;
+
+// 障害発生設定(確率は1000000=100%)
+typedef struct
+{
+	uint32_t seed;				// 乱数シード(0は1として扱う)
+	uint32_t writeStallPpm;		// 書込後のビジー長期化(内部GC)の確率[ppm/sector]
+	uint32_t writeStallMinUs;	// 同 時間の最小値[us]
+	uint32_t writeStallMaxUs;	// 同 時間の最大値[us]
+	uint32_t readStallPpm;		// 読込データトークン遅延の確率[ppm/sector]
+	uint32_t readStallMinUs;	// 同 時間の最小値[us]
+	uint32_t readStallMaxUs;	// 同 時間の最大値[us]
+	uint32_t crcErrorPpm;		// CRCエラーの確率[ppm/sector]
+	uint32_t timeoutPpm;		// 読込/書込コマンド無応答の確率[ppm/command]
+} SimSdFaults;
+
+// 書込回数(sim_SdGetHotSectors)
+typedef struct
+{
+	uint32_t sector;			// セクタ番号
+	uint32_t writes;			// 書込回数
+} SimSdHotSector;
+
+void sim_SdDefaultConfig(SimSdConfig *config);
+void sim_SdInsert(const SimSdConfig *config);
+void sim_SdRemove(void);
+uint8_t *sim_SdSector(uint32_t sector);
+void sim_SdGetStats(SimSdStats *stats);
+void sim_SdSetFaults(const SimSdFaults *faults);
+uint32_t sim_SdGetWriteCount(uint32_t sector);
+int sim_SdGetHotSectors(SimSdHotSector *hot, int maxCount);
+void sim_VfsSetOpen(FILE *(*open)(const char *name, const char *mode));
+
+//----- LCDパネル -----
+#define SIM_LCD_PAGES	8
+#define SIM_LCD_COLUMNS	132
+
+typedef struct
+{
+	uint32_t commandBytes;		// 受信コマンドバイト数
+	uint32_t dataBytes;			// 受信データバイト数
+	uint32_t resets;			// リセット回数(ハード+ソフト)
+	int displayOn;				// 表示ON
+} SimLcdStats;
+
+uint8_t sim_LcdRam(int page, int column);
+void sim_LcdGetStats(SimLcdStats *stats);
+
+//----- 1-Wire温度センサー(DS18B20, GPIO2) -----
+#define SIM_ONEWIRE_PROBES	8
+
+typedef struct
+{
+	uint32_t resets;			// リセットパルス数
+	uint32_t slots;				// タイムスロット数
+	uint32_t conversions;		// 温度変換を始めたセンサー数(延べ)
+	uint32_t timingErrors;		// データシートの範囲外のパルス・スロット
+	uint32_t lateSamples;		// 読取りスロットの立下りから15us以降の読取り
+} SimOneWireStats;
+
+int sim_OneWireAddProbe(uint64_t serial, int16_t raw);
+void sim_OneWireSetTemperature(int index, int16_t raw);
+void sim_OneWireCorruptReads(int index, int count);
+void sim_OneWireGetRom(int index, uint8_t rom[8]);
+void sim_OneWireGetStats(SimOneWireStats *stats);
+
+//----- ディープスリープ・ADC -----
+int sim_DeepSleepRequested(uint64_t *us, uint8_t *rfOption);
+void sim_DeepSleepWake(void);
+void sim_ResetButton(void);
+void sim_SetAdc(uint16_t value);
+
+#endif
@@ -0,0 +1,52 @@
+//======================================================================
+//! @file   simdev.h
+//! @brief  ホスト模擬環境 内部接続
+//! @note	模擬モジュール間でのみ使用する.テストからは sim.h を使うこと.
+//======================================================================
+#ifndef _SIMDEV_H_
+#define _SIMDEV_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// 仮想時計
+void simdev_AddTimeNs(uint64_t ns);
+void simdev_RunTimers(void);
+void simdev_ResetRtos(void);
+
+// ハードウェアタイマ
+int simdev_HwTimerAlarm(uint64_t *ns);
+void simdev_FireHwTimer(void);
+void simdev_ResetHwTimer(void);
+
+// GPIO
+int simdev_GpioLevel(int gpioNum);
+uint32_t simdev_PinFunction(int gpioNum);
+void simdev_ResetGpio(void);
+
+// 1-Wire(GPIO2に接続したDS18B20)
+void simdev_OneWireDrive(int level);
+int simdev_OneWireLevel(void);
+void simdev_ResetOneWire(void);
+
+// SPI
+void simdev_ResetSpi(void);
+
+// SDカード(CS=L時に1byte交換)
+uint8_t simdev_SdExchange(uint8_t in);
+void simdev_SdDeselected(void);
+void simdev_ResetSd(void);
+
+// LCDパネル
+void simdev_LcdWrite(uint8_t data, int isData);
+void simdev_LcdHardReset(void);
+void simdev_ResetLcd(void);
+
+// ディスクI/O
+void simdev_ResetDiskio(void);
+
+// ディープスリープ・RTCメモリ
+uint64_t simdev_BootTimeNs(void);
+void simdev_ResetSleep(void);
+
+#endif
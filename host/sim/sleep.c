@@ -0,0 +1,156 @@
+//======================================================================
+//! @file   sleep.c
+//! @brief  [ホスト模擬] ディープスリープ・RTCメモリ・リセット要因・ADC
+//! @note	RTCメモリはディープスリープとリセットボタンでは保持し、sim_Reset()(電源投入)で不定値になる.
+//! 		眠っている間は仮想時計だけ進め、FreeRTOSタイマは呼ばない.
+//======================================================================
+#include <string.h>
+
+#include "esp_system.h"
+#include "esp_sleep.h"
+#include "driver/adc.h"
+
+#include "sim.h"
+#include "simdev.h"
+
+#define RTC_BLOCKS			192			// RTCメモリ全体[4byteブロック]
+#define RTC_USER_BLOCK		64			// ユーザー領域の先頭ブロック
+
+//----- 変数 -----
+static uint8_t s_rtcMemory[RTC_BLOCKS * 4];			// RTCメモリ
+static esp_reset_reason_t s_resetReason;			// 直前のリセット要因
+static uint64_t s_bootNs;							// 起動時刻[ns]
+static int s_sleepRequested;						// esp_deep_sleep()が呼ばれた
+static uint64_t s_sleepUs;							// 要求されたスリープ時間[us]
+static uint8_t s_rfOption;							// 起床後のRF設定
+static uint16_t s_adcValue;							// ADC読込値
+
+//----------------------------------------------------------------------
+//! @brief  電源投入状態にする
+//----------------------------------------------------------------------
+void simdev_ResetSleep(void)
+{
+	memset(s_rtcMemory, 0x5a, sizeof(s_rtcMemory));
+	s_resetReason = ESP_RST_POWERON;
+	s_bootNs = sim_GetTimeNs();
+	s_sleepRequested = 0;
+	s_sleepUs = 0;
+	s_rfOption = 0;
+	s_adcValue = 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  起動時刻(esp_timer_get_time()の基準)
+//----------------------------------------------------------------------
+uint64_t simdev_BootTimeNs(void)
+{
+	return s_bootNs;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ディープスリープの要求を取得
+//! @param	us			[O]スリープ時間[us] (NULL可)
+//! @param	rfOption	[O]起床後のRF設定 (NULL可)
+//! @return	1=前回の起床(リセット)以降にesp_deep_sleep()が呼ばれた
+//----------------------------------------------------------------------
+int sim_DeepSleepRequested(uint64_t *us, uint8_t *rfOption)
+{
+	if(us != NULL)
+	{
+		*us = s_sleepUs;
+	}
+	if(rfOption != NULL)
+	{
+		*rfOption = s_rfOption;
+	}
+	return s_sleepRequested;
+}
+
+//----------------------------------------------------------------------
+//! @brief  要求された時間だけ眠って起床する(リセット要因ESP_RST_DEEPSLEEP)
+//----------------------------------------------------------------------
+void sim_DeepSleepWake(void)
+{
+	simdev_AddTimeNs(s_sleepUs * 1000);
+	s_resetReason = ESP_RST_DEEPSLEEP;
+	s_bootNs = sim_GetTimeNs();
+	s_sleepRequested = 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  リセットボタンで起動する(リセット要因ESP_RST_EXT, RTCメモリは保持)
+//----------------------------------------------------------------------
+void sim_ResetButton(void)
+{
+	s_resetReason = ESP_RST_EXT;
+	s_bootNs = sim_GetTimeNs();
+	s_sleepRequested = 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ADC読込値の設定
+//----------------------------------------------------------------------
+void sim_SetAdc(uint16_t value)
+{
+	s_adcValue = value;
+}
+
+//----------------------------------------------------------------------
+//! @brief  リセット要因
+//----------------------------------------------------------------------
+esp_reset_reason_t esp_reset_reason(void)
+{
+	return s_resetReason;
+}
+
+//----------------------------------------------------------------------
+//! @brief  RTCメモリ(ユーザー領域のみ)
+//----------------------------------------------------------------------
+bool system_rtc_mem_read(int src_addr, void *des_addr, int save_size)
+{
+	if(src_addr < RTC_USER_BLOCK || save_size < 0 || src_addr * 4 + save_size > (int)sizeof(s_rtcMemory))
+	{
+		return false;
+	}
+	memcpy(des_addr, &s_rtcMemory[src_addr * 4], save_size);
+	return true;
+}
+
+bool system_rtc_mem_write(int des_addr, const void *src_addr, int save_size)
+{
+	if(des_addr < RTC_USER_BLOCK || save_size < 0 || des_addr * 4 + save_size > (int)sizeof(s_rtcMemory))
+	{
+		return false;
+	}
+	memcpy(&s_rtcMemory[des_addr * 4], src_addr, save_size);
+	return true;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ディープスリープ(ホストでは要求を記録して戻る)
+//----------------------------------------------------------------------
+void esp_deep_sleep(uint64_t time_in_us)
+{
+	s_sleepRequested = 1;
+	s_sleepUs = time_in_us;
+}
+
+esp_err_t esp_deep_sleep_set_rf_option(uint8_t option)
+{
+	s_rfOption = option;
+	return ESP_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ADC(TOUT)
+//----------------------------------------------------------------------
+esp_err_t adc_init(adc_config_t *config)
+{
+	return (config->mode == ADC_READ_TOUT_MODE || config->mode == ADC_READ_VDD_MODE) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t adc_read(uint16_t *data)
+{
+	*data = s_adcValue;
+	return ESP_OK;
+}
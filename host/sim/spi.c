@@ -0,0 +1,204 @@
+//======================================================================
+//! @file   spi.c
+//! @brief  [ホスト模擬] SPIドライバ
+//! @note	ESP8266のSPIは半二重で、cmd → addr → mosi → miso の順に転送する.
+//! 		cmdは下位バイトから、addrは上位バイトから、mosi/misoはメモリ順に並ぶ.
+//! 		CSはGPIOで手動制御されるので、転送時のCSレベルで相手デバイスを決める.
+//======================================================================
+#include <stdio.h>
+#include <string.h>
+
+#include "driver/spi.h"
+#include "driver/gpio.h"
+#include "esp8266/spi_struct.h"
+
+#include "global.h"
+#include "sim.h"
+#include "simdev.h"
+
+//----- 定数 -----
+static const uint32_t apbClockHz = 80000000UL;			// SPIクロック源
+static const uint32_t defaultOverheadNs = 1000;			// spi_trans()1回あたりのCPU/設定時間
+
+//----- 変数 -----
+volatile spi_dev_t SPI0;
+volatile spi_dev_t SPI1;
+
+static spi_interface_t s_interface;				// インターフェイス設定
+static spi_event_callback_t s_eventCallback;	// イベントコールバック
+static int s_transDoneIntr;						// 転送完了割り込み有効
+static uint32_t s_overheadNs;					// spi_trans()1回あたりの付加時間
+static SimSpiStats s_stats;						// 統計
+
+//----------------------------------------------------------------------
+//! @brief  SPI模擬状態の初期化
+//----------------------------------------------------------------------
+void simdev_ResetSpi(void)
+{
+	memset((void *)&SPI1, 0, sizeof(SPI1));
+	s_interface.val = 0;
+	s_eventCallback = NULL;
+	s_transDoneIntr = 0;
+	s_overheadNs = defaultOverheadNs;
+	memset(&s_stats, 0, sizeof(s_stats));
+}
+
+void sim_GetSpiStats(SimSpiStats *stats)
+{
+	*stats = s_stats;
+}
+
+void sim_SetSpiOverheadNs(uint32_t ns)
+{
+	s_overheadNs = ns;
+}
+
+//----------------------------------------------------------------------
+//! @brief  SPIクロック周波数
+//! @return	周波数[Hz]
+//----------------------------------------------------------------------
+uint32_t sim_GetSpiClockHz(void)
+{
+	if(SPI1.clock.clk_equ_sysclk)
+	{
+		return apbClockHz;
+	}
+	return apbClockHz / ((SPI1.clock.clkcnt_n + 1) * (SPI1.clock.clkdiv_pre + 1));
+}
+
+esp_err_t spi_init(spi_host_t host, spi_config_t *config)
+{
+	if(host != HSPI_HOST)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+	s_eventCallback = config->event_cb;
+	s_transDoneIntr = config->intr_enable.trans_done;
+	spi_set_interface(host, &config->interface);
+	spi_set_clk_div(host, &config->clk_div);
+	if(s_eventCallback != NULL)
+	{
+		s_eventCallback(SPI_INIT_EVENT, NULL);
+	}
+	return ESP_OK;
+}
+
+esp_err_t spi_set_interface(spi_host_t host, spi_interface_t *interface)
+{
+	s_interface = *interface;
+	PIN_FUNC_SELECT(PERIPHS_IO_MUX_MTMS_U, FUNC_HSPI_CLK);
+	if(interface->mosi_en)
+	{
+		PIN_FUNC_SELECT(PERIPHS_IO_MUX_MTCK_U, FUNC_HSPID_MOSI);
+	}
+	if(interface->miso_en)
+	{
+		PIN_FUNC_SELECT(PERIPHS_IO_MUX_MTDI_U, FUNC_HSPIQ_MISO);
+	}
+	return ESP_OK;
+}
+
+esp_err_t spi_set_clk_div(spi_host_t host, spi_clk_div_t *clkDiv)
+{
+	if(*clkDiv > 1)
+	{
+		SPI1.clock.clk_equ_sysclk = 0;
+		SPI1.clock.clkdiv_pre = 0;
+		SPI1.clock.clkcnt_n = *clkDiv - 1;
+		SPI1.clock.clkcnt_h = *clkDiv / 2 - 1;
+		SPI1.clock.clkcnt_l = *clkDiv - 1;
+	}
+	else
+	{
+		SPI1.clock.clk_equ_sysclk = 1;
+		SPI1.clock.clkdiv_pre = 0;
+		SPI1.clock.clkcnt_n = 0;
+		SPI1.clock.clkcnt_h = 0;
+		SPI1.clock.clkcnt_l = 0;
+	}
+	return ESP_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  1byte転送
+//! @param	out			[I]送信データ(MOSI)
+//! @param	byteNs		[I]1byteの転送時間[ns]
+//! @return	受信データ(MISO)
+//----------------------------------------------------------------------
+static uint8_t Exchange(uint8_t out, uint32_t byteNs)
+{
+	int sdSelected = simdev_GpioLevel(GPIO_SDCS_NUM) == 0 && simdev_GpioLevel(GPIO_LCDCS_NUM) != 0;
+	int lcdSelected = simdev_GpioLevel(GPIO_LCDCS_NUM) == 0 && simdev_GpioLevel(GPIO_SDCS_NUM) != 0;
+	uint8_t in = 0xff;
+
+	if(sdSelected)
+	{
+		in = simdev_SdExchange(out);
+	}
+	else if(lcdSelected)
+	{
+		simdev_LcdWrite(out, simdev_GpioLevel(GPIO_MISO_LCDRS_NUM));
+	}
+	simdev_AddTimeNs(byteNs);
+	return in;
+}
+
+//----------------------------------------------------------------------
+//! @brief  転送
+//! @note	MOSIピンがGPIO機能の間は、GPIOの出力レベルが送信データになる.
+//! 		MOSI機能のままmiso転送するとMOSIは0x00固定になる(実機と同じ).
+//----------------------------------------------------------------------
+esp_err_t spi_trans(spi_host_t host, spi_trans_t *trans)
+{
+	if(host != HSPI_HOST)
+	{
+		return ESP_ERR_INVALID_ARG;
+	}
+
+	const int mosiDriven = simdev_PinFunction(GPIO_MOSI_NUM) == FUNC_HSPID_MOSI;
+	const uint8_t idle = (!mosiDriven && simdev_GpioLevel(GPIO_MOSI_NUM)) ? 0xff : 0x00;
+	const uint32_t totalBits = trans->bits.cmd + trans->bits.addr + trans->bits.mosi + trans->bits.miso;
+	const uint32_t byteNs = (uint32_t)(8ULL * 1000000000ULL / sim_GetSpiClockHz());
+	const uint64_t startNs = sim_GetTimeNs();
+
+	simdev_AddTimeNs(s_overheadNs);
+
+	//----- cmd (下位バイトから) -----
+	for(int i = 0; i < trans->bits.cmd / 8; i++)
+	{
+		uint8_t out = (uint8_t)(*trans->cmd >> (8 * i));
+		Exchange(mosiDriven ? out : idle, byteNs);
+	}
+
+	//----- addr (上位バイトから) -----
+	for(int i = 0; i < trans->bits.addr / 8; i++)
+	{
+		uint8_t out = (uint8_t)(*trans->addr >> (24 - 8 * i));
+		Exchange(mosiDriven ? out : idle, byteNs);
+	}
+
+	//----- mosi (メモリ順) -----
+	const uint8_t *mosi = (const uint8_t *)trans->mosi;
+	for(int i = 0; i < trans->bits.mosi / 8; i++)
+	{
+		Exchange(mosiDriven ? mosi[i] : idle, byteNs);
+	}
+
+	//----- miso (メモリ順) -----
+	uint8_t *miso = (uint8_t *)trans->miso;
+	for(int i = 0; i < trans->bits.miso / 8; i++)
+	{
+		miso[i] = Exchange(idle, byteNs);
+	}
+
+	//----- 統計 & 完了通知 -----
+	s_stats.transactions++;
+	s_stats.bytes += totalBits / 8;
+	s_stats.busyNs += sim_GetTimeNs() - startNs;
+	simdev_RunTimers();
+	if(s_transDoneIntr && s_eventCallback != NULL)
+	{
+		s_eventCallback(SPI_TRANS_DONE_EVENT, NULL);
+	}
+	return ESP_OK;
+}
@@ -0,0 +1,1312 @@
+//======================================================================
+//! @file   logfs.c
+//! @brief  長期試験用のFAT32/exFAT配置モデル(ホスト模擬)
+//! @note	FatFs R0.13の次の処理に合わせてセクタアクセスを発行する.
+//! 		  create_chain: 新規は前回割当(last_clst)の次、伸長は末尾クラスタの次から空きを探す
+//! 		  remove_chain: 連鎖をたどって0を書く(exFATはビットマップを0にするだけ)
+//! 		  dir_find/dir_alloc: ディレクトリ先頭から順に読む
+//! 		  gen_numname: 短い名前(~1〜~5)が重なるたびにdir_findをやり直す(FAT32のみ)
+//! 		  f_sync: ファイルバッファ→ディレクトリエントリ→FSINFO(FAT32のみ)の順に書く
+//! 		exFATの配置はデータ領域の先頭からビットマップ, 大文字変換表(2クラスタ), ルートディレクトリ.
+//! 		FATの写し(s_fat)は連続ファイルの分もRAM上でつなぎ、SDへは連鎖を使うものだけ書く.
+//! 		logfs_Fopen()はfopencookie()で読込(f_read)と追記(f_write)をFILEにつなぐ.
+//======================================================================
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "diskio.h"
+
+#include "global.h"
+#include "logfs.h"
+
+//----- 定義 -----
+#define RESERVED_SECTORS	32				// 予約領域(VBR, FSINFO)
+#define FAT_PER_SECTOR		(LOGFS_SECTOR_SIZE / 4)
+#define SLOT_SIZE			32				// ディレクトリエントリ
+#define SLOTS_PER_SECTOR	(LOGFS_SECTOR_SIZE / SLOT_SIZE)
+#define SLOTS_PER_CLUSTER	(SLOTS_PER_SECTOR * LOGFS_CLUSTER_SECTORS)
+#define LFN_CHARS			13				// LFNエントリ1つの文字数
+#define SFN_PREFIX			6				// 番号付き短い名前の元になる文字数
+#define SFN_NUMBERED_MAX	5				// 番号(~1〜~5)の後はハッシュ名
+#define CLUSTER_EOC			0x0fffffffUL
+#define BITS_PER_SECTOR		(LOGFS_SECTOR_SIZE * 8)
+#define UPCASE_CLUSTERS		2				// 大文字変換表(5836byte)
+#define EXFAT_NAME_CHARS	15				// ファイル名エントリ1つの文字数
+#define NO_SECTOR			UINT32_MAX
+
+typedef enum
+{
+	Slot_End = 0,							// 未使用(以降も未使用)
+	Slot_Deleted,							// 削除済
+	Slot_Used,								// 使用中(LFN/SFN)
+} SlotState;
+
+typedef struct
+{
+	uint8_t state;							// SlotState
+	uint8_t count;							// 先頭スロット: エントリのスロット数
+	char name[LOGFS_NAME_MAX];				// 先頭スロット: 名前
+	uint32_t firstCluster;					// 先頭スロット: 先頭クラスタ(最後のf_sync時点)
+	uint32_t fragments;						// 先頭スロット: 断片数(同上)
+	int noFatChain;							// 先頭スロット: 連続(同上)
+	uint32_t size;							// 先頭スロット: サイズ(同上)
+} DirSlot;
+
+// stdioで開いたファイル(FatFsのFIL + VFSのファイル位置)
+typedef struct
+{
+	LogFile file;
+	int writable;							// 1=追記できる
+	int written;							// 1=書込あり(閉じるときに同期)
+	uint32_t position;						// 読込位置[byte]
+	uint32_t readSector;					// readBuffのセクタ番号(NO_SECTOR=なし)
+	uint8_t readBuff[LOGFS_SECTOR_SIZE];	// 読込バッファ
+} StdioFile;
+
+//----- 定数 -----
+static const BYTE pdrv = 0;
+
+//----- 変数 -----
+static LogFsType s_type;
+static uint32_t s_volumeSector;				// VBRのセクタ
+static uint32_t s_fatSector;				// FATの先頭セクタ
+static uint32_t s_dataSector;				// データ領域の先頭セクタ
+static uint32_t s_bitmapClusters;			// ビットマップのクラスタ数(exFAT)
+static uint32_t s_clusters;					// FATエントリ数(クラスタ数+2)
+static uint32_t *s_fat;						// FAT(RAM上の写し)
+static uint32_t s_lastCluster;				// 前回割り当てたクラスタ
+static uint32_t s_freeClusters;				// 空きクラスタ数
+static int s_fsinfoDirty;					// FSINFO更新要
+static DirSlot *s_slots;					// ディレクトリ
+static uint32_t *s_dirClusters;				// ディレクトリのクラスタ
+static uint32_t s_dirClusterCount;
+static uint8_t s_win[LOGFS_SECTOR_SIZE];	// 共有窓
+static uint32_t s_winSector;
+static int s_winDirty;
+static LogFsStats s_stats;
+
+static uint32_t ClusterSector(uint32_t cluster);
+static uint32_t SlotSector(uint32_t slot);
+static int MoveWindow(uint32_t sector);
+static int SyncWindow(void);
+static int WriteSector(const uint8_t *buff, uint32_t sector);
+static int GetFat(uint32_t cluster, uint32_t *value);
+static int PutFat(uint32_t cluster, uint32_t value);
+static int IsUsed(uint32_t cluster, int *used);
+static int SetBitmap(uint32_t cluster, int used);
+static int LinkCluster(uint32_t cluster, uint32_t value, int noFatChain);
+static uint32_t CreateChain(uint32_t cluster, int noFatChain);
+static int RemoveChain(uint32_t cluster, int noFatChain);
+static int NextCluster(LogFile *file);
+static int FindCluster(const LogFile *file, uint32_t index, uint32_t *cluster);
+static int ClearCluster(uint32_t cluster);
+static int FindEntry(const char *name, int *entry);
+static int AllocEntry(uint32_t count, int *entry);
+static int SfnProbes(const char *name);
+static ssize_t StdioRead(void *cookie, char *buff, size_t size);
+static ssize_t StdioWrite(void *cookie, const char *buff, size_t size);
+static int StdioSeek(void *cookie, off64_t *offset, int whence);
+static int StdioClose(void *cookie);
+
+//----------------------------------------------------------------------
+//! @brief  フォーマット
+//! @param	type		[I]ファイルシステム
+//! @param	firstSector	[I]ボリュームの先頭セクタ
+//! @param	sectors		[I]ボリュームのセクタ数
+//! @return	RET_OK=成功 RET_NG=書込失敗/容量不足
+//----------------------------------------------------------------------
+int logfs_Format(LogFsType type, uint32_t firstSector, uint32_t sectors)
+{
+	logfs_Release();
+	if(sectors < RESERVED_SECTORS + (2 + UPCASE_CLUSTERS + 2) * LOGFS_CLUSTER_SECTORS)
+	{
+		return RET_NG;
+	}
+
+	// FATの大きさはデータ領域のクラスタ数から決まる
+	uint32_t clusters = (sectors - RESERVED_SECTORS) / LOGFS_CLUSTER_SECTORS;
+	uint32_t fatSectors;
+	do
+	{
+		clusters--;
+		fatSectors = (clusters + 2 + FAT_PER_SECTOR - 1) / FAT_PER_SECTOR;
+	} while(RESERVED_SECTORS + fatSectors + clusters * LOGFS_CLUSTER_SECTORS > sectors);
+
+	// exFATはデータ領域の先頭にビットマップと大文字変換表を置き、その次がディレクトリ
+	s_type = type;
+	s_volumeSector = firstSector;
+	s_fatSector = firstSector + RESERVED_SECTORS;
+	s_dataSector = s_fatSector + fatSectors;
+	s_clusters = clusters + 2;
+	s_bitmapClusters = (type == LogFs_Exfat) ? (clusters + BITS_PER_SECTOR * LOGFS_CLUSTER_SECTORS - 1) / (BITS_PER_SECTOR * LOGFS_CLUSTER_SECTORS) : 0;
+	uint32_t dirCluster = (type == LogFs_Exfat) ? 2 + s_bitmapClusters + UPCASE_CLUSTERS : 2;
+	s_fat = calloc(s_clusters, sizeof(uint32_t));
+	s_fat[0] = 0x0ffffff8;
+	s_fat[1] = CLUSTER_EOC;
+	for(uint32_t c = 2; c < dirCluster; c++)
+	{
+		s_fat[c] = (c + 1 == 2 + s_bitmapClusters || c + 1 == dirCluster) ? CLUSTER_EOC : c + 1;
+	}
+	s_fat[dirCluster] = CLUSTER_EOC;
+	s_lastCluster = dirCluster;
+	s_freeClusters = clusters - (dirCluster - 1);
+	s_slots = calloc(SLOTS_PER_CLUSTER, sizeof(DirSlot));
+	s_dirClusters = malloc(sizeof(uint32_t));
+	s_dirClusters[0] = dirCluster;
+	s_dirClusterCount = 1;
+	s_winSector = UINT32_MAX;
+	s_winDirty = 0;
+	s_fsinfoDirty = 0;
+
+	// VBR, FSINFO(FAT32), FAT先頭, ビットマップ先頭(exFAT), ディレクトリ
+	uint8_t sector[LOGFS_SECTOR_SIZE];
+	memset(sector, 0, sizeof(sector));
+	if(type == LogFs_Exfat)
+	{
+		memcpy(sector, "\xeb\x76\x90" "EXFAT   ", 11);
+	}
+	sector[510] = 0x55;
+	sector[511] = 0xaa;
+	if(disk_write(pdrv, sector, s_volumeSector, 1) != RES_OK
+	|| (type == LogFs_Fat32 && disk_write(pdrv, sector, s_volumeSector + 1, 1) != RES_OK))
+	{
+		return RET_NG;
+	}
+	for(uint32_t i = 0; i * FAT_PER_SECTOR <= dirCluster; i++)
+	{
+		memset(sector, 0, sizeof(sector));
+		for(uint32_t c = i * FAT_PER_SECTOR; c <= dirCluster && c < (i + 1) * FAT_PER_SECTOR; c++)
+		{
+			memcpy(&sector[(c % FAT_PER_SECTOR) * 4], &s_fat[c], 4);
+		}
+		if(disk_write(pdrv, sector, s_fatSector + i, 1) != RES_OK)
+		{
+			return RET_NG;
+		}
+	}
+	if(type == LogFs_Exfat)
+	{
+		memset(sector, 0, sizeof(sector));
+		for(uint32_t c = 2; c <= dirCluster; c++)
+		{
+			sector[(c - 2) / 8] |= (uint8_t)(1 << ((c - 2) % 8));
+		}
+		if(disk_write(pdrv, sector, ClusterSector(2), 1) != RES_OK)
+		{
+			return RET_NG;
+		}
+	}
+	if(ClearCluster(dirCluster) != RET_OK)
+	{
+		return RET_NG;
+	}
+	memset(&s_stats, 0, sizeof(s_stats));
+	s_stats.totalClusters = clusters;
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  RAM上の管理情報を解放
+//----------------------------------------------------------------------
+void logfs_Release(void)
+{
+	free(s_fat);
+	free(s_slots);
+	free(s_dirClusters);
+	s_fat = NULL;
+	s_slots = NULL;
+	s_dirClusters = NULL;
+	s_dirClusterCount = 0;
+	memset(&s_stats, 0, sizeof(s_stats));
+}
+
+//----------------------------------------------------------------------
+//! @brief  ファイル作成
+//! @param	name	[I]名前(LOGFS_NAME_MAX未満)
+//! @param	file	[O]開いたファイル
+//! @return	RET_OK=成功 RET_NG=既にある/ディスクエラー/満杯
+//----------------------------------------------------------------------
+int logfs_Create(const char *name, LogFile *file)
+{
+	int entry;
+	size_t length = strlen(name);
+	if(s_fat == NULL || length == 0 || length >= LOGFS_NAME_MAX)
+	{
+		return RET_NG;
+	}
+
+	// 名前の確認と短い名前の生成(それぞれディレクトリ全体を読む, exFATは短い名前なし)
+	if(FindEntry(name, &entry) != RET_OK || entry >= 0)
+	{
+		return RET_NG;
+	}
+	for(int i = (s_type == LogFs_Fat32) ? SfnProbes(name) : 0; i > 0; i--)
+	{
+		if(FindEntry(NULL, &entry) != RET_OK)
+		{
+			return RET_NG;
+		}
+	}
+
+	// LFN+SFN(exFAT: ファイル+ストリーム拡張+ファイル名)のスロットを確保して書く
+	uint32_t count = (s_type == LogFs_Fat32)
+		? (uint32_t)(length + LFN_CHARS - 1) / LFN_CHARS + 1
+		: (uint32_t)(length + EXFAT_NAME_CHARS - 1) / EXFAT_NAME_CHARS + 2;
+	if(AllocEntry(count, &entry) != RET_OK)
+	{
+		return RET_NG;
+	}
+	for(uint32_t i = 0; i < count; i++)
+	{
+		if(MoveWindow(SlotSector(entry + i)) != RET_OK)
+		{
+			return RET_NG;
+		}
+		uint8_t *slot = &s_win[((entry + i) % SLOTS_PER_SECTOR) * SLOT_SIZE];
+		memset(slot, 0, SLOT_SIZE);
+		size_t position = i * LFN_CHARS;
+		size_t n = (position < length) ? length - position : 0;
+		memcpy(&slot[1], &name[position], (n > 11) ? 11 : n);
+		s_winDirty = 1;
+		s_slots[entry + i].state = Slot_Used;
+		s_slots[entry + i].count = 0;
+	}
+	DirSlot *head = &s_slots[entry];
+	head->count = (uint8_t)count;
+	strcpy(head->name, name);
+	head->firstCluster = 0;
+	head->fragments = 0;
+	head->noFatChain = 0;
+	head->size = 0;
+
+	memset(file, 0, sizeof(*file));
+	file->entry = entry;
+	file->noFatChain = (s_type == LogFs_Exfat);
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ファイルを開く(f_open相当)
+//! @param	name	[I]名前
+//! @param	append	[I]1=追記用(FA_OPEN_APPEND: 末尾クラスタまで連鎖をたどり、途中の末尾セクタを読む)
+//! @param	file	[O]開いたファイル
+//! @return	RET_OK=成功 RET_NG=ない/ディスクエラー
+//----------------------------------------------------------------------
+int logfs_Open(const char *name, int append, LogFile *file)
+{
+	const uint32_t clusterBytes = LOGFS_SECTOR_SIZE * LOGFS_CLUSTER_SECTORS;
+	int entry;
+
+	if(s_fat == NULL || FindEntry(name, &entry) != RET_OK || entry < 0)
+	{
+		return RET_NG;
+	}
+	memset(file, 0, sizeof(*file));
+	file->entry = entry;
+	file->firstCluster = s_slots[entry].firstCluster;
+	file->size = s_slots[entry].size;
+	file->fragments = s_slots[entry].fragments;
+	file->noFatChain = s_slots[entry].noFatChain;
+	if(!append || file->size == 0)
+	{
+		return RET_OK;
+	}
+
+	if(FindCluster(file, (file->size - 1) / clusterBytes, &file->lastCluster) != RET_OK)
+	{
+		return RET_NG;
+	}
+	if(file->size % LOGFS_SECTOR_SIZE != 0)
+	{
+		uint32_t sector = ClusterSector(file->lastCluster) + (file->size / LOGFS_SECTOR_SIZE) % LOGFS_CLUSTER_SECTORS;
+		s_stats.dataReads++;
+		if(disk_read(pdrv, file->buff, sector, 1) != RES_OK)
+		{
+			s_stats.diskErrors++;
+			return RET_NG;
+		}
+	}
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  マウントし直す(再起動後のf_mount相当)
+//! @note	共有窓を捨て、次のFAT/ディレクトリ参照でSDから読み直す.RAM上の管理情報はそのまま使う.
+//----------------------------------------------------------------------
+void logfs_Mount(void)
+{
+	s_winSector = UINT32_MAX;
+	s_winDirty = 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  stdioのファイルとして開く
+//! @param	name	[I]名前(ボリューム内のパス)
+//! @param	mode	[I]"r"=読込 "a"=追記(なければ作成) "w"=作り直して追記 ("b","t"は無視)
+//! @return	ファイル NULL=失敗(errno: ENOENT=ない, EINVAL=未対応のモード, EIO=ディスクエラー)
+//! @note	ファームウェアがVFS(/sd)経由で開くファイルの置き先.書込は常に末尾への追記で、
+//! 		閉じるときに書いていればlogfs_Sync()する(f_close相当).
+//----------------------------------------------------------------------
+FILE *logfs_Fopen(const char *name, const char *mode)
+{
+	const cookie_io_functions_t io = {StdioRead, StdioWrite, StdioSeek, StdioClose};
+	int ok;
+
+	if(mode[0] == '\0' || strchr("raw", mode[0]) == NULL || strchr(mode, '+') != NULL)
+	{
+		errno = EINVAL;
+		return NULL;
+	}
+	StdioFile *fp = calloc(1, sizeof(StdioFile));
+	if(fp == NULL)
+	{
+		errno = ENOMEM;
+		return NULL;
+	}
+	fp->readSector = NO_SECTOR;
+	fp->writable = (mode[0] != 'r');
+	if(mode[0] == 'r')
+	{
+		ok = (logfs_Open(name, 0, &fp->file) == RET_OK);
+		errno = ENOENT;
+	}
+	else if(mode[0] == 'a')
+	{
+		ok = (logfs_Open(name, 1, &fp->file) == RET_OK);
+		fp->written = !ok;							// 作成したらエントリを書く
+		ok = ok || (logfs_Create(name, &fp->file) == RET_OK);
+		errno = EIO;
+	}
+	else
+	{
+		logfs_Delete(name);
+		ok = (logfs_Create(name, &fp->file) == RET_OK);
+		fp->written = 1;
+		errno = EIO;
+	}
+	FILE *stream = ok ? fopencookie(fp, mode, io) : NULL;
+	if(stream == NULL)
+	{
+		free(fp);
+		return NULL;
+	}
+	return stream;
+}
+
+//----------------------------------------------------------------------
+//! @brief  追記
+//! @param	file	[IO]ファイル
+//! @param	data	[I]データ
+//! @param	length	[I]長さ[byte]
+//! @return	RET_OK=成功 RET_NG=ディスクエラー/満杯(書けた分はsizeに反映)
+//----------------------------------------------------------------------
+int logfs_Append(LogFile *file, const void *data, uint32_t length)
+{
+	const uint8_t *src = data;
+	const uint32_t clusterBytes = LOGFS_SECTOR_SIZE * LOGFS_CLUSTER_SECTORS;
+
+	while(length > 0)
+	{
+		uint32_t offset = file->size % LOGFS_SECTOR_SIZE;
+		if(file->size % clusterBytes == 0 && NextCluster(file) != RET_OK)
+		{
+			return RET_NG;
+		}
+
+		uint32_t n = LOGFS_SECTOR_SIZE - offset;
+		if(n > length)
+		{
+			n = length;
+		}
+		memcpy(&file->buff[offset], src, n);
+		src += n;
+		length -= n;
+		file->size += n;
+		file->dirty = 1;
+
+		if(file->size % LOGFS_SECTOR_SIZE == 0)
+		{
+			uint32_t sector = ClusterSector(file->lastCluster) + ((file->size - 1) / LOGFS_SECTOR_SIZE) % LOGFS_CLUSTER_SECTORS;
+			if(WriteSector(file->buff, sector) != RET_OK)
+			{
+				return RET_NG;
+			}
+			file->dirty = 0;
+		}
+	}
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  同期(f_sync相当)
+//! @param	file	[IO]ファイル
+//! @return	RET_OK=成功 RET_NG=ディスクエラー
+//----------------------------------------------------------------------
+int logfs_Sync(LogFile *file)
+{
+	if(file->dirty)
+	{
+		uint32_t sector = ClusterSector(file->lastCluster) + (file->size / LOGFS_SECTOR_SIZE) % LOGFS_CLUSTER_SECTORS;
+		if(WriteSector(file->buff, sector) != RET_OK)
+		{
+			return RET_NG;
+		}
+		file->dirty = 0;
+	}
+
+	// ディレクトリエントリのサイズ・先頭クラスタ
+	// FAT32はSFNだけ、exFATはチェックサムがあるのでエントリセット全体を書く
+	DirSlot *head = &s_slots[file->entry];
+	uint32_t first = (s_type == LogFs_Fat32) ? file->entry + head->count - 1 : (uint32_t)file->entry;
+	for(uint32_t i = first; i < file->entry + head->count; i++)
+	{
+		if(MoveWindow(SlotSector(i)) != RET_OK)
+		{
+			return RET_NG;
+		}
+		uint8_t *slot = &s_win[(i % SLOTS_PER_SECTOR) * SLOT_SIZE];
+		if(s_type == LogFs_Fat32)
+		{
+			memcpy(&slot[26], &file->firstCluster, 2);
+			memcpy(&slot[28], &file->size, 4);
+		}
+		else if(i == (uint32_t)file->entry + 1)				// ストリーム拡張
+		{
+			slot[1] = (uint8_t)(file->noFatChain ? 0x03 : 0x01);
+			memcpy(&slot[20], &file->firstCluster, 4);
+			memcpy(&slot[24], &file->size, 4);
+		}
+		s_winDirty = 1;
+	}
+	head->firstCluster = file->firstCluster;
+	head->fragments = file->fragments;
+	head->noFatChain = file->noFatChain;
+	head->size = file->size;
+	if(SyncWindow() != RET_OK)
+	{
+		return RET_NG;
+	}
+
+	if(s_type == LogFs_Fat32 && s_fsinfoDirty)
+	{
+		uint8_t sector[LOGFS_SECTOR_SIZE];
+		memset(sector, 0, sizeof(sector));
+		memcpy(&sector[488], &s_freeClusters, 4);
+		memcpy(&sector[492], &s_lastCluster, 4);
+		sector[510] = 0x55;
+		sector[511] = 0xaa;
+		s_stats.winWrites++;
+		if(disk_write(pdrv, sector, s_volumeSector + 1, 1) != RES_OK)
+		{
+			s_stats.diskErrors++;
+			return RET_NG;
+		}
+		s_fsinfoDirty = 0;
+	}
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  連続領域の確保(f_expand(opt=1)相当)
+//! @param	file	[IO]作成直後(空)のファイル
+//! @param	bytes	[I]確保するバイト数
+//! @return	RET_OK=成功 RET_NG=連続した空きがない/ディスクエラー
+//! @note	前回割当位置の次から連続した空きを探し、連鎖(exFATはビットマップ)を書く.サイズは変えない.
+//! 		確保した範囲の追記ではFATを書き換えない.使わなかった分はlogfs_Close()で返す.
+//----------------------------------------------------------------------
+int logfs_Expand(LogFile *file, uint32_t bytes)
+{
+	const uint32_t need = (bytes + LOGFS_SECTOR_SIZE * LOGFS_CLUSTER_SECTORS - 1) / (LOGFS_SECTOR_SIZE * LOGFS_CLUSTER_SECTORS);
+	uint32_t start = 0, run = 0;
+	int used;
+
+	if(file->size != 0 || file->firstCluster != 0 || need == 0 || need > s_freeClusters)
+	{
+		return RET_NG;
+	}
+	uint32_t cluster = s_lastCluster;
+	for(uint32_t i = 2; i < s_clusters && run < need; i++)
+	{
+		cluster = (cluster + 1 < s_clusters) ? cluster + 1 : 2;
+		if(cluster == 2)
+		{
+			run = 0;						// 折り返しで連続が切れる
+		}
+		if(IsUsed(cluster, &used) != RET_OK)
+		{
+			return RET_NG;
+		}
+		if(used)
+		{
+			run = 0;
+			continue;
+		}
+		start = (run == 0) ? cluster : start;
+		run++;
+	}
+	if(run < need)
+	{
+		return RET_NG;
+	}
+
+	for(uint32_t c = start; c < start + need; c++)
+	{
+		if((s_type == LogFs_Exfat && SetBitmap(c, 1) != RET_OK)
+		|| LinkCluster(c, (c + 1 < start + need) ? c + 1 : CLUSTER_EOC, file->noFatChain) != RET_OK)
+		{
+			return RET_NG;
+		}
+	}
+	s_lastCluster = start + need - 1;
+	s_freeClusters -= need;
+	s_fsinfoDirty = 1;
+	file->firstCluster = start;
+	file->fragments = 1;
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  閉じる(f_truncate + f_close相当)
+//! @param	file	[IO]ファイル
+//! @return	RET_OK=成功 RET_NG=ディスクエラー
+//! @note	logfs_Expand()で確保して使わなかったクラスタを解放してから同期する.
+//----------------------------------------------------------------------
+int logfs_Close(LogFile *file)
+{
+	uint32_t next = file->firstCluster;
+	if(file->lastCluster != 0)
+	{
+		if(file->noFatChain)
+		{
+			next = s_fat[file->lastCluster];
+		}
+		else if(GetFat(file->lastCluster, &next) != RET_OK)
+		{
+			return RET_NG;
+		}
+		if(next >= 2 && next < s_clusters && LinkCluster(file->lastCluster, CLUSTER_EOC, file->noFatChain) != RET_OK)
+		{
+			return RET_NG;
+		}
+	}
+	else
+	{
+		file->firstCluster = 0;
+		file->fragments = 0;
+	}
+	if(RemoveChain(next, file->noFatChain) != RET_OK)
+	{
+		return RET_NG;
+	}
+	return logfs_Sync(file);
+}
+
+//----------------------------------------------------------------------
+//! @brief  サイズを伸ばす(書込モードでのf_lseekによる伸長相当)
+//! @param	file	[IO]ファイル
+//! @param	size	[I]新しいサイズ[byte](今のサイズ以上)
+//! @return	RET_OK=成功 RET_NG=縮小/ディスクエラー/満杯
+//! @note	クラスタは追記と同じく1つずつ割り当て、データは書かない.
+//----------------------------------------------------------------------
+int logfs_Stretch(LogFile *file, uint32_t size)
+{
+	const uint32_t clusterBytes = LOGFS_SECTOR_SIZE * LOGFS_CLUSTER_SECTORS;
+
+	if(size < file->size)
+	{
+		return RET_NG;
+	}
+	if(size / LOGFS_SECTOR_SIZE != file->size / LOGFS_SECTOR_SIZE)
+	{
+		if(file->dirty)
+		{
+			uint32_t sector = ClusterSector(file->lastCluster) + (file->size / LOGFS_SECTOR_SIZE) % LOGFS_CLUSTER_SECTORS;
+			if(WriteSector(file->buff, sector) != RET_OK)
+			{
+				return RET_NG;
+			}
+			file->dirty = 0;
+		}
+		memset(file->buff, 0, sizeof(file->buff));
+	}
+	while(file->size < size)
+	{
+		if(file->size % clusterBytes == 0 && NextCluster(file) != RET_OK)
+		{
+			return RET_NG;
+		}
+		uint32_t n = clusterBytes - file->size % clusterBytes;
+		file->size += (n < size - file->size) ? n : size - file->size;
+	}
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  セクタの用途
+//! @param	sector	[I]セクタ
+//! @return	"vbr", "fsinfo", "reserved", "fat", "bitmap", "upcase", "dir", "data", "outside"
+//----------------------------------------------------------------------
+const char *logfs_SectorRegion(uint32_t sector)
+{
+	if(s_fat == NULL || sector < s_volumeSector)
+	{
+		return "outside";
+	}
+	if(sector == s_volumeSector)
+	{
+		return "vbr";
+	}
+	if(s_type == LogFs_Fat32 && sector == s_volumeSector + 1)
+	{
+		return "fsinfo";
+	}
+	if(sector < s_fatSector)
+	{
+		return "reserved";
+	}
+	if(sector < s_dataSector)
+	{
+		return "fat";
+	}
+	uint32_t cluster = (sector - s_dataSector) / LOGFS_CLUSTER_SECTORS + 2;
+	if(cluster >= s_clusters)
+	{
+		return "outside";
+	}
+	if(cluster < 2 + s_bitmapClusters)
+	{
+		return "bitmap";
+	}
+	if(s_type == LogFs_Exfat && cluster < 2 + s_bitmapClusters + UPCASE_CLUSTERS)
+	{
+		return "upcase";
+	}
+	for(uint32_t i = 0; i < s_dirClusterCount; i++)
+	{
+		if(s_dirClusters[i] == cluster)
+		{
+			return "dir";
+		}
+	}
+	return "data";
+}
+
+//----------------------------------------------------------------------
+//! @brief  1セクタ読込
+//! @param	file	[I]ファイル
+//! @param	offset	[I]位置[byte](セクタ境界, size未満)
+//! @param	buff	[O]データ(512byte)
+//! @return	RET_OK=成功 RET_NG=範囲外/ディスクエラー
+//! @note	FAT連鎖を先頭からたどる(連続ファイルは計算で求める).書込前の末尾セクタはファイルバッファから返す.
+//----------------------------------------------------------------------
+int logfs_Read(const LogFile *file, uint32_t offset, uint8_t *buff)
+{
+	if(offset >= file->size || offset % LOGFS_SECTOR_SIZE != 0)
+	{
+		return RET_NG;
+	}
+	if(file->dirty && offset / LOGFS_SECTOR_SIZE == file->size / LOGFS_SECTOR_SIZE)
+	{
+		memcpy(buff, file->buff, LOGFS_SECTOR_SIZE);
+		return RET_OK;
+	}
+
+	uint32_t cluster;
+	if(FindCluster(file, offset / (LOGFS_SECTOR_SIZE * LOGFS_CLUSTER_SECTORS), &cluster) != RET_OK)
+	{
+		return RET_NG;
+	}
+	uint32_t sector = ClusterSector(cluster) + (offset / LOGFS_SECTOR_SIZE) % LOGFS_CLUSTER_SECTORS;
+	s_stats.dataReads++;
+	if(disk_read(pdrv, buff, sector, 1) != RES_OK)
+	{
+		s_stats.diskErrors++;
+		return RET_NG;
+	}
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ファイル削除(f_unlink相当, 開いていないこと)
+//! @param	name	[I]名前
+//! @return	RET_OK=成功 RET_NG=ない/ディスクエラー
+//----------------------------------------------------------------------
+int logfs_Delete(const char *name)
+{
+	int entry;
+	if(s_fat == NULL || FindEntry(name, &entry) != RET_OK || entry < 0)
+	{
+		return RET_NG;
+	}
+
+	// クラスタ連鎖の解放
+	if(RemoveChain(s_slots[entry].firstCluster, s_slots[entry].noFatChain) != RET_OK)
+	{
+		return RET_NG;
+	}
+
+	// エントリの削除(FAT32: 0xe5, exFAT: 使用中ビットを0)
+	uint32_t count = s_slots[entry].count;
+	for(uint32_t i = 0; i < count; i++)
+	{
+		if(MoveWindow(SlotSector(entry + i)) != RET_OK)
+		{
+			return RET_NG;
+		}
+		s_win[((entry + i) % SLOTS_PER_SECTOR) * SLOT_SIZE] = 0xe5;
+		s_winDirty = 1;
+		memset(&s_slots[entry + i], 0, sizeof(DirSlot));
+		s_slots[entry + i].state = Slot_Deleted;
+	}
+	return SyncWindow();
+}
+
+//----------------------------------------------------------------------
+//! @brief  ファイルサイズ(最後のf_sync時点)
+//! @param	name	[I]名前
+//! @return	サイズ[byte] 0=ない
+//! @note	RAM上の管理情報から返し、SDにはアクセスしない(試験の集計用).
+//----------------------------------------------------------------------
+uint32_t logfs_GetSize(const char *name)
+{
+	for(uint32_t i = 0; s_slots != NULL && i < s_dirClusterCount * SLOTS_PER_CLUSTER && s_slots[i].state != Slot_End; i++)
+	{
+		if(s_slots[i].count > 0 && strcmp(s_slots[i].name, name) == 0)
+		{
+			return s_slots[i].size;
+		}
+	}
+	return 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  統計取得
+//! @param	stats	[O]統計(ファイル数・断片数は最後のf_sync時点)
+//----------------------------------------------------------------------
+void logfs_GetStats(LogFsStats *stats)
+{
+	*stats = s_stats;
+	stats->freeClusters = s_freeClusters;
+	stats->files = 0;
+	stats->fragments = 0;
+	stats->dirSlots = 0;
+	stats->dirSectors = s_dirClusterCount * LOGFS_CLUSTER_SECTORS;
+	for(uint32_t i = 0; s_slots != NULL && i < s_dirClusterCount * SLOTS_PER_CLUSTER && s_slots[i].state != Slot_End; i++)
+	{
+		stats->dirSlots++;
+		if(s_slots[i].count > 0)
+		{
+			stats->files++;
+			stats->fragments += s_slots[i].fragments;
+		}
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  クラスタの先頭セクタ
+//----------------------------------------------------------------------
+uint32_t ClusterSector(uint32_t cluster)
+{
+	return s_dataSector + (cluster - 2) * LOGFS_CLUSTER_SECTORS;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ディレクトリスロットのセクタ
+//----------------------------------------------------------------------
+uint32_t SlotSector(uint32_t slot)
+{
+	return ClusterSector(s_dirClusters[slot / SLOTS_PER_CLUSTER]) + (slot % SLOTS_PER_CLUSTER) / SLOTS_PER_SECTOR;
+}
+
+//----------------------------------------------------------------------
+//! @brief  窓を移動(move_window相当)
+//! @param	sector	[I]セクタ
+//! @return	RET_OK=成功 RET_NG=ディスクエラー
+//----------------------------------------------------------------------
+int MoveWindow(uint32_t sector)
+{
+	if(sector == s_winSector)
+	{
+		return RET_OK;
+	}
+	if(SyncWindow() != RET_OK)
+	{
+		return RET_NG;
+	}
+	s_stats.winReads++;
+	if(disk_read(pdrv, s_win, sector, 1) != RES_OK)
+	{
+		s_stats.diskErrors++;
+		s_winSector = UINT32_MAX;
+		return RET_NG;
+	}
+	s_winSector = sector;
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  窓を書き戻す(sync_window相当)
+//! @return	RET_OK=成功 RET_NG=ディスクエラー
+//----------------------------------------------------------------------
+int SyncWindow(void)
+{
+	if(!s_winDirty)
+	{
+		return RET_OK;
+	}
+	s_stats.winWrites++;
+	if(disk_write(pdrv, s_win, s_winSector, 1) != RES_OK)
+	{
+		s_stats.diskErrors++;
+		return RET_NG;
+	}
+	s_winDirty = 0;
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  データセクタ書込
+//----------------------------------------------------------------------
+int WriteSector(const uint8_t *buff, uint32_t sector)
+{
+	s_stats.dataWrites++;
+	if(disk_write(pdrv, buff, sector, 1) != RES_OK)
+	{
+		s_stats.diskErrors++;
+		return RET_NG;
+	}
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  FATエントリ読込(値はRAM上の写しから取り、SDは窓の移動だけ)
+//----------------------------------------------------------------------
+int GetFat(uint32_t cluster, uint32_t *value)
+{
+	if(MoveWindow(s_fatSector + cluster / FAT_PER_SECTOR) != RET_OK)
+	{
+		return RET_NG;
+	}
+	*value = s_fat[cluster];
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  FATエントリ書込
+//----------------------------------------------------------------------
+int PutFat(uint32_t cluster, uint32_t value)
+{
+	if(MoveWindow(s_fatSector + cluster / FAT_PER_SECTOR) != RET_OK)
+	{
+		return RET_NG;
+	}
+	s_fat[cluster] = value;
+	memcpy(&s_win[(cluster % FAT_PER_SECTOR) * 4], &value, 4);
+	s_winDirty = 1;
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  クラスタが使用中か(FAT32: FAT, exFAT: ビットマップ)
+//----------------------------------------------------------------------
+int IsUsed(uint32_t cluster, int *used)
+{
+	if(s_type == LogFs_Fat32)
+	{
+		uint32_t value;
+		if(GetFat(cluster, &value) != RET_OK)
+		{
+			return RET_NG;
+		}
+		*used = (value != 0);
+		return RET_OK;
+	}
+	if(MoveWindow(ClusterSector(2) + (cluster - 2) / BITS_PER_SECTOR) != RET_OK)
+	{
+		return RET_NG;
+	}
+	*used = (s_fat[cluster] != 0);
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ビットマップ書込(change_bitmap相当, exFAT)
+//----------------------------------------------------------------------
+int SetBitmap(uint32_t cluster, int used)
+{
+	if(MoveWindow(ClusterSector(2) + (cluster - 2) / BITS_PER_SECTOR) != RET_OK)
+	{
+		return RET_NG;
+	}
+	uint8_t *bits = &s_win[((cluster - 2) % BITS_PER_SECTOR) / 8];
+	uint8_t mask = (uint8_t)(1 << ((cluster - 2) % 8));
+	*bits = used ? (*bits | mask) : (*bits & ~mask);
+	s_winDirty = 1;
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  連鎖の書込
+//! @param	cluster		[I]クラスタ
+//! @param	value		[I]次のクラスタ/CLUSTER_EOC
+//! @param	noFatChain	[I]1=連続ファイル(RAM上の写しだけ変える)
+//----------------------------------------------------------------------
+int LinkCluster(uint32_t cluster, uint32_t value, int noFatChain)
+{
+	if(noFatChain)
+	{
+		s_fat[cluster] = value;
+		return RET_OK;
+	}
+	return PutFat(cluster, value);
+}
+
+//----------------------------------------------------------------------
+//! @brief  クラスタ割当(create_chain相当)
+//! @param	cluster		[I]伸ばす連鎖の末尾 0=新規
+//! @param	noFatChain	[I]1=連続ファイル(FATを読み書きしない)
+//! @return	割り当てたクラスタ(既に続きがあればそのクラスタ) 0=満杯/ディスクエラー
+//----------------------------------------------------------------------
+uint32_t CreateChain(uint32_t cluster, int noFatChain)
+{
+	uint32_t start = (cluster == 0) ? s_lastCluster : cluster;
+	uint32_t next = start;
+	uint32_t value;
+	int used;
+
+	if(cluster != 0)
+	{
+		if(noFatChain)
+		{
+			value = s_fat[cluster];			// 連続ファイルは確保済みの範囲がサイズから分かる
+		}
+		else if(GetFat(cluster, &value) != RET_OK)
+		{
+			return 0;
+		}
+		if(value >= 2 && value < s_clusters)
+		{
+			return value;					// 確保済み(f_expand)
+		}
+	}
+	if(s_freeClusters == 0)
+	{
+		return 0;
+	}
+	do
+	{
+		next = (next + 1 < s_clusters) ? next + 1 : 2;
+		if(next == start || IsUsed(next, &used) != RET_OK)
+		{
+			return 0;
+		}
+	} while(used);
+
+	if((s_type == LogFs_Exfat && SetBitmap(next, 1) != RET_OK)
+	|| LinkCluster(next, CLUSTER_EOC, noFatChain) != RET_OK
+	|| (cluster != 0 && LinkCluster(cluster, next, noFatChain) != RET_OK))
+	{
+		return 0;
+	}
+	s_lastCluster = next;
+	s_freeClusters--;
+	s_fsinfoDirty = 1;
+	return next;
+}
+
+//----------------------------------------------------------------------
+//! @brief  連鎖の解放(remove_chain相当)
+//! @param	cluster		[I]先頭クラスタ(範囲外なら何もしない)
+//! @param	noFatChain	[I]1=連続ファイル
+//! @note	exFATはFATを消さず、ビットマップだけ0にする.
+//----------------------------------------------------------------------
+int RemoveChain(uint32_t cluster, int noFatChain)
+{
+	while(cluster >= 2 && cluster < s_clusters)
+	{
+		uint32_t next = s_fat[cluster];
+		if(!noFatChain && GetFat(cluster, &next) != RET_OK)
+		{
+			return RET_NG;
+		}
+		if(s_type == LogFs_Fat32 ? PutFat(cluster, 0) != RET_OK : SetBitmap(cluster, 0) != RET_OK)
+		{
+			return RET_NG;
+		}
+		s_fat[cluster] = 0;
+		s_freeClusters++;
+		s_fsinfoDirty = 1;
+		cluster = next;
+	}
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  末尾にクラスタを足す
+//! @param	file	[IO]ファイル(サイズがクラスタ境界)
+//! @return	RET_OK=成功 RET_NG=ディスクエラー/満杯
+//! @note	連続ファイルが途切れたら、それまでの分のFAT連鎖を書いて連鎖を使うファイルにする(fill_first_frag).
+//----------------------------------------------------------------------
+int NextCluster(LogFile *file)
+{
+	uint32_t cluster = (file->lastCluster == 0) ? file->firstCluster : 0;
+	if(cluster == 0)
+	{
+		cluster = CreateChain(file->lastCluster, file->noFatChain);
+	}
+	if(cluster == 0)
+	{
+		return RET_NG;
+	}
+	if(file->firstCluster == 0)
+	{
+		file->firstCluster = cluster;
+		file->fragments = 1;
+	}
+	else if(file->lastCluster != 0 && cluster != file->lastCluster + 1)
+	{
+		file->fragments++;
+		if(file->noFatChain)
+		{
+			file->noFatChain = 0;
+			for(uint32_t c = file->firstCluster; c != CLUSTER_EOC; c = s_fat[c])
+			{
+				if(PutFat(c, s_fat[c]) != RET_OK)
+				{
+					return RET_NG;
+				}
+			}
+		}
+	}
+	file->lastCluster = cluster;
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ファイル内のクラスタ
+//! @param	file	[I]ファイル
+//! @param	index	[I]先頭からのクラスタ番号
+//! @param	cluster	[O]クラスタ
+//! @return	RET_OK=成功 RET_NG=連鎖が切れている/ディスクエラー
+//! @note	連鎖を使うファイルはFATを先頭からたどる.連続ファイルはFATを読まない.
+//----------------------------------------------------------------------
+int FindCluster(const LogFile *file, uint32_t index, uint32_t *cluster)
+{
+	if(file->noFatChain)
+	{
+		*cluster = file->firstCluster + index;
+		return (*cluster >= 2 && *cluster < s_clusters) ? RET_OK : RET_NG;
+	}
+	*cluster = file->firstCluster;
+	for(uint32_t i = index; i > 0; i--)
+	{
+		if(GetFat(*cluster, cluster) != RET_OK || *cluster < 2 || *cluster >= s_clusters)
+		{
+			return RET_NG;
+		}
+	}
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  クラスタを0で埋める(dir_clear相当)
+//----------------------------------------------------------------------
+int ClearCluster(uint32_t cluster)
+{
+	uint8_t sector[LOGFS_SECTOR_SIZE];
+	memset(sector, 0, sizeof(sector));
+	if(SyncWindow() != RET_OK)
+	{
+		return RET_NG;
+	}
+	for(int i = 0; i < LOGFS_CLUSTER_SECTORS; i++)
+	{
+		s_stats.winWrites++;
+		if(disk_write(pdrv, sector, ClusterSector(cluster) + i, 1) != RES_OK)
+		{
+			s_stats.diskErrors++;
+			return RET_NG;
+		}
+	}
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  名前を探す(dir_find相当)
+//! @param	name	[I]名前 NULL=見つからない名前(短い名前の重なり確認)
+//! @param	entry	[O]先頭スロット -1=ない
+//! @return	RET_OK=成功 RET_NG=ディスクエラー
+//----------------------------------------------------------------------
+int FindEntry(const char *name, int *entry)
+{
+	const uint32_t slots = s_dirClusterCount * SLOTS_PER_CLUSTER;
+
+	*entry = -1;
+	for(uint32_t i = 0; i < slots && s_slots[i].state != Slot_End; i++)
+	{
+		if(MoveWindow(SlotSector(i)) != RET_OK)
+		{
+			return RET_NG;
+		}
+		if(name != NULL && s_slots[i].count > 0 && strcmp(s_slots[i].name, name) == 0)
+		{
+			*entry = (int)i;
+			break;
+		}
+	}
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  連続した空きスロットを確保(dir_alloc相当)
+//! @param	count	[I]スロット数
+//! @param	entry	[O]先頭スロット
+//! @return	RET_OK=成功 RET_NG=ディスクエラー/満杯
+//! @note	先頭から探し、削除済スロットも使う.末尾まで足りなければディレクトリを1クラスタ伸ばす.
+//----------------------------------------------------------------------
+int AllocEntry(uint32_t count, int *entry)
+{
+	uint32_t run = 0;
+	for(uint32_t i = 0; ; i++)
+	{
+		if(i == s_dirClusterCount * SLOTS_PER_CLUSTER)
+		{
+			uint32_t cluster = CreateChain(s_dirClusters[s_dirClusterCount - 1], 0);
+			if(cluster == 0 || ClearCluster(cluster) != RET_OK)
+			{
+				return RET_NG;
+			}
+			s_dirClusters = realloc(s_dirClusters, (s_dirClusterCount + 1) * sizeof(uint32_t));
+			s_dirClusters[s_dirClusterCount++] = cluster;
+			s_slots = realloc(s_slots, s_dirClusterCount * SLOTS_PER_CLUSTER * sizeof(DirSlot));
+			memset(&s_slots[i], 0, SLOTS_PER_CLUSTER * sizeof(DirSlot));
+		}
+		if(MoveWindow(SlotSector(i)) != RET_OK)
+		{
+			return RET_NG;
+		}
+		run = (s_slots[i].state == Slot_Used) ? 0 : run + 1;
+		if(run == count)
+		{
+			*entry = (int)(i + 1 - count);
+			return RET_OK;
+		}
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  短い名前の生成で行う確認の回数(gen_numname)
+//! @note	名前は8.3形式に収まらない前提.~1から順に重なりを確認し、~5の後はハッシュ名にする.
+//----------------------------------------------------------------------
+int SfnProbes(const char *name)
+{
+	const uint32_t slots = s_dirClusterCount * SLOTS_PER_CLUSTER;
+	int same = 0;
+
+	for(uint32_t i = 0; i < slots && s_slots[i].state != Slot_End && same < SFN_NUMBERED_MAX; i++)
+	{
+		same += (s_slots[i].count > 0 && strncasecmp(s_slots[i].name, name, SFN_PREFIX) == 0);
+	}
+	return same + 1;
+}
+
+//----------------------------------------------------------------------
+//! @brief  stdio: 読込(f_read相当, 1セクタずつ)
+//----------------------------------------------------------------------
+ssize_t StdioRead(void *cookie, char *buff, size_t size)
+{
+	StdioFile *fp = cookie;
+	size_t done = 0;
+
+	while(done < size && fp->position < fp->file.size)
+	{
+		uint32_t sector = fp->position / LOGFS_SECTOR_SIZE;
+		if(sector != fp->readSector)
+		{
+			if(logfs_Read(&fp->file, sector * LOGFS_SECTOR_SIZE, fp->readBuff) != RET_OK)
+			{
+				errno = EIO;
+				return (done > 0) ? (ssize_t)done : -1;
+			}
+			fp->readSector = sector;
+		}
+		uint32_t offset = fp->position % LOGFS_SECTOR_SIZE;
+		uint32_t n = LOGFS_SECTOR_SIZE - offset;
+		if(n > fp->file.size - fp->position)
+		{
+			n = fp->file.size - fp->position;
+		}
+		if(n > size - done)
+		{
+			n = (uint32_t)(size - done);
+		}
+		memcpy(&buff[done], &fp->readBuff[offset], n);
+		done += n;
+		fp->position += n;
+	}
+	return (ssize_t)done;
+}
+
+//----------------------------------------------------------------------
+//! @brief  stdio: 書込(末尾への追記)
+//----------------------------------------------------------------------
+ssize_t StdioWrite(void *cookie, const char *buff, size_t size)
+{
+	StdioFile *fp = cookie;
+
+	if(!fp->writable)
+	{
+		errno = EBADF;
+		return -1;
+	}
+	fp->written = 1;
+	fp->readSector = NO_SECTOR;
+	if(logfs_Append(&fp->file, buff, (uint32_t)size) != RET_OK)
+	{
+		errno = EIO;
+		return -1;
+	}
+	fp->position = fp->file.size;
+	return (ssize_t)size;
+}
+
+//----------------------------------------------------------------------
+//! @brief  stdio: 位置(f_lseek相当, サイズより先には伸ばさない)
+//----------------------------------------------------------------------
+int StdioSeek(void *cookie, off64_t *offset, int whence)
+{
+	StdioFile *fp = cookie;
+	off64_t base = (whence == SEEK_SET) ? 0 : (whence == SEEK_CUR) ? fp->position : fp->file.size;
+
+	if((whence != SEEK_SET && whence != SEEK_CUR && whence != SEEK_END)
+	|| base + *offset < 0 || base + *offset > fp->file.size)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+	fp->position = (uint32_t)(base + *offset);
+	*offset = fp->position;
+	return 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  stdio: 閉じる(f_close相当)
+//----------------------------------------------------------------------
+int StdioClose(void *cookie)
+{
+	StdioFile *fp = cookie;
+	int ret = 0;
+
+	if(fp->written && logfs_Sync(&fp->file) != RET_OK)
+	{
+		errno = EIO;
+		ret = -1;
+	}
+	free(fp);
+	return ret;
+}
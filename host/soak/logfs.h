@@ -0,0 +1,81 @@
+//======================================================================
+//! @file   logfs.h
+//! @brief  長期試験用のFAT32/exFAT配置モデル(ホスト模擬)
+//! @note	FatFsと同じ順序・同じセクタへdisk_read()/disk_write()を発行し、
+//! 		ログファイルの伸長、ディレクトリの肥大、断片化によるSDアクセスの増加を再現する.
+//! 		管理情報(FAT, ディレクトリ)はRAM上にも持ち、SDには内容を書くだけで読み直さない.
+//! 		  - FAT/ディレクトリは1セクタの共有窓(FatFsのfs->win)を通して読み書きする
+//! 		  - クラスタはFatFsと同じく前回割り当て位置の次から空きを探す
+//! 		  - ディレクトリは1つで、作成/削除のたびに先頭から名前を探す(LFN含め1ファイル複数エントリ)
+//! 		  - ファイルは追記のみ.データは1セクタのファイルバッファ経由(FF_FS_TINY=0)
+//! 		  - logfs_Fopen()でstdioのFILEとして開ける(ファームウェアのfopen("/sd/...")の置き先)
+//! 		  - 読込はFAT連鎖を先頭からたどる(FF_USE_FASTSEEKなし)
+//! 		  - f_expandによる連続領域の事前確保と、閉じるときの未使用分の解放(f_truncate)
+//! 		  - exFATは空きをアロケーションビットマップで管理し、連続したファイル(NoFatChain)は
+//! 		    FATを読み書きしない.途中で断片化したらそれまでの分もFAT連鎖にする
+//! 		    (モデルのみ.実機のFatFsはFF_FS_EXFAT=0で、exFATのカードはマウントできない)
+//======================================================================
+#ifndef _LOGFS_H_
+#define _LOGFS_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define LOGFS_SECTOR_SIZE		512
+#define LOGFS_CLUSTER_SECTORS	8			// 4KiB/クラスタ
+#define LOGFS_NAME_MAX			32
+
+// ファイルシステム
+typedef enum
+{
+	LogFs_Fat32 = 0,
+	LogFs_Exfat,
+} LogFsType;
+
+// 開いているファイル
+typedef struct
+{
+	int entry;								// ディレクトリエントリ番号
+	uint32_t firstCluster;					// 先頭クラスタ(0=未割当)
+	uint32_t lastCluster;					// 末尾クラスタ
+	uint32_t size;							// サイズ[byte]
+	uint32_t fragments;						// 断片数
+	int noFatChain;							// 1=連続(exFAT, FATを使わない)
+	uint8_t buff[LOGFS_SECTOR_SIZE];		// ファイルバッファ(末尾セクタ)
+	int dirty;								// ファイルバッファ未書込
+} LogFile;
+
+// 統計
+typedef struct
+{
+	uint32_t totalClusters;					// データ領域のクラスタ数
+	uint32_t freeClusters;					// 空きクラスタ数
+	uint32_t files;							// ファイル数
+	uint32_t fragments;						// 全ファイルの断片数の合計
+	uint32_t dirSlots;						// ディレクトリの使用済スロット数(削除済含む, 末尾まで)
+	uint32_t dirSectors;					// ディレクトリのセクタ数
+	uint32_t winReads;						// 窓(FAT/ディレクトリ)の読込セクタ数
+	uint32_t winWrites;						// 窓の書戻しセクタ数
+	uint32_t dataReads;						// データ読込セクタ数
+	uint32_t dataWrites;					// データ書込セクタ数
+	uint32_t diskErrors;					// disk_read/disk_writeの失敗数
+} LogFsStats;
+
+int logfs_Format(LogFsType type, uint32_t firstSector, uint32_t sectors);
+void logfs_Release(void);
+int logfs_Create(const char *name, LogFile *file);
+int logfs_Open(const char *name, int append, LogFile *file);
+void logfs_Mount(void);
+FILE *logfs_Fopen(const char *name, const char *mode);
+int logfs_Append(LogFile *file, const void *data, uint32_t length);
+int logfs_Sync(LogFile *file);
+int logfs_Expand(LogFile *file, uint32_t bytes);
+int logfs_Stretch(LogFile *file, uint32_t size);
+int logfs_Close(LogFile *file);
+const char *logfs_SectorRegion(uint32_t sector);
+int logfs_Read(const LogFile *file, uint32_t offset, uint8_t *buff);
+int logfs_Delete(const char *name);
+uint32_t logfs_GetSize(const char *name);
+void logfs_GetStats(LogFsStats *stats);
+
+#endif
@@ -0,0 +1,594 @@
+//======================================================================
+//! @file   longrun_main.c
+//! @brief  ロガー全体の長期試験(ホスト模擬, 仮想時計)
+//! @note	使い方: longrun [--days N] [--interval-s N] [--batch N] [--session-hours N] [--session-min N]
+//! 		        [--poll-s N] [--report-hours N] [--card-mb N] [--seed N] [--rtc-ppm N]
+//! 		ファームウェアのモジュール(sleeplog, rtctime, http, hottail, sd.c)をそのまま動かし、
+//! 		電池駆動の運用を仮想時計で繰り返す.
+//! 		  起動: main.cのapp_main()と同じ順(時刻の復元→起床の判定→初期化→書出し→直近値の読込)
+//! 		  間欠記録: esp_deep_sleep()の要求どおりに起床させる(ADCは乱歩, --rtc-ppmでRTCが遅れる)
+//! 		  操作: --session-hoursごとにリセットボタンで起こし、SNTP同期(期限のときだけ)の後、
+//! 		        ブラウザでグラフを開いて--poll-sごとに/data.binと/statusを--session-min分取る.
+//! 		        終わったら間欠記録を始め直す
+//! 		SDカード上のファイルシステムはlogfs.c(FatFsと同じセクタアクセスをするモデル)で、
+//! 		ファームウェアのfopen("/sd/...")はsim_VfsSetOpen()でlogfs_Fopen()へつなぐ.
+//! 		set_Initialize()は作り直せないもの(タスク, ドライブ登録)があるので電源投入時だけ呼び、
+//! 		2回目以降の起動ではRAMを失うもの(マウント, 直近値キャッシュ)だけ初期化し直す.
+//! 		Wi-Fiは接続時間と送信速度で時間だけ進め、HTTPの送信は記録する.
+//! 		報告間隔ごとに1行、最後に全体を1行のJSONで標準出力へ出す.
+//! 		最後に書込回数の多いセクタ(模擬SDカードの正確な値と、ドライバの推定値)も出す.
+//======================================================================
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "diskio.h"
+#include "esp_log.h"
+
+#include "global.h"
+#include "setup.h"
+#include "hottail.h"
+#include "http.h"
+#include "pool.h"
+#include "rtctime.h"
+#include "sd.h"
+#include "sleeplog.h"
+#include "sim.h"
+#include "logfs.h"
+
+//----- 定義 -----
+#define VOLUME_SECTOR		8192			// ボリューム先頭(4MiB境界)
+#define START_TIME			1767225600		// 2026-01-01 00:00:00 UTC
+#define NS_PER_S			1000000000ULL
+#define HOT_SECTORS			5				// 出力する書込回数上位のセクタ数
+#define WIFI_CONNECT_NS		(3 * NS_PER_S)	// 起動からWi-Fi接続まで
+#define WIFI_BYTES_PER_S	100000			// 送信速度
+#define MAX_SOCKETS			8				// ソケット番号(1〜MAX_SOCKETS-1を順に使う)
+#define REQUEST_SIZE		128
+
+typedef struct
+{
+	uint32_t *values;
+	uint32_t count;
+	uint32_t capacity;
+	int sorted;
+} Series;
+
+// 集計(報告間隔ごとにクリア)
+typedef struct
+{
+	uint32_t samples;						// サンプルを取った起床
+	uint32_t flushWakes;					// 書出し起床
+	uint32_t sessions;						// 操作(リセットボタン)
+	uint32_t syncs;							// SNTP同期
+	uint32_t requests;
+	uint32_t connections;
+	uint64_t responseBytes;
+	uint32_t httpErrors;					// 200以外/応答なし
+	uint32_t hotHits;						// 直近値キャッシュ(RAMだけ)
+	uint32_t hotMerged;						// 直近値キャッシュ(SDとRAM)
+	uint32_t hotMisses;						// 直近値キャッシュ(SDだけ)
+	uint32_t errors;						// 書出し・マウント・読込の失敗
+	Series flushUs;							// 書出し起床(起動〜スリープ要求)
+	Series bootUs;							// 操作の起動(起動〜直近値の読込)
+	Series responseUs;						// 応答(受信〜最後の送信)
+	Series timeErrorMs;						// 書出し起床での時刻のずれ(推定と真の時刻の差)
+} Interval;
+
+//----- 定数 -----
+static const char logName[] = "sleeplog.csv";	// SLEEPLOG_FILEのボリューム内の名前
+
+//----- 変数 -----
+static Interval s_interval;
+static Interval s_total;
+static uint32_t s_random;
+static uint64_t s_startNs;
+static int s_socket;						// 使用中のソケット番号
+static HttpConnection *s_conn;				// 使用中の接続 NULL=切断
+static char s_responseHead[16];				// 応答の先頭
+static uint64_t s_responseBytes;			// 応答のバイト数
+
+//----------------------------------------------------------------------
+//! @brief  値を追加
+//----------------------------------------------------------------------
+static void AddValue(Series *series, uint64_t value)
+{
+	if(series->count == series->capacity)
+	{
+		series->capacity = (series->capacity == 0) ? 1024 : series->capacity * 2;
+		series->values = realloc(series->values, series->capacity * sizeof(uint32_t));
+	}
+	series->values[series->count++] = (value > UINT32_MAX) ? UINT32_MAX : (uint32_t)value;
+	series->sorted = 0;
+}
+
+static int CompareU32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+	return (x > y) - (x < y);
+}
+
+//----------------------------------------------------------------------
+//! @brief  パーセンタイル
+//----------------------------------------------------------------------
+static uint32_t Percentile(Series *series, uint32_t permille)
+{
+	if(series->count == 0)
+	{
+		return 0;
+	}
+	if(!series->sorted)
+	{
+		qsort(series->values, series->count, sizeof(uint32_t), CompareU32);
+		series->sorted = 1;
+	}
+	return series->values[(uint64_t)(series->count - 1) * permille / 1000];
+}
+
+//----------------------------------------------------------------------
+//! @brief  集計をクリア(確保済みの領域は使い回す)
+//----------------------------------------------------------------------
+static void ClearInterval(Interval *interval)
+{
+	Series *series[] = {&interval->flushUs, &interval->bootUs, &interval->responseUs, &interval->timeErrorMs};
+	Series saved[sizeof(series) / sizeof(series[0])];
+
+	for(size_t i = 0; i < sizeof(series) / sizeof(series[0]); i++)
+	{
+		saved[i] = *series[i];
+		saved[i].count = 0;
+	}
+	memset(interval, 0, sizeof(*interval));
+	for(size_t i = 0; i < sizeof(series) / sizeof(series[0]); i++)
+	{
+		*series[i] = saved[i];
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  報告間隔と全体の両方へ追加
+//----------------------------------------------------------------------
+#define ADD_VALUE(member, value)	do { AddValue(&s_interval.member, value); AddValue(&s_total.member, value); } while(0)
+#define ADD_COUNT(member, value)	do { s_interval.member += (value); s_total.member += (value); } while(0)
+
+//----------------------------------------------------------------------
+//! @brief  乱数(xorshift32)
+//----------------------------------------------------------------------
+static uint32_t Random(void)
+{
+	s_random ^= s_random << 13;
+	s_random ^= s_random >> 17;
+	s_random ^= s_random << 5;
+	return s_random;
+}
+
+//----------------------------------------------------------------------
+//! @brief  真の時刻(SNTPとブラウザの時計)[us]
+//----------------------------------------------------------------------
+static int64_t TrueTimeUs(void)
+{
+	return (int64_t)START_TIME * 1000000 + (int64_t)((sim_GetTimeNs() - s_startNs) / 1000);
+}
+
+//----------------------------------------------------------------------
+//! @brief  パーティションテーブル(FAT32 LBA 1つ)
+//----------------------------------------------------------------------
+static int WritePartitionTable(uint32_t sectors)
+{
+	uint8_t mbr[LOGFS_SECTOR_SIZE];
+	uint32_t first = VOLUME_SECTOR;
+	uint32_t count = sectors - VOLUME_SECTOR;
+
+	memset(mbr, 0, sizeof(mbr));
+	mbr[446 + 4] = 0x0c;
+	memcpy(&mbr[446 + 8], &first, 4);
+	memcpy(&mbr[446 + 12], &count, 4);
+	mbr[510] = 0x55;
+	mbr[511] = 0xaa;
+	return (disk_write(0, mbr, 0, 1) == RES_OK) ? RET_OK : RET_NG;
+}
+
+//----------------------------------------------------------------------
+//! @brief  起動(app_main()と同じ順)
+//! @return	起床の種類
+//! @note	サンプル起床はSPIを使わずに眠り、書出し起床は書出して眠る.それ以外は直近値を読んで戻る.
+//----------------------------------------------------------------------
+static SleepLogWake Boot(void)
+{
+	rtctime_Restore();
+	SleepLogWake wake = sleeplog_Wake();
+	if(wake == SleepLog_Sleep)
+	{
+		sleeplog_Sleep();
+		return wake;
+	}
+
+	logfs_Mount();
+	hottail_Initialize();
+	if(sd_Mount() != RET_OK)
+	{
+		ADD_COUNT(errors, 1);
+	}
+	if(wake != SleepLog_Off)
+	{
+		if(sleeplog_Flush(SLEEPLOG_FILE) != RET_OK)
+		{
+			ADD_COUNT(errors, 1);
+		}
+		if(wake == SleepLog_Flush)
+		{
+			sleeplog_Sleep();
+			return wake;
+		}
+		sleeplog_Stop();
+	}
+	if(hottail_Load(SLEEPLOG_FILE) != RET_OK)
+	{
+		ADD_COUNT(errors, 1);
+	}
+	return wake;
+}
+
+//----------------------------------------------------------------------
+//! @brief  送信(送信速度の分だけ時間を進め、応答の先頭と長さを記録)
+//----------------------------------------------------------------------
+static int WifiSend(int socket, const void *data, size_t length)
+{
+	size_t used = strlen(s_responseHead);
+	if(used < sizeof(s_responseHead) - 1)
+	{
+		size_t n = sizeof(s_responseHead) - 1 - used;
+		n = (n < length) ? n : length;
+		memcpy(&s_responseHead[used], data, n);
+		s_responseHead[used + n] = '\0';
+	}
+	s_responseBytes += length;
+	sim_AdvanceNs((uint64_t)length * NS_PER_S / WIFI_BYTES_PER_S);
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  切断
+//----------------------------------------------------------------------
+static void WifiClose(int socket)
+{
+	if(socket == s_socket)
+	{
+		s_conn = NULL;
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  ブラウザからのGET(切断されていればつなぎ直す)
+//----------------------------------------------------------------------
+static void Request(const char *path)
+{
+	char request[REQUEST_SIZE];
+	uint8_t *buffer;
+
+	http_Service((int64_t)(sim_GetTimeNs() / 1000));		// 無通信の接続を閉じる
+	int64_t nowUs = (int64_t)(sim_GetTimeNs() / 1000);
+	if(s_conn == NULL)
+	{
+		s_socket = s_socket % (MAX_SOCKETS - 1) + 1;
+		s_conn = http_Accept(s_socket, nowUs);
+		ADD_COUNT(connections, 1);
+	}
+	int length = snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nHost: esp8266\r\n\r\n", path);
+	if(s_conn == NULL || http_GetRxSpace(s_conn, &buffer) < (size_t)length)
+	{
+		ADD_COUNT(httpErrors, 1);
+		return;
+	}
+	memcpy(buffer, request, length);
+	http_Received(s_conn, length, nowUs);
+
+	s_responseHead[0] = '\0';
+	s_responseBytes = 0;
+	uint64_t start = sim_GetTimeNs();
+	http_Service(nowUs);
+	ADD_VALUE(responseUs, (sim_GetTimeNs() - start) / 1000);
+	ADD_COUNT(requests, 1);
+	ADD_COUNT(responseBytes, s_responseBytes);
+	if(strncmp(s_responseHead, "HTTP/1.1 200", 12) != 0)
+	{
+		ADD_COUNT(httpErrors, 1);
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  操作(Wi-Fi接続, SNTP同期, ブラウザでグラフを見る)
+//----------------------------------------------------------------------
+static void Session(uint32_t minutes, uint32_t pollS)
+{
+	static const HttpIo io = {WifiSend, WifiClose};
+	char path[HTTP_PATH_SIZE];
+	HotTailStats hot;
+
+	sim_AdvanceNs(WIFI_CONNECT_NS);
+	if(rtctime_IsSyncDue())
+	{
+		rtctime_Sync(TrueTimeUs());
+		ADD_COUNT(syncs, 1);
+	}
+	http_Initialize(&io);
+	s_conn = NULL;
+
+	// ページを開く: 案内ページ, 48時間の集計, 直近1時間の記録値
+	const uint64_t endNs = sim_GetTimeNs() + (uint64_t)minutes * 60 * NS_PER_S;
+	uint32_t nowS = (uint32_t)(TrueTimeUs() / 1000000);
+	Request("/");
+	snprintf(path, sizeof(path), "/rollup.json?from=%u", nowS - 48 * 3600);
+	Request(path);
+	snprintf(path, sizeof(path), "/data.bin?from=%u", nowS - 3600);
+	Request(path);
+
+	// 表示したまま更新する
+	for(uint64_t next = sim_GetTimeNs() + (uint64_t)pollS * NS_PER_S; next < endNs; next += (uint64_t)pollS * NS_PER_S)
+	{
+		if(next > sim_GetTimeNs())
+		{
+			sim_AdvanceNs(next - sim_GetTimeNs());
+		}
+		snprintf(path, sizeof(path), "/data.bin?from=%u", (uint32_t)(TrueTimeUs() / 1000000) - 3600);
+		Request(path);
+		Request("/status");
+	}
+
+	for(int type = 0; type < HotTail_QueryTypes; type++)
+	{
+		hottail_GetStats((HotTailQuery)type, &hot);
+		ADD_COUNT(hotHits, hot.hits);
+		ADD_COUNT(hotMerged, hot.merged);
+		ADD_COUNT(hotMisses, hot.misses);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t days = 30;
+	uint32_t intervalS = 60;
+	uint32_t batch = 60;
+	uint32_t sessionHours = 24;
+	uint32_t sessionMin = 10;
+	uint32_t pollS = 10;
+	uint32_t reportHours = 24;
+	uint32_t cardMb = 64;
+	uint32_t seed = 1;
+	uint32_t rtcPpm = 0;
+	const struct
+	{
+		const char *name;
+		uint32_t *value;
+		uint32_t minimum;
+		uint32_t maximum;
+	} options[] =
+	{
+		{"--days", &days, 1, 3650},
+		{"--interval-s", &intervalS, 1, 86400},
+		{"--batch", &batch, 1, SLEEPLOG_BATCH_MAX},
+		{"--session-hours", &sessionHours, 1, 24 * 365},
+		{"--session-min", &sessionMin, 1, 24 * 60},
+		{"--poll-s", &pollS, 1, 3600},
+		{"--report-hours", &reportHours, 1, 24 * 3650},
+		{"--card-mb", &cardMb, 8, 32768},
+		{"--seed", &seed, 0, UINT32_MAX},
+		{"--rtc-ppm", &rtcPpm, 0, 100000},
+	};
+
+	for(int i = 1; i < argc; i += 2)
+	{
+		int index = -1;
+		for(size_t j = 0; j < sizeof(options) / sizeof(options[0]); j++)
+		{
+			if(strcmp(argv[i], options[j].name) == 0)
+			{
+				index = (int)j;
+			}
+		}
+		if(i + 1 >= argc || index < 0
+		|| (*options[index].value = (uint32_t)strtoul(argv[i + 1], NULL, 10)) < options[index].minimum
+		|| *options[index].value > options[index].maximum)
+		{
+			fprintf(stderr, "usage: longrun [--days N] [--interval-s N] [--batch N] [--session-hours N] [--session-min N] [--poll-s N] [--report-hours N] [--card-mb N] [--seed N] [--rtc-ppm N]\n");
+			return 2;
+		}
+	}
+
+	//----- 電源投入とカードの準備 -----
+	esp_log_level_set("*", ESP_LOG_NONE);
+	sim_Reset();
+	SimSdConfig card;
+	sim_SdDefaultConfig(&card);
+	card.sectors = cardMb * 2048;
+	sim_SdInsert(&card);
+	pool_Initialize();
+	set_Initialize();					// 未フォーマットなのでマウントは失敗する
+	if(disk_status(0) != 0 || WritePartitionTable(card.sectors) != RET_OK
+	|| logfs_Format(LogFs_Fat32, VOLUME_SECTOR, card.sectors - VOLUME_SECTOR) != RET_OK)
+	{
+		fprintf(stderr, "longrun: card not initialized\n");
+		return 1;
+	}
+	sim_VfsSetOpen(logfs_Fopen);
+	s_random = (seed == 0) ? 1 : seed;
+	ClearInterval(&s_interval);
+	ClearInterval(&s_total);
+
+	//----- 実行 -----
+	struct timespec wallStart, wallEnd;
+	clock_gettime(CLOCK_MONOTONIC, &wallStart);
+	s_startNs = sim_GetTimeNs();
+	const uint64_t endNs = s_startNs + (uint64_t)days * 86400 * NS_PER_S;
+	const uint64_t reportNs = (uint64_t)reportHours * 3600 * NS_PER_S;
+	uint64_t nextSessionNs = s_startNs;
+	uint64_t nextReportNs = s_startNs + reportNs;
+	uint32_t dropped = 0;
+	int32_t adc = 512;
+	SimSdStats sdStart;
+	SimHeapStats heapStart;
+	SleepLogReport report;
+
+	sd_ClearWear();
+	sim_SdGetStats(&sdStart);
+	const SimSdStats sdRunStart = sdStart;
+	sim_GetHeapStats(&heapStart);
+	while(sim_GetTimeNs() < endNs)
+	{
+		uint64_t sleepUs;
+		uint64_t now = sim_GetTimeNs();
+		uint64_t wakeNs = UINT64_MAX;
+		if(sim_DeepSleepRequested(&sleepUs, NULL))
+		{
+			uint64_t oversleepNs = sleepUs * rtcPpm / 1000;
+			wakeNs = now + sleepUs * 1000 + oversleepNs + BOOT_TIME_US * 1000ULL;
+		}
+
+		if(nextSessionNs <= wakeNs)
+		{
+			//----- 操作 -----
+			if(nextSessionNs > now)
+			{
+				sim_AdvanceNs(nextSessionNs - now);
+			}
+			sim_ResetButton();
+			uint64_t start = sim_GetTimeNs();
+			if(Boot() == SleepLog_Stopped && sleeplog_GetReport(&report) == RET_OK)
+			{
+				dropped += report.dropped;
+			}
+			ADD_VALUE(bootUs, (sim_GetTimeNs() - start) / 1000);
+			ADD_COUNT(sessions, 1);
+			Session(sessionMin, pollS);
+			if(sleeplog_Start(intervalS * 1000, batch) != RET_OK)
+			{
+				ADD_COUNT(errors, 1);
+				break;
+			}
+			sleeplog_Sleep();
+			nextSessionNs += (uint64_t)sessionHours * 3600 * NS_PER_S;
+		}
+		else
+		{
+			//----- 間欠記録の起床 -----
+			sim_AdvanceNs(wakeNs - now - sleepUs * 1000);		// RTCの遅れと起動時間(スリープ時間はsim_DeepSleepWake()が進める)
+			sim_DeepSleepWake();
+			adc += (int32_t)(Random() % 21) - 10;
+			adc = (adc < 0) ? 0 : (adc > 1023) ? 1023 : adc;
+			sim_SetAdc((uint16_t)adc);
+			uint64_t start = sim_GetTimeNs();
+			SleepLogWake wake = Boot();
+			ADD_COUNT(samples, 1);
+			if(wake == SleepLog_Flush)
+			{
+				int64_t estimateUs;
+				ADD_VALUE(flushUs, (sim_GetTimeNs() - start) / 1000);
+				ADD_COUNT(flushWakes, 1);
+				if(rtctime_GetTime(&estimateUs) == RET_OK)
+				{
+					int64_t errorUs = estimateUs - TrueTimeUs();
+					ADD_VALUE(timeErrorMs, (uint64_t)((errorUs < 0) ? -errorUs : errorUs) / 1000);
+				}
+			}
+			else if(wake != SleepLog_Sleep)
+			{
+				ADD_COUNT(errors, 1);							// 記録モードが途切れた
+				sleeplog_Start(intervalS * 1000, batch);
+				sleeplog_Sleep();
+			}
+		}
+
+		while(nextReportNs <= sim_GetTimeNs())
+		{
+			//----- 報告 -----
+			SimSdStats sd;
+			SimHeapStats heap;
+			LogFsStats fs;
+			PoolStats pool;
+			sim_SdGetStats(&sd);
+			sim_GetHeapStats(&heap);
+			logfs_GetStats(&fs);
+			pool_GetStats(&pool);
+			printf("{\"longrun\":\"interval\",\"sim_hours\":%llu,\"samples\":%u,\"flush_wakes\":%u,"
+				"\"flush_us_p50\":%u,\"flush_us_p99\":%u,\"flush_us_max\":%u,\"time_error_ms_max\":%u,"
+				"\"sessions\":%u,\"boot_us_max\":%u,\"requests\":%u,\"connections\":%u,"
+				"\"response_us_p50\":%u,\"response_us_p99\":%u,\"response_us_max\":%u,\"response_bytes\":%llu,\"http_errors\":%u,"
+				"\"hottail_hits\":%u,\"hottail_merged\":%u,\"hottail_misses\":%u,\"file_bytes\":%u,\"fragments\":%u,"
+				"\"sd_sectors_written\":%u,\"sd_sectors_read\":%u,"
+				"\"heap_in_use\":%lld,\"heap_peak\":%lld,\"heap_allocs\":%u,\"pool_fallbacks\":%u,\"errors\":%u}\n",
+				(unsigned long long)((nextReportNs - s_startNs) / NS_PER_S / 3600), s_interval.samples, s_interval.flushWakes,
+				Percentile(&s_interval.flushUs, 500), Percentile(&s_interval.flushUs, 990), Percentile(&s_interval.flushUs, 1000),
+				Percentile(&s_interval.timeErrorMs, 1000),
+				s_interval.sessions, Percentile(&s_interval.bootUs, 1000), s_interval.requests, s_interval.connections,
+				Percentile(&s_interval.responseUs, 500), Percentile(&s_interval.responseUs, 990), Percentile(&s_interval.responseUs, 1000),
+				(unsigned long long)s_interval.responseBytes, s_interval.httpErrors,
+				s_interval.hotHits, s_interval.hotMerged, s_interval.hotMisses, logfs_GetSize(logName), fs.fragments,
+				sd.sectorsWritten - sdStart.sectorsWritten, sd.sectorsRead - sdStart.sectorsRead,
+				(long long)heap.inUseBytes, (long long)heap.peakInUseBytes, heap.allocCount - heapStart.allocCount, pool.fallbackCount,
+				s_interval.errors + fs.diskErrors);
+			fflush(stdout);
+			sdStart = sd;
+			heapStart = heap;
+			ClearInterval(&s_interval);
+			nextReportNs += reportNs;
+		}
+	}
+
+	//----- 結果 -----
+	clock_gettime(CLOCK_MONOTONIC, &wallEnd);
+	uint64_t wallMs = (uint64_t)(wallEnd.tv_sec - wallStart.tv_sec) * 1000 + (wallEnd.tv_nsec - wallStart.tv_nsec) / 1000000;
+	SimHeapStats heap;
+	LogFsStats fs;
+	RtcTimeStatus time;
+	sim_GetHeapStats(&heap);
+	logfs_GetStats(&fs);
+	rtctime_GetStatus(&time);
+	sleeplog_GetReport(&report);
+	dropped += report.dropped;
+	const uint32_t fileBytes = logfs_GetSize(logName);
+	printf("{\"longrun\":\"total\",\"sim_days\":%llu,\"interval_s\":%u,\"batch\":%u,\"card_mb\":%u,\"seed\":%u,\"rtc_ppm\":%u,"
+		"\"wall_ms\":%llu,\"speedup\":%llu,\"samples\":%u,\"dropped\":%u,\"flush_wakes\":%u,"
+		"\"flush_us_p50\":%u,\"flush_us_p99\":%u,\"flush_us_max\":%u,\"sessions\":%u,\"boot_us_max\":%u,"
+		"\"syncs\":%u,\"sleep_ppm\":%d,\"sync_interval_s\":%u,\"time_error_ms_max\":%u,"
+		"\"requests\":%u,\"response_us_p50\":%u,\"response_us_p99\":%u,\"response_us_max\":%u,\"http_errors\":%u,"
+		"\"hottail_hits\":%u,\"hottail_merged\":%u,\"hottail_misses\":%u,\"file_bytes\":%u,\"fragments\":%u,"
+		"\"win_reads\":%u,\"win_writes\":%u,\"average_ua\":%u,\"battery_hours\":%u,\"heap_peak\":%lld,\"errors\":%u}\n",
+		(unsigned long long)days, intervalS, batch, cardMb, seed, rtcPpm, (unsigned long long)wallMs,
+		(unsigned long long)((wallMs > 0) ? (uint64_t)days * 86400 * 1000 / wallMs : 0),
+		s_total.samples, dropped, s_total.flushWakes,
+		Percentile(&s_total.flushUs, 500), Percentile(&s_total.flushUs, 990), Percentile(&s_total.flushUs, 1000),
+		s_total.sessions, Percentile(&s_total.bootUs, 1000),
+		s_total.syncs, (int)time.sleepPpm, time.syncIntervalS, Percentile(&s_total.timeErrorMs, 1000),
+		s_total.requests, Percentile(&s_total.responseUs, 500), Percentile(&s_total.responseUs, 990), Percentile(&s_total.responseUs, 1000),
+		s_total.httpErrors, s_total.hotHits, s_total.hotMerged, s_total.hotMisses, fileBytes, fs.fragments,
+		fs.winReads, fs.winWrites, report.averageUa, report.batteryHours, (long long)heap.peakInUseBytes,
+		s_total.errors + fs.diskErrors);
+
+	//----- 書込回数 -----
+	SimSdStats sd;
+	SimSdHotSector hot[HOT_SECTORS];
+	SdWear wear;
+	sim_SdGetStats(&sd);
+	int hotCount = sim_SdGetHotSectors(hot, HOT_SECTORS);
+	sd_GetWear(&wear);
+	uint32_t sectorsWritten = sd.sectorsWritten - sdRunStart.sectorsWritten;
+	printf("{\"longrun\":\"wear\",\"sectors_written\":%u,\"write_amplification_x100\":%llu,\"hot\":[",
+		sectorsWritten, (unsigned long long)((fileBytes > 0) ? (uint64_t)sectorsWritten * LOGFS_SECTOR_SIZE * 100 / fileBytes : 0));
+	for(int i = 0; i < hotCount; i++)
+	{
+		printf("%s{\"sector\":%u,\"region\":\"%s\",\"writes\":%u}", (i == 0) ? "" : ",",
+			hot[i].sector, logfs_SectorRegion(hot[i].sector), hot[i].writes);
+	}
+	printf("],\"hot_estimate\":[");
+	for(int i = 0; i < HOT_SECTORS && wear.hot[i].count != 0; i++)
+	{
+		printf("%s{\"sector\":%u,\"writes\":%u,\"error\":%u}", (i == 0) ? "" : ",",
+			wear.hot[i].sector, wear.hot[i].count, wear.hot[i].error);
+	}
+	printf("]}\n");
+
+	logfs_Release();
+	return (s_total.errors + fs.diskErrors == 0 && s_total.httpErrors == 0) ? 0 : 1;
+}
@@ -0,0 +1,263 @@
+//======================================================================
+//! @file   soak_main.c
+//! @brief  SDカード障害下の耐久試験(ホスト模擬)
+//! @note	使い方: soak [--seconds N] [--seed N] [--profile none|gc|harsh]
+//! 		        [--period-ms N] [--ring N] [--sample-bytes N]
+//! 		ロガーを次のようにモデル化し、仮想時計で指定時間動かす.
+//! 		  測定タスク: 周期ごとに1サンプルをRAMリングへ入れる(バスを使わない)
+//! 		  書込タスク: 1セクタ分たまったらdisk_write()で書く.失敗したら次の機会に再試行
+//! 		  表示タスク: 周期ごとにlcd_Update()(SDとバスを共用)
+//! 		模擬環境は単一スレッドなので、SD書込中に来た測定/表示の周期は書込後にまとめて処理する.
+//! 		リングがあふれたサンプルを欠損、表示更新の間隔が2周期を超えたものを表示停止として数える.
+//! 		結果は1行のJSONで標準出力へ出す.
+//======================================================================
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "diskio.h"
+#include "esp_log.h"
+
+#include "setup.h"
+#include "lcd.h"
+#include "sim.h"
+
+//----- 定義 -----
+#define SECTOR_SIZE		512
+#define FIRST_SECTOR	1024			// ログ領域の先頭セクタ
+
+typedef struct
+{
+	const char *name;					// プロファイル名
+	SimSdFaults faults;					// 障害設定(seedは--seedで上書き)
+} Profile;
+
+//----- 定数 -----
+static const BYTE pdrv = 0;
+static const Profile profiles[] =
+{
+	// seed, writeStall ppm/min/max, readStall ppm/min/max, crc, timeout
+	{"none",  {0, 0, 0, 0, 0, 0, 0, 0, 0}},
+	{"gc",    {0, 20000, 50000, 300000, 0, 0, 0, 100, 100}},		// 2%で50〜300msのGC
+	{"harsh", {0, 50000, 100000, 800000, 0, 0, 0, 2000, 1000}},		// タイムアウト(500ms)を超えるGCあり
+};
+
+//----- 変数 -----
+static uint32_t *s_latencies;			// 書込時間[us]
+static uint32_t s_latencyCount;
+static uint32_t s_latencyCapacity;
+
+//----------------------------------------------------------------------
+//! @brief  書込時間を記録
+//----------------------------------------------------------------------
+static void AddLatency(uint32_t us)
+{
+	if(s_latencyCount == s_latencyCapacity)
+	{
+		s_latencyCapacity = (s_latencyCapacity == 0) ? 1024 : s_latencyCapacity * 2;
+		s_latencies = realloc(s_latencies, s_latencyCapacity * sizeof(uint32_t));
+	}
+	s_latencies[s_latencyCount++] = us;
+}
+
+static int CompareU32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+	return (x > y) - (x < y);
+}
+
+//----------------------------------------------------------------------
+//! @brief  パーセンタイル(記録をソート済みであること)
+//----------------------------------------------------------------------
+static uint32_t Percentile(uint32_t permille)
+{
+	if(s_latencyCount == 0)
+	{
+		return 0;
+	}
+	return s_latencies[(uint64_t)(s_latencyCount - 1) * permille / 1000];
+}
+
+int main(int argc, char *argv[])
+{
+	uint64_t seconds = 3600;
+	uint32_t seed = 1;
+	uint32_t periodMs = 100;
+	uint32_t ringCapacity = 64;
+	uint32_t sampleBytes = 32;
+	const Profile *profile = &profiles[1];
+
+	for(int i = 1; i < argc; i++)
+	{
+		const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+		if(value != NULL && strcmp(argv[i], "--seconds") == 0)
+		{
+			seconds = strtoull(value, NULL, 10);
+		}
+		else if(value != NULL && strcmp(argv[i], "--seed") == 0)
+		{
+			seed = (uint32_t)strtoul(value, NULL, 10);
+		}
+		else if(value != NULL && strcmp(argv[i], "--period-ms") == 0)
+		{
+			periodMs = (uint32_t)strtoul(value, NULL, 10);
+		}
+		else if(value != NULL && strcmp(argv[i], "--ring") == 0)
+		{
+			ringCapacity = (uint32_t)strtoul(value, NULL, 10);
+		}
+		else if(value != NULL && strcmp(argv[i], "--sample-bytes") == 0)
+		{
+			sampleBytes = (uint32_t)strtoul(value, NULL, 10);
+		}
+		else if(value != NULL && strcmp(argv[i], "--profile") == 0)
+		{
+			profile = NULL;
+			for(size_t p = 0; p < sizeof(profiles) / sizeof(profiles[0]); p++)
+			{
+				if(strcmp(value, profiles[p].name) == 0)
+				{
+					profile = &profiles[p];
+				}
+			}
+		}
+		else
+		{
+			profile = NULL;
+		}
+		if(profile == NULL || periodMs == 0 || sampleBytes == 0 || sampleBytes > SECTOR_SIZE)
+		{
+			fprintf(stderr, "usage: soak [--seconds N] [--seed N] [--profile none|gc|harsh] [--period-ms N] [--ring N] [--sample-bytes N]\n");
+			return 2;
+		}
+		i++;
+	}
+
+	const uint32_t samplesPerSector = SECTOR_SIZE / sampleBytes;
+	const uint64_t periodNs = (uint64_t)periodMs * 1000000;
+	if(ringCapacity < samplesPerSector)
+	{
+		ringCapacity = samplesPerSector;
+	}
+
+	//----- 初期化 -----
+	esp_log_level_set("*", ESP_LOG_NONE);
+	sim_Reset();
+	set_Initialize();
+	if(disk_status(pdrv) != 0)
+	{
+		fprintf(stderr, "soak: card not initialized\n");
+		return 1;
+	}
+	SimSdFaults faults = profile->faults;
+	faults.seed = seed;
+	sim_SdSetFaults(&faults);
+
+	//----- 実行 -----
+	uint8_t sector[SECTOR_SIZE];
+	const uint64_t startNs = sim_GetTimeNs();
+	const uint64_t endNs = startNs + seconds * 1000000000ULL;
+	uint64_t nextSampleNs = startNs + periodNs;
+	uint64_t nextLcdNs = startNs + periodNs;
+	uint64_t lastLcdNs = startNs;
+	uint64_t maxFreezeNs = 0;
+	uint32_t freezeCount = 0;
+	uint32_t ring = 0, ringPeak = 0;
+	uint64_t samples = 0, lost = 0, written = 0;
+	uint32_t writeErrors = 0;
+	uint32_t nextSector = FIRST_SECTOR;
+	SimSdConfig card;
+	sim_SdDefaultConfig(&card);
+
+	memset(sector, 0x5a, sizeof(sector));
+	while(sim_GetTimeNs() < endNs)
+	{
+		uint64_t now = sim_GetTimeNs();
+
+		// 測定タスク
+		for(; nextSampleNs <= now; nextSampleNs += periodNs)
+		{
+			samples++;
+			if(ring < ringCapacity)
+			{
+				ring++;
+				if(ring > ringPeak)
+				{
+					ringPeak = ring;
+				}
+			}
+			else
+			{
+				lost++;
+			}
+		}
+
+		// 表示タスク(遅れた周期は1回の更新にまとめる)
+		if(nextLcdNs <= now)
+		{
+			lcd_Update();
+			now = sim_GetTimeNs();
+			if(now - lastLcdNs > 2 * periodNs)
+			{
+				freezeCount++;
+			}
+			if(now - lastLcdNs > maxFreezeNs)
+			{
+				maxFreezeNs = now - lastLcdNs;
+			}
+			lastLcdNs = now;
+			while(nextLcdNs <= now)
+			{
+				nextLcdNs += periodNs;
+			}
+			continue;
+		}
+
+		// 書込タスク
+		if(ring >= samplesPerSector)
+		{
+			uint64_t writeStart = sim_GetTimeNs();
+			DRESULT res = disk_write(pdrv, sector, nextSector, 1);
+			AddLatency((uint32_t)((sim_GetTimeNs() - writeStart) / 1000));
+			if(res == RES_OK)
+			{
+				ring -= samplesPerSector;
+				written += samplesPerSector;
+				nextSector = (nextSector + 1 < card.sectors) ? nextSector + 1 : FIRST_SECTOR;
+			}
+			else
+			{
+				writeErrors++;
+			}
+			if(res == RES_OK || sim_GetTimeNs() >= nextSampleNs)
+			{
+				continue;
+			}
+		}
+
+		// 次の周期まで待つ
+		uint64_t wakeNs = (nextSampleNs < nextLcdNs) ? nextSampleNs : nextLcdNs;
+		if(wakeNs > now)
+		{
+			sim_AdvanceNs(wakeNs - now);
+		}
+	}
+
+	//----- 結果 -----
+	SimSdStats sdStats;
+	sim_SdGetStats(&sdStats);
+	qsort(s_latencies, s_latencyCount, sizeof(uint32_t), CompareU32);
+	printf("{\"soak\":\"%s\",\"seed\":%u,\"sim_seconds\":%llu,\"period_ms\":%u,\"ring\":%u,"
+		"\"samples\":%llu,\"written\":%llu,\"lost\":%llu,\"ring_peak\":%u,"
+		"\"writes\":%u,\"write_errors\":%u,\"write_us_p50\":%u,\"write_us_p99\":%u,\"write_us_max\":%u,"
+		"\"lcd_freezes\":%u,\"lcd_freeze_ms_max\":%llu,"
+		"\"injected_stalls\":%u,\"injected_stall_ms\":%llu,\"injected_crc_errors\":%u,\"injected_timeouts\":%u}\n",
+		profile->name, seed, (unsigned long long)seconds, periodMs, ringCapacity,
+		(unsigned long long)samples, (unsigned long long)written, (unsigned long long)lost, ringPeak,
+		s_latencyCount, writeErrors, Percentile(500), Percentile(990), Percentile(1000),
+		freezeCount, (unsigned long long)(maxFreezeNs / 1000000),
+		sdStats.injectedStalls, (unsigned long long)(sdStats.injectedStallNs / 1000000), sdStats.injectedCrcErrors, sdStats.injectedTimeouts);
+	free(s_latencies);
+	return 0;
+}
@@ -0,0 +1,69 @@
+//======================================================================
+//! @file   test.h
+//! @brief  ホスト単体テスト
+//======================================================================
+#ifndef _TEST_H_
+#define _TEST_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct
+{
+	const char *name;			// テスト名
+	void (*function)(void);		// テスト関数
+} TestCase;
+
+void test_Fail(const char *file, int line, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+// 失敗したらテスト関数から抜ける
+#define TEST_ASSERT(cond)																\
+	do																					\
+	{																					\
+		if(!(cond))																		\
+		{																				\
+			test_Fail(__FILE__, __LINE__, "%s", #cond);									\
+			return;																		\
+		}																				\
+	} while(0)
+
+#define TEST_ASSERT_EQUAL_INT(expected, actual)											\
+	do																					\
+	{																					\
+		long long e_ = (long long)(expected), a_ = (long long)(actual);					\
+		if(e_ != a_)																	\
+		{																				\
+			test_Fail(__FILE__, __LINE__, "%s: expected %lld, got %lld", #actual, e_, a_);	\
+			return;																		\
+		}																				\
+	} while(0)
+
+#define TEST_ASSERT_EQUAL_MEMORY(expected, actual, size)								\
+	do																					\
+	{																					\
+		if(memcmp((expected), (actual), (size)) != 0)									\
+		{																				\
+			test_Fail(__FILE__, __LINE__, "%s differs from %s", #actual, #expected);	\
+			return;																		\
+		}																				\
+	} while(0)
+
+// テスト一覧(各テストファイルで定義, {NULL, NULL}で終端)
+extern const TestCase test_buscapCases[];
+extern const TestCase test_charcodeCases[];
+extern const TestCase test_consoleCases[];
+extern const TestCase test_lcdCases[];
+extern const TestCase test_monitorCases[];
+extern const TestCase test_poolCases[];
+extern const TestCase test_sdCases[];
+extern const TestCase test_setupCases[];
+extern const TestCase test_traceCases[];
+extern const TestCase test_viewerCases[];
+extern const TestCase test_sleeplogCases[];
+extern const TestCase test_rtctimeCases[];
+extern const TestCase test_httpCases[];
+extern const TestCase test_seriesCases[];
+extern const TestCase test_hottailCases[];
+extern const TestCase test_ds18b20Cases[];
+
+#endif
@@ -0,0 +1,171 @@
+//======================================================================
+//! @file   test_buscap.c
+//! @brief  buscap.c / busanalysis.c 単体テスト
+//! @note	ホストでは時刻は仮想時計[ns] (ticksPerUs=1000).
+//======================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "diskio.h"
+
+#include "global.h"
+#include "setup.h"
+#include "lcd.h"
+#include "buscap.h"
+#include "busanalysis.h"
+#include "sim.h"
+#include "test.h"
+
+static BusCapRecord records[BUSCAP_MAX_RECORDS];
+
+//----------------------------------------------------------------------
+//! @brief  全画面を書き換えて転送
+//----------------------------------------------------------------------
+static void Redraw(void)
+{
+	lcd_BeginDrawing();
+	lcd_Cls();
+	lcd_DrawLine(0, 0, 127, 63);
+	lcd_EndDrawing();
+	lcd_Update();
+}
+
+//----------------------------------------------------------------------
+//! @brief  記録は相手・バイト数・時間がSPI模擬の統計と一致する
+//----------------------------------------------------------------------
+static void CaptureMatchesBus(void)
+{
+	uint8_t buff[512] = {0};
+	SimSpiStats before, after;
+	uint64_t bytes = 0, busyNs = 0;
+	int sd = 0, lcd = 0;
+
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(0, disk_status(0));
+	sim_GetSpiStats(&before);
+	buscap_Start();
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_write(0, buff, 10, 1));
+	Redraw();
+	buscap_Stop();
+	sim_GetSpiStats(&after);
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_read(0, buff, 10, 1));		// 停止後は記録しない
+
+	int count = buscap_GetRecords(records, BUSCAP_MAX_RECORDS);
+	TEST_ASSERT_EQUAL_INT(after.transactions - before.transactions, count);
+	TEST_ASSERT_EQUAL_INT(count, buscap_GetCount());
+	TEST_ASSERT_EQUAL_INT(0, buscap_GetDropCount());
+	for(int i = 0; i < count; i++)
+	{
+		bytes += records[i].txBytes + records[i].rxBytes;
+		busyNs += records[i].duration;
+		sd += (records[i].device == BusDevice_Sd);
+		lcd += (records[i].device == BusDevice_Lcd);
+		TEST_ASSERT(records[i].device != BusDevice_Both);
+		TEST_ASSERT(records[i].clockKhz > 0);
+	}
+	TEST_ASSERT_EQUAL_INT(after.bytes - before.bytes, bytes);
+	TEST_ASSERT_EQUAL_INT(after.busyNs - before.busyNs, busyNs);
+	TEST_ASSERT(sd > 0);
+	TEST_ASSERT(lcd > 0);
+	// LCDの最後の転送は表示データ(RS=H)
+	TEST_ASSERT_EQUAL_INT(BusDevice_Lcd, records[count - 1].device);
+	TEST_ASSERT(records[count - 1].pins & BUSCAP_PIN_RS);
+}
+
+//----------------------------------------------------------------------
+//! @brief  満杯になったら記録を止めて数える
+//----------------------------------------------------------------------
+static void CaptureFull(void)
+{
+	set_Initialize();
+	buscap_Start();
+	while(buscap_GetDropCount() == 0)
+	{
+		Redraw();
+	}
+	buscap_Stop();
+	TEST_ASSERT_EQUAL_INT(BUSCAP_MAX_RECORDS, buscap_GetCount());
+	TEST_ASSERT(buscap_GetDropCount() > 0);
+}
+
+//----------------------------------------------------------------------
+//! @brief  保存→読込→再生で記録どおりの時間になる
+//----------------------------------------------------------------------
+static void SaveAndReplay(void)
+{
+	uint8_t buff[512 * 4] = {0};
+	BusCapHeader header;
+	BusCapRecord *loaded;
+	BusReplayResult result;
+
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(0, disk_status(0));
+	uint64_t start = sim_GetTimeNs();
+	buscap_Start();
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_read(0, buff, 0, 4));
+	Redraw();
+	buscap_Stop();
+	uint64_t elapsed = sim_GetTimeNs() - start;
+
+	FILE *fp = tmpfile();
+	TEST_ASSERT_EQUAL_INT(RET_OK, buscap_Save(fp));
+	rewind(fp);
+	TEST_ASSERT_EQUAL_INT(0, busanalysis_Load(fp, &header, &loaded));
+	fclose(fp);
+	TEST_ASSERT_EQUAL_INT(1000, header.ticksPerUs);
+	TEST_ASSERT_EQUAL_INT(buscap_GetCount(), header.count);
+
+	busanalysis_Replay(&header, loaded, NULL, &result);
+	free(loaded);
+	TEST_ASSERT_EQUAL_INT(header.count, result.records);
+	TEST_ASSERT(result.spanNs <= elapsed);
+	TEST_ASSERT(result.busyNs <= result.spanNs);
+	TEST_ASSERT_EQUAL_INT(result.busyNs, result.deviceBusyNs[BusDevice_None] + result.deviceBusyNs[BusDevice_Sd] + result.deviceBusyNs[BusDevice_Lcd]);
+	TEST_ASSERT(result.deviceRecords[BusDevice_Sd] > 0);
+	TEST_ASSERT(result.deviceRecords[BusDevice_Lcd] > 0);
+	TEST_ASSERT(result.switches >= 1);
+}
+
+//----------------------------------------------------------------------
+//! @brief  クロック・チャンクサイズを変えた見積り
+//----------------------------------------------------------------------
+static void WhatIf(void)
+{
+	// 1MHz, 固定分2us, 転送間の空き1us の64byte受信×4
+	BusCapHeader header = {BUSCAP_MAGIC, BUSCAP_VERSION, sizeof(BusCapRecord), 1000, 4, 0};
+	BusCapRecord run[4];
+	BusReplayOptions options = {0, 0};
+	BusReplayResult base, result;
+	for(int i = 0; i < 4; i++)
+	{
+		run[i] = (BusCapRecord){(uint32_t)(i * 515000), 514000, 0, 64, 1000, BusDevice_Sd, 0};
+	}
+
+	busanalysis_Replay(&header, run, NULL, &base);
+	TEST_ASSERT_EQUAL_INT(4 * 514000 + 3 * 1000, base.spanNs);
+	TEST_ASSERT_EQUAL_INT(4 * 512000, base.payloadNs);
+	TEST_ASSERT_EQUAL_INT(1000, base.gapP50Ns);
+
+	// クロック2倍: ビット時間が半分
+	options.clockKhz = 2000;
+	busanalysis_Replay(&header, run, &options, &result);
+	TEST_ASSERT_EQUAL_INT(4 * 256000, result.payloadNs);
+	TEST_ASSERT_EQUAL_INT(4 * 258000 + 3 * 1000, result.spanNs);
+
+	// 256byteチャンク: 1転送にまとまり、固定分と空き時間が減る
+	options.clockKhz = 0;
+	options.chunkBytes = 256;
+	busanalysis_Replay(&header, run, &options, &result);
+	TEST_ASSERT_EQUAL_INT(1, result.records);
+	TEST_ASSERT_EQUAL_INT(4 * 512000 + 2000, result.spanNs);
+}
+
+const TestCase test_buscapCases[] =
+{
+	{"CaptureMatchesBus", CaptureMatchesBus},
+	{"CaptureFull", CaptureFull},
+	{"SaveAndReplay", SaveAndReplay},
+	{"WhatIf", WhatIf},
+	{NULL, NULL}
+};
@@ -0,0 +1,92 @@
+//======================================================================
+//! @file   test_charcode.c
+//! @brief  charcode.c 単体テスト
+//======================================================================
+#include <string.h>
+
+#include "charcode.h"
+#include "test.h"
+
+//----------------------------------------------------------------------
+//! @brief  ASCII 1文字
+//----------------------------------------------------------------------
+static void Utf8Ascii(void)
+{
+	int width = 0, bytes = 0;
+	TEST_ASSERT_EQUAL_INT('A', char_TransUtf8ToSerial("AB", &width, &bytes));
+	TEST_ASSERT_EQUAL_INT(1, width);
+	TEST_ASSERT_EQUAL_INT(1, bytes);
+}
+
+//----------------------------------------------------------------------
+//! @brief  ひらがな(UTF-8 3byte → 全角)
+//----------------------------------------------------------------------
+static void Utf8Hiragana(void)
+{
+	int width = 0, bytes = 0;
+	// "あ" = U+3042 = SJIS 0x82a0
+	int code = char_TransUtf8ToSerial("\xe3\x81\x82", &width, &bytes);
+	TEST_ASSERT_EQUAL_INT(2, width);
+	TEST_ASSERT_EQUAL_INT(3, bytes);
+	TEST_ASSERT_EQUAL_INT(char_TransSjisToSerial("\x82\xa0", NULL, NULL), code);
+}
+
+//----------------------------------------------------------------------
+//! @brief  半角カタカナ(UTF-8 3byte → 半角)
+//----------------------------------------------------------------------
+static void Utf8HalfWidthKatakana(void)
+{
+	int width = 0, bytes = 0;
+	// "ｱ" = U+FF71 = SJIS 0xb1
+	TEST_ASSERT_EQUAL_INT(0xb1, char_TransUtf8ToSerial("\xef\xbd\xb1", &width, &bytes));
+	TEST_ASSERT_EQUAL_INT(1, width);
+	TEST_ASSERT_EQUAL_INT(3, bytes);
+}
+
+//----------------------------------------------------------------------
+//! @brief  Shift-JIS 区点連番
+//----------------------------------------------------------------------
+static void SjisSerial(void)
+{
+	int width = 0, bytes = 0;
+	// 0x8140(1区1点) → 0, 0x829f(4区1点) → 3*94
+	TEST_ASSERT_EQUAL_INT(0, char_TransSjisToSerial("\x81\x40", &width, &bytes));
+	TEST_ASSERT_EQUAL_INT(2, width);
+	TEST_ASSERT_EQUAL_INT(2, bytes);
+	TEST_ASSERT_EQUAL_INT(3 * 94, char_TransSjisToSerial("\x82\x9f", NULL, NULL));
+	// 0xe040(63区1点)
+	TEST_ASSERT_EQUAL_INT(62 * 94, char_TransSjisToSerial("\xe0\x40", NULL, NULL));
+}
+
+//----------------------------------------------------------------------
+//! @brief  Shift-JIS 1byte文字
+//----------------------------------------------------------------------
+static void SjisSingleByte(void)
+{
+	int width = 0, bytes = 0;
+	TEST_ASSERT_EQUAL_INT(0xb1, char_TransSjisToSerial("\xb1", &width, &bytes));
+	TEST_ASSERT_EQUAL_INT(1, width);
+	TEST_ASSERT_EQUAL_INT(1, bytes);
+}
+
+//----------------------------------------------------------------------
+//! @brief  UTF-8 → UTF-16
+//----------------------------------------------------------------------
+static void Utf8ToUtf16(void)
+{
+	TEST_ASSERT_EQUAL_INT(0x41, char_TransUtf8ToUtf16(0x41));
+	TEST_ASSERT_EQUAL_INT(0x00e9, char_TransUtf8ToUtf16(0xc3a9));
+	TEST_ASSERT_EQUAL_INT(0x3042, char_TransUtf8ToUtf16(0xe38182));
+	TEST_ASSERT_EQUAL_INT(0x1f600, char_TransUtf8ToUtf16(0xf09f9880));
+}
+
+const TestCase test_charcodeCases[] =
+{
+	{"Utf8Ascii", Utf8Ascii},
+	{"Utf8Hiragana", Utf8Hiragana},
+	{"Utf8HalfWidthKatakana", Utf8HalfWidthKatakana},
+	{"SjisSerial", SjisSerial},
+	{"SjisSingleByte", SjisSingleByte},
+	{"Utf8ToUtf16", Utf8ToUtf16},
+	{NULL, NULL}
+};
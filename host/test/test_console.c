@@ -0,0 +1,328 @@
+//======================================================================
+//! @file   test_console.c
+//! @brief  console.c 単体テスト
+//! @note	console_Execute()の標準出力を取り込んで確認する.
+//======================================================================
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "diskio.h"
+
+#include "global.h"
+#include "setup.h"
+#include "console.h"
+#include "lcd.h"
+#include "rtctime.h"
+#include "sd.h"
+#include "sim.h"
+#include "test.h"
+
+static char output[4096];		// コマンドの出力
+
+//----------------------------------------------------------------------
+//! @brief  コマンド実行して出力を取り込む
+//! @param	command		[I]コマンド行
+//! @return	console_Execute()の戻り値
+//----------------------------------------------------------------------
+static int Run(const char *command)
+{
+	char line[64];
+	FILE *capture = tmpfile();
+	int saved, ret;
+	size_t size;
+
+	snprintf(line, sizeof(line), "%s", command);
+	fflush(stdout);
+	saved = dup(fileno(stdout));
+	dup2(fileno(capture), fileno(stdout));
+	ret = console_Execute(line);
+	fflush(stdout);
+	dup2(saved, fileno(stdout));
+	close(saved);
+
+	rewind(capture);
+	size = fread(output, 1, sizeof(output) - 1, capture);
+	output[size] = '\0';
+	fclose(capture);
+	return ret;
+}
+
+//----------------------------------------------------------------------
+//! @brief  不明なコマンドはエラー行と終了行
+//----------------------------------------------------------------------
+static void UnknownCommand(void)
+{
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(RET_NG, Run("foo 1 2"));
+	TEST_ASSERT(strstr(output, "{\"error\":\"unknown command\"}\n") != NULL);
+	TEST_ASSERT(strstr(output, "{\"cmd\":\"foo\",\"status\":\"error\"}\n") != NULL);
+}
+
+//----------------------------------------------------------------------
+//! @brief  空行は何も出力しない
+//----------------------------------------------------------------------
+static void EmptyLine(void)
+{
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("  "));
+	TEST_ASSERT_EQUAL_INT(0, strlen(output));
+}
+
+//----------------------------------------------------------------------
+//! @brief  helpは全コマンドの書式を出す
+//----------------------------------------------------------------------
+static void Help(void)
+{
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("help"));
+	TEST_ASSERT(strstr(output, "{\"usage\":\"sdbench") != NULL);
+	TEST_ASSERT(strstr(output, "{\"usage\":\"tasks\"}") != NULL);
+	TEST_ASSERT(strstr(output, "{\"cmd\":\"help\",\"status\":\"ok\"}\n") != NULL);
+}
+
+//----------------------------------------------------------------------
+//! @brief  countersはドライバ統計を出す
+//----------------------------------------------------------------------
+static void Counters(void)
+{
+	uint8_t buff[512 * 3];
+	SdCounters sd;
+	char expected[64];
+
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_read(0, buff, 100, 3));
+	sd_GetCounters(&sd);
+	TEST_ASSERT(sd.readSectors >= 3);
+	TEST_ASSERT_EQUAL_INT(0, sd.errorCount);
+
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("counters"));
+	snprintf(expected, sizeof(expected), "\"read_sectors\":%u,", sd.readSectors);
+	TEST_ASSERT(strstr(output, expected) != NULL);
+	TEST_ASSERT(strstr(output, "{\"counters\":\"lcd\",\"updates\":1,") != NULL);
+}
+
+//----------------------------------------------------------------------
+//! @brief  lcdbenchは1画面分の転送量と時間を出す
+//----------------------------------------------------------------------
+static void LcdBench(void)
+{
+	LcdCounters lcd;
+
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("lcdbench 2"));
+	TEST_ASSERT(strstr(output, "\"frames\":2,") != NULL);
+	TEST_ASSERT(strstr(output, "\"bytes_per_frame\":1048}") != NULL);
+	TEST_ASSERT(strstr(output, "\"us_per_frame\":0,") == NULL);
+	lcd_GetCounters(&lcd);
+	TEST_ASSERT_EQUAL_INT(3, lcd.updateCount);
+}
+
+//----------------------------------------------------------------------
+//! @brief  tasksは生成済みタスクを出す
+//----------------------------------------------------------------------
+static void Tasks(void)
+{
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("tasks"));
+	TEST_ASSERT(strstr(output, "{\"task\":\"console\",") != NULL);
+	TEST_ASSERT(strstr(output, "\"stack_free\":3072,") != NULL);
+}
+
+//----------------------------------------------------------------------
+//! @brief  heapは領域別の残量を出す
+//----------------------------------------------------------------------
+static void Heap(void)
+{
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("heap"));
+	TEST_ASSERT(strstr(output, "{\"heap\":\"total\",\"free\":") != NULL);
+	TEST_ASSERT(strstr(output, "{\"heap\":\"iram\",\"free\":0}") != NULL);
+	TEST_ASSERT(strstr(output, "{\"pool\":\"fallback\",\"count\":") != NULL);
+}
+
+//----------------------------------------------------------------------
+//! @brief  sdbenchの引数誤り
+//----------------------------------------------------------------------
+static void SdBenchArguments(void)
+{
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(RET_NG, Run("sdbench seq"));
+	TEST_ASSERT(strstr(output, "missing argument") != NULL);
+	TEST_ASSERT_EQUAL_INT(RET_NG, Run("sdbench seq erase"));
+	TEST_ASSERT_EQUAL_INT(RET_NG, Run("sdbench burst read"));
+}
+
+//----------------------------------------------------------------------
+//! @brief  traceは1行1イベントと上書き数を出す
+//----------------------------------------------------------------------
+static void Trace(void)
+{
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("trace clear"));
+	lcd_Update();
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("trace"));
+	TEST_ASSERT(strstr(output, "{\"name\":\"BusWait\",\"cat\":\"bus\",\"ph\":\"B\",") == output);
+	TEST_ASSERT(strstr(output, "\"name\":\"LcdUpdate\"") != NULL);
+	TEST_ASSERT(strstr(output, "{\"trace_dropped\":0}\n") != NULL);
+}
+
+//----------------------------------------------------------------------
+//! @brief  formatはconfirmがなければ何もしない
+//----------------------------------------------------------------------
+static void FormatRequiresConfirm(void)
+{
+	uint8_t *boot = sim_SdSector(0);
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(0, disk_status(0));
+	TEST_ASSERT_EQUAL_INT(RET_NG, Run("format"));
+	TEST_ASSERT(strstr(output, "{\"cmd\":\"format\",\"status\":\"error\"}\n") != NULL);
+	TEST_ASSERT_EQUAL_INT(0, boot[510]);
+
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("format confirm"));
+	TEST_ASSERT(strstr(output, "{\"format\":\"fat32\",\"align_sectors\":8192,\"volume_sector\":8192,") != NULL);
+	TEST_ASSERT_EQUAL_INT(0x55, boot[510]);
+}
+
+//----------------------------------------------------------------------
+//! @brief  viewは1ページ表示し、2回目は保存した索引を使う
+//----------------------------------------------------------------------
+static void View(void)
+{
+	FILE *fp = fopen("console_view.txt", "w");
+	fputs("hello\n", fp);
+	fclose(fp);
+	remove("console_view.txt.idx");
+
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(RET_NG, Run("view"));
+	TEST_ASSERT_EQUAL_INT(RET_NG, Run("view missing.txt"));
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("view console_view.txt"));
+	TEST_ASSERT(strstr(output, "{\"view\":\"console_view.txt\",\"pages\":1,\"page\":0,\"offset\":0,\"bytes\":6,\"index\":\"built\",") == output);
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("view console_view.txt 0"));
+	TEST_ASSERT(strstr(output, "\"index\":\"cached\"") != NULL);
+	TEST_ASSERT_EQUAL_INT(RET_NG, Run("view console_view.txt 1"));
+	TEST_ASSERT(strstr(output, "no page 1") != NULL);
+	remove("console_view.txt");
+	remove("console_view.txt.idx");
+}
+
+//----------------------------------------------------------------------
+//! @brief  sleeplog start は記録モードにして眠り、sleeplog は見積りを出す
+//----------------------------------------------------------------------
+static void SleepLog(void)
+{
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("sleeplog"));
+	TEST_ASSERT(strstr(output, "{\"sleeplog\":\"none\"}") == output);
+	TEST_ASSERT_EQUAL_INT(RET_NG, Run("sleeplog start"));
+	TEST_ASSERT_EQUAL_INT(RET_NG, Run("sleeplog start 60 1000"));
+	TEST_ASSERT(!sim_DeepSleepRequested(NULL, NULL));
+
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("sleeplog start 60 30"));
+	TEST_ASSERT(strstr(output, "{\"sleeplog\":\"start\",\"interval_ms\":60000,\"batch\":30,") == output);
+	TEST_ASSERT(sim_DeepSleepRequested(NULL, NULL));
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("sleeplog"));
+	TEST_ASSERT(strstr(output, "{\"sleeplog\":\"report\",\"running\":1,\"interval_ms\":60000,\"batch\":30,") == output);
+	TEST_ASSERT(strstr(output, "\"battery_days\":") != NULL);
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("sleeplog stop"));
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("sleeplog"));
+	TEST_ASSERT(strstr(output, "\"running\":0,") != NULL);
+}
+
+//----------------------------------------------------------------------
+//! @brief  rotateはLCDの向きを変え、viewは向きに合わせた範囲に描く
+//----------------------------------------------------------------------
+static void Rotate(void)
+{
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("rotate"));
+	TEST_ASSERT(strstr(output, "{\"rotate\":0,\"width\":128,\"height\":64}\n") == output);
+	TEST_ASSERT_EQUAL_INT(RET_NG, Run("rotate 45"));
+	TEST_ASSERT_EQUAL_INT(RET_NG, Run("rotate 90x"));
+	TEST_ASSERT_EQUAL_INT(LcdRotation_0, lcd_GetRotation());
+
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("rotate 90"));
+	TEST_ASSERT(strstr(output, "{\"rotate\":90,\"width\":64,\"height\":128}\n") == output);
+	TEST_ASSERT_EQUAL_INT(LcdRotation_90, lcd_GetRotation());
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("rotate 270"));
+	TEST_ASSERT_EQUAL_INT(LcdRotation_270, lcd_GetRotation());
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("rotate 0"));
+	TEST_ASSERT_EQUAL_INT(LcdRotation_0, lcd_GetRotation());
+}
+
+//----------------------------------------------------------------------
+//! @brief  timeは時刻と同期の状態を出す
+//----------------------------------------------------------------------
+static void Time(void)
+{
+	set_Initialize();
+	rtctime_Restore();
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("time"));
+	TEST_ASSERT(strstr(output, "{\"time\":0,\"valid\":0,\"syncs\":0,") == output);
+	TEST_ASSERT(strstr(output, "\"sync_due\":1}") != NULL);
+
+	rtctime_Sync(1700000000LL * 1000000);
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("time"));
+	TEST_ASSERT(strstr(output, "{\"time\":1700000000,\"valid\":1,\"syncs\":1,\"last_sync\":1700000000,") == output);
+	TEST_ASSERT(strstr(output, "\"sync_interval_s\":3600,\"sync_due\":0}") != NULL);
+}
+
+//----------------------------------------------------------------------
+//! @brief  http: HTTPサーバの統計
+//----------------------------------------------------------------------
+static void Http(void)
+{
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("http"));
+	TEST_ASSERT(strstr(output, "{\"http\":\"stats\",\"open\":") == output);
+	TEST_ASSERT(strstr(output, "\"pipelined\":") != NULL);
+}
+
+//----------------------------------------------------------------------
+//! @brief  cache: RAMキャッシュの統計
+//----------------------------------------------------------------------
+static void Cache(void)
+{
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("cache"));
+	TEST_ASSERT(strstr(output, "{\"cache\":\"samples\",\"queries\":") == output);
+	TEST_ASSERT(strstr(output, "{\"cache\":\"rollup\",\"queries\":") != NULL);
+	TEST_ASSERT(strstr(output, "\"hit_permille\":") != NULL);
+}
+
+//----------------------------------------------------------------------
+//! @brief  temp: センサーごとの温度と統計
+//----------------------------------------------------------------------
+static void Temp(void)
+{
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(RET_NG, Run("temp"));
+	TEST_ASSERT(strstr(output, "{\"error\":\"no DS18B20 on GPIO2\"}") == output);
+
+	sim_OneWireAddProbe(0x123456, 377);
+	TEST_ASSERT_EQUAL_INT(RET_OK, Run("temp search"));
+	TEST_ASSERT(strstr(output, "{\"temp\":\"28563412000000") == output);
+	TEST_ASSERT(strstr(output, "\"celsius\":23.5625}") != NULL);
+	TEST_ASSERT(strstr(output, "{\"temp\":\"stats\",\"probes\":1,\"conversions\":1,\"reads\":1,\"crc_errors\":0,") != NULL);
+}
+
+const TestCase test_consoleCases[] =
+{
+	{"UnknownCommand", UnknownCommand},
+	{"EmptyLine", EmptyLine},
+	{"Help", Help},
+	{"Counters", Counters},
+	{"LcdBench", LcdBench},
+	{"Tasks", Tasks},
+	{"Heap", Heap},
+	{"SdBenchArguments", SdBenchArguments},
+	{"Trace", Trace},
+	{"FormatRequiresConfirm", FormatRequiresConfirm},
+	{"View", View},
+	{"Rotate", Rotate},
+	{"SleepLog", SleepLog},
+	{"Time", Time},
+	{"Http", Http},
+	{"Cache", Cache},
+	{"Temp", Temp},
+	{NULL, NULL}
+};
@@ -0,0 +1,181 @@
+//======================================================================
+//! @file   test_ds18b20.c
+//! @brief  ds18b20.c 単体テスト
+//! @note	GPIO2に繋いだ模擬センサー(sim/onewire.c)がパルス幅をデータシートの範囲で検査する.
+//======================================================================
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "global.h"
+#include "ds18b20.h"
+#include "sim.h"
+#include "test.h"
+
+static const uint64_t serials[] = {0x123456, 0x123457, 0xa00001};
+static const int16_t raws[] = {377, -162, 0x07d0};		// 23.5625℃, -10.125℃, 125℃
+#define PROBES	(sizeof(serials) / sizeof(serials[0]))
+
+//----------------------------------------------------------------------
+//! @brief  センサーを繋いで探す
+//! @return	見つけたセンサー数
+//----------------------------------------------------------------------
+static int Connect(void)
+{
+	for(size_t i = 0; i < PROBES; i++)
+	{
+		sim_OneWireAddProbe(serials[i], raws[i]);
+	}
+	ds18b20_Initialize();
+	return ds18b20_Search();
+}
+
+//----------------------------------------------------------------------
+//! @brief  センサーの番号(見つからなければ-1)
+//----------------------------------------------------------------------
+static int ProbeIndex(int found)
+{
+	uint8_t rom[8], simRom[8];
+
+	ds18b20_GetRom(found, rom);
+	for(size_t i = 0; i < PROBES; i++)
+	{
+		sim_OneWireGetRom((int)i, simRom);
+		if(memcmp(rom, simRom, 8) == 0)
+		{
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ROM探索でバスの全センサーを1回ずつ見つける
+//----------------------------------------------------------------------
+static void SearchFindsAll(void)
+{
+	int seen[PROBES] = {0};
+	SimOneWireStats stats;
+
+	TEST_ASSERT_EQUAL_INT(PROBES, Connect());
+	for(size_t i = 0; i < PROBES; i++)
+	{
+		int index = ProbeIndex((int)i);
+		TEST_ASSERT(index >= 0);
+		TEST_ASSERT_EQUAL_INT(0, seen[index]);
+		seen[index] = 1;
+	}
+	sim_OneWireGetStats(&stats);
+	TEST_ASSERT_EQUAL_INT(PROBES, stats.resets);
+	TEST_ASSERT_EQUAL_INT(0, stats.timingErrors);
+	TEST_ASSERT_EQUAL_INT(0, stats.lateSamples);
+}
+
+//----------------------------------------------------------------------
+//! @brief  変換は全センサー同時で、コマンドを送ったらすぐ戻り、750ms後に読める
+//----------------------------------------------------------------------
+static void ConcurrentConversion(void)
+{
+	int16_t values[DS18B20_PROBES_MAX];
+	SimOneWireStats simStats;
+	Ds18b20Stats stats;
+
+	TEST_ASSERT_EQUAL_INT(PROBES, Connect());
+	uint64_t startNs = sim_GetTimeNs();
+	TEST_ASSERT_EQUAL_INT(RET_OK, ds18b20_StartConversion());
+	TEST_ASSERT(sim_GetTimeNs() - startNs <= 10000000ULL);		// 1tick
+	TEST_ASSERT_EQUAL_INT(0, ds18b20_IsReady());
+	TEST_ASSERT_EQUAL_INT(RET_NG, ds18b20_Read(values));
+	sim_OneWireGetStats(&simStats);
+	TEST_ASSERT_EQUAL_INT(PROBES, simStats.conversions);
+
+	vTaskDelay(pdMS_TO_TICKS(DS18B20_CONVERT_MS));
+	TEST_ASSERT_EQUAL_INT(1, ds18b20_IsReady());
+	TEST_ASSERT_EQUAL_INT(RET_OK, ds18b20_Read(values));
+	for(size_t i = 0; i < PROBES; i++)
+	{
+		TEST_ASSERT_EQUAL_INT(raws[ProbeIndex((int)i)], values[i]);
+	}
+	TEST_ASSERT(sim_GetTimeNs() - startNs < 1000000000ULL);		// センサー数×750msではない
+
+	ds18b20_GetStats(&stats);
+	TEST_ASSERT_EQUAL_INT(1, stats.conversions);
+	TEST_ASSERT_EQUAL_INT(1, stats.reads);
+	TEST_ASSERT_EQUAL_INT(0, stats.crcErrors);
+	sim_OneWireGetStats(&simStats);
+	TEST_ASSERT_EQUAL_INT(0, simStats.timingErrors);
+	TEST_ASSERT_EQUAL_INT(0, simStats.lateSamples);
+	TEST_ASSERT_EQUAL_INT(simStats.slots, stats.slots);
+	TEST_ASSERT(stats.spinUs <= 10 * stats.slots);				// 割込み内の待ちは1スロット10us以下
+}
+
+//----------------------------------------------------------------------
+//! @brief  CRCの合わないセンサーだけ値なし
+//----------------------------------------------------------------------
+static void CrcErrorGivesNoValue(void)
+{
+	int16_t values[DS18B20_PROBES_MAX];
+	Ds18b20Stats stats;
+
+	TEST_ASSERT_EQUAL_INT(PROBES, Connect());
+	int bad = ProbeIndex(1);
+	sim_OneWireCorruptReads(bad, 1);
+	TEST_ASSERT_EQUAL_INT(RET_OK, ds18b20_StartConversion());
+	vTaskDelay(pdMS_TO_TICKS(DS18B20_CONVERT_MS));
+	TEST_ASSERT_EQUAL_INT(RET_OK, ds18b20_Read(values));
+	TEST_ASSERT_EQUAL_INT(DS18B20_NO_VALUE, values[1]);
+	TEST_ASSERT_EQUAL_INT(raws[ProbeIndex(0)], values[0]);
+	TEST_ASSERT_EQUAL_INT(raws[ProbeIndex(2)], values[2]);
+	ds18b20_GetStats(&stats);
+	TEST_ASSERT_EQUAL_INT(1, stats.crcErrors);
+
+	TEST_ASSERT_EQUAL_INT(RET_OK, ds18b20_Read(values));		// 読み直せば戻る
+	TEST_ASSERT_EQUAL_INT(raws[bad], values[1]);
+}
+
+//----------------------------------------------------------------------
+//! @brief  変換ごとに新しい温度になる
+//----------------------------------------------------------------------
+static void NewValueEachConversion(void)
+{
+	int16_t values[DS18B20_PROBES_MAX];
+
+	TEST_ASSERT_EQUAL_INT(PROBES, Connect());
+	int first = ProbeIndex(0);
+	for(int16_t raw = -880; raw <= 2000; raw += 720)		// -55℃～125℃
+	{
+		sim_OneWireSetTemperature(first, raw);
+		TEST_ASSERT_EQUAL_INT(RET_OK, ds18b20_StartConversion());
+		vTaskDelay(pdMS_TO_TICKS(DS18B20_CONVERT_MS));
+		TEST_ASSERT_EQUAL_INT(RET_OK, ds18b20_Read(values));
+		TEST_ASSERT_EQUAL_INT(raw, values[0]);
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  センサーがなければ探索は0個、変換は失敗
+//----------------------------------------------------------------------
+static void NoProbes(void)
+{
+	int16_t values[DS18B20_PROBES_MAX];
+	Ds18b20Stats stats;
+
+	ds18b20_Initialize();
+	TEST_ASSERT_EQUAL_INT(0, ds18b20_Search());
+	TEST_ASSERT_EQUAL_INT(RET_NG, ds18b20_StartConversion());
+	TEST_ASSERT_EQUAL_INT(RET_NG, ds18b20_Read(values));
+	ds18b20_GetStats(&stats);
+	TEST_ASSERT_EQUAL_INT(1, stats.busErrors);
+	TEST_ASSERT_EQUAL_INT(1, gpio_get_level(GPIO_ONEWIRE_NUM));		// バスは解放したまま
+}
+
+const TestCase test_ds18b20Cases[] =
+{
+	{"SearchFindsAll", SearchFindsAll},
+	{"ConcurrentConversion", ConcurrentConversion},
+	{"CrcErrorGivesNoValue", CrcErrorGivesNoValue},
+	{"NewValueEachConversion", NewValueEachConversion},
+	{"NoProbes", NoProbes},
+	{NULL, NULL}
+};
@@ -0,0 +1,298 @@
+//======================================================================
+//! @file   test_hottail.c
+//! @brief  hottail.c 単体テスト
+//! @note	記録ファイルはSDカードの代わりに作業ディレクトリのファイルを使う.
+//! 		キャッシュを使った応答は、読込前(すべてSDから答える)の応答とバイト単位で一致すること.
+//======================================================================
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "global.h"
+#include "hottail.h"
+#include "series.h"
+#include "test.h"
+
+#define BASE_S			1700000000		// 先頭サンプルの時刻
+#define LARGE_ROWS		4000			// HOTTAIL_LOAD_BYTESより大きいファイルの行数
+
+static const char *path = "hottail_test.csv";
+static char s_out[2][64 * 1024];		// 出力([0]=基準, [1]=キャッシュあり)
+static size_t s_outLength[2];
+static SeriesSample s_buffer[SERIES_READ_BLOCK];
+
+//----------------------------------------------------------------------
+//! @brief  出力先(メモリ)
+//----------------------------------------------------------------------
+static int Sink(void *context, const void *data, size_t length)
+{
+	int index = *(int *)context;
+	if(s_outLength[index] + length > sizeof(s_out[index]))
+	{
+		return RET_NG;
+	}
+	memcpy(&s_out[index][s_outLength[index]], data, length);
+	s_outLength[index] += length;
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  i番目のサンプル(1分間隔, 時々値なし)
+//----------------------------------------------------------------------
+static SeriesSample Sample(int i)
+{
+	SeriesSample sample;
+	sample.timeS = BASE_S + i * 60;
+	sample.value = (i % 97 == 5) ? SERIES_NO_VALUE : (int16_t)(400 + (i * 7) % 23 - 11);
+	return sample;
+}
+
+//----------------------------------------------------------------------
+//! @brief  sleeplogと同じ形式で行を追記する
+//! @param	first	[I]最初の番号
+//! @param	count	[I]行数
+//! @param	append	[I]1=キャッシュにも足す(sleeplog_Flush()相当)
+//----------------------------------------------------------------------
+static void AppendRows(int first, int count, int append)
+{
+	FILE *fp = fopen(path, "a");
+	for(int i = first; i < first + count && fp != NULL; i++)
+	{
+		SeriesSample sample = Sample(i);
+		if(sample.value == SERIES_NO_VALUE)
+		{
+			fprintf(fp, "%d,%d,%u,\n", i, i * 60, sample.timeS);
+		}
+		else
+		{
+			fprintf(fp, "%d,%d,%u,%d\n", i, i * 60, sample.timeS, sample.value);
+		}
+		if(append)
+		{
+			hottail_Append(&sample, 1);
+		}
+	}
+	if(fp != NULL)
+	{
+		fclose(fp);
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  見出しとcount行の記録ファイルを作る
+//----------------------------------------------------------------------
+static void MakeFile(int count)
+{
+	FILE *fp = fopen(path, "w");
+	if(fp != NULL)
+	{
+		fprintf(fp, "sequence,elapsed_s,unix_s,value\n");
+		fclose(fp);
+	}
+	AppendRows(0, count, 0);
+}
+
+//----------------------------------------------------------------------
+//! @brief  fromS以降のサンプルをs_out[index]へ書く(バイナリ形式)
+//----------------------------------------------------------------------
+static int QuerySamples(int index, uint32_t fromS)
+{
+	SeriesWriter writer;
+
+	s_outLength[index] = 0;
+	series_Begin(&writer, Series_Binary, 1.0f, 0.0f, Sink, &index);
+	if(hottail_QuerySamples(path, fromS, &writer, s_buffer, SERIES_READ_BLOCK) != RET_OK)
+	{
+		return RET_NG;
+	}
+	return series_End(&writer);
+}
+
+//----------------------------------------------------------------------
+//! @brief  fromS以降の集計をs_out[index]へ書く
+//----------------------------------------------------------------------
+static int QueryRollup(int index, uint32_t fromS)
+{
+	s_outLength[index] = 0;
+	return hottail_QueryRollup(path, fromS, Sink, &index, 1.0f, 0.0f, s_buffer, SERIES_READ_BLOCK);
+}
+
+//----------------------------------------------------------------------
+//! @brief  読込前(すべてSD)の応答を基準にする
+//----------------------------------------------------------------------
+static void Reference(uint32_t fromS, int rollup)
+{
+	hottail_Initialize();
+	if(rollup)
+	{
+		QueryRollup(0, fromS);
+	}
+	else
+	{
+		QuerySamples(0, fromS);
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  基準と同じ応答か
+//----------------------------------------------------------------------
+static int SameAsReference(void)
+{
+	return s_outLength[0] == s_outLength[1] && memcmp(s_out[0], s_out[1], s_outLength[0]) == 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ファイル全体を読んだらすべてRAMから答える
+//----------------------------------------------------------------------
+static void WholeFileIsHit(void)
+{
+	HotTailStats stats;
+
+	MakeFile(200);
+	Reference(0, 0);
+	hottail_GetStats(HotTail_Samples, &stats);
+	TEST_ASSERT_EQUAL_INT(1, stats.misses);
+	TEST_ASSERT_EQUAL_INT(200, stats.diskItems);
+
+	hottail_Initialize();
+	TEST_ASSERT_EQUAL_INT(RET_OK, hottail_Load(path));
+	TEST_ASSERT_EQUAL_INT(RET_OK, QuerySamples(1, 0));
+	TEST_ASSERT(SameAsReference());
+	TEST_ASSERT_EQUAL_INT(SERIES_HEADER_SIZE + 2 * 200 + 1, s_outLength[1]);
+	hottail_GetStats(HotTail_Samples, &stats);
+	TEST_ASSERT_EQUAL_INT(1, stats.queries);
+	TEST_ASSERT_EQUAL_INT(1, stats.hits);
+	TEST_ASSERT_EQUAL_INT(200, stats.ramItems);
+	TEST_ASSERT_EQUAL_INT(0, stats.diskItems);
+	remove(path);
+}
+
+//----------------------------------------------------------------------
+//! @brief  大きなファイルは末尾だけ読み、古い範囲はSDとRAMを合わせて答える
+//----------------------------------------------------------------------
+static void LargeFileMerges(void)
+{
+	static const uint32_t froms[] = {0, BASE_S + 3000 * 60, BASE_S + (LARGE_ROWS - 60) * 60, BASE_S + LARGE_ROWS * 60};
+	HotTailStats stats;
+
+	MakeFile(LARGE_ROWS);
+	for(size_t i = 0; i < sizeof(froms) / sizeof(froms[0]); i++)
+	{
+		Reference(froms[i], 0);
+		TEST_ASSERT_EQUAL_INT(RET_OK, hottail_Load(path));
+		TEST_ASSERT_EQUAL_INT(RET_OK, QuerySamples(1, froms[i]));
+		TEST_ASSERT(SameAsReference());
+		hottail_GetStats(HotTail_Samples, &stats);
+		TEST_ASSERT_EQUAL_INT((i < 2) ? 1 : 0, stats.merged);
+		TEST_ASSERT_EQUAL_INT((i < 2) ? 0 : 1, stats.hits);
+		TEST_ASSERT(stats.ramItems <= HOTTAIL_SAMPLES);
+	}
+	TEST_ASSERT_EQUAL_INT(0, stats.ramItems);		// 最後の問合せは該当なし
+	remove(path);
+}
+
+//----------------------------------------------------------------------
+//! @brief  追記でリングから捨てても応答は変わらない
+//----------------------------------------------------------------------
+static void AppendEvicts(void)
+{
+	HotTailStats stats;
+
+	MakeFile(0);
+	hottail_Initialize();
+	TEST_ASSERT_EQUAL_INT(RET_OK, hottail_Load(path));
+	AppendRows(0, HOTTAIL_SAMPLES, 1);
+	TEST_ASSERT_EQUAL_INT(RET_OK, QuerySamples(1, 0));
+	hottail_GetStats(HotTail_Samples, &stats);
+	TEST_ASSERT_EQUAL_INT(1, stats.hits);
+
+	AppendRows(HOTTAIL_SAMPLES, 100, 1);
+	TEST_ASSERT_EQUAL_INT(RET_OK, QuerySamples(1, 0));
+	hottail_GetStats(HotTail_Samples, &stats);
+	TEST_ASSERT_EQUAL_INT(1, stats.merged);
+	TEST_ASSERT_EQUAL_INT(100, stats.diskItems);
+	TEST_ASSERT_EQUAL_INT(2 * HOTTAIL_SAMPLES, stats.ramItems);
+	Reference(0, 0);
+	TEST_ASSERT(SameAsReference());
+	remove(path);
+}
+
+//----------------------------------------------------------------------
+//! @brief  集計はRAMだけ・SDとRAM・SDだけのいずれでも同じ
+//----------------------------------------------------------------------
+static void RollupMatchesDisk(void)
+{
+	static const uint32_t froms[] = {0, BASE_S + 1000 * 60, BASE_S + (LARGE_ROWS - 300) * 60 + 17};
+	HotTailStats stats;
+
+	MakeFile(LARGE_ROWS);
+	for(size_t i = 0; i < sizeof(froms) / sizeof(froms[0]); i++)
+	{
+		Reference(froms[i], 1);
+		hottail_GetStats(HotTail_Rollup, &stats);
+		TEST_ASSERT_EQUAL_INT(1, stats.misses);
+		TEST_ASSERT_EQUAL_INT(RET_OK, hottail_Load(path));
+		TEST_ASSERT_EQUAL_INT(RET_OK, QueryRollup(1, froms[i]));
+		TEST_ASSERT(SameAsReference());
+		hottail_GetStats(HotTail_Rollup, &stats);
+		TEST_ASSERT_EQUAL_INT((i < 2) ? 1 : 0, stats.merged);
+		TEST_ASSERT_EQUAL_INT((i < 2) ? 0 : 1, stats.hits);
+	}
+	s_out[1][s_outLength[1]] = '\0';
+	TEST_ASSERT(strstr(s_out[1], "{\"scale\":1,\"offset\":0,\"step\":3600,\"buckets\":[[") == s_out[1]);
+	remove(path);
+}
+
+//----------------------------------------------------------------------
+//! @brief  時刻が戻ったら(時刻の再設定)以後はSDから答える
+//----------------------------------------------------------------------
+static void TimeStepBackMisses(void)
+{
+	HotTailStats stats;
+
+	MakeFile(100);
+	hottail_Initialize();
+	TEST_ASSERT_EQUAL_INT(RET_OK, hottail_Load(path));
+	AppendRows(50, 10, 1);
+	TEST_ASSERT_EQUAL_INT(RET_OK, QuerySamples(1, 0));
+	TEST_ASSERT_EQUAL_INT(RET_OK, QueryRollup(1, 0));
+	hottail_GetStats(HotTail_Samples, &stats);
+	TEST_ASSERT_EQUAL_INT(1, stats.misses);
+	TEST_ASSERT_EQUAL_INT(0, stats.ramItems);
+	TEST_ASSERT_EQUAL_INT(110, stats.diskItems);
+	hottail_GetStats(HotTail_Rollup, &stats);
+	TEST_ASSERT_EQUAL_INT(1, stats.misses);
+	remove(path);
+}
+
+//----------------------------------------------------------------------
+//! @brief  記録ファイルがなければ空のキャッシュで、以後の追記から答える
+//----------------------------------------------------------------------
+static void MissingFile(void)
+{
+	HotTailStats stats;
+	SeriesSample sample = Sample(0);
+
+	remove(path);
+	hottail_Initialize();
+	TEST_ASSERT_EQUAL_INT(RET_OK, hottail_Load(path));
+	TEST_ASSERT_EQUAL_INT(RET_OK, QuerySamples(1, 0));
+	TEST_ASSERT_EQUAL_INT(SERIES_HEADER_SIZE, s_outLength[1]);
+	hottail_Append(&sample, 1);
+	TEST_ASSERT_EQUAL_INT(RET_OK, QuerySamples(1, 0));
+	TEST_ASSERT_EQUAL_INT(SERIES_HEADER_SIZE + 3, s_outLength[1]);
+	hottail_GetStats(HotTail_Samples, &stats);
+	TEST_ASSERT_EQUAL_INT(2, stats.hits);
+	TEST_ASSERT_EQUAL_INT(1, stats.ramItems);
+}
+
+const TestCase test_hottailCases[] =
+{
+	{"WholeFileIsHit", WholeFileIsHit},
+	{"LargeFileMerges", LargeFileMerges},
+	{"AppendEvicts", AppendEvicts},
+	{"RollupMatchesDisk", RollupMatchesDisk},
+	{"TimeStepBackMisses", TimeStepBackMisses},
+	{"MissingFile", MissingFile},
+	{NULL, NULL}
+};
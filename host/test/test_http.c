@@ -0,0 +1,295 @@
+//======================================================================
+//! @file   test_http.c
+//! @brief  http.c 単体テスト
+//! @note	ソケットの代わりにソケット番号ごとの送信内容と切断を記録する.
+//======================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "global.h"
+#include "http.h"
+#include "test.h"
+
+#define MAX_SOCKETS		8
+
+static char s_sent[MAX_SOCKETS][16384];		// ソケットごとの送信内容
+static size_t s_sentLength[MAX_SOCKETS];
+static int s_closed[MAX_SOCKETS];			// 1=閉じた
+
+//----------------------------------------------------------------------
+//! @brief  送信の記録
+//----------------------------------------------------------------------
+static int FakeSend(int socket, const void *data, size_t length)
+{
+	if(s_closed[socket] || s_sentLength[socket] + length >= sizeof(s_sent[socket]))
+	{
+		test_Fail(__FILE__, __LINE__, "send to socket %d", socket);
+		return RET_NG;
+	}
+	memcpy(&s_sent[socket][s_sentLength[socket]], data, length);
+	s_sentLength[socket] += length;
+	s_sent[socket][s_sentLength[socket]] = '\0';
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  切断の記録
+//----------------------------------------------------------------------
+static void FakeClose(int socket)
+{
+	s_closed[socket] = 1;
+}
+
+//----------------------------------------------------------------------
+//! @brief  初期化して1接続受け付ける
+//----------------------------------------------------------------------
+static HttpConnection *Open(int socket, int64_t nowUs)
+{
+	static const HttpIo io = {FakeSend, FakeClose};
+
+	if(socket == 1)
+	{
+		memset(s_sent, 0, sizeof(s_sent));
+		memset(s_sentLength, 0, sizeof(s_sentLength));
+		memset(s_closed, 0, sizeof(s_closed));
+		http_Initialize(&io);
+	}
+	return http_Accept(socket, nowUs);
+}
+
+//----------------------------------------------------------------------
+//! @brief  受信バッファに文字列を受信させる
+//----------------------------------------------------------------------
+static void Receive(HttpConnection *conn, const char *text, int64_t nowUs)
+{
+	uint8_t *buffer;
+	size_t space = http_GetRxSpace(conn, &buffer);
+
+	TEST_ASSERT(strlen(text) <= space);
+	memcpy(buffer, text, strlen(text));
+	http_Received(conn, strlen(text), nowUs);
+}
+
+//----------------------------------------------------------------------
+//! @brief  文字列の出現回数
+//----------------------------------------------------------------------
+static int Count(const char *text, const char *pattern)
+{
+	int count = 0;
+	for(const char *p = strstr(text, pattern); p != NULL; p = strstr(p + 1, pattern))
+	{
+		count++;
+	}
+	return count;
+}
+
+//----------------------------------------------------------------------
+//! @brief  1回の受信で届いた3つのリクエストに、届いた順に応答し、接続は保持する
+//----------------------------------------------------------------------
+static void PipelinedRequestsInOrder(void)
+{
+	HttpStats stats;
+	HttpConnection *conn = Open(1, 0);
+
+	Receive(conn, "GET /status HTTP/1.1\r\nHost: esp\r\n\r\n"
+		"GET / HTTP/1.1\r\nHost: esp\r\n\r\n"
+		"HEAD /?x=1 HTTP/1.1\r\nHost: esp\r\n\r\n", 0);
+	TEST_ASSERT_EQUAL_INT(1, http_Service(1000));
+	TEST_ASSERT_EQUAL_INT(1, http_Service(2000));
+	TEST_ASSERT_EQUAL_INT(1, http_Service(3000));
+	TEST_ASSERT_EQUAL_INT(0, http_Service(4000));
+
+	char *status = s_sent[1];
+	char *index = strstr(status, "HTTP/1.1 200 OK\r\nContent-Type: text/html");
+	char *head = (index != NULL) ? strstr(index + 1, "HTTP/1.1 200 OK\r\nContent-Type: text/html") : NULL;
+	TEST_ASSERT(strstr(status, "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nTransfer-Encoding: chunked\r\n") == status);
+	TEST_ASSERT(index != NULL && head != NULL);
+	TEST_ASSERT(strstr(index, "</html>") < head);
+	TEST_ASSERT(strstr(head, "<html>") == NULL);		// HEADは本文なし
+	TEST_ASSERT_EQUAL_INT(3, Count(s_sent[1], "Connection: keep-alive\r\n"));
+	TEST_ASSERT(!s_closed[1]);
+
+	http_GetStats(&stats);
+	TEST_ASSERT_EQUAL_INT(3, stats.requests);
+	TEST_ASSERT_EQUAL_INT(2, stats.reused);
+	TEST_ASSERT_EQUAL_INT(2, stats.pipelined);
+	TEST_ASSERT_EQUAL_INT(1, stats.open);
+}
+
+//----------------------------------------------------------------------
+//! @brief  chunkedの本文は長さ付きのチャンクと終端チャンク
+//----------------------------------------------------------------------
+static void ChunkedBody(void)
+{
+	HttpConnection *conn = Open(1, 0);
+
+	Receive(conn, "GET /status HTTP/1.1\r\n\r\n", 0);
+	http_Service(0);
+
+	char *body = strstr(s_sent[1], "\r\n\r\n") + 4;
+	unsigned long length = strtoul(body, NULL, 16);
+	TEST_ASSERT(strncmp(body + 4, "\r\n{\"uptime_ms\":", 15) == 0);
+	TEST_ASSERT_EQUAL_INT(strlen(body + 6), length + 7);
+	TEST_ASSERT_EQUAL_INT(0, strcmp(body + 6 + length, "\r\n0\r\n\r\n"));
+	TEST_ASSERT(body[6 + length - 2] == '}');
+}
+
+//----------------------------------------------------------------------
+//! @brief  Connection: close, HTTP/1.0の既定, 上限数で接続を閉じる
+//----------------------------------------------------------------------
+static void ConnectionClose(void)
+{
+	HttpConnection *conn = Open(1, 0);
+
+	Receive(conn, "GET / HTTP/1.1\r\nConnection: Close\r\n\r\nGET / HTTP/1.1\r\n\r\n", 0);
+	http_Service(0);
+	TEST_ASSERT(strstr(s_sent[1], "Connection: close\r\n\r\n") != NULL);
+	TEST_ASSERT(s_closed[1]);
+	TEST_ASSERT_EQUAL_INT(1, Count(s_sent[1], "HTTP/1.1 200"));		// 後続は捨てる
+
+	conn = http_Accept(2, 0);
+	Receive(conn, "GET / HTTP/1.0\r\n\r\n", 0);
+	http_Service(0);
+	TEST_ASSERT(strstr(s_sent[2], "Connection: close\r\n") != NULL);
+	TEST_ASSERT(s_closed[2]);
+
+	// HTTP/1.0でもkeep-aliveを求めれば保持(長さ不明の応答はchunkedにできないので閉じる)
+	conn = http_Accept(3, 0);
+	Receive(conn, "GET / HTTP/1.0\r\nConnection: keep-alive\r\n\r\nGET /status HTTP/1.0\r\nConnection: keep-alive\r\n\r\n", 0);
+	http_Service(0);
+	TEST_ASSERT(strstr(s_sent[3], "Keep-Alive: timeout=5, max=99\r\n") != NULL);
+	TEST_ASSERT(!s_closed[3]);
+	http_Service(0);
+	TEST_ASSERT(strstr(s_sent[3], "chunked") == NULL);
+	TEST_ASSERT(s_closed[3]);
+
+	conn = http_Accept(4, 0);
+	for(int i = 0; i < HTTP_MAX_REQUESTS; i++)
+	{
+		Receive(conn, "GET / HTTP/1.1\r\n\r\n", 0);
+		TEST_ASSERT(!s_closed[4]);
+		s_sentLength[4] = 0;					// 最後の応答だけ見る
+		http_Service(0);
+	}
+	TEST_ASSERT(strstr(s_sent[4], "Connection: close\r\n") != NULL);
+	TEST_ASSERT(s_closed[4]);
+}
+
+//----------------------------------------------------------------------
+//! @brief  待ちリクエストのない接続は無通信時間で閉じる
+//----------------------------------------------------------------------
+static void IdleTimeout(void)
+{
+	HttpStats stats;
+	HttpConnection *conn = Open(1, 0);
+
+	Receive(conn, "GET / HTTP/1.1\r\n\r\n", 1000000);
+	http_Service(1000000);
+	http_Service(1000000 + HTTP_IDLE_TIMEOUT_MS * 1000LL - 1);
+	TEST_ASSERT(!s_closed[1]);
+	http_Service(1000000 + HTTP_IDLE_TIMEOUT_MS * 1000LL);
+	TEST_ASSERT(s_closed[1]);
+	http_GetStats(&stats);
+	TEST_ASSERT_EQUAL_INT(1, stats.timeouts);
+	TEST_ASSERT_EQUAL_INT(0, stats.open);
+}
+
+//----------------------------------------------------------------------
+//! @brief  1回のhttp_Service()では各接続を1リクエストずつ処理する
+//----------------------------------------------------------------------
+static void FairAcrossConnections(void)
+{
+	HttpConnection *a = Open(1, 0);
+	HttpConnection *b = http_Accept(2, 0);
+
+	Receive(a, "GET / HTTP/1.1\r\n\r\nGET / HTTP/1.1\r\n\r\nGET / HTTP/1.1\r\n\r\n", 0);
+	Receive(b, "GET /status HTTP/1.1\r\n\r\n", 0);
+	TEST_ASSERT_EQUAL_INT(2, http_Service(0));
+	TEST_ASSERT_EQUAL_INT(1, Count(s_sent[1], "HTTP/1.1 200"));
+	TEST_ASSERT_EQUAL_INT(1, Count(s_sent[2], "HTTP/1.1 200"));
+	TEST_ASSERT_EQUAL_INT(1, http_Service(0));
+	TEST_ASSERT_EQUAL_INT(1, http_Service(0));
+	TEST_ASSERT_EQUAL_INT(3, Count(s_sent[1], "HTTP/1.1 200"));
+}
+
+//----------------------------------------------------------------------
+//! @brief  満杯なら最も古い待機中の接続を閉じ、待機中がなければ断る(503)
+//----------------------------------------------------------------------
+static void FullServerEvictsOrRejects(void)
+{
+	HttpStats stats;
+
+	Open(1, 100);
+	for(int i = 1; i < HTTP_MAX_CONNECTIONS; i++)
+	{
+		http_Accept(i + 1, 100 - i);		// 後の接続ほど古い
+	}
+	TEST_ASSERT(http_Accept(HTTP_MAX_CONNECTIONS + 1, 200) != NULL);
+	TEST_ASSERT(s_closed[HTTP_MAX_CONNECTIONS]);
+	for(int i = 1; i < HTTP_MAX_CONNECTIONS; i++)
+	{
+		TEST_ASSERT(!s_closed[i]);
+	}
+
+	for(int i = 0; i < HTTP_MAX_CONNECTIONS; i++)
+	{
+		Receive(http_GetConnection(i), "GET / HTTP/1.1\r\n", 300);	// 受信途中
+	}
+	TEST_ASSERT(http_Accept(HTTP_MAX_CONNECTIONS + 2, 400) == NULL);
+	http_Reject(HTTP_MAX_CONNECTIONS + 2);
+	TEST_ASSERT(strncmp(s_sent[HTTP_MAX_CONNECTIONS + 2], "HTTP/1.1 503 ", 13) == 0);
+	TEST_ASSERT(s_closed[HTTP_MAX_CONNECTIONS + 2]);
+
+	http_GetStats(&stats);
+	TEST_ASSERT_EQUAL_INT(HTTP_MAX_CONNECTIONS + 1, stats.accepted);
+	TEST_ASSERT_EQUAL_INT(1, stats.evicted);
+	TEST_ASSERT_EQUAL_INT(1, stats.rejected);
+	TEST_ASSERT_EQUAL_INT(HTTP_MAX_CONNECTIONS, stats.open);
+}
+
+//----------------------------------------------------------------------
+//! @brief  不正なリクエストはエラーを返して閉じる, 存在しないパスは404で保持
+//----------------------------------------------------------------------
+static void BadRequests(void)
+{
+	HttpStats stats;
+	HttpConnection *conn = Open(1, 0);
+	char header[HTTP_RX_SIZE + 1];
+
+	Receive(conn, "GET /none HTTP/1.1\r\n\r\nPOST / HTTP/1.1\r\nContent-Length: 3\r\n\r\nabc", 0);
+	http_Service(0);
+	TEST_ASSERT(strncmp(s_sent[1], "HTTP/1.1 404 Not Found\r\n", 24) == 0);
+	TEST_ASSERT(!s_closed[1]);
+	http_Service(0);
+	TEST_ASSERT(strstr(s_sent[1], "HTTP/1.1 405 Method Not Allowed\r\n") != NULL);
+	TEST_ASSERT(s_closed[1]);
+
+	conn = http_Accept(2, 0);
+	memset(header, 'a', HTTP_RX_SIZE);
+	header[HTTP_RX_SIZE] = '\0';
+	Receive(conn, header, 0);
+	http_Service(0);
+	TEST_ASSERT(strncmp(s_sent[2], "HTTP/1.1 431 ", 13) == 0);
+	TEST_ASSERT(s_closed[2]);
+
+	conn = http_Accept(3, 0);
+	Receive(conn, "GET / HTTP/2.0\r\n\r\n", 0);
+	http_Service(0);
+	TEST_ASSERT(strncmp(s_sent[3], "HTTP/1.1 505 ", 13) == 0);
+
+	http_GetStats(&stats);
+	TEST_ASSERT_EQUAL_INT(3, stats.errors);
+}
+
+const TestCase test_httpCases[] =
+{
+	{"PipelinedRequestsInOrder", PipelinedRequestsInOrder},
+	{"ChunkedBody", ChunkedBody},
+	{"ConnectionClose", ConnectionClose},
+	{"IdleTimeout", IdleTimeout},
+	{"FairAcrossConnections", FairAcrossConnections},
+	{"FullServerEvictsOrRejects", FullServerEvictsOrRejects},
+	{"BadRequests", BadRequests},
+	{NULL, NULL}
+};
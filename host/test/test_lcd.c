@@ -0,0 +1,464 @@
+//======================================================================
+//! @file   test_lcd.c
+//! @brief  lcd.c 単体テスト
+//! @note	描画後lcd_Update()でパネルへ転送し、模擬パネルの表示RAMを確認する.
+//======================================================================
+#include <stdio.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/timers.h"
+
+#include "setup.h"
+#include "lcd.h"
+#include "charcode.h"
+#include "font.h"
+#include "sim.h"
+#include "test.h"
+
+//----------------------------------------------------------------------
+//! @brief  パネル上の点
+//----------------------------------------------------------------------
+static int PanelPixel(int x, int y)
+{
+	return (sim_LcdRam(y / 8, x) >> (y % 8)) & 1;
+}
+
+//----------------------------------------------------------------------
+//! @brief  描画して転送
+//----------------------------------------------------------------------
+static void DrawImage(Rect rect, const uint8_t *image, const uint8_t *mask)
+{
+	lcd_BeginDrawing();
+	lcd_PutImage(rect, image, mask);
+	lcd_EndDrawing();
+	lcd_Update();
+}
+
+//----------------------------------------------------------------------
+//! @brief  初期化で全画面消去され、表示ONになる
+//----------------------------------------------------------------------
+static void InitializeClearsPanel(void)
+{
+	SimLcdStats stats;
+	set_Initialize();
+	sim_LcdGetStats(&stats);
+	TEST_ASSERT(stats.displayOn);
+	TEST_ASSERT(stats.resets >= 1);
+	TEST_ASSERT_EQUAL_INT(128 * 8, stats.dataBytes);
+	for(int y = 0; y < 64; y++)
+	{
+		for(int x = 0; x < 128; x++)
+		{
+			TEST_ASSERT_EQUAL_INT(0, PanelPixel(x, y));
+		}
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  8dot境界に合った画像
+//----------------------------------------------------------------------
+static void PutImageAligned(void)
+{
+	const uint8_t image[] = {0x01, 0x80, 0xff, 0x3c};
+	Rect rect = {10, 16, 4, 8};
+	set_Initialize();
+	DrawImage(rect, image, NULL);
+	for(int x = 0; x < 4; x++)
+	{
+		TEST_ASSERT_EQUAL_INT(image[x], sim_LcdRam(2, 10 + x));
+	}
+	TEST_ASSERT_EQUAL_INT(0, sim_LcdRam(2, 9));
+	TEST_ASSERT_EQUAL_INT(0, sim_LcdRam(2, 14));
+}
+
+//----------------------------------------------------------------------
+//! @brief  8dot境界をまたぐ画像
+//----------------------------------------------------------------------
+static void PutImageUnaligned(void)
+{
+	const uint8_t image[] = {0xff, 0x81};
+	Rect rect = {0, 3, 2, 8};
+	set_Initialize();
+	DrawImage(rect, image, NULL);
+	TEST_ASSERT_EQUAL_INT(0xf8, sim_LcdRam(0, 0));
+	TEST_ASSERT_EQUAL_INT(0x07, sim_LcdRam(1, 0));
+	TEST_ASSERT_EQUAL_INT(0x08, sim_LcdRam(0, 1));
+	TEST_ASSERT_EQUAL_INT(0x04, sim_LcdRam(1, 1));
+}
+
+//----------------------------------------------------------------------
+//! @brief  高さが8の倍数でない画像は下端を書き換えない
+//----------------------------------------------------------------------
+static void PutImagePartialHeight(void)
+{
+	const uint8_t full[] = {0xff};
+	const uint8_t image[] = {0x00};
+	set_Initialize();
+	DrawImage((Rect){0, 0, 1, 8}, full, NULL);
+	DrawImage((Rect){0, 0, 1, 5}, image, NULL);
+	TEST_ASSERT_EQUAL_INT(0xe0, sim_LcdRam(0, 0));
+}
+
+//----------------------------------------------------------------------
+//! @brief  マスク部分のみ書き換える
+//----------------------------------------------------------------------
+static void PutImageMasked(void)
+{
+	const uint8_t full[] = {0xff, 0xff};
+	const uint8_t image[] = {0x00, 0x00};
+	const uint8_t mask[] = {0x0f, 0xf0};
+	set_Initialize();
+	DrawImage((Rect){0, 0, 2, 8}, full, NULL);
+	DrawImage((Rect){0, 0, 2, 8}, image, mask);
+	TEST_ASSERT_EQUAL_INT(0xf0, sim_LcdRam(0, 0));
+	TEST_ASSERT_EQUAL_INT(0x0f, sim_LcdRam(0, 1));
+}
+
+//----------------------------------------------------------------------
+//! @brief  画面端でのクリッピング
+//----------------------------------------------------------------------
+static void PutImageClipped(void)
+{
+	const uint8_t image[] = {0x11, 0x22, 0x44, 0x88};
+	set_Initialize();
+
+	// 左端
+	DrawImage((Rect){-2, 0, 4, 8}, image, NULL);
+	TEST_ASSERT_EQUAL_INT(0x44, sim_LcdRam(0, 0));
+	TEST_ASSERT_EQUAL_INT(0x88, sim_LcdRam(0, 1));
+
+	// 右端
+	DrawImage((Rect){126, 8, 4, 8}, image, NULL);
+	TEST_ASSERT_EQUAL_INT(0x11, sim_LcdRam(1, 126));
+	TEST_ASSERT_EQUAL_INT(0x22, sim_LcdRam(1, 127));
+	TEST_ASSERT_EQUAL_INT(0x00, sim_LcdRam(1, 128));
+
+	// 上端
+	DrawImage((Rect){20, -4, 1, 8}, &image[3], NULL);
+	TEST_ASSERT_EQUAL_INT(0x08, sim_LcdRam(0, 20));
+
+	// 下端
+	DrawImage((Rect){30, 60, 1, 8}, &image[0], NULL);
+	TEST_ASSERT_EQUAL_INT(0x10, sim_LcdRam(7, 30));
+}
+
+//----------------------------------------------------------------------
+//! @brief  更新のない行は転送しない
+//----------------------------------------------------------------------
+static void UpdateSendsOnlyDirtySpan(void)
+{
+	const uint8_t image[] = {0xaa, 0x55, 0xaa};
+	SimLcdStats before, after;
+	set_Initialize();
+
+	sim_LcdGetStats(&before);
+	lcd_Update();
+	sim_LcdGetStats(&after);
+	TEST_ASSERT_EQUAL_INT(before.dataBytes, after.dataBytes);
+
+	DrawImage((Rect){40, 24, 3, 8}, image, NULL);
+	sim_LcdGetStats(&after);
+	TEST_ASSERT_EQUAL_INT(before.dataBytes + 3, after.dataBytes);
+}
+
+//----------------------------------------------------------------------
+//! @brief  転送中に割り込んで描画する(タイマ)
+//----------------------------------------------------------------------
+static int s_drawCount;
+static void DrawDuringUpdate(TimerHandle_t timer)
+{
+	static const uint8_t image[2] = {0x81, 0x42};
+	lcd_BeginDrawing();
+	lcd_PutImage((Rect){100, 56, 2, 8}, image, NULL);
+	lcd_EndDrawing();
+	s_drawCount++;
+}
+
+//----------------------------------------------------------------------
+//! @brief  転送中も描画できる.転送中に描いた範囲は次の更新で送る
+//----------------------------------------------------------------------
+static void UpdateDoesNotBlockDrawing(void)
+{
+	SimLcdStats before, after;
+
+	set_Initialize();
+	lcd_BeginDrawing();
+	lcd_Cls();
+	lcd_EndDrawing();
+
+	// 1転送ごとに1tick進め、毎tickタイマから描画する
+	sim_SetSpiOverheadNs(10 * 1000 * 1000);
+	TimerHandle_t timer = xTimerCreate("draw", 1, pdTRUE, NULL, DrawDuringUpdate);
+	TEST_ASSERT(timer != NULL);
+	s_drawCount = 0;
+	xTimerStart(timer, 0);
+	lcd_Update();
+	xTimerStop(timer, 0);
+	xTimerDelete(timer, 0);
+	sim_SetSpiOverheadNs(1000);
+	TEST_ASSERT(s_drawCount > 0);
+
+	sim_LcdGetStats(&before);
+	lcd_Update();
+	sim_LcdGetStats(&after);
+	TEST_ASSERT_EQUAL_INT(before.dataBytes + 2, after.dataBytes);
+	TEST_ASSERT_EQUAL_INT(0x81, sim_LcdRam(7, 100));
+	TEST_ASSERT_EQUAL_INT(0x42, sim_LcdRam(7, 101));
+}
+
+//----------------------------------------------------------------------
+//! @brief  直線
+//----------------------------------------------------------------------
+static void DrawLine(void)
+{
+	set_Initialize();
+	lcd_BeginDrawing();
+	lcd_DrawLine(0, 10, 127, 10);
+	lcd_DrawLine(5, 20, 15, 30);
+	lcd_DrawLine(-10, 63, 10, 63);
+	lcd_EndDrawing();
+	lcd_Update();
+
+	for(int x = 0; x < 128; x++)
+	{
+		TEST_ASSERT_EQUAL_INT(1, PanelPixel(x, 10));
+		TEST_ASSERT_EQUAL_INT(0, PanelPixel(x, 11));
+	}
+	for(int i = 0; i <= 10; i++)
+	{
+		TEST_ASSERT_EQUAL_INT(1, PanelPixel(5 + i, 20 + i));
+	}
+	TEST_ASSERT_EQUAL_INT(1, PanelPixel(0, 63));
+	TEST_ASSERT_EQUAL_INT(1, PanelPixel(10, 63));
+	TEST_ASSERT_EQUAL_INT(0, PanelPixel(11, 63));
+}
+
+//----------------------------------------------------------------------
+//! @brief  ASCII文字列
+//----------------------------------------------------------------------
+static void PutsAscii(void)
+{
+	set_Initialize();
+	lcd_BeginDrawing();
+	lcd_Puts((Rect){0, 0, 128, 8}, "Hi", Code_Utf8);
+	lcd_EndDrawing();
+	lcd_Update();
+	for(int x = 0; x < 4; x++)
+	{
+		TEST_ASSERT_EQUAL_INT(asciiFont['H' * 4 + x], sim_LcdRam(0, x));
+		TEST_ASSERT_EQUAL_INT(asciiFont['i' * 4 + x], sim_LcdRam(0, 4 + x));
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  全角文字と折り返し
+//----------------------------------------------------------------------
+static void PutsWrap(void)
+{
+	const uint8_t *kana = &jisFont[char_TransSjisToSerial("\x82\xa0", NULL, NULL) * 8];
+	set_Initialize();
+	lcd_BeginDrawing();
+	// 幅10dotのエリアに "A"(4dot) + "あ"(8dot) → "あ"は次の行へ
+	lcd_Puts((Rect){0, 0, 10, 16}, "A\xe3\x81\x82", Code_Utf8);
+	lcd_EndDrawing();
+	lcd_Update();
+	for(int x = 0; x < 8; x++)
+	{
+		TEST_ASSERT_EQUAL_INT(kana[x], sim_LcdRam(1, x));
+	}
+	TEST_ASSERT_EQUAL_INT(0, sim_LcdRam(0, 4));
+}
+
+//----------------------------------------------------------------------
+//! @brief  縦向きの描画座標→パネル上の点
+//----------------------------------------------------------------------
+static int RotatedPixel(LcdRotation rotation, int x, int y)
+{
+	return (rotation == LcdRotation_90) ? PanelPixel(127 - y, x) : PanelPixel(y, 63 - x);
+}
+
+//----------------------------------------------------------------------
+//! @brief  縦向きの画像描画は1dotずつ座標変換した結果と一致する(端数、8dot境界とのずれ、マスク、はみ出し)
+//----------------------------------------------------------------------
+static void PutImageRotated(void)
+{
+	static const Rect rects[] =
+	{
+		{0, 0, 8, 8}, {3, 5, 13, 11}, {-4, 120, 10, 14}, {58, -3, 9, 20}, {17, 40, 1, 1},
+	};
+	uint8_t image[3 * 16], mask[3 * 16];
+	uint8_t expected[128][64];
+	uint32_t seed = 1;
+
+	for(int rotation = LcdRotation_90; rotation <= LcdRotation_270; rotation++)
+	{
+		for(int r = 0; r < (int)(sizeof(rects) / sizeof(rects[0])); r++)
+		{
+			Rect rect = rects[r];
+			for(int i = 0; i < (int)sizeof(image); i++)
+			{
+				seed = seed * 1103515245 + 12345;
+				image[i] = (uint8_t)(seed >> 16);
+				mask[i] = (uint8_t)(seed >> 24);
+			}
+
+			set_Initialize();
+			lcd_BeginDrawing();
+			lcd_SetRotation(rotation);
+			for(int y = 0; y < 128; y += 3)
+			{
+				lcd_DrawLine(0, y, 63, y);						// 背景(マスク外は残る)
+			}
+			lcd_PutImage(rect, image, (r % 2 == 0) ? NULL : mask);
+			lcd_EndDrawing();
+			lcd_Update();
+
+			memset(expected, 0, sizeof(expected));
+			for(int y = 0; y < 128; y += 3)
+			{
+				memset(expected[y], 1, 64);
+			}
+			for(int y = 0; y < rect.h; y++)
+			{
+				for(int x = 0; x < rect.w; x++)
+				{
+					int index = (y / 8) * rect.w + x;
+					int dx = rect.x + x, dy = rect.y + y;
+					if(dx < 0 || dx >= 64 || dy < 0 || dy >= 128 || (r % 2 != 0 && !((mask[index] >> (y % 8)) & 1)))
+					{
+						continue;
+					}
+					expected[dy][dx] = (image[index] >> (y % 8)) & 1;
+				}
+			}
+			for(int y = 0; y < 128; y++)
+			{
+				for(int x = 0; x < 64; x++)
+				{
+					TEST_ASSERT_EQUAL_INT(expected[y][x], RotatedPixel(rotation, x, y));
+				}
+			}
+		}
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  縦向きでも描いた範囲だけ転送する
+//----------------------------------------------------------------------
+static void RotatedUpdateSendsOnlyDirtySpan(void)
+{
+	SimLcdStats before, after;
+
+	set_Initialize();
+	lcd_BeginDrawing();
+	lcd_SetRotation(LcdRotation_90);
+	lcd_EndDrawing();
+	lcd_Update();
+
+	// 縦向きの文字"A"(4x8dot)はパネル上で8x4dotになり、1ページに収まる
+	sim_LcdGetStats(&before);
+	lcd_BeginDrawing();
+	lcd_Puts((Rect){16, 40, 4, 8}, "A", Code_Utf8);
+	lcd_EndDrawing();
+	lcd_Update();
+	sim_LcdGetStats(&after);
+	TEST_ASSERT_EQUAL_INT(before.dataBytes + 8, after.dataBytes);
+	for(int y = 0; y < 8; y++)
+	{
+		for(int x = 0; x < 4; x++)
+		{
+			TEST_ASSERT_EQUAL_INT((asciiFont['A' * 4 + x] >> y) & 1, RotatedPixel(LcdRotation_90, 16 + x, 40 + y));
+		}
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  UI文字列はlcd_Puts()と同じ表示になり、エリアからはみ出す分は描かない
+//----------------------------------------------------------------------
+static void PutUiStrMatchesPuts(void)
+{
+	uint8_t expected[128];
+
+	set_Initialize();
+	lcd_BeginDrawing();
+	lcd_Puts((Rect){0, 0, 128, 8}, "SDカードエラー", Code_Utf8);
+	lcd_PutUiStr((Rect){0, 8, 128, 8}, UiStr_SdError);
+	lcd_PutUiStr((Rect){0, 16, 10, 8}, UiStr_SdError);
+	lcd_EndDrawing();
+	lcd_Update();
+
+	TEST_ASSERT_EQUAL_INT(56, uiStrTable[UiStr_SdError].width);
+	for(int x = 0; x < 128; x++)
+	{
+		expected[x] = sim_LcdRam(0, x);
+		TEST_ASSERT_EQUAL_INT(expected[x], sim_LcdRam(1, x));
+		TEST_ASSERT_EQUAL_INT((x < 10) ? expected[x] : 0, sim_LcdRam(2, x));
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  uistr.txtの全文字列で、UI文字列表の列データがlcd_Puts()の表示と一致する
+//! @note	生成した表が古い・変換が変わったときに気付くため、表の行をそのままlcd_Puts()で描いて比べる.
+//----------------------------------------------------------------------
+static void PutUiStrMatchesPutsForAllEntries(void)
+{
+	char line[256];
+	int id = 0;
+	FILE *fp = fopen(UISTR_TABLE, "r");
+
+	TEST_ASSERT(fp != NULL);
+	set_Initialize();
+	while(fgets(line, sizeof(line), fp) != NULL)
+	{
+		char *text = strchr(line, '\t');
+		if(line[0] == '#' || text == NULL)
+		{
+			continue;
+		}
+		text[strcspn(text, "\r\n")] = '\0';
+		if(id >= UiStr_Count)
+		{
+			break;
+		}
+
+		lcd_BeginDrawing();
+		lcd_Cls();
+		lcd_Puts((Rect){0, 0, 128, 8}, text + 1, Code_Utf8);
+		lcd_PutUiStr((Rect){0, 8, 128, 8}, (UiStrId)id);
+		lcd_EndDrawing();
+		lcd_Update();
+		for(int x = 0; x < 128; x++)
+		{
+			if(sim_LcdRam(0, x) != sim_LcdRam(1, x))
+			{
+				test_Fail(__FILE__, __LINE__, "%s: column %d differs", line, x);
+				fclose(fp);
+				return;
+			}
+		}
+		id++;
+	}
+	fclose(fp);
+	TEST_ASSERT_EQUAL_INT(UiStr_Count, id);
+}
+
+const TestCase test_lcdCases[] =
+{
+	{"InitializeClearsPanel", InitializeClearsPanel},
+	{"PutImageAligned", PutImageAligned},
+	{"PutImageUnaligned", PutImageUnaligned},
+	{"PutImagePartialHeight", PutImagePartialHeight},
+	{"PutImageMasked", PutImageMasked},
+	{"PutImageClipped", PutImageClipped},
+	{"UpdateSendsOnlyDirtySpan", UpdateSendsOnlyDirtySpan},
+	{"UpdateDoesNotBlockDrawing", UpdateDoesNotBlockDrawing},
+	{"DrawLine", DrawLine},
+	{"PutsAscii", PutsAscii},
+	{"PutsWrap", PutsWrap},
+	{"PutUiStrMatchesPuts", PutUiStrMatchesPuts},
+	{"PutUiStrMatchesPutsForAllEntries", PutUiStrMatchesPutsForAllEntries},
+	{"PutImageRotated", PutImageRotated},
+	{"RotatedUpdateSendsOnlyDirtySpan", RotatedUpdateSendsOnlyDirtySpan},
+	{NULL, NULL}
+};
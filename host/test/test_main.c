@@ -0,0 +1,83 @@
+//======================================================================
+//! @file   test_main.c
+//! @brief  ホスト単体テスト実行
+//! @note	使い方: unit_tests [テスト名の一部]
+//! 		各テストの前に模擬環境を初期化する.
+//======================================================================
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+
+#include "sim.h"
+#include "test.h"
+
+static const struct
+{
+	const char *name;
+	const TestCase *cases;
+} suites[] =
+{
+	{"buscap", test_buscapCases},
+	{"charcode", test_charcodeCases},
+	{"console", test_consoleCases},
+	{"lcd", test_lcdCases},
+	{"monitor", test_monitorCases},
+	{"pool", test_poolCases},
+	{"sd", test_sdCases},
+	{"setup", test_setupCases},
+	{"trace", test_traceCases},
+	{"viewer", test_viewerCases},
+	{"sleeplog", test_sleeplogCases},
+	{"rtctime", test_rtctimeCases},
+	{"http", test_httpCases},
+	{"series", test_seriesCases},
+	{"hottail", test_hottailCases},
+	{"ds18b20", test_ds18b20Cases},
+};
+
+static int s_failed;		// 実行中テストの失敗
+
+//----------------------------------------------------------------------
+//! @brief  失敗の記録
+//----------------------------------------------------------------------
+void test_Fail(const char *file, int line, const char *format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	fprintf(stderr, "  %s:%d: ", file, line);
+	vfprintf(stderr, format, args);
+	fputc('\n', stderr);
+	va_end(args);
+	s_failed = 1;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *filter = (argc >= 2) ? argv[1] : NULL;
+	int run = 0, failed = 0;
+	char fullName[128];
+
+	esp_log_level_set("*", ESP_LOG_ERROR);
+	for(size_t s = 0; s < sizeof(suites) / sizeof(suites[0]); s++)
+	{
+		for(const TestCase *test = suites[s].cases; test->name != NULL; test++)
+		{
+			snprintf(fullName, sizeof(fullName), "%s/%s", suites[s].name, test->name);
+			if(filter != NULL && strstr(fullName, filter) == NULL)
+			{
+				continue;
+			}
+			sim_Reset();
+			s_failed = 0;
+			test->function();
+			run++;
+			failed += s_failed;
+			printf("%s %s\n", s_failed ? "FAIL" : "ok  ", fullName);
+		}
+	}
+
+	printf("%d tests, %d failed\n", run, failed);
+	return (failed == 0 && run > 0) ? 0 : 1;
+}
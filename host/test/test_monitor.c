@@ -0,0 +1,121 @@
+//======================================================================
+//! @file   test_monitor.c
+//! @brief  monitor.c 単体テスト
+//! @note	模擬タスクの実行時間はsim_AddTaskRunTime()で与える.
+//======================================================================
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "setup.h"
+#include "monitor.h"
+#include "sim.h"
+#include "test.h"
+
+//----------------------------------------------------------------------
+//! @brief  何もしないタスク関数
+//----------------------------------------------------------------------
+static void Idle(void *arg)
+{
+}
+
+//----------------------------------------------------------------------
+//! @brief  名前でタスク情報を探す
+//----------------------------------------------------------------------
+static const MonTaskStats *Find(const MonTaskStats *stats, int count, const char *name)
+{
+	for(int i = 0; i < count; i++)
+	{
+		if(strcmp(stats[i].name, name) == 0)
+		{
+			return &stats[i];
+		}
+	}
+	return NULL;
+}
+
+//----------------------------------------------------------------------
+//! @brief  CPU使用率は前回サンプルからの区間で計算する
+//----------------------------------------------------------------------
+static void CpuShareSincePreviousSample(void)
+{
+	MonTaskStats stats[MON_MAX_TASKS];
+	TaskHandle_t worker;
+	const MonTaskStats *stat;
+	int count;
+
+	set_Initialize();
+	xTaskCreate(Idle, "worker", 1024, NULL, 3, &worker);
+	sim_AddTaskRunTime(worker, 12345);
+	mon_Sample(NULL, 0);
+
+	sim_AdvanceNs(1000000000ULL);
+	sim_AddTaskRunTime(worker, 250000);
+	count = mon_Sample(stats, MON_MAX_TASKS);
+	stat = Find(stats, count, "worker");
+	TEST_ASSERT(stat != NULL);
+	TEST_ASSERT_EQUAL_INT(250, stat->cpuPermille);
+	TEST_ASSERT_EQUAL_INT(3, stat->priority);
+	TEST_ASSERT_EQUAL_INT(1024, stat->stackFree);
+	TEST_ASSERT_EQUAL_INT('B', stat->state);
+}
+
+//----------------------------------------------------------------------
+//! @brief  スタック残量の警告はタスクごとに1回
+//----------------------------------------------------------------------
+static void StackWarningOnce(void)
+{
+	uint32_t warnings;
+
+	set_Initialize();
+	mon_Sample(NULL, 0);
+	warnings = mon_GetWarningCount();
+	xTaskCreate(Idle, "small", 200, NULL, 1, NULL);
+	mon_Sample(NULL, 0);
+	mon_Sample(NULL, 0);
+	TEST_ASSERT_EQUAL_INT(warnings + 1, mon_GetWarningCount());
+}
+
+//----------------------------------------------------------------------
+//! @brief  削除したタスクの枠は再利用される
+//----------------------------------------------------------------------
+static void DeletedTasksFreeSlots(void)
+{
+	MonTaskStats stats[MON_MAX_TASKS];
+	TaskHandle_t tasks[MON_MAX_TASKS];
+	TaskHandle_t late;
+	const MonTaskStats *stat;
+	int count;
+
+	set_Initialize();
+	for(int round = 0; round < 3; round++)
+	{
+		for(int i = 0; i < MON_MAX_TASKS - 4; i++)
+		{
+			xTaskCreate(Idle, "temp", 1024, NULL, 1, &tasks[i]);
+		}
+		mon_Sample(NULL, 0);
+		for(int i = 0; i < MON_MAX_TASKS - 4; i++)
+		{
+			vTaskDelete(tasks[i]);
+		}
+	}
+
+	xTaskCreate(Idle, "late", 1024, NULL, 1, &late);
+	mon_Sample(NULL, 0);
+	sim_AdvanceNs(1000000000ULL);
+	sim_AddTaskRunTime(late, 500000);
+	count = mon_Sample(stats, MON_MAX_TASKS);
+	stat = Find(stats, count, "late");
+	TEST_ASSERT(stat != NULL);
+	TEST_ASSERT_EQUAL_INT(500, stat->cpuPermille);
+}
+
+const TestCase test_monitorCases[] =
+{
+	{"CpuShareSincePreviousSample", CpuShareSincePreviousSample},
+	{"StackWarningOnce", StackWarningOnce},
+	{"DeletedTasksFreeSlots", DeletedTasksFreeSlots},
+	{NULL, NULL}
+};
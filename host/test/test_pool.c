@@ -0,0 +1,157 @@
+//======================================================================
+//! @file   test_pool.c
+//! @brief  pool.c 単体テスト
+//======================================================================
+#include <stdint.h>
+#include <string.h>
+
+#include "ff.h"
+
+#include "global.h"
+#include "pool.h"
+#include "test.h"
+
+//----------------------------------------------------------------------
+//! @brief  指定サイズを受け持つクラスの統計を取得
+//----------------------------------------------------------------------
+static int FindClass(size_t size, PoolClassStats *stats)
+{
+	for(int i = 0; pool_GetClassStats(i, stats) == RET_OK; i++)
+	{
+		if(size <= stats->blockSize)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+//----------------------------------------------------------------------
+//! @brief  LFN作業バッファはプールから取り、ヒープへは回さない
+//----------------------------------------------------------------------
+static void TestLfnBufferFromPool(void)
+{
+	PoolClassStats stats;
+	PoolStats pool;
+
+	pool_Initialize();
+	int index = FindClass(POOL_LFN_BLOCK_SIZE, &stats);
+	TEST_ASSERT(index >= 0);
+
+	// --wrapによりff_memalloc()はpool.cへ向く
+	for(int i = 0; i < 100; i++)
+	{
+		uint8_t *lfn = ff_memalloc(POOL_LFN_BLOCK_SIZE);
+		TEST_ASSERT(lfn != NULL);
+		memset(lfn, 0xaa, POOL_LFN_BLOCK_SIZE);
+		ff_memfree(lfn);
+	}
+
+	pool_GetClassStats(index, &stats);
+	TEST_ASSERT_EQUAL_INT(100, stats.allocCount);
+	TEST_ASSERT_EQUAL_INT(0, stats.inUse);
+	TEST_ASSERT_EQUAL_INT(1, stats.peakInUse);
+	pool_GetStats(&pool);
+	TEST_ASSERT_EQUAL_INT(0, pool.fallbackCount);
+}
+
+//----------------------------------------------------------------------
+//! @brief  クラスが枯渇したら次のクラス、最後はヒープへ回す
+//----------------------------------------------------------------------
+static void TestExhaustionFallsBack(void)
+{
+	PoolClassStats stats;
+	PoolStats pool;
+	void *blocks[64];
+	int count = 0;
+
+	pool_Initialize();
+	int classCount = pool_GetClassCount();
+
+	// 全クラスのブロック数+1個確保すると最後の1個はヒープになる
+	int total = 0;
+	for(int i = 0; i < classCount; i++)
+	{
+		pool_GetClassStats(i, &stats);
+		total += stats.blockCount;
+	}
+	TEST_ASSERT(total + 1 <= 64);
+	for(count = 0; count < total + 1; count++)
+	{
+		blocks[count] = pool_Alloc(8);
+		TEST_ASSERT(blocks[count] != NULL);
+		TEST_ASSERT_EQUAL_INT(0, (uintptr_t)blocks[count] % 4);
+	}
+
+	pool_GetClassStats(0, &stats);
+	TEST_ASSERT_EQUAL_INT(stats.blockCount, stats.inUse);
+	TEST_ASSERT_EQUAL_INT(total + 1 - stats.blockCount, stats.exhaustedCount);
+	pool_GetStats(&pool);
+	TEST_ASSERT_EQUAL_INT(1, pool.fallbackCount);
+	TEST_ASSERT_EQUAL_INT(8, pool.fallbackBytes);
+
+	for(int i = 0; i < count; i++)
+	{
+		pool_Free(blocks[i]);
+	}
+	for(int i = 0; i < classCount; i++)
+	{
+		pool_GetClassStats(i, &stats);
+		TEST_ASSERT_EQUAL_INT(0, stats.inUse);
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  PoolFallback_NoneではNULLを返して失敗を数える
+//----------------------------------------------------------------------
+static void TestFallbackNone(void)
+{
+	PoolClassStats stats;
+	PoolStats pool;
+
+	pool_Initialize();
+	pool_SetFallback(PoolFallback_None);
+	pool_GetClassStats(pool_GetClassCount() - 1, &stats);
+
+	TEST_ASSERT(pool_Alloc(stats.blockSize + 1) == NULL);
+	pool_GetStats(&pool);
+	TEST_ASSERT_EQUAL_INT(1, pool.failCount);
+	TEST_ASSERT_EQUAL_INT(0, pool.fallbackCount);
+	pool_SetFallback(PoolFallback_Heap);
+}
+
+//----------------------------------------------------------------------
+//! @brief  アリーナは終了時に容量超過分も含めて一括で返す
+//----------------------------------------------------------------------
+static void TestArena(void)
+{
+	PoolArena arena;
+	PoolClassStats stats;
+	PoolStats pool;
+
+	pool_Initialize();
+	TEST_ASSERT_EQUAL_INT(RET_OK, pool_ArenaBegin(&arena));
+	int index = FindClass(POOL_ARENA_SIZE, &stats);
+
+	uint8_t *a = pool_ArenaAlloc(&arena, 3);
+	uint8_t *b = pool_ArenaAlloc(&arena, 16);
+	TEST_ASSERT(a != NULL && b != NULL);
+	TEST_ASSERT_EQUAL_INT(4, b - a);
+	TEST_ASSERT(pool_ArenaAlloc(&arena, POOL_ARENA_SIZE) != NULL);	// 容量超過→ヒープ
+	pool_GetStats(&pool);
+	TEST_ASSERT_EQUAL_INT(1, pool.arenaOverflowCount);
+
+	pool_ArenaEnd(&arena);
+	pool_GetClassStats(index, &stats);
+	TEST_ASSERT_EQUAL_INT(0, stats.inUse);
+	TEST_ASSERT(arena.base == NULL);
+}
+
+const TestCase test_poolCases[] =
+{
+	{"LfnBufferFromPool", TestLfnBufferFromPool},
+	{"ExhaustionFallsBack", TestExhaustionFallsBack},
+	{"FallbackNone", TestFallbackNone},
+	{"Arena", TestArena},
+	{NULL, NULL}
+};
@@ -0,0 +1,141 @@
+//======================================================================
+//! @file   test_rtctime.c
+//! @brief  rtctime.c 単体テスト
+//======================================================================
+#include <stdint.h>
+
+#include "esp_sleep.h"
+
+#include "global.h"
+#include "rtctime.h"
+#include "sim.h"
+#include "test.h"
+
+#define SYNC_US		(1700000000LL * 1000000)	// 最初の同期時刻
+
+//----------------------------------------------------------------------
+//! @brief  眠って起床し、時刻を復元する(sleeplog_Sleep()と起動直後の処理)
+//----------------------------------------------------------------------
+static void SleepAndWake(uint64_t sleepUs)
+{
+	rtctime_PrepareSleep(sleepUs);
+	esp_deep_sleep(sleepUs);
+	sim_DeepSleepWake();
+	rtctime_Restore();
+}
+
+//----------------------------------------------------------------------
+//! @brief  電源投入直後は時刻不明で、同期が必要
+//----------------------------------------------------------------------
+static void PowerOnHasNoTime(void)
+{
+	int64_t nowUs;
+
+	TEST_ASSERT_EQUAL_INT(RET_NG, rtctime_Restore());
+	TEST_ASSERT_EQUAL_INT(RET_NG, rtctime_GetTime(&nowUs));
+	TEST_ASSERT(rtctime_IsSyncDue());
+
+	rtctime_Sync(SYNC_US);
+	sim_AdvanceNs(1500000000ULL);
+	TEST_ASSERT_EQUAL_INT(RET_OK, rtctime_GetTime(&nowUs));
+	TEST_ASSERT_EQUAL_INT(SYNC_US + 1500000, nowUs);
+	TEST_ASSERT(!rtctime_IsSyncDue());
+}
+
+//----------------------------------------------------------------------
+//! @brief  リセットでは最後の保存時刻+起動時間、ディープスリープではさらにスリープ時間を足す
+//----------------------------------------------------------------------
+static void RestoreAfterResetAndSleep(void)
+{
+	int64_t nowUs;
+
+	rtctime_Restore();
+	rtctime_Sync(SYNC_US);
+	sim_AdvanceNs(5000000000ULL);
+	rtctime_Save();
+	sim_ResetButton();
+	TEST_ASSERT_EQUAL_INT(RET_OK, rtctime_Restore());
+	rtctime_GetTime(&nowUs);
+	TEST_ASSERT_EQUAL_INT(SYNC_US + 5000000 + BOOT_TIME_US, nowUs);
+
+	SleepAndWake(60000000);
+	rtctime_GetTime(&nowUs);
+	TEST_ASSERT_EQUAL_INT(SYNC_US + 65000000 + 2 * BOOT_TIME_US, nowUs);
+
+	// 復元した時刻は保存し直すので、続けてリセットしてもスリープ時間を二重に足さない
+	sim_ResetButton();
+	rtctime_Restore();
+	rtctime_GetTime(&nowUs);
+	TEST_ASSERT_EQUAL_INT(SYNC_US + 65000000 + 3 * BOOT_TIME_US, nowUs);
+}
+
+//----------------------------------------------------------------------
+//! @brief  スリープ中の遅れを同期で測って補正し、誤差がなくなれば同期間隔を延ばす
+//! @note	RTCスロークロックが2%速く、実際の経過時間は公称スリープ時間の1.02倍とする.
+//----------------------------------------------------------------------
+static void SleepDriftIsCorrected(void)
+{
+	RtcTimeStatus status;
+	int64_t nowUs, trueUs = SYNC_US;
+
+	rtctime_Restore();
+	rtctime_Sync(SYNC_US);
+	for(int i = 0; i < 20; i++)
+	{
+		SleepAndWake(60000000);
+		trueUs += 60000000LL * 102 / 100 + BOOT_TIME_US;
+	}
+	rtctime_GetTime(&nowUs);
+	TEST_ASSERT_EQUAL_INT(24000000, trueUs - nowUs);
+	rtctime_Sync(trueUs);
+	rtctime_GetStatus(&status);
+	TEST_ASSERT_EQUAL_INT(20000, status.sleepPpm);
+	TEST_ASSERT_EQUAL_INT(24000, status.lastErrorMs);
+	TEST_ASSERT_EQUAL_INT(RTCTIME_SYNC_MIN_S, status.syncIntervalS);
+
+	for(int i = 0; i < 20; i++)
+	{
+		SleepAndWake(60000000);
+		trueUs += 60000000LL * 102 / 100 + BOOT_TIME_US;
+	}
+	rtctime_GetTime(&nowUs);
+	TEST_ASSERT_EQUAL_INT(trueUs, nowUs);
+	rtctime_Sync(trueUs);
+	rtctime_GetStatus(&status);
+	TEST_ASSERT_EQUAL_INT(0, status.lastErrorMs);
+	TEST_ASSERT_EQUAL_INT(RTCTIME_SYNC_MAX_S, status.syncIntervalS);
+	TEST_ASSERT_EQUAL_INT(3, status.syncCount);
+}
+
+//----------------------------------------------------------------------
+//! @brief  同期間隔は誤差が許容誤差に届くまでの時間(起きている間の誤差はスリープの補正に使わない)
+//----------------------------------------------------------------------
+static void SyncIntervalFollowsDrift(void)
+{
+	RtcTimeStatus status;
+	int64_t nowUs;
+
+	rtctime_Restore();
+	rtctime_Sync(SYNC_US);
+	sim_AdvanceNs(35995ULL * 1000000000);		// 10時間で5秒遅れる
+	rtctime_GetTime(&nowUs);
+	TEST_ASSERT(rtctime_IsSyncDue());
+	rtctime_Sync(nowUs + 5000000);
+	rtctime_GetStatus(&status);
+	TEST_ASSERT_EQUAL_INT(0, status.sleepPpm);
+	TEST_ASSERT_EQUAL_INT(7200, status.syncIntervalS);
+
+	sim_AdvanceNs(7199ULL * 1000000000);
+	TEST_ASSERT(!rtctime_IsSyncDue());
+	sim_AdvanceNs(1000000000);
+	TEST_ASSERT(rtctime_IsSyncDue());
+}
+
+const TestCase test_rtctimeCases[] =
+{
+	{"PowerOnHasNoTime", PowerOnHasNoTime},
+	{"RestoreAfterResetAndSleep", RestoreAfterResetAndSleep},
+	{"SleepDriftIsCorrected", SleepDriftIsCorrected},
+	{"SyncIntervalFollowsDrift", SyncIntervalFollowsDrift},
+	{NULL, NULL}
+};
@@ -0,0 +1,496 @@
+//======================================================================
+//! @file   test_sd.c
+//! @brief  sd.c 単体テスト
+//! @note	FatFsから呼ばれるディスクI/O関数(ff_disk_*)経由で、
+//! 		模擬SDカードに対する初期化・読込・書込を確認する.
+//======================================================================
+#include <string.h>
+
+#include "diskio.h"
+#include "ff.h"
+
+#include "global.h"
+#include "setup.h"
+#include "sd.h"
+#include "sim.h"
+#include "test.h"
+
+static const BYTE pdrv = 0;		// sim_Reset()後に最初に割り当てられるドライブ番号
+
+//----------------------------------------------------------------------
+//! @brief  テストパターン作成
+//----------------------------------------------------------------------
+static void FillPattern(uint8_t *buff, int size, uint32_t seed)
+{
+	for(int i = 0; i < size; i++)
+	{
+		seed = seed * 1103515245UL + 12345UL;
+		buff[i] = (uint8_t)(seed >> 16);
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  SDHCの識別と容量・消去単位取得
+//----------------------------------------------------------------------
+static void InitializeSdhc(void)
+{
+	SimSdConfig config;
+	DWORD sectors = 0, blockSize = 0;
+	WORD sectorSize = 0;
+
+	sim_SdDefaultConfig(&config);
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(0, disk_status(pdrv));
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_ioctl(pdrv, GET_SECTOR_COUNT, &sectors));
+	TEST_ASSERT_EQUAL_INT(config.sectors, sectors);
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_ioctl(pdrv, GET_SECTOR_SIZE, &sectorSize));
+	TEST_ASSERT_EQUAL_INT(512, sectorSize);
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_ioctl(pdrv, GET_BLOCK_SIZE, &blockSize));
+	TEST_ASSERT_EQUAL_INT(8192, blockSize);
+}
+
+//----------------------------------------------------------------------
+//! @brief  SDSC(バイトアドレス, CSD Ver.1)
+//----------------------------------------------------------------------
+static void InitializeSdsc(void)
+{
+	SimSdConfig config;
+	DWORD sectors = 0, blockSize = 0;
+	uint8_t data[512], readData[512];
+
+	sim_SdDefaultConfig(&config);
+	config.type = SimSd_Sdsc;
+	config.sectors = 512 * 256;
+	sim_SdInsert(&config);
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(0, disk_status(pdrv));
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_ioctl(pdrv, GET_SECTOR_COUNT, &sectors));
+	TEST_ASSERT_EQUAL_INT(config.sectors, sectors);
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_ioctl(pdrv, GET_BLOCK_SIZE, &blockSize));
+	TEST_ASSERT_EQUAL_INT(128, blockSize);
+
+	FillPattern(data, sizeof(data), 7);
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_write(pdrv, data, 100, 1));
+	TEST_ASSERT_EQUAL_MEMORY(data, sim_SdSector(100), sizeof(data));
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_read(pdrv, readData, 100, 1));
+	TEST_ASSERT_EQUAL_MEMORY(data, readData, sizeof(data));
+}
+
+//----------------------------------------------------------------------
+//! @brief  SDXC(64GB, CSD Ver.2)は容量をそのまま返し、最終セクタまで読み書きできる
+//----------------------------------------------------------------------
+static void InitializeSdxc(void)
+{
+	SimSdConfig config;
+	DWORD sectors = 0, blockSize = 0;
+	uint8_t data[512], readData[512];
+
+	sim_SdDefaultConfig(&config);
+	config.sectors = 64UL * 1024 * 1024 * 2;
+	config.auSizeCode = 15;				// 64MiB
+	sim_SdInsert(&config);
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(0, disk_status(pdrv));
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_ioctl(pdrv, GET_SECTOR_COUNT, &sectors));
+	TEST_ASSERT_EQUAL_INT(config.sectors, sectors);
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_ioctl(pdrv, GET_BLOCK_SIZE, &blockSize));
+	TEST_ASSERT_EQUAL_INT(131072, blockSize);
+
+	FillPattern(data, sizeof(data), 11);
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_write(pdrv, data, sectors - 1, 1));
+	TEST_ASSERT_EQUAL_MEMORY(data, sim_SdSector(sectors - 1), sizeof(data));
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_read(pdrv, readData, sectors - 1, 1));
+	TEST_ASSERT_EQUAL_MEMORY(data, readData, sizeof(data));
+	TEST_ASSERT(disk_read(pdrv, readData, sectors, 1) != RES_OK);
+}
+
+//----------------------------------------------------------------------
+//! @brief  カードなしはタイムアウトで未初期化のまま
+//----------------------------------------------------------------------
+static void InitializeNoCard(void)
+{
+	uint8_t buff[512];
+	sim_SdRemove();
+	set_Initialize();
+	TEST_ASSERT(disk_status(pdrv) & STA_NOINIT);
+	TEST_ASSERT_EQUAL_INT(RES_NOTRDY, disk_read(pdrv, buff, 0, 1));
+	TEST_ASSERT(sim_GetTimeNs() >= 500000000ULL);
+}
+
+//----------------------------------------------------------------------
+//! @brief  1セクタ書込・読込
+//----------------------------------------------------------------------
+static void WriteReadSingle(void)
+{
+	uint8_t data[512], readData[512];
+	set_Initialize();
+	FillPattern(data, sizeof(data), 1);
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_write(pdrv, data, 1234, 1));
+	TEST_ASSERT_EQUAL_MEMORY(data, sim_SdSector(1234), sizeof(data));
+
+	FillPattern(sim_SdSector(99), 512, 2);
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_read(pdrv, readData, 99, 1));
+	TEST_ASSERT_EQUAL_MEMORY(sim_SdSector(99), readData, sizeof(readData));
+}
+
+//----------------------------------------------------------------------
+//! @brief  マルチブロック書込・読込
+//----------------------------------------------------------------------
+static void WriteReadMulti(void)
+{
+	uint8_t data[512 * 4], readData[512 * 4];
+	SimSdStats stats;
+	set_Initialize();
+	FillPattern(data, sizeof(data), 3);
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_write(pdrv, data, 2000, 4));
+	for(int i = 0; i < 4; i++)
+	{
+		TEST_ASSERT_EQUAL_MEMORY(&data[i * 512], sim_SdSector(2000 + i), 512);
+	}
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_read(pdrv, readData, 2000, 4));
+	TEST_ASSERT_EQUAL_MEMORY(data, readData, sizeof(data));
+	sim_SdGetStats(&stats);
+	TEST_ASSERT_EQUAL_INT(0, stats.illegalCommands);
+}
+
+//----------------------------------------------------------------------
+//! @brief  4byte境界にないバッファ
+//----------------------------------------------------------------------
+static void UnalignedBuffers(void)
+{
+	uint32_t storage[(512 * 3 + 4) / 4];
+	uint8_t data[512 * 3];
+	uint8_t *buff;
+	set_Initialize();
+
+	for(int offset = 1; offset < 4; offset++)
+	{
+		buff = (uint8_t *)storage + offset;
+		FillPattern(data, sizeof(data), offset);
+
+		// 書込(シングル, マルチ)
+		memcpy(buff, data, sizeof(data));
+		TEST_ASSERT_EQUAL_INT(RES_OK, disk_write(pdrv, buff, 10, 1));
+		TEST_ASSERT_EQUAL_MEMORY(data, sim_SdSector(10), 512);
+		TEST_ASSERT_EQUAL_INT(RES_OK, disk_write(pdrv, buff, 20, 3));
+		for(int i = 0; i < 3; i++)
+		{
+			TEST_ASSERT_EQUAL_MEMORY(&data[i * 512], sim_SdSector(20 + i), 512);
+		}
+
+		// 読込(シングル, マルチ)
+		memset(storage, 0, sizeof(storage));
+		TEST_ASSERT_EQUAL_INT(RES_OK, disk_read(pdrv, buff, 10, 1));
+		TEST_ASSERT_EQUAL_MEMORY(data, buff, 512);
+		memset(storage, 0, sizeof(storage));
+		TEST_ASSERT_EQUAL_INT(RES_OK, disk_read(pdrv, buff, 20, 3));
+		TEST_ASSERT_EQUAL_MEMORY(data, buff, sizeof(data));
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  範囲外セクタはエラー
+//----------------------------------------------------------------------
+static void OutOfRange(void)
+{
+	SimSdConfig config;
+	uint8_t buff[512] = {0};
+	sim_SdDefaultConfig(&config);
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(RES_ERROR, disk_read(pdrv, buff, config.sectors, 1));
+	TEST_ASSERT_EQUAL_INT(RES_ERROR, disk_write(pdrv, buff, config.sectors, 1));
+	// エラー後も通常通りアクセスできる
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_read(pdrv, buff, 0, 1));
+}
+
+//----------------------------------------------------------------------
+//! @brief  ブートセクタ署名の有無でマウント結果が変わる
+//----------------------------------------------------------------------
+static void MountRequiresSignature(void)
+{
+	uint8_t *boot = sim_SdSector(0);
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(RET_NG, sd_Mount());
+
+	boot[510] = 0x55;
+	boot[511] = 0xaa;
+	TEST_ASSERT_EQUAL_INT(RET_OK, sd_Mount());
+}
+
+//----------------------------------------------------------------------
+//! @brief  exFATのブートセクタは実機と同じ設定(FF_FS_EXFAT=0)ではマウントできない
+//----------------------------------------------------------------------
+static void MountExfatFails(void)
+{
+	uint8_t *boot = sim_SdSector(0);
+	FATFS fs;
+
+	memcpy(boot, "\xeb\x76\x90" "EXFAT   ", 11);
+	boot[510] = 0x55;
+	boot[511] = 0xaa;
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(RET_NG, sd_Mount());
+	TEST_ASSERT_EQUAL_INT(FR_NO_FILESYSTEM, f_mount(&fs, "0:", 1));
+
+	memset(boot, 0, 11);
+	TEST_ASSERT_EQUAL_INT(RET_OK, sd_Mount());
+	TEST_ASSERT_EQUAL_INT(FR_OK, f_mount(&fs, "0:", 1));
+	TEST_ASSERT_EQUAL_INT(FS_FAT32, fs.fs_type);
+}
+
+//----------------------------------------------------------------------
+//! @brief  コマンドごとのタイムアウト用タイマがヒープに残らない
+//----------------------------------------------------------------------
+static void NoTimerLeak(void)
+{
+	uint8_t buff[512 * 2];
+	SimHeapStats before, after;
+	set_Initialize();
+	sim_GetHeapStats(&before);
+	for(int i = 0; i < 10; i++)
+	{
+		TEST_ASSERT_EQUAL_INT(RES_OK, disk_read(pdrv, buff, i, 2));
+		TEST_ASSERT_EQUAL_INT(RES_OK, disk_write(pdrv, buff, i, 1));
+	}
+	sim_GetHeapStats(&after);
+	TEST_ASSERT_EQUAL_INT(before.inUseBytes, after.inUseBytes);
+}
+
+//----------------------------------------------------------------------
+//! @brief  書込後のビジー長期化はタイムアウト未満なら成功し、その分だけ遅れる
+//----------------------------------------------------------------------
+static void FaultWriteStall(void)
+{
+	SimSdFaults faults = {0};
+	SimSdStats stats;
+	uint8_t buff[512] = {0};
+
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(0, disk_status(pdrv));
+	faults.seed = 1;
+	faults.writeStallPpm = 1000000;
+	faults.writeStallMinUs = 200000;
+	faults.writeStallMaxUs = 200000;
+	sim_SdSetFaults(&faults);
+
+	uint64_t start = sim_GetTimeNs();
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_write(pdrv, buff, 10, 1));
+	TEST_ASSERT(sim_GetTimeNs() - start >= 200000000ULL);
+	sim_SdGetStats(&stats);
+	TEST_ASSERT_EQUAL_INT(1, stats.injectedStalls);
+
+	// タイムアウト(500ms)を超えるビジーは書込エラー.ビジーが明ければ回復する
+	faults.writeStallMinUs = faults.writeStallMaxUs = 800000;
+	sim_SdSetFaults(&faults);
+	TEST_ASSERT_EQUAL_INT(RES_ERROR, disk_write(pdrv, buff, 11, 1));
+	sim_SdSetFaults(NULL);
+	sim_AdvanceNs(400000000ULL);
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_write(pdrv, buff, 11, 1));
+}
+
+//----------------------------------------------------------------------
+//! @brief  書込CRCエラーと無応答は書込エラーになり、次のアクセスは成功する
+//----------------------------------------------------------------------
+static void FaultCrcAndTimeout(void)
+{
+	SimSdFaults faults = {0};
+	SdCounters counters;
+	uint8_t buff[512] = {0};
+
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(0, disk_status(pdrv));
+	faults.crcErrorPpm = 1000000;
+	sim_SdSetFaults(&faults);
+	TEST_ASSERT_EQUAL_INT(RES_ERROR, disk_write(pdrv, buff, 10, 1));
+
+	faults.crcErrorPpm = 0;
+	faults.timeoutPpm = 1000000;
+	sim_SdSetFaults(&faults);
+	TEST_ASSERT_EQUAL_INT(RES_ERROR, disk_read(pdrv, buff, 10, 1));
+	sd_GetCounters(&counters);
+	TEST_ASSERT_EQUAL_INT(1, counters.timeoutCount);
+
+	sim_SdSetFaults(NULL);
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_write(pdrv, buff, 10, 1));
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_read(pdrv, buff, 10, 1));
+}
+
+//----------------------------------------------------------------------
+//! @brief  同じシードなら同じ順序で障害が起きる
+//----------------------------------------------------------------------
+static void FaultSeedReproducible(void)
+{
+	SimSdFaults faults = {0};
+	uint8_t buff[512] = {0};
+	uint32_t failures[2] = {0, 0};
+
+	faults.seed = 12345;
+	faults.crcErrorPpm = 300000;
+	for(int run = 0; run < 2; run++)
+	{
+		sim_Reset();
+		set_Initialize();
+		sim_SdSetFaults(&faults);
+		for(int i = 0; i < 32; i++)
+		{
+			failures[run] = (failures[run] << 1) | (disk_write(pdrv, buff, i, 1) != RES_OK);
+		}
+	}
+	TEST_ASSERT(failures[0] != 0);
+	TEST_ASSERT_EQUAL_INT(failures[0], failures[1]);
+}
+
+//----------------------------------------------------------------------
+//! @brief  書込回数: 区間は正確, 上位セクタは模擬カードの実回数を誤差内で含む
+//----------------------------------------------------------------------
+static void WearTracking(void)
+{
+	uint8_t buff[512 * 64];
+	SimSdStats before, after;
+	SimSdHotSector hot[2];
+	SdWear wear;
+
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(0, disk_status(pdrv));
+	sd_ClearWear();
+	sim_SdGetStats(&before);
+	FillPattern(buff, sizeof(buff), 3);
+	for(int i = 0; i < 50; i++)
+	{
+		TEST_ASSERT_EQUAL_INT(RES_OK, disk_write(pdrv, buff, 100, 1));
+		if(i < 20)
+		{
+			TEST_ASSERT_EQUAL_INT(RES_OK, disk_write(pdrv, buff, 5000, 1));
+		}
+	}
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_write(pdrv, buff, 1000, 64));
+	sim_SdGetStats(&after);
+	sd_GetWear(&wear);
+
+	TEST_ASSERT_EQUAL_INT(after.sectorsWritten - before.sectorsWritten, wear.sectorsWritten);
+	TEST_ASSERT_EQUAL_INT(64 * 2048 / SD_WEAR_BUCKETS, wear.bucketSectors);
+	TEST_ASSERT_EQUAL_INT(50 + 64, wear.buckets[0]);
+	TEST_ASSERT_EQUAL_INT(20, wear.buckets[5000 / wear.bucketSectors]);
+
+	TEST_ASSERT_EQUAL_INT(2, sim_SdGetHotSectors(hot, 2));
+	TEST_ASSERT_EQUAL_INT(100, hot[0].sector);
+	TEST_ASSERT_EQUAL_INT(50, hot[0].writes);
+	TEST_ASSERT_EQUAL_INT(5000, hot[1].sector);
+	for(int i = 0; i < 2; i++)
+	{
+		TEST_ASSERT_EQUAL_INT(hot[i].sector, wear.hot[i].sector);
+		TEST_ASSERT(wear.hot[i].count >= hot[i].writes);
+		TEST_ASSERT(wear.hot[i].count - wear.hot[i].error <= hot[i].writes);
+	}
+	sd_ClearWear();
+	sd_GetWear(&wear);
+	TEST_ASSERT_EQUAL_INT(0, wear.sectorsWritten);
+	TEST_ASSERT_EQUAL_INT(0, wear.hot[0].count);
+}
+
+//----------------------------------------------------------------------
+//! @brief  リトルエンディアン読込
+//----------------------------------------------------------------------
+static uint32_t GetLe(const uint8_t *buff, int bytes)
+{
+	uint32_t value = 0;
+	for(int i = bytes - 1; i >= 0; i--)
+	{
+		value = (value << 8) | buff[i];
+	}
+	return value;
+}
+
+//----------------------------------------------------------------------
+//! @brief  フォーマットはパーティション・FAT・データ領域をAU境界に置き、マウントできる
+//----------------------------------------------------------------------
+static void FormatAligned(void)
+{
+	SimSdConfig config;
+	SdFormat format;
+
+	sim_SdDefaultConfig(&config);
+	config.sectors = 4UL * 1024 * 1024 * 2;		// 4GB, AU 4MiB
+	sim_SdInsert(&config);
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(0, disk_status(pdrv));
+	TEST_ASSERT_EQUAL_INT(RET_OK, sd_Format(&format));
+	TEST_ASSERT_EQUAL_INT(8192, format.alignSectors);
+	TEST_ASSERT_EQUAL_INT(8192, format.volumeSector);
+	TEST_ASSERT_EQUAL_INT(0, format.fatSector % 8192);
+	TEST_ASSERT_EQUAL_INT(0, format.dataSector % 8192);
+	TEST_ASSERT_EQUAL_INT(64, format.clusterSectors);
+	TEST_ASSERT(format.fatSectors * 128 >= format.clusters + 2);
+	TEST_ASSERT_EQUAL_INT((config.sectors - format.dataSector) / 64, format.clusters);
+
+	// MBR, VBR(BPB), FSINFO, バックアップ, FAT先頭
+	const uint8_t *mbr = sim_SdSector(0);
+	TEST_ASSERT_EQUAL_INT(0x0c, mbr[446 + 4]);
+	TEST_ASSERT_EQUAL_INT(format.volumeSector, GetLe(&mbr[446 + 8], 4));
+	TEST_ASSERT_EQUAL_INT(format.volumeSectors, GetLe(&mbr[446 + 12], 4));
+	const uint8_t *vbr = sim_SdSector(format.volumeSector);
+	TEST_ASSERT_EQUAL_INT(512, GetLe(&vbr[11], 2));
+	TEST_ASSERT_EQUAL_INT(64, vbr[13]);
+	TEST_ASSERT_EQUAL_INT(format.fatSector - format.volumeSector, GetLe(&vbr[14], 2));
+	TEST_ASSERT_EQUAL_INT(format.fatSectors, GetLe(&vbr[36], 4));
+	TEST_ASSERT_EQUAL_INT(0xaa55, GetLe(&vbr[510], 2));
+	TEST_ASSERT_EQUAL_MEMORY(vbr, sim_SdSector(format.volumeSector + 6), 512);
+	const uint8_t *fsinfo = sim_SdSector(format.volumeSector + 1);
+	TEST_ASSERT_EQUAL_INT(0x41615252UL, GetLe(&fsinfo[0], 4));
+	TEST_ASSERT_EQUAL_INT(format.clusters - 1, GetLe(&fsinfo[488], 4));
+	for(int fat = 0; fat < 2; fat++)
+	{
+		const uint8_t *entries = sim_SdSector(format.fatSector + fat * format.fatSectors);
+		TEST_ASSERT_EQUAL_INT(0x0ffffff8UL, GetLe(&entries[0], 4));
+		TEST_ASSERT_EQUAL_INT(0x0fffffffUL, GetLe(&entries[8], 4));
+	}
+	TEST_ASSERT_EQUAL_INT(RET_OK, sd_Mount());
+}
+
+//----------------------------------------------------------------------
+//! @brief  クラスタサイズはFAT32の最小クラスタ数を満たす最大の大きさ
+//----------------------------------------------------------------------
+static void FormatClusterSize(void)
+{
+	SdFormat format;
+
+	// 64GB, AU 64MiB: 予約領域に収まらないのでFAT先頭は合わせない
+	TEST_ASSERT_EQUAL_INT(RET_OK, sd_CalcFormat(64UL * 1024 * 1024 * 2, 131072, &format));
+	TEST_ASSERT_EQUAL_INT(131072, format.volumeSector);
+	TEST_ASSERT_EQUAL_INT(32, format.fatSector - format.volumeSector);
+	TEST_ASSERT_EQUAL_INT(0, format.dataSector % 131072);
+	TEST_ASSERT_EQUAL_INT(64, format.clusterSectors);
+
+	// 1GB: 32KiBでは65526クラスタに届かない
+	TEST_ASSERT_EQUAL_INT(RET_OK, sd_CalcFormat(1024UL * 1024 * 2, 8192, &format));
+	TEST_ASSERT_EQUAL_INT(16, format.clusterSectors);
+	TEST_ASSERT(format.clusters >= 65526);
+
+	// AU不明(0)は4MiB, 小さすぎるカードはFAT32にできない
+	TEST_ASSERT_EQUAL_INT(RET_OK, sd_CalcFormat(64UL * 1024 * 2, 0, &format));
+	TEST_ASSERT_EQUAL_INT(8192, format.alignSectors);
+	TEST_ASSERT_EQUAL_INT(1, format.clusterSectors);
+	TEST_ASSERT_EQUAL_INT(RET_NG, sd_CalcFormat(32UL * 1024 * 2, 8192, &format));
+}
+
+const TestCase test_sdCases[] =
+{
+	{"InitializeSdhc", InitializeSdhc},
+	{"InitializeSdsc", InitializeSdsc},
+	{"InitializeSdxc", InitializeSdxc},
+	{"InitializeNoCard", InitializeNoCard},
+	{"WriteReadSingle", WriteReadSingle},
+	{"WriteReadMulti", WriteReadMulti},
+	{"UnalignedBuffers", UnalignedBuffers},
+	{"OutOfRange", OutOfRange},
+	{"MountRequiresSignature", MountRequiresSignature},
+	{"MountExfatFails", MountExfatFails},
+	{"NoTimerLeak", NoTimerLeak},
+	{"FaultWriteStall", FaultWriteStall},
+	{"FaultCrcAndTimeout", FaultCrcAndTimeout},
+	{"FaultSeedReproducible", FaultSeedReproducible},
+	{"WearTracking", WearTracking},
+	{"FormatAligned", FormatAligned},
+	{"FormatClusterSize", FormatClusterSize},
+	{NULL, NULL}
+};
@@ -0,0 +1,224 @@
+//======================================================================
+//! @file   test_series.c
+//! @brief  series.c 単体テスト
+//======================================================================
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "global.h"
+#include "series.h"
+#include "test.h"
+
+#define SAMPLE_COUNT	10000
+
+static uint8_t s_out[SAMPLE_COUNT * 24];		// 出力
+static size_t s_outLength;
+static SeriesSample s_samples[SAMPLE_COUNT];
+static SeriesSample s_decoded[SAMPLE_COUNT];
+
+//----------------------------------------------------------------------
+//! @brief  出力先(メモリ)
+//----------------------------------------------------------------------
+static int Sink(void *context, const void *data, size_t length)
+{
+	if(s_outLength + length > sizeof(s_out))
+	{
+		return RET_NG;
+	}
+	memcpy(&s_out[s_outLength], data, length);
+	s_outLength += length;
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  全サンプルを書く
+//----------------------------------------------------------------------
+static int Encode(SeriesFormat format, const SeriesSample *samples, size_t count)
+{
+	SeriesWriter writer;
+
+	s_outLength = 0;
+	series_Begin(&writer, format, 0.0625f, -10.0f, Sink, NULL);
+	for(size_t i = 0; i < count; i += SERIES_READ_BLOCK)
+	{
+		size_t block = (count - i < SERIES_READ_BLOCK) ? count - i : SERIES_READ_BLOCK;
+		if(series_Write(&writer, &samples[i], block) != RET_OK)
+		{
+			return RET_NG;
+		}
+	}
+	return series_End(&writer);
+}
+
+//----------------------------------------------------------------------
+//! @brief  可変長整数を読む
+//----------------------------------------------------------------------
+static uint32_t GetVarint(size_t *position)
+{
+	uint32_t value = 0;
+	for(int shift = 0; *position < s_outLength; shift += 7)
+	{
+		uint8_t c = s_out[(*position)++];
+		value |= (uint32_t)(c & 0x7f) << shift;
+		if(!(c & 0x80))
+		{
+			break;
+		}
+	}
+	return value;
+}
+
+//----------------------------------------------------------------------
+//! @brief  バイナリ形式を読む("/"ページのdecode()と同じ手順)
+//! @return	サンプル数
+//----------------------------------------------------------------------
+static size_t Decode(SeriesSample *samples)
+{
+	size_t position = SERIES_HEADER_SIZE, count = 0;
+	uint32_t timeS = s_out[4] | s_out[5] << 8 | s_out[6] << 16 | (uint32_t)s_out[7] << 24;
+	int32_t deltaS = 0, value = 0;
+
+	while(position < s_outLength)
+	{
+		uint32_t z = GetVarint(&position);
+		deltaS += (z & 1) ? -(int32_t)(z >> 1) - 1 : (int32_t)(z >> 1);
+		timeS += deltaS;
+		uint32_t token = GetVarint(&position);
+		if(token != 0)
+		{
+			z = token - 1;
+			value += (z & 1) ? -(int32_t)(z >> 1) - 1 : (int32_t)(z >> 1);
+		}
+		samples[count].timeS = timeS;
+		samples[count].value = (token != 0) ? (int16_t)value : SERIES_NO_VALUE;
+		count++;
+	}
+	return count;
+}
+
+//----------------------------------------------------------------------
+//! @brief  1分間隔でゆっくり変わる値(気温相当)を作る
+//----------------------------------------------------------------------
+static void MakeSamples(void)
+{
+	uint32_t random = 1;
+	int value = 400;
+
+	for(int i = 0; i < SAMPLE_COUNT; i++)
+	{
+		random = random * 1103515245 + 12345;
+		value += (int)((random >> 16) % 5) - 2;
+		s_samples[i].timeS = 1700000000 + i * 60;
+		s_samples[i].value = (int16_t)value;
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  バイナリ形式は欠測・間隔の乱れ・大きな変化・値なしを含めて元に戻る
+//----------------------------------------------------------------------
+static void BinaryRoundTrip(void)
+{
+	float scale;
+	static const SeriesSample samples[] =
+	{
+		{1700000000, 100}, {1700000060, 101}, {1700000120, 99}, {1700000300, -32767},
+		{1700000360, SERIES_NO_VALUE}, {1700000420, 32767}, {1700000421, 0}, {1800000000, 5},
+	};
+	const size_t count = sizeof(samples) / sizeof(samples[0]);
+
+	TEST_ASSERT_EQUAL_INT(RET_OK, Encode(Series_Binary, samples, count));
+	TEST_ASSERT_EQUAL_MEMORY(SERIES_MAGIC, s_out, 4);
+	memcpy(&scale, &s_out[8], 4);
+	TEST_ASSERT(scale == 0.0625f);
+	TEST_ASSERT_EQUAL_INT(count, Decode(s_decoded));
+	for(size_t i = 0; i < count; i++)
+	{
+		TEST_ASSERT_EQUAL_INT(samples[i].timeS, s_decoded[i].timeS);
+		TEST_ASSERT_EQUAL_INT(samples[i].value, s_decoded[i].value);
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  JSON形式
+//----------------------------------------------------------------------
+static void JsonFormat(void)
+{
+	static const SeriesSample samples[] = {{1700000000, 100}, {1700000060, SERIES_NO_VALUE}, {1700000120, -3}};
+
+	TEST_ASSERT_EQUAL_INT(RET_OK, Encode(Series_Json, samples, 3));
+	s_out[s_outLength] = '\0';
+	TEST_ASSERT(strcmp((char *)s_out, "{\"scale\":0.0625,\"offset\":-10,\"samples\":[[1700000000,100],[1700000060,null],[1700000120,-3]]}\n") == 0);
+
+	TEST_ASSERT_EQUAL_INT(RET_OK, Encode(Series_Json, samples, 0));
+	s_out[s_outLength] = '\0';
+	TEST_ASSERT(strcmp((char *)s_out, "{\"scale\":0.0625,\"offset\":-10,\"samples\":[]}\n") == 0);
+	TEST_ASSERT_EQUAL_INT(RET_OK, Encode(Series_Binary, samples, 0));
+	TEST_ASSERT_EQUAL_INT(SERIES_HEADER_SIZE, s_outLength);
+}
+
+//----------------------------------------------------------------------
+//! @brief  1万サンプルでバイナリ形式は1サンプル約2byte, JSONの1/8以下
+//----------------------------------------------------------------------
+static void BinaryIsCompact(void)
+{
+	size_t jsonLength;
+
+	MakeSamples();
+	TEST_ASSERT_EQUAL_INT(RET_OK, Encode(Series_Json, s_samples, SAMPLE_COUNT));
+	jsonLength = s_outLength;
+	TEST_ASSERT_EQUAL_INT(RET_OK, Encode(Series_Binary, s_samples, SAMPLE_COUNT));
+	TEST_ASSERT_EQUAL_INT(SERIES_HEADER_SIZE + 2 * SAMPLE_COUNT + 1, s_outLength);	// 先頭の値だけ2byte
+	TEST_ASSERT(jsonLength >= 8 * s_outLength);
+	TEST_ASSERT_EQUAL_INT(SAMPLE_COUNT, Decode(s_decoded));
+	for(int i = 0; i < SAMPLE_COUNT; i++)
+	{
+		TEST_ASSERT_EQUAL_INT(s_samples[i].timeS, s_decoded[i].timeS);
+		TEST_ASSERT_EQUAL_INT(s_samples[i].value, s_decoded[i].value);
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  sleeplogのCSVを読む(見出し・時刻なしの行とfromより前は飛ばす)
+//----------------------------------------------------------------------
+static void ReadCsv(void)
+{
+	const char *path = "test_series.csv";
+	SeriesSample samples[4];
+	FILE *fp = fopen(path, "w");
+
+	TEST_ASSERT(fp != NULL);
+	fprintf(fp, "sequence,elapsed_s,unix_s,value\n0,0,,12\n1,60,1700000060,13\n2,120,1700000120,\n3,180,1700000180,-4\n");
+	for(int i = 4; i < 10; i++)
+	{
+		fprintf(fp, "%d,%d,%d,%d\n", i, i * 60, 1700000000 + i * 60, i);
+	}
+	fclose(fp);
+
+	fp = fopen(path, "r");
+	TEST_ASSERT(fp != NULL);
+	TEST_ASSERT_EQUAL_INT(4, series_ReadCsv(fp, 1700000100, UINT32_MAX, samples, 4));
+	TEST_ASSERT_EQUAL_INT(1700000120, samples[0].timeS);
+	TEST_ASSERT_EQUAL_INT(SERIES_NO_VALUE, samples[0].value);
+	TEST_ASSERT_EQUAL_INT(-4, samples[1].value);
+	TEST_ASSERT_EQUAL_INT(5, samples[3].value);
+	TEST_ASSERT_EQUAL_INT(4, series_ReadCsv(fp, 1700000100, UINT32_MAX, samples, 4));
+	TEST_ASSERT_EQUAL_INT(9, samples[3].value);
+	TEST_ASSERT_EQUAL_INT(0, series_ReadCsv(fp, 1700000100, UINT32_MAX, samples, 4));
+
+	rewind(fp);
+	TEST_ASSERT_EQUAL_INT(2, series_ReadCsv(fp, 1700000100, 1700000240, samples, 4));
+	TEST_ASSERT_EQUAL_INT(1700000180, samples[1].timeS);
+	TEST_ASSERT_EQUAL_INT(0, series_ReadCsv(fp, 1700000100, 1700000240, samples, 4));
+	fclose(fp);
+	remove(path);
+}
+
+const TestCase test_seriesCases[] =
+{
+	{"BinaryRoundTrip", BinaryRoundTrip},
+	{"JsonFormat", JsonFormat},
+	{"BinaryIsCompact", BinaryIsCompact},
+	{"ReadCsv", ReadCsv},
+	{NULL, NULL}
+};
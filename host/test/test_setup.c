@@ -0,0 +1,66 @@
+//======================================================================
+//! @file   test_setup.c
+//! @brief  setup.c 単体テスト
+//======================================================================
+#include <string.h>
+
+#include "driver/gpio.h"
+
+#include "global.h"
+#include "setup.h"
+#include "sim.h"
+#include "test.h"
+
+//----------------------------------------------------------------------
+//! @brief  初期化後の出力ピン状態
+//----------------------------------------------------------------------
+static void InitialPinLevels(void)
+{
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(1, gpio_get_level(GPIO_SDCS_NUM));
+	TEST_ASSERT_EQUAL_INT(1, gpio_get_level(GPIO_LCDCS_NUM));
+	TEST_ASSERT_EQUAL_INT(0, gpio_get_level(GPIO_LED_NUM));
+}
+
+//----------------------------------------------------------------------
+//! @brief  ピン設定ごとのSPIクロック
+//----------------------------------------------------------------------
+static void SpiClockPerSetting(void)
+{
+	set_Initialize();
+	set_TakeCommunicationMutex();
+	set_SetPin(PinSetting_SdMount, NULL);
+	TEST_ASSERT_EQUAL_INT(400000, sim_GetSpiClockHz());
+	set_SetPin(PinSetting_SdMain, NULL);
+	TEST_ASSERT_EQUAL_INT(20000000, sim_GetSpiClockHz());
+	set_SetPin(PinSetting_SdRead, NULL);
+	TEST_ASSERT_EQUAL_INT(2000000, sim_GetSpiClockHz());
+	set_SetPin(PinSetting_LcdMain, NULL);
+	TEST_ASSERT_EQUAL_INT(20000000, sim_GetSpiClockHz());
+	set_GiveCommunicationMutex();
+}
+
+//----------------------------------------------------------------------
+//! @brief  ピン設定の切り替えはSPI転送を伴わない
+//----------------------------------------------------------------------
+static void PinSwitchDoesNotTransfer(void)
+{
+	SimSpiStats before, after;
+	set_Initialize();
+	sim_GetSpiStats(&before);
+	set_TakeCommunicationMutex();
+	set_SetPin(PinSetting_SdMain, NULL);
+	set_SetPin(PinSetting_LcdMain, NULL);
+	set_SetPin(PinSetting_Inititialized, NULL);
+	set_GiveCommunicationMutex();
+	sim_GetSpiStats(&after);
+	TEST_ASSERT_EQUAL_INT(before.transactions, after.transactions);
+}
+
+const TestCase test_setupCases[] =
+{
+	{"InitialPinLevels", InitialPinLevels},
+	{"SpiClockPerSetting", SpiClockPerSetting},
+	{"PinSwitchDoesNotTransfer", PinSwitchDoesNotTransfer},
+	{NULL, NULL}
+};
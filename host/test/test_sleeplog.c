@@ -0,0 +1,201 @@
+//======================================================================
+//! @file   test_sleeplog.c
+//! @brief  sleeplog.c 単体テスト
+//! @note	ホストのesp_deep_sleep()は戻るので、sim_DeepSleepWake()で起床させて実機の起動を繰り返す.
+//! 		書出し先はSDカードの代わりに作業ディレクトリのファイルを使う.
+//======================================================================
+#include <stdio.h>
+#include <string.h>
+
+#include "global.h"
+#include "setup.h"
+#include "rtctime.h"
+#include "sleeplog.h"
+#include "sim.h"
+#include "test.h"
+
+static const char *path = "sleeplog_test.csv";
+
+//----------------------------------------------------------------------
+//! @brief  ファイル全体を読む
+//----------------------------------------------------------------------
+static const char *ReadFile(void)
+{
+	static char text[4096];
+	size_t length = 0;
+	FILE *fp = fopen(path, "r");
+	if(fp != NULL)
+	{
+		length = fread(text, 1, sizeof(text) - 1, fp);
+		fclose(fp);
+	}
+	text[length] = '\0';
+	return text;
+}
+
+//----------------------------------------------------------------------
+//! @brief  サンプルの起床はSPIを使わずに眠り、満杯の起床で書出す
+//! @note	時刻はRTCメモリから復元し、バッチ先頭の時刻を記録する.
+//----------------------------------------------------------------------
+static void FastPathUntilBatchFull(void)
+{
+	SimSpiStats before, after;
+	uint64_t sleepUs;
+	uint8_t rfOption;
+
+	remove(path);
+	rtctime_Sync(1700000000LL * 1000000);
+	TEST_ASSERT_EQUAL_INT(RET_OK, sleeplog_Start(10000, 4));
+	sleeplog_Sleep();
+	TEST_ASSERT(sim_DeepSleepRequested(&sleepUs, &rfOption));
+	TEST_ASSERT_EQUAL_INT(10000000, sleepUs);
+	TEST_ASSERT_EQUAL_INT(4, rfOption);
+
+	sim_GetSpiStats(&before);
+	for(int i = 0; i < 3; i++)
+	{
+		sim_DeepSleepWake();
+		sim_SetAdc(100 + i);
+		TEST_ASSERT_EQUAL_INT(RET_OK, rtctime_Restore());
+		TEST_ASSERT_EQUAL_INT(SleepLog_Sleep, sleeplog_Wake());
+		sim_AdvanceNs(2000000);
+		sleeplog_Sleep();
+		TEST_ASSERT(sim_DeepSleepRequested(&sleepUs, &rfOption));
+		TEST_ASSERT_EQUAL_INT(10000000 - 2000 - BOOT_TIME_US, sleepUs);
+		TEST_ASSERT_EQUAL_INT((i == 2) ? 2 : 4, rfOption);		// 次が書出しならRFを使う
+	}
+	sim_GetSpiStats(&after);
+	TEST_ASSERT_EQUAL_INT(before.transactions, after.transactions);
+
+	sim_DeepSleepWake();
+	sim_SetAdc(103);
+	rtctime_Restore();
+	TEST_ASSERT_EQUAL_INT(SleepLog_Flush, sleeplog_Wake());
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(RET_OK, sleeplog_Flush(path));
+	sleeplog_Sleep();
+	TEST_ASSERT(sim_DeepSleepRequested(NULL, &rfOption));
+	TEST_ASSERT_EQUAL_INT(4, rfOption);
+	TEST_ASSERT(strcmp("sequence,elapsed_s,unix_s,value\n0,0,1700000010,100\n1,10,1700000020,101\n2,20,1700000030,102\n3,30,1700000040,103\n", ReadFile()) == 0);
+
+	// 次のバッチは続きの番号で追記する
+	for(int i = 0; i < 4; i++)
+	{
+		sim_DeepSleepWake();
+		sim_SetAdc(200 + i);
+		rtctime_Restore();
+		sleeplog_Wake();
+		sleeplog_Sleep();
+	}
+	TEST_ASSERT_EQUAL_INT(RET_OK, sleeplog_Flush(path));
+	TEST_ASSERT(strstr(ReadFile(), "3,30,1700000040,103\n4,40,1700000050,200\n5,50,1700000060,201\n6,60,1700000070,202\n7,70,1700000080,203\n") != NULL);
+	remove(path);
+}
+
+//----------------------------------------------------------------------
+//! @brief  リセットボタンで起動すると残りを書出して記録モードを終える(統計は残る)
+//----------------------------------------------------------------------
+static void ResetButtonStops(void)
+{
+	SleepLogReport report;
+
+	remove(path);
+	TEST_ASSERT_EQUAL_INT(RET_NG, rtctime_Restore());			// 電源投入直後のRTCメモリは不定
+	TEST_ASSERT_EQUAL_INT(SleepLog_Off, sleeplog_Wake());
+	TEST_ASSERT_EQUAL_INT(RET_NG, sleeplog_GetReport(&report));
+
+	sleeplog_Start(60000, 10);
+	sleeplog_Sleep();
+	for(int i = 0; i < 2; i++)
+	{
+		sim_DeepSleepWake();
+		sim_SetAdc(i);
+		sleeplog_Wake();
+		sleeplog_Sleep();
+	}
+	sim_ResetButton();
+	TEST_ASSERT_EQUAL_INT(SleepLog_Stopped, sleeplog_Wake());
+	TEST_ASSERT_EQUAL_INT(RET_OK, sleeplog_Flush(path));
+	sleeplog_Stop();
+	TEST_ASSERT(strcmp("sequence,elapsed_s,unix_s,value\n0,0,,0\n1,60,,1\n", ReadFile()) == 0);
+
+	sim_ResetButton();
+	TEST_ASSERT_EQUAL_INT(SleepLog_Off, sleeplog_Wake());
+	TEST_ASSERT_EQUAL_INT(RET_OK, sleeplog_GetReport(&report));
+	TEST_ASSERT_EQUAL_INT(0, report.running);
+	TEST_ASSERT_EQUAL_INT(2, report.sequence);
+	TEST_ASSERT_EQUAL_INT(2, report.sampleWakes);
+	remove(path);
+}
+
+//----------------------------------------------------------------------
+//! @brief  書出しに失敗したらバッチを残し、満杯の間のサンプルは捨てて数える
+//----------------------------------------------------------------------
+static void FlushFailureKeepsBatch(void)
+{
+	SleepLogReport report;
+
+	remove(path);
+	rtctime_Restore();
+	sleeplog_Start(1000, 2);
+	for(int i = 0; i < 2; i++)
+	{
+		sim_DeepSleepWake();
+		sim_SetAdc(i + 1);
+		sleeplog_Wake();
+	}
+	TEST_ASSERT_EQUAL_INT(RET_NG, sleeplog_Flush("missing/sleeplog.csv"));
+	sleeplog_Sleep();
+
+	sim_DeepSleepWake();
+	sim_SetAdc(9);
+	TEST_ASSERT_EQUAL_INT(SleepLog_Flush, sleeplog_Wake());
+	TEST_ASSERT_EQUAL_INT(RET_OK, sleeplog_Flush(path));
+	TEST_ASSERT(strcmp("sequence,elapsed_s,unix_s,value\n0,0,,1\n1,1,,2\n", ReadFile()) == 0);
+	sleeplog_GetReport(&report);
+	TEST_ASSERT_EQUAL_INT(1, report.dropped);
+	TEST_ASSERT_EQUAL_INT(0, report.count);
+	remove(path);
+}
+
+//----------------------------------------------------------------------
+//! @brief  電池寿命の見積り
+//! @note	60秒間隔、60サンプルで書出し.サンプル起床5ms、書出し起床2s(どちらも起動時間70msを足す).
+//! 		1時間の電荷 = 59×75ms×20mA + 2.07s×80mA + (3600s-6.495s)×150uA → 平均220uA, 2000mAhで9090時間.
+//----------------------------------------------------------------------
+static void ReportProjectsBatteryLife(void)
+{
+	SleepLogReport report;
+
+	sleeplog_Start(60000, 60);
+	sleeplog_Sleep();
+	for(int i = 0; i < 60; i++)
+	{
+		sim_DeepSleepWake();
+		SleepLogWake wake = sleeplog_Wake();
+		sim_AdvanceNs((wake == SleepLog_Flush) ? 2000000000ULL : 5000000);
+		if(wake == SleepLog_Flush)
+		{
+			sleeplog_Flush(path);
+		}
+		sleeplog_Sleep();
+	}
+	TEST_ASSERT_EQUAL_INT(RET_OK, sleeplog_GetReport(&report));
+	TEST_ASSERT_EQUAL_INT(1, report.running);
+	TEST_ASSERT_EQUAL_INT(59, report.sampleWakes);
+	TEST_ASSERT_EQUAL_INT(5000, report.awakeAvgUs);
+	TEST_ASSERT_EQUAL_INT(1, report.flushWakes);
+	TEST_ASSERT_EQUAL_INT(2000000, report.flushAvgUs);
+	TEST_ASSERT_EQUAL_INT(220, report.averageUa);
+	TEST_ASSERT_EQUAL_INT(9090, report.batteryHours);
+	remove(path);
+}
+
+const TestCase test_sleeplogCases[] =
+{
+	{"FastPathUntilBatchFull", FastPathUntilBatchFull},
+	{"ResetButtonStops", ResetButtonStops},
+	{"FlushFailureKeepsBatch", FlushFailureKeepsBatch},
+	{"ReportProjectsBatteryLife", ReportProjectsBatteryLife},
+	{NULL, NULL}
+};
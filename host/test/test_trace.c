@@ -0,0 +1,260 @@
+//======================================================================
+//! @file   test_trace.c
+//! @brief  trace.c 単体テスト
+//! @note	ホストでは時刻は仮想時計[us].
+//======================================================================
+#define _GNU_SOURCE			// fopencookie()
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "diskio.h"
+
+#include "setup.h"
+#include "lcd.h"
+#include "trace.h"
+#include "sim.h"
+#include "test.h"
+
+#define SINK_BUFFER		128				// 出力先のバッファ(小さいほど書込みが多い)
+#define SINK_LIMIT		(64 * 1024)		// 出力の上限(超えたら止まらなかったとみなす)
+
+static TraceEvent events[TRACE_RING_SIZE];
+static char s_sinkText[SINK_LIMIT + 1];
+static size_t s_sinkLength;
+static int s_sinkOverflow;						// 上限を超えた
+static jmp_buf s_sinkJump;						// 上限を超えたらtrace_Export()から抜ける
+
+//----------------------------------------------------------------------
+//! @brief  条件に合う最初の記録の位置
+//! @return	位置 -1=なし
+//----------------------------------------------------------------------
+static int FindEvent(int count, int start, TraceId id, TracePhase phase)
+{
+	for(int i = start; i < count; i++)
+	{
+		if(events[i].id == id && events[i].phase == phase)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+//----------------------------------------------------------------------
+//! @brief  出力を文字列で取得
+//----------------------------------------------------------------------
+static char *Export(int isLines)
+{
+	FILE *fp = tmpfile();
+	long size;
+	char *text;
+
+	trace_Export(fp, isLines);
+	size = ftell(fp);
+	rewind(fp);
+	text = malloc(size + 1);
+	text[fread(text, 1, size, fp)] = '\0';
+	fclose(fp);
+	return text;
+}
+
+//----------------------------------------------------------------------
+//! @brief  書込みごとにトレースを記録する出力先(SDへのtrace saveと同じ)
+//! @note	上限を超えたら出力が止まらないので、待たずに失敗させる.
+//----------------------------------------------------------------------
+static ssize_t SinkWrite(void *cookie, const char *data, size_t size)
+{
+	if(s_sinkOverflow)
+	{
+		return -1;
+	}
+	if(s_sinkLength + size > SINK_LIMIT)
+	{
+		s_sinkOverflow = 1;
+		longjmp(s_sinkJump, 1);
+	}
+	memcpy(&s_sinkText[s_sinkLength], data, size);
+	s_sinkLength += size;
+	trace_Record(TraceId_SdWrite, TracePhase_Begin, 1);
+	trace_Record(TraceId_SdWrite, TracePhase_End, 0);
+	return (ssize_t)size;
+}
+
+//----------------------------------------------------------------------
+//! @brief  セクタ読込: バス取得 → 読込(CMD18, CMD12) → バス解放
+//----------------------------------------------------------------------
+static void SdReadTimeline(void)
+{
+	uint8_t buff[512 * 2];
+	int count, wait, held, read, cmd18, cmd12, readEnd, heldEnd;
+
+	set_Initialize();
+	trace_Clear();
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_read(0, buff, 5, 2));
+	count = trace_GetEvents(events, TRACE_RING_SIZE);
+
+	wait = FindEvent(count, 0, TraceId_BusWait, TracePhase_Begin);
+	held = FindEvent(count, 0, TraceId_BusHeld, TracePhase_Begin);
+	read = FindEvent(count, 0, TraceId_SdRead, TracePhase_Begin);
+	cmd18 = FindEvent(count, 0, TraceId_SdCommand, TracePhase_Begin);
+	cmd12 = FindEvent(count, cmd18 + 1, TraceId_SdCommand, TracePhase_Begin);
+	readEnd = FindEvent(count, 0, TraceId_SdRead, TracePhase_End);
+	heldEnd = FindEvent(count, 0, TraceId_BusHeld, TracePhase_End);
+	TEST_ASSERT(wait == 0);
+	TEST_ASSERT(wait < held && held < read && read < cmd18 && cmd18 < cmd12 && cmd12 < readEnd && readEnd < heldEnd);
+	TEST_ASSERT_EQUAL_INT(2, events[read].arg);
+	TEST_ASSERT_EQUAL_INT(18, events[cmd18].arg);
+	TEST_ASSERT_EQUAL_INT(12, events[cmd12].arg);
+	TEST_ASSERT(events[readEnd].timestamp > events[read].timestamp);
+	for(int i = 1; i < count; i++)
+	{
+		TEST_ASSERT(events[i].timestamp >= events[i - 1].timestamp);
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  ピン設定の切替は瞬間イベント
+//----------------------------------------------------------------------
+static void SetPinInstant(void)
+{
+	uint8_t buff[512];
+	int count, sd, lcd, update;
+
+	set_Initialize();
+	TEST_ASSERT_EQUAL_INT(RES_OK, disk_read(0, buff, 5, 1));
+	trace_Clear();
+	lcd_BeginDrawing();
+	lcd_DrawLine(0, 0, 10, 0);
+	lcd_EndDrawing();
+	lcd_Update();
+	count = trace_GetEvents(events, TRACE_RING_SIZE);
+
+	update = FindEvent(count, 0, TraceId_LcdUpdate, TracePhase_Begin);
+	lcd = FindEvent(count, 0, TraceId_SetPin, TracePhase_Instant);
+	sd = FindEvent(count, 0, TraceId_SdCommand, TracePhase_Begin);
+	TEST_ASSERT(update >= 0 && lcd > update);
+	TEST_ASSERT_EQUAL_INT(PinSetting_LcdMain, events[lcd].arg);
+	TEST_ASSERT_EQUAL_INT(-1, sd);
+}
+
+//----------------------------------------------------------------------
+//! @brief  満杯になると古い記録から上書き
+//----------------------------------------------------------------------
+static void RingKeepsNewest(void)
+{
+	int count;
+
+	trace_Clear();
+	for(int i = 0; i < TRACE_RING_SIZE + 10; i++)
+	{
+		trace_Record(TraceId_WifiEvent, TracePhase_Instant, (uint16_t)i);
+	}
+	count = trace_GetEvents(events, TRACE_RING_SIZE);
+	TEST_ASSERT_EQUAL_INT(TRACE_RING_SIZE, count);
+	TEST_ASSERT_EQUAL_INT(10, events[0].arg);
+	TEST_ASSERT_EQUAL_INT(TRACE_RING_SIZE + 9, events[count - 1].arg);
+	TEST_ASSERT_EQUAL_INT(10, trace_GetDropCount());
+}
+
+//----------------------------------------------------------------------
+//! @brief  Chrome trace形式(JSON配列, 1行1イベント)
+//----------------------------------------------------------------------
+static void ExportChromeTrace(void)
+{
+	char *text;
+	int lines = 0;
+
+	trace_Clear();
+	trace_Record(TraceId_SdWrite, TracePhase_Begin, 4);
+	sim_AdvanceNs(1500000);
+	trace_Record(TraceId_SdWrite, TracePhase_End, 0);
+	trace_Record(TraceId_IpEvent, TracePhase_Instant, 0);
+
+	static const char head[] = "[\n{\"name\":\"SdWrite\",\"cat\":\"sd\",\"ph\":\"B\",\"ts\":0.000,\"pid\":1,\"tid\":1,\"args\":{\"arg\":4}},\n";
+	text = Export(0);
+	TEST_ASSERT(strncmp(text, head, sizeof(head) - 1) == 0);
+	TEST_ASSERT(strstr(text, "{\"name\":\"SdWrite\",\"cat\":\"sd\",\"ph\":\"E\",\"ts\":1500.000,\"pid\":1,\"tid\":1},\n") != NULL);
+	TEST_ASSERT(strstr(text, "\"ph\":\"i\",\"ts\":1500.000,\"pid\":1,\"tid\":1,\"s\":\"t\"") != NULL);
+	TEST_ASSERT(strcmp(text + strlen(text) - 3, "\n]\n") == 0);
+	free(text);
+
+	text = Export(1);
+	for(char *p = text; *p != '\0'; p++)
+	{
+		lines += (*p == '\n');
+	}
+	TEST_ASSERT_EQUAL_INT(3, lines);
+	TEST_ASSERT(text[0] == '{');
+	free(text);
+}
+
+//----------------------------------------------------------------------
+//! @brief  32bit時刻の折り返しを補正する
+//----------------------------------------------------------------------
+static void TimestampWrap(void)
+{
+	char *text;
+
+	sim_AdvanceNs((0x100000000ULL - 16) * 1000);
+	trace_Clear();
+	trace_Record(TraceId_BusWait, TracePhase_Begin, 0);
+	sim_AdvanceNs(32 * 1000);
+	trace_Record(TraceId_BusWait, TracePhase_End, 0);
+	trace_GetEvents(events, 2);
+	TEST_ASSERT(events[1].timestamp < events[0].timestamp);
+
+	text = Export(1);
+	TEST_ASSERT(strstr(text, "\"ph\":\"E\",\"ts\":32.000,") != NULL);
+	free(text);
+}
+
+//----------------------------------------------------------------------
+//! @brief  出力先への書込みが記録しても、出力は開始時の記録までで終わる
+//----------------------------------------------------------------------
+static void ExportWhileRecording(void)
+{
+	static const cookie_io_functions_t functions = {NULL, SinkWrite, NULL, NULL};
+	static char buffer[SINK_BUFFER];
+	int lines = 0;
+
+	trace_Clear();
+	for(int i = 0; i < TRACE_RING_SIZE; i++)
+	{
+		trace_Record(TraceId_WifiEvent, TracePhase_Instant, (uint16_t)i);
+	}
+	s_sinkLength = 0;
+	s_sinkOverflow = 0;
+	FILE *fp = fopencookie(NULL, "w", functions);
+	TEST_ASSERT(fp != NULL);
+	setvbuf(fp, buffer, _IOFBF, sizeof(buffer));
+	if(setjmp(s_sinkJump) == 0)
+	{
+		trace_Export(fp, 1);
+	}
+	fclose(fp);
+	s_sinkText[s_sinkLength] = '\0';
+
+	TEST_ASSERT_EQUAL_INT(0, s_sinkOverflow);
+	TEST_ASSERT(trace_GetDropCount() > 0);			// 出力中に上書きされた
+	TEST_ASSERT(strstr(s_sinkText, "SdWrite") == NULL);		// 出力中の記録は含まない
+	for(char *p = s_sinkText; *p != '\0'; p++)
+	{
+		lines += (*p == '\n');
+	}
+	TEST_ASSERT(lines > 0 && lines < TRACE_RING_SIZE);
+	static const char head[] = "{\"name\":\"WifiEvent\"";
+	TEST_ASSERT(strncmp(s_sinkText, head, sizeof(head) - 1) == 0);
+}
+
+const TestCase test_traceCases[] =
+{
+	{"SdReadTimeline", SdReadTimeline},
+	{"SetPinInstant", SetPinInstant},
+	{"RingKeepsNewest", RingKeepsNewest},
+	{"ExportChromeTrace", ExportChromeTrace},
+	{"TimestampWrap", TimestampWrap},
+	{"ExportWhileRecording", ExportWhileRecording},
+	{NULL, NULL}
+};
@@ -0,0 +1,248 @@
+//======================================================================
+//! @file   test_viewer.c
+//! @brief  viewer.c 単体テスト
+//! @note	ホストではSDカードの代わりに作業ディレクトリのファイルを使う.
+//======================================================================
+#include <stdio.h>
+#include <string.h>
+
+#include "global.h"
+#include "setup.h"
+#include "lcd.h"
+#include "viewer.h"
+#include "sim.h"
+#include "test.h"
+
+static const char *path = "viewer_test.txt";
+static const char *indexPath = "viewer_test.txt" VIEWER_INDEX_SUFFIX;
+static const Rect screen = {0, 0, 128, 64};
+static char text[8192];
+static Viewer viewer;
+
+//----------------------------------------------------------------------
+//! @brief  ファイル作成(索引は消す)
+//----------------------------------------------------------------------
+static void WriteFile(const char *data, size_t length)
+{
+	FILE *fp = fopen(path, "wb");
+	fwrite(data, 1, length, fp);
+	fclose(fp);
+	remove(indexPath);
+}
+
+//----------------------------------------------------------------------
+//! @brief  後片付け
+//----------------------------------------------------------------------
+static void RemoveFiles(void)
+{
+	viewer_Close(&viewer);
+	remove(path);
+	remove(indexPath);
+}
+
+//----------------------------------------------------------------------
+//! @brief  パネルの表示RAMを写す
+//----------------------------------------------------------------------
+static void CapturePanel(uint8_t panel[8][128])
+{
+	for(int page = 0; page < 8; page++)
+	{
+		for(int x = 0; x < 128; x++)
+		{
+			panel[page][x] = sim_LcdRam(page, x);
+		}
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  各ページの表示は、そのページの先頭からlcd_Puts()で描いた画面と同じ
+//! @note	lcd_Puts()は表示エリアの下で止まるので、ページの区切りがずれていれば一致しない.
+//----------------------------------------------------------------------
+static int PagesMatchPuts(size_t length, CharCode charCode)
+{
+	uint8_t expected[8][128], actual[8][128];
+	uint32_t offset, bytes, next = 0;
+
+	for(uint32_t page = 0; page < viewer.pageCount; page++)
+	{
+		if(viewer_GetPageRange(&viewer, page, &offset, &bytes) != RET_OK || offset != next)
+		{
+			return 0;
+		}
+		next = offset + bytes;
+
+		lcd_BeginDrawing();
+		lcd_Cls();
+		lcd_Puts(screen, &text[offset], charCode);
+		lcd_EndDrawing();
+		lcd_Update();
+		CapturePanel(expected);
+
+		lcd_BeginDrawing();
+		lcd_DrawLine(0, 0, 127, 63);			// 前の表示が消えることも確かめる
+		int ret = viewer_Show(&viewer, page);
+		lcd_EndDrawing();
+		lcd_Update();
+		CapturePanel(actual);
+		if(ret != RET_OK || memcmp(expected, actual, sizeof(expected)) != 0)
+		{
+			return 0;
+		}
+	}
+	return next == length;
+}
+
+//----------------------------------------------------------------------
+//! @brief  改行ごとに1行、8行で1ページ
+//----------------------------------------------------------------------
+static void PagesFollowLines(void)
+{
+	uint32_t offset, length;
+	size_t size = 0;
+
+	set_Initialize();
+	for(int i = 0; i < 20; i++)
+	{
+		size += sprintf(&text[size], "line%02d\n", i);
+	}
+	WriteFile(text, size);
+
+	TEST_ASSERT_EQUAL_INT(RET_OK, viewer_Open(&viewer, path, screen, Code_Utf8));
+	TEST_ASSERT_EQUAL_INT(1, viewer.indexBuilt);
+	TEST_ASSERT_EQUAL_INT(3, viewer.pageCount);
+	TEST_ASSERT_EQUAL_INT(RET_OK, viewer_GetPageRange(&viewer, 1, &offset, &length));
+	TEST_ASSERT_EQUAL_INT(8 * 7, offset);
+	TEST_ASSERT_EQUAL_INT(8 * 7, length);
+	TEST_ASSERT_EQUAL_INT(RET_OK, viewer_GetPageRange(&viewer, 2, &offset, &length));
+	TEST_ASSERT_EQUAL_INT(4 * 7, length);
+	TEST_ASSERT_EQUAL_INT(RET_NG, viewer_GetPageRange(&viewer, 3, &offset, &length));
+	TEST_ASSERT(PagesMatchPuts(size, Code_Utf8));
+	RemoveFiles();
+}
+
+//----------------------------------------------------------------------
+//! @brief  折り返し、全角、空行、CR/LFの混ざったUTF-8
+//----------------------------------------------------------------------
+static void PagesMatchPutsUtf8(void)
+{
+	static const char *lines[] =
+	{
+		"2024-01-01 00:00 気温 12.5 湿度 40%\r\n",
+		"\r\n",
+		"記録開始 ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789\n",
+		"\n\n",
+		"あいうえおかきくけこさしすせそたちつてとなにぬねの\n",
+		"AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAあ\n",
+		"\rカタカナ\r上書き\n",
+	};
+	size_t size = 0;
+
+	set_Initialize();
+	for(int i = 0; size < sizeof(text) - 128; i++)
+	{
+		size += sprintf(&text[size], "%s", lines[i % (sizeof(lines) / sizeof(lines[0]))]);
+	}
+	WriteFile(text, size);
+
+	TEST_ASSERT_EQUAL_INT(RET_OK, viewer_Open(&viewer, path, screen, Code_Utf8));
+	TEST_ASSERT(viewer.pageCount > VIEWER_WINDOW);
+	TEST_ASSERT(PagesMatchPuts(size, Code_Utf8));
+	RemoveFiles();
+}
+
+//----------------------------------------------------------------------
+//! @brief  Shift-JIS: 全角16文字で1行、128文字で1ページ
+//----------------------------------------------------------------------
+static void PagesMatchPutsSjis(void)
+{
+	uint32_t offset, length;
+	size_t size = 0;
+
+	set_Initialize();
+	for(int i = 0; i < 200; i++)
+	{
+		memcpy(&text[size], (i % 2 == 0) ? "\x82\xa0" : "\x83\x41", 2);
+		size += 2;
+	}
+	text[size] = '\0';
+	WriteFile(text, size);
+
+	TEST_ASSERT_EQUAL_INT(RET_OK, viewer_Open(&viewer, path, screen, Code_Sjis));
+	TEST_ASSERT_EQUAL_INT(2, viewer.pageCount);
+	TEST_ASSERT_EQUAL_INT(RET_OK, viewer_GetPageRange(&viewer, 1, &offset, &length));
+	TEST_ASSERT_EQUAL_INT(128 * 2, offset);
+	TEST_ASSERT(PagesMatchPuts(size, Code_Sjis));
+	RemoveFiles();
+}
+
+//----------------------------------------------------------------------
+//! @brief  2回目は索引を読むだけ.ファイルや表示エリアが変われば作り直す
+//----------------------------------------------------------------------
+static void IndexIsCached(void)
+{
+	const Rect half = {0, 0, 64, 64};
+
+	set_Initialize();
+	WriteFile("cached\n", 7);
+	TEST_ASSERT_EQUAL_INT(RET_OK, viewer_Open(&viewer, path, screen, Code_Utf8));
+	TEST_ASSERT_EQUAL_INT(1, viewer.indexBuilt);
+	viewer_Close(&viewer);
+
+	TEST_ASSERT_EQUAL_INT(RET_OK, viewer_Open(&viewer, path, screen, Code_Utf8));
+	TEST_ASSERT_EQUAL_INT(0, viewer.indexBuilt);
+	TEST_ASSERT_EQUAL_INT(1, viewer.pageCount);
+	viewer_Close(&viewer);
+
+	TEST_ASSERT_EQUAL_INT(RET_OK, viewer_Open(&viewer, path, half, Code_Utf8));
+	TEST_ASSERT_EQUAL_INT(1, viewer.indexBuilt);
+	viewer_Close(&viewer);
+
+	FILE *fp = fopen(path, "ab");
+	fputs("appended\n", fp);
+	fclose(fp);
+	TEST_ASSERT_EQUAL_INT(RET_OK, viewer_Open(&viewer, path, half, Code_Utf8));
+	TEST_ASSERT_EQUAL_INT(1, viewer.indexBuilt);
+	RemoveFiles();
+}
+
+//----------------------------------------------------------------------
+//! @brief  不正なUTF-8、NUL、改行だけが続くファイルでも止まらずに表示できる
+//----------------------------------------------------------------------
+static void BrokenText(void)
+{
+	uint32_t offset, length;
+	size_t size = 0;
+
+	set_Initialize();
+	memcpy(&text[size], "ok\x80\xbf\xff", 5);
+	size += 5;
+	text[size++] = '\0';
+	memset(&text[size], '\n', 1000);		// 空行は詰まるので、バイト数でページを分ける
+	size += 1000;
+	memcpy(&text[size], "end\xe3\x81", 5);	// 末尾で欠けた文字
+	size += 5;
+	WriteFile(text, size);
+
+	TEST_ASSERT_EQUAL_INT(RET_OK, viewer_Open(&viewer, path, screen, Code_Utf8));
+	TEST_ASSERT(viewer.pageCount >= 2);
+	for(uint32_t page = 0; page < viewer.pageCount; page++)
+	{
+		TEST_ASSERT_EQUAL_INT(RET_OK, viewer_GetPageRange(&viewer, page, &offset, &length));
+		TEST_ASSERT(length <= VIEWER_PAGE_BYTES);
+		lcd_BeginDrawing();
+		TEST_ASSERT_EQUAL_INT(RET_OK, viewer_Show(&viewer, page));
+		lcd_EndDrawing();
+	}
+	TEST_ASSERT_EQUAL_INT(size, offset + length);
+	RemoveFiles();
+}
+
+const TestCase test_viewerCases[] =
+{
+	{"PagesFollowLines", PagesFollowLines},
+	{"PagesMatchPutsUtf8", PagesMatchPutsUtf8},
+	{"PagesMatchPutsSjis", PagesMatchPutsSjis},
+	{"IndexIsCached", IndexIsCached},
+	{"BrokenText", BrokenText},
+	{NULL, NULL}
+};
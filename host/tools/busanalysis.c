@@ -0,0 +1,239 @@
+//======================================================================
+//! @file   busanalysis.c
+//! @brief  SPIバス記録(buscap)の解析
+//! @note	記録を時間順に並べ直し、転送時間だけを条件に合わせて計算し直す.
+//! 		転送間の空き時間(CPU処理, ミューテックス, ピン設定切替)は記録どおりとする.
+//! 		転送時間 = 固定分(記録の所要時間 - ビット時間) + ビット時間(バイト数×8/クロック)
+//! 		チャンクサイズを変えるときは、同じ相手・同じ向き・同じクロックで4byte以上の転送が
+//! 		続く区間をまとめて、区間内の平均の固定分と空き時間で転送数を置き換える.
+//======================================================================
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "busanalysis.h"
+
+//----- 定義 -----
+#define MIN_CHUNK_BYTES		4			// チャンクとして扱う転送の最小バイト数
+
+typedef struct
+{
+	uint64_t *values;
+	uint32_t count;
+	uint32_t capacity;
+} Samples;
+
+//----------------------------------------------------------------------
+//! @brief  値を追加
+//----------------------------------------------------------------------
+static void AddSample(Samples *samples, uint64_t value)
+{
+	if(samples->count == samples->capacity)
+	{
+		samples->capacity = (samples->capacity == 0) ? 256 : samples->capacity * 2;
+		samples->values = realloc(samples->values, samples->capacity * sizeof(uint64_t));
+	}
+	samples->values[samples->count++] = value;
+}
+
+static int CompareU64(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+	return (x > y) - (x < y);
+}
+
+//----------------------------------------------------------------------
+//! @brief  ビット時間[ns]
+//----------------------------------------------------------------------
+static uint64_t PayloadNs(uint32_t bytes, uint32_t clockKhz)
+{
+	return (clockKhz == 0) ? 0 : (uint64_t)bytes * 8 * 1000000 / clockKhz;
+}
+
+//----------------------------------------------------------------------
+//! @brief  チャンク区間に含められる転送か
+//----------------------------------------------------------------------
+static int IsChunk(const BusCapRecord *record)
+{
+	return (record->txBytes == 0 && record->rxBytes >= MIN_CHUNK_BYTES)
+		|| (record->rxBytes == 0 && record->txBytes >= MIN_CHUNK_BYTES);
+}
+
+//----------------------------------------------------------------------
+//! @brief  同じチャンク区間に続く転送か
+//----------------------------------------------------------------------
+static int IsSameRun(const BusCapRecord *a, const BusCapRecord *b)
+{
+	return IsChunk(a) && IsChunk(b) && a->device == b->device && a->clockKhz == b->clockKhz
+		&& (a->rxBytes == 0) == (b->rxBytes == 0);
+}
+
+//----------------------------------------------------------------------
+//! @brief  記録ファイル読込
+//! @param	fp		[I]記録ファイル(buscap_Save()の出力)
+//! @param	header	[O]ヘッダ
+//! @param	records	[O]記録(mallocで確保, 呼び出し側で解放)
+//! @return	0=成功 -1=形式不正
+//----------------------------------------------------------------------
+int busanalysis_Load(FILE *fp, BusCapHeader *header, BusCapRecord **records)
+{
+	*records = NULL;
+	if(fread(header, sizeof(*header), 1, fp) != 1 || header->magic != BUSCAP_MAGIC
+	|| header->version != BUSCAP_VERSION || header->recordSize != sizeof(BusCapRecord) || header->ticksPerUs == 0)
+	{
+		return -1;
+	}
+	*records = malloc((header->count + 1) * sizeof(BusCapRecord));
+	if(fread(*records, sizeof(BusCapRecord), header->count, fp) != header->count)
+	{
+		free(*records);
+		*records = NULL;
+		return -1;
+	}
+	return 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  再生
+//! @param	header	[I]ヘッダ
+//! @param	records	[I]記録
+//! @param	options	[I]再生条件 NULL=記録どおり
+//! @param	result	[O]解析結果
+//----------------------------------------------------------------------
+void busanalysis_Replay(const BusCapHeader *header, const BusCapRecord *records, const BusReplayOptions *options, BusReplayResult *result)
+{
+	const uint32_t count = header->count;
+	const uint32_t chunkBytes = (options != NULL) ? options->chunkBytes : 0;
+	uint64_t *startNs = malloc((count + 1) * sizeof(uint64_t));
+	uint64_t *durationNs = malloc((count + 1) * sizeof(uint64_t));
+	Samples gaps = {NULL, 0, 0};
+	uint64_t now = 0;
+	int prevDevice = -1;
+
+	memset(result, 0, sizeof(*result));
+
+	// 時刻の折り返し補正(連続する転送の間隔が折り返し周期未満である前提)
+	for(uint32_t i = 0; i < count; i++)
+	{
+		startNs[i] = (i == 0) ? 0 : startNs[i - 1] + (uint64_t)(uint32_t)(records[i].start - records[i - 1].start) * 1000 / header->ticksPerUs;
+		durationNs[i] = (uint64_t)records[i].duration * 1000 / header->ticksPerUs;
+	}
+
+	for(uint32_t i = 0; i < count; )
+	{
+		// 区間(チャンクを変えないときは1転送)
+		uint32_t runEnd = i + 1;
+		if(chunkBytes != 0)
+		{
+			while(runEnd < count && IsSameRun(&records[runEnd - 1], &records[runEnd]))
+			{
+				runEnd++;
+			}
+		}
+		const int device = records[i].device & (BUSANALYSIS_DEVICES - 1);
+		uint32_t clockKhz = records[i].clockKhz;
+		if(options != NULL && options->clockKhz != 0 && clockKhz >= 1000)
+		{
+			clockKhz = options->clockKhz;
+		}
+
+		// 直前の転送からの空き時間(記録どおり)
+		if(i > 0)
+		{
+			uint64_t prevEnd = startNs[i - 1] + durationNs[i - 1];
+			uint64_t gapNs = (startNs[i] > prevEnd) ? startNs[i] - prevEnd : 0;
+			now += gapNs;
+			if(device != prevDevice)
+			{
+				result->switches++;
+				result->switchGapNs += gapNs;
+			}
+			else
+			{
+				AddSample(&gaps, gapNs);
+			}
+		}
+
+		// 区間の固定分・バイト数・区間内の空き時間
+		uint64_t fixedNs = 0, innerGapNs = 0, bytes = 0;
+		for(uint32_t j = i; j < runEnd; j++)
+		{
+			uint32_t recordBytes = records[j].txBytes + records[j].rxBytes;
+			uint64_t payloadNs = PayloadNs(recordBytes, records[j].clockKhz);
+			fixedNs += (durationNs[j] > payloadNs) ? durationNs[j] - payloadNs : 0;
+			bytes += recordBytes;
+			if(j > i)
+			{
+				uint64_t prevEnd = startNs[j - 1] + durationNs[j - 1];
+				innerGapNs += (startNs[j] > prevEnd) ? startNs[j] - prevEnd : 0;
+			}
+		}
+		uint32_t oldCount = runEnd - i;
+		uint32_t newCount = oldCount;
+		if(oldCount >= 2)
+		{
+			newCount = (uint32_t)((bytes + chunkBytes - 1) / chunkBytes);
+		}
+
+		// 転送数を置き換えて再計算
+		uint64_t payloadNs = PayloadNs((uint32_t)bytes, clockKhz);
+		uint64_t busyNs = fixedNs * newCount / oldCount + payloadNs;
+		uint64_t gapNs = (oldCount >= 2) ? innerGapNs / (oldCount - 1) : 0;
+		for(uint32_t j = 1; j < newCount; j++)
+		{
+			AddSample(&gaps, gapNs);
+		}
+		now += busyNs + gapNs * (newCount - 1);
+
+		result->records += newCount;
+		result->busyNs += busyNs;
+		result->payloadNs += payloadNs;
+		result->deviceRecords[device] += newCount;
+		result->deviceBytes[device] += bytes;
+		result->deviceBusyNs[device] += busyNs;
+		prevDevice = device;
+		i = runEnd;
+	}
+	result->spanNs = now;
+
+	if(gaps.count > 0)
+	{
+		qsort(gaps.values, gaps.count, sizeof(uint64_t), CompareU64);
+		result->gapP50Ns = gaps.values[(gaps.count - 1) / 2];
+		result->gapP99Ns = gaps.values[(uint64_t)(gaps.count - 1) * 99 / 100];
+		result->gapMaxNs = gaps.values[gaps.count - 1];
+	}
+	free(gaps.values);
+	free(startNs);
+	free(durationNs);
+}
+
+//----------------------------------------------------------------------
+//! @brief  解析結果を1行のJSONで出力
+//! @param	fp		[I]出力先
+//! @param	name	[I]条件名
+//! @param	result	[I]解析結果
+//----------------------------------------------------------------------
+void busanalysis_Print(FILE *fp, const char *name, const BusReplayResult *result)
+{
+	static const char *const deviceNames[BUSANALYSIS_DEVICES] = {"none", "sd", "lcd", "both"};
+
+	fprintf(fp, "{\"replay\":\"%s\",\"records\":%u,\"span_ns\":%llu,\"busy_ns\":%llu,\"payload_ns\":%llu,\"utilisation_permille\":%llu",
+		name, result->records, (unsigned long long)result->spanNs, (unsigned long long)result->busyNs, (unsigned long long)result->payloadNs,
+		(unsigned long long)((result->spanNs > 0) ? result->busyNs * 1000 / result->spanNs : 0));
+	for(int i = 0; i < BUSANALYSIS_DEVICES; i++)
+	{
+		if(result->deviceRecords[i] == 0)
+		{
+			continue;
+		}
+		fprintf(fp, ",\"%s_records\":%u,\"%s_bytes\":%llu,\"%s_busy_ns\":%llu,\"%s_share_permille\":%llu",
+			deviceNames[i], result->deviceRecords[i], deviceNames[i], (unsigned long long)result->deviceBytes[i],
+			deviceNames[i], (unsigned long long)result->deviceBusyNs[i],
+			deviceNames[i], (unsigned long long)((result->busyNs > 0) ? result->deviceBusyNs[i] * 1000 / result->busyNs : 0));
+	}
+	fprintf(fp, ",\"switches\":%u,\"switch_gap_ns\":%llu,\"gap_p50_ns\":%llu,\"gap_p99_ns\":%llu,\"gap_max_ns\":%llu}\n",
+		result->switches, (unsigned long long)result->switchGapNs,
+		(unsigned long long)result->gapP50Ns, (unsigned long long)result->gapP99Ns, (unsigned long long)result->gapMaxNs);
+}
@@ -0,0 +1,43 @@
+//======================================================================
+//! @file   busanalysis.h
+//! @brief  SPIバス記録(buscap)の解析
+//======================================================================
+#ifndef _BUSANALYSIS_H_
+#define _BUSANALYSIS_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "buscap.h"
+
+#define BUSANALYSIS_DEVICES		4		// BusDeviceの種類数
+
+// 再生条件(0=記録どおり)
+typedef struct
+{
+	uint32_t clockKhz;					// SPIクロック[kHz] (1MHz未満で記録された転送は変えない)
+	uint32_t chunkBytes;				// 連続データ転送の1転送あたりの最大バイト数
+} BusReplayOptions;
+
+// 解析結果(時間はns)
+typedef struct
+{
+	uint32_t records;					// 転送数
+	uint64_t spanNs;					// 最初の転送開始から最後の転送終了まで
+	uint64_t busyNs;					// 転送時間の合計
+	uint64_t payloadNs;					// うちデータのビット時間
+	uint32_t deviceRecords[BUSANALYSIS_DEVICES];	// 相手別 転送数
+	uint64_t deviceBytes[BUSANALYSIS_DEVICES];		// 相手別 バイト数
+	uint64_t deviceBusyNs[BUSANALYSIS_DEVICES];		// 相手別 転送時間
+	uint32_t switches;					// 相手の切替回数
+	uint64_t switchGapNs;				// 切替時の空き時間の合計
+	uint64_t gapP50Ns;					// 同じ相手への連続転送間の空き時間 中央値
+	uint64_t gapP99Ns;					// 同 99パーセンタイル
+	uint64_t gapMaxNs;					// 同 最大値
+} BusReplayResult;
+
+int busanalysis_Load(FILE *fp, BusCapHeader *header, BusCapRecord **records);
+void busanalysis_Replay(const BusCapHeader *header, const BusCapRecord *records, const BusReplayOptions *options, BusReplayResult *result);
+void busanalysis_Print(FILE *fp, const char *name, const BusReplayResult *result);
+
+#endif
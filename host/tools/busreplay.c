@@ -0,0 +1,75 @@
+//======================================================================
+//! @file   busreplay.c
+//! @brief  SPIバス記録(buscap)の再生・解析
+//! @note	使い方: busreplay <記録ファイル> [--clock-khz N] [--chunk N]
+//! 		記録どおりの結果("captured")と、条件を変えたときの見積り("what_if")を
+//! 		1行1件のJSONで標準出力へ出す.
+//======================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "busanalysis.h"
+
+int main(int argc, char *argv[])
+{
+	BusReplayOptions options = {0, 0};
+	const char *path = NULL;
+
+	for(int i = 1; i < argc; i++)
+	{
+		if(i + 1 < argc && strcmp(argv[i], "--clock-khz") == 0)
+		{
+			options.clockKhz = (uint32_t)strtoul(argv[++i], NULL, 10);
+		}
+		else if(i + 1 < argc && strcmp(argv[i], "--chunk") == 0)
+		{
+			options.chunkBytes = (uint32_t)strtoul(argv[++i], NULL, 10);
+		}
+		else if(path == NULL && argv[i][0] != '-')
+		{
+			path = argv[i];
+		}
+		else
+		{
+			path = NULL;
+			break;
+		}
+	}
+	if(path == NULL)
+	{
+		fprintf(stderr, "usage: busreplay <capture file> [--clock-khz N] [--chunk N]\n");
+		return 2;
+	}
+
+	FILE *fp = fopen(path, "rb");
+	if(fp == NULL)
+	{
+		fprintf(stderr, "busreplay: cannot open %s\n", path);
+		return 1;
+	}
+	BusCapHeader header;
+	BusCapRecord *records;
+	int ret = busanalysis_Load(fp, &header, &records);
+	fclose(fp);
+	if(ret != 0)
+	{
+		fprintf(stderr, "busreplay: %s is not a bus capture\n", path);
+		return 1;
+	}
+	if(header.dropped > 0)
+	{
+		fprintf(stderr, "busreplay: %u transactions were dropped (capture buffer full)\n", header.dropped);
+	}
+
+	BusReplayResult result;
+	busanalysis_Replay(&header, records, NULL, &result);
+	busanalysis_Print(stdout, "captured", &result);
+	if(options.clockKhz != 0 || options.chunkBytes != 0)
+	{
+		busanalysis_Replay(&header, records, &options, &result);
+		busanalysis_Print(stdout, "what_if", &result);
+	}
+	free(records);
+	return 0;
+}
@@ -0,0 +1,16 @@
+# Fails when main/uistr.h or main/uistr.c differs from what uistrgen makes
+# out of main/uistr.txt (run "cmake --build <dir> --target uistr" to fix).
+execute_process(
+	COMMAND ${GENERATOR} ${MAIN_DIR}/uistr.txt ${OUT_DIR}/uistr.h ${OUT_DIR}/uistr.c
+	RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "uistrgen failed")
+endif()
+foreach(name uistr.h uistr.c)
+	execute_process(
+		COMMAND ${CMAKE_COMMAND} -E compare_files ${MAIN_DIR}/${name} ${OUT_DIR}/${name}
+		RESULT_VARIABLE result)
+	if(NOT result EQUAL 0)
+		message(FATAL_ERROR "main/${name} is out of date; rebuild the uistr target")
+	endif()
+endforeach()
@@ -0,0 +1,228 @@
+//======================================================================
+//! @file   uistrgen.c
+//! @brief  UI文字列表の生成(main/uistr.txt → main/uistr.h, main/uistr.c)
+//! @note	使い方: uistrgen <uistr.txt> <uistr.h> <uistr.c>
+//! 		1行1文字列 "ID<TAB>文字列(UTF-8)"、'#'で始まる行と空行は無視する.
+//! 		各文字列をlcd_Puts()と同じ変換(char_TransUtf8ToSerial, font.h)で高さ8dotの列データにし、
+//! 		lcd_PutUiStr()がlcd_PutImage()1回で描ける形で出力する.
+//! 		文字列は1行のみ(改行・制御文字は不可).ホストのff_uni2oem()で変換できない文字はエラーにする.
+//======================================================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "charcode.h"
+#include "font.h"
+
+#define LINE_MAX		256
+#define STRINGS_MAX		256
+#define STRIP_MAX		0xffff				// 列データ全体の上限[byte](UiStr.offsetが16bit)
+
+typedef struct
+{
+	char id[64];
+	char text[LINE_MAX];
+	uint16_t offset;
+	uint16_t width;
+} Entry;
+
+static Entry s_entries[STRINGS_MAX];
+static uint8_t s_strips[STRIP_MAX];
+
+static int ReadTable(const char *path, int *count, uint32_t *bytes);
+static int WriteHeader(const char *path, int count);
+static int WriteSource(const char *path, int count, uint32_t bytes);
+
+int main(int argc, char *argv[])
+{
+	int count;
+	uint32_t bytes;
+
+	if(argc != 4)
+	{
+		fprintf(stderr, "usage: uistrgen <uistr.txt> <uistr.h> <uistr.c>\n");
+		return 2;
+	}
+	if(ReadTable(argv[1], &count, &bytes) != 0
+	|| WriteHeader(argv[2], count) != 0
+	|| WriteSource(argv[3], count, bytes) != 0)
+	{
+		return 1;
+	}
+	return 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  文字列表の読込と列データへの変換
+//! @param	path	[I]文字列表
+//! @param	count	[O]文字列数
+//! @param	bytes	[O]列データ全体のバイト数
+//! @return	0=成功
+//----------------------------------------------------------------------
+int ReadTable(const char *path, int *count, uint32_t *bytes)
+{
+	char line[LINE_MAX];
+	int lineNo = 0;
+	FILE *fp = fopen(path, "r");
+	if(fp == NULL)
+	{
+		perror(path);
+		return 1;
+	}
+
+	*count = 0;
+	*bytes = 0;
+	while(fgets(line, sizeof(line), fp) != NULL)
+	{
+		lineNo++;
+		line[strcspn(line, "\r\n")] = '\0';
+		if(line[0] == '\0' || line[0] == '#')
+		{
+			continue;
+		}
+
+		char *tab = strchr(line, '\t');
+		Entry *entry = &s_entries[*count];
+		if(tab == NULL || tab == line || (size_t)(tab - line) >= sizeof(entry->id) || *count >= STRINGS_MAX)
+		{
+			fprintf(stderr, "%s:%d: expected \"ID<TAB>text\"\n", path, lineNo);
+			fclose(fp);
+			return 1;
+		}
+		memcpy(entry->id, line, tab - line);
+		entry->id[tab - line] = '\0';
+		snprintf(entry->text, sizeof(entry->text), "%s", tab + 1);
+		entry->offset = (uint16_t)*bytes;
+
+		// lcd_Puts()と同じ変換で1文字ずつ列データを並べる
+		for(const char *text = entry->text; *text != '\0'; )
+		{
+			int width, length;
+			if((unsigned char)*text < 0x20)
+			{
+				fprintf(stderr, "%s:%d: control character in text\n", path, lineNo);
+				fclose(fp);
+				return 1;
+			}
+			int code = char_TransUtf8ToSerial(text, &width, &length);
+			const uint8_t *font = (width == 2) ? &jisFont[code * 8] : &asciiFont[code * 4];
+			if(length == 0 || code == 0 || *bytes + width * 4 > STRIP_MAX)
+			{
+				fprintf(stderr, "%s:%d: unknown character or table too large\n", path, lineNo);
+				fclose(fp);
+				return 1;
+			}
+			memcpy(&s_strips[*bytes], font, width * 4);
+			*bytes += width * 4;
+			text += length;
+		}
+		entry->width = (uint16_t)(*bytes - entry->offset);
+		(*count)++;
+	}
+	fclose(fp);
+	return 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ヘッダ出力(IDの列挙と表の宣言)
+//! @param	path	[I]出力先
+//! @param	count	[I]文字列数
+//! @return	0=成功
+//----------------------------------------------------------------------
+int WriteHeader(const char *path, int count)
+{
+	FILE *fp = fopen(path, "w");
+	if(fp == NULL)
+	{
+		perror(path);
+		return 1;
+	}
+
+	fprintf(fp,
+		"//======================================================================\n"
+		"//! @file   uistr.h\n"
+		"//! @brief  UI文字列表(uistr.txtからhost/tools/uistrgen.cで生成.直接編集しない)\n"
+		"//======================================================================\n"
+		"#ifndef _UISTR_H_\n"
+		"#define _UISTR_H_\n"
+		"\n"
+		"#include <stdint.h>\n"
+		"\n"
+		"// 文字列ID\n"
+		"typedef enum\n"
+		"{\n");
+	for(int i = 0; i < count; i++)
+	{
+		fprintf(fp, "\tUiStr_%s,\t\t// %s\n", s_entries[i].id, s_entries[i].text);
+	}
+	fprintf(fp,
+		"\tUiStr_Count\n"
+		"} UiStrId;\n"
+		"\n"
+		"// 文字列の列データ(高さ8dot, 1byte=1列)\n"
+		"typedef struct\n"
+		"{\n"
+		"\tuint16_t offset;\t\t// uiStrStrips内の位置\n"
+		"\tuint16_t width;\t\t\t// 幅[dot]\n"
+		"} UiStr;\n"
+		"\n"
+		"extern const UiStr uiStrTable[UiStr_Count];\n"
+		"extern const uint8_t uiStrStrips[];\n"
+		"\n"
+		"#endif\n");
+	return (fclose(fp) == 0) ? 0 : 1;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ソース出力(表と列データ)
+//! @param	path	[I]出力先
+//! @param	count	[I]文字列数
+//! @param	bytes	[I]列データ全体のバイト数
+//! @return	0=成功
+//----------------------------------------------------------------------
+int WriteSource(const char *path, int count, uint32_t bytes)
+{
+	FILE *fp = fopen(path, "w");
+	if(fp == NULL)
+	{
+		perror(path);
+		return 1;
+	}
+
+	fprintf(fp,
+		"//======================================================================\n"
+		"//! @file   uistr.c\n"
+		"//! @brief  UI文字列表(uistr.txtからhost/tools/uistrgen.cで生成.直接編集しない)\n"
+		"//======================================================================\n"
+		"#include <stdint.h>\n"
+		"\n"
+		"#include \"uistr.h\"\n"
+		"\n"
+		"const UiStr uiStrTable[UiStr_Count] =\n"
+		"{\n");
+	for(int i = 0; i < count; i++)
+	{
+		fprintf(fp, "\t{%u, %u},\t\t// UiStr_%s\n", s_entries[i].offset, s_entries[i].width, s_entries[i].id);
+	}
+	fprintf(fp,
+		"};\n"
+		"\n"
+		"const uint8_t uiStrStrips[%u] =\n"
+		"{\n", (unsigned)(bytes > 0 ? bytes : 1));
+	for(int i = 0; i < count; i++)
+	{
+		const Entry *entry = &s_entries[i];
+		fprintf(fp, "\t// %s\n", entry->text);
+		for(int x = 0; x < entry->width; x += 16)
+		{
+			fprintf(fp, "\t");
+			for(int n = x; n < x + 16 && n < entry->width; n++)
+			{
+				fprintf(fp, "0x%02x,%s", s_strips[entry->offset + n], (n + 1 < x + 16 && n + 1 < entry->width) ? " " : "");
+			}
+			fprintf(fp, "\n");
+		}
+	}
+	fprintf(fp, "};\n");
+	return (fclose(fp) == 0) ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+//======================================================================
+//! @file   bench.c
+//! @brief  描画ベンチマーク
+//! @note	lcd_PutImage, lcd_Puts, lcd_PutUiStr, lcd_DrawLineの主要な経路を計測する.
+//! 		VRAMへの描画のみでLCDへの転送は含まない.
+//======================================================================
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "lcd.h"
+#include "bench.h"
+
+// 8x8 (1行に収まる)
+static const uint8_t glyph8x8[8] = {0x00, 0x7e, 0x11, 0x11, 0x11, 0x7e, 0x00, 0x00};
+
+// 16x16 (2行)
+static const uint8_t image16x16[32] =
+{
+	0xff, 0x01, 0x7d, 0x45, 0x45, 0x7d, 0x01, 0xff, 0xff, 0x01, 0x7d, 0x45, 0x45, 0x7d, 0x01, 0xff,
+	0xff, 0x80, 0xbe, 0xa2, 0xa2, 0xbe, 0x80, 0xff, 0xff, 0x80, 0xbe, 0xa2, 0xa2, 0xbe, 0x80, 0xff,
+};
+static const uint8_t mask16x16[32] =
+{
+	0x3c, 0x7e, 0xff, 0xff, 0xff, 0xff, 0x7e, 0x3c, 0x3c, 0x7e, 0xff, 0xff, 0xff, 0xff, 0x7e, 0x3c,
+	0x3c, 0x7e, 0xff, 0xff, 0xff, 0xff, 0x7e, 0x3c, 0x3c, 0x7e, 0xff, 0xff, 0xff, 0xff, 0x7e, 0x3c,
+};
+
+// 全画面分の文字列
+static const char asciiText[] =
+	"The quick brown fox j"
+	"umps over the lazy do"
+	"g. 0123456789 !\"#$%&'"
+	"()*+,-./:;<=>?@[\\]^_`"
+	"ABCDEFGHIJKLMNOPQRSTU"
+	"VWXYZabcdefghijklmnop"
+	"qrstuvwxyz{|}~ The qu"
+	"ick brown fox jumps o";
+static const char japaneseUtf8Text[] =
+	"あいうえおかきくけこ"
+	"さしすせそたちつてと"
+	"なにぬねのはひふへほ"
+	"まみむめもやゆよらり"
+	"るれろわをんアイウエ"
+	"オカキクケコサシスセ"
+	"ソタチツテトナニヌネ"
+	"ノハヒフヘホマミムメ";
+static const char japaneseSjisText[] =
+	"\x82\xa0\x82\xa2\x82\xa4\x82\xa6\x82\xa8\x82\xa9\x82\xab\x82\xad\x82\xaf\x82\xb1"
+	"\x83\x41\x83\x43\x83\x45\x83\x47\x83\x49\x83\x4a\x83\x4c\x83\x4e\x83\x50\x83\x52"
+	"\x82\x60\x82\x61\x82\x62\x82\x63\x82\x64\x82\x65\x82\x66\x82\x67\x82\x68\x82\x69"
+	"\x82\x4f\x82\x50\x82\x51\x82\x52\x82\x53\x82\x54\x82\x55\x82\x56\x82\x57\x82\x58"
+	"\x82\xa0\x82\xa2\x82\xa4\x82\xa6\x82\xa8\x82\xa9\x82\xab\x82\xad\x82\xaf\x82\xb1"
+	"\x83\x41\x83\x43\x83\x45\x83\x47\x83\x49\x83\x4a\x83\x4c\x83\x4e\x83\x50\x83\x52"
+	"\x82\x60\x82\x61\x82\x62\x82\x63\x82\x64\x82\x65\x82\x66\x82\x67\x82\x68\x82\x69"
+	"\x82\x4f\x82\x50\x82\x51\x82\x52\x82\x53\x82\x54\x82\x55\x82\x56\x82\x57\x82\x58";
+
+//----- 画像 -----
+static void GlyphAligned(void)			{ Rect r = {40, 16, 8, 8};		lcd_PutImage(r, glyph8x8, NULL); }
+static void GlyphUnaligned(void)		{ Rect r = {40, 19, 8, 8};		lcd_PutImage(r, glyph8x8, NULL); }
+static void ImageAligned(void)			{ Rect r = {40, 16, 16, 16};	lcd_PutImage(r, image16x16, NULL); }
+static void ImageUnaligned(void)		{ Rect r = {40, 19, 16, 16};	lcd_PutImage(r, image16x16, NULL); }
+static void ImageMaskedAligned(void)	{ Rect r = {40, 16, 16, 16};	lcd_PutImage(r, image16x16, mask16x16); }
+static void ImageMaskedUnaligned(void)	{ Rect r = {40, 19, 16, 16};	lcd_PutImage(r, image16x16, mask16x16); }
+static void ClipLeft(void)				{ Rect r = {-8, 19, 16, 16};	lcd_PutImage(r, image16x16, NULL); }
+static void ClipRight(void)				{ Rect r = {120, 19, 16, 16};	lcd_PutImage(r, image16x16, NULL); }
+static void ClipTop(void)				{ Rect r = {40, -5, 16, 16};	lcd_PutImage(r, image16x16, NULL); }
+static void ClipBottom(void)			{ Rect r = {40, 53, 16, 16};	lcd_PutImage(r, image16x16, NULL); }
+
+//----- 文字列(全画面) -----
+static void PutsAscii(void)				{ Rect r = {0, 0, 128, 64};		lcd_Puts(r, asciiText, Code_Utf8); }
+static void PutsJapaneseUtf8(void)		{ Rect r = {0, 0, 128, 64};		lcd_Puts(r, japaneseUtf8Text, Code_Utf8); }
+static void PutsJapaneseSjis(void)		{ Rect r = {0, 0, 128, 64};		lcd_Puts(r, japaneseSjisText, Code_Sjis); }
+
+//----- UI文字列(同じ文字列をlcd_Puts()と列データで描く) -----
+static void LabelAsciiPuts(void)		{ Rect r = {108, 0, 20, 8};		lcd_Puts(r, "--:--", Code_Utf8); }
+static void LabelAsciiUiStr(void)		{ Rect r = {108, 0, 20, 8};		lcd_PutUiStr(r, UiStr_TimeUnset); }
+static void LabelJapanesePuts(void)		{ Rect r = {0, 56, 128, 8};		lcd_Puts(r, "SDカードエラー", Code_Utf8); }
+static void LabelJapaneseUiStr(void)	{ Rect r = {0, 56, 128, 8};		lcd_PutUiStr(r, UiStr_SdError); }
+
+//----- 直線 -----
+static void LineDiagonal(void)			{ lcd_DrawLine(0, 0, 127, 63); }
+static void LineSteep(void)				{ lcd_DrawLine(60, 0, 67, 63); }
+static void LineHorizontal(void)		{ lcd_DrawLine(0, 21, 127, 21); }
+static void LineVertical(void)			{ lcd_DrawLine(21, 0, 21, 63); }
+
+const BenchCase bench_renderCases[] =
+{
+	{"GlyphAligned", GlyphAligned},
+	{"GlyphUnaligned", GlyphUnaligned},
+	{"ImageAligned", ImageAligned},
+	{"ImageUnaligned", ImageUnaligned},
+	{"ImageMaskedAligned", ImageMaskedAligned},
+	{"ImageMaskedUnaligned", ImageMaskedUnaligned},
+	{"ClipLeft", ClipLeft},
+	{"ClipRight", ClipRight},
+	{"ClipTop", ClipTop},
+	{"ClipBottom", ClipBottom},
+	{"PutsAscii", PutsAscii},
+	{"PutsJapaneseUtf8", PutsJapaneseUtf8},
+	{"PutsJapaneseSjis", PutsJapaneseSjis},
+	{"LabelAsciiPuts", LabelAsciiPuts},
+	{"LabelAsciiUiStr", LabelAsciiUiStr},
+	{"LabelJapanesePuts", LabelJapanesePuts},
+	{"LabelJapaneseUiStr", LabelJapaneseUiStr},
+	{"LineDiagonal", LineDiagonal},
+	{"LineSteep", LineSteep},
+	{"LineHorizontal", LineHorizontal},
+	{"LineVertical", LineVertical},
+	{NULL, NULL}
+};
+
+//----------------------------------------------------------------------
+//! @brief  描画ベンチマーク実行
+//! @param	filter		[I]ケース名に含まれる文字列 NULL=全ケース
+//! @param	iterations	[I]1ケースあたりの実行回数
+//! @note	結果は1ケース1行のJSONで標準出力へ出す.
+//! 		描画用ミューテックスを計測中保持し、終了後に画面を消去する.
+//----------------------------------------------------------------------
+void bench_RunRender(const char *filter, int iterations)
+{
+	uint32_t start, cycles;
+
+	if(iterations <= 0)
+	{
+		iterations = 1;
+	}
+	for(const BenchCase *bench = bench_renderCases; bench->name != NULL; bench++)
+	{
+		if(filter != NULL && strstr(bench->name, filter) == NULL)
+		{
+			continue;
+		}
+
+		lcd_BeginDrawing();
+		bench->run();					// キャッシュ・分岐予測を温める
+		start = bench_GetCycleCount();
+		for(int i = 0; i < iterations; i++)
+		{
+			bench->run();
+		}
+		cycles = bench_GetCycleCount() - start;
+		lcd_Cls();
+		lcd_EndDrawing();
+
+#ifdef BENCH_CYCLES_PER_US
+		printf("{\"name\":\"render/%s\",\"iterations\":%d,\"cycles_per_op\":%u,\"ns_per_op\":%u}\n",
+			bench->name, iterations, (unsigned)(cycles / iterations),
+			(unsigned)((uint64_t)cycles * 1000 / BENCH_CYCLES_PER_US / iterations));
+#else
+		printf("{\"name\":\"render/%s\",\"iterations\":%d,\"cycles_per_op\":%u}\n",
+			bench->name, iterations, (unsigned)(cycles / iterations));
+#endif
+	}
+}
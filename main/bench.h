@@ -0,0 +1,53 @@
+//======================================================================
+//! @file   bench.h
+//! @brief  描画ベンチマーク
+//! @note	実機(CCOUNTレジスタ)とホスト(TSC)で同じケースを計測する.
+//======================================================================
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <stdint.h>
+
+#if defined(__XTENSA__)
+#include "sdkconfig.h"
+#define BENCH_CYCLES_PER_US		CONFIG_ESP8266_DEFAULT_CPU_FREQ_MHZ		// CCOUNTのカウント数/us
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+// 起動時に描画ベンチマークを実行する(0=しない)
+#define BENCH_RUN_ON_BOOT	0
+
+// ベンチマークケース
+typedef struct
+{
+	const char *name;		// ケース名
+	void (*run)(void);		// 1回分の処理(描画中に呼ぶ)
+} BenchCase;
+
+extern const BenchCase bench_renderCases[];		// 描画ケース一覧({NULL}で終端)
+
+void bench_RunRender(const char *filter, int iterations);
+
+//----------------------------------------------------------------------
+//! @brief  サイクルカウンタ取得
+//! @return	カウンタ値(実機:CPUクロック, x86:TSC, その他:ns)
+//----------------------------------------------------------------------
+static inline uint32_t bench_GetCycleCount(void)
+{
+#if defined(__XTENSA__)
+	uint32_t ccount;
+	__asm__ __volatile__("rsr %0, ccount" : "=a"(ccount));
+	return ccount;
+#elif defined(__x86_64__) || defined(__i386__)
+	return (uint32_t)__rdtsc();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)(ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+#endif
+}
+
+#endif
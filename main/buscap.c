@@ -0,0 +1,192 @@
+//======================================================================
+//! @file   buscap.c
+//! @brief  SPIバス転送の記録
+//! @note	時刻は実機ではCCOUNT(CPUクロック)、ホストでは仮想時計[ns].
+//! 		BUSCAP_ENABLE=0でも--wrapのリンク指定があるので、__wrap_spi_trans()は常に定義する.
+//======================================================================
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+#include "driver/spi.h"
+#include "esp8266/spi_struct.h"
+
+#include "global.h"
+#include "buscap.h"
+
+esp_err_t __real_spi_trans(spi_host_t host, spi_trans_t *trans);
+
+#if BUSCAP_ENABLE
+
+#if defined(__XTENSA__)
+#include "bench.h"
+#define BUSCAP_TICKS_PER_US	BENCH_CYCLES_PER_US
+#define GetTimestamp()		bench_GetCycleCount()
+#else
+#include "sim.h"
+#define BUSCAP_TICKS_PER_US	1000
+#define GetTimestamp()		((uint32_t)sim_GetTimeNs())
+#endif
+
+//----- 定数 -----
+static const uint32_t apbClockKhz = 80000;			// SPIクロック源[kHz]
+
+//----- 変数 -----
+static BusCapRecord s_records[BUSCAP_MAX_RECORDS];	// 記録
+static uint32_t s_count;							// 記録数
+static uint32_t s_dropped;							// 満杯で記録できなかった転送数
+static volatile int s_isRecording;					// 記録中
+
+//----- プロトタイプ宣言 -----
+static uint16_t GetClockKhz(void);
+
+//----------------------------------------------------------------------
+//! @brief  記録開始
+//! @note	それまでの記録は消去する.
+//----------------------------------------------------------------------
+void buscap_Start(void)
+{
+	vPortEnterCritical();
+	s_count = 0;
+	s_dropped = 0;
+	s_isRecording = 1;
+	vPortExitCritical();
+}
+
+//----------------------------------------------------------------------
+//! @brief  記録停止
+//----------------------------------------------------------------------
+void buscap_Stop(void)
+{
+	s_isRecording = 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  記録取得(古い順)
+//! @param	records		[O]記録
+//! @param	maxCount	[I]recordsの要素数
+//! @return	取得数
+//----------------------------------------------------------------------
+int buscap_GetRecords(BusCapRecord *records, int maxCount)
+{
+	int count;
+
+	vPortEnterCritical();
+	count = (s_count < (uint32_t)maxCount) ? (int)s_count : maxCount;
+	memcpy(records, s_records, count * sizeof(BusCapRecord));
+	vPortExitCritical();
+
+	return count;
+}
+
+//----------------------------------------------------------------------
+//! @brief  記録数
+//! @return	buscap_Start()からの記録数
+//----------------------------------------------------------------------
+uint32_t buscap_GetCount(void)
+{
+	return s_count;
+}
+
+//----------------------------------------------------------------------
+//! @brief  満杯で記録できなかった転送数
+//! @return	buscap_Start()からの数
+//----------------------------------------------------------------------
+uint32_t buscap_GetDropCount(void)
+{
+	return s_dropped;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ファイルへ保存
+//! @param	fp	[I]出力先(バイナリ)
+//! @return	RET_OK=成功 RET_NG=書込失敗
+//! @note	保存先がSDカードだと保存自体が記録されるので、記録を止めてから呼ぶ.
+//----------------------------------------------------------------------
+int buscap_Save(FILE *fp)
+{
+	BusCapHeader header;
+
+	header.magic = BUSCAP_MAGIC;
+	header.version = BUSCAP_VERSION;
+	header.recordSize = sizeof(BusCapRecord);
+	header.ticksPerUs = BUSCAP_TICKS_PER_US;
+	header.count = s_count;
+	header.dropped = s_dropped;
+	if(fwrite(&header, sizeof(header), 1, fp) != 1)
+	{
+		return RET_NG;
+	}
+	if(s_count > 0 && fwrite(s_records, sizeof(BusCapRecord), s_count, fp) != s_count)
+	{
+		return RET_NG;
+	}
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  SPI転送(spi_trans()の差し替え)
+//! @note	記録中は転送前のピン状態と転送時間を記録する.
+//----------------------------------------------------------------------
+esp_err_t __wrap_spi_trans(spi_host_t host, spi_trans_t *trans)
+{
+	if(!s_isRecording || host != HSPI_HOST)
+	{
+		return __real_spi_trans(host, trans);
+	}
+
+	uint8_t pins = (gpio_get_level(GPIO_SDCS_NUM) ? BUSCAP_PIN_SDCS : 0)
+		| (gpio_get_level(GPIO_LCDCS_NUM) ? BUSCAP_PIN_LCDCS : 0)
+		| (gpio_get_level(GPIO_MISO_LCDRS_NUM) ? BUSCAP_PIN_RS : 0);
+	uint16_t clockKhz = GetClockKhz();
+	uint32_t start = GetTimestamp();
+
+	esp_err_t ret = __real_spi_trans(host, trans);
+
+	uint32_t end = GetTimestamp();
+	vPortEnterCritical();
+	if(s_count < BUSCAP_MAX_RECORDS)
+	{
+		BusCapRecord *record = &s_records[s_count++];
+		record->start = start;
+		record->duration = end - start;
+		record->txBytes = (uint16_t)((trans->bits.cmd + trans->bits.addr + trans->bits.mosi) / 8);
+		record->rxBytes = (uint16_t)(trans->bits.miso / 8);
+		record->clockKhz = clockKhz;
+		record->device = (!(pins & BUSCAP_PIN_SDCS) && !(pins & BUSCAP_PIN_LCDCS)) ? BusDevice_Both
+			: !(pins & BUSCAP_PIN_SDCS) ? BusDevice_Sd
+			: !(pins & BUSCAP_PIN_LCDCS) ? BusDevice_Lcd
+			: BusDevice_None;
+		record->pins = pins;
+	}
+	else
+	{
+		s_dropped++;
+	}
+	vPortExitCritical();
+
+	return ret;
+}
+
+//----------------------------------------------------------------------
+//! @brief  現在のSPIクロック
+//! @return	周波数[kHz]
+//----------------------------------------------------------------------
+uint16_t GetClockKhz(void)
+{
+	if(SPI1.clock.clk_equ_sysclk)
+	{
+		return (uint16_t)apbClockKhz;
+	}
+	return (uint16_t)(apbClockKhz / ((SPI1.clock.clkcnt_n + 1) * (SPI1.clock.clkdiv_pre + 1)));
+}
+
+#else
+
+esp_err_t __wrap_spi_trans(spi_host_t host, spi_trans_t *trans)
+{
+	return __real_spi_trans(host, trans);
+}
+
+#endif
@@ -0,0 +1,67 @@
+//======================================================================
+//! @file   buscap.h
+//! @brief  SPIバス転送の記録
+//! @note	BUSCAP_ENABLEを1にしたときだけ記録処理が組み込まれる.
+//! 		spi_trans()をリンカの--wrapで差し替え、1転送を1件(16byte)として記録する.
+//! 		保存形式(リトルエンディアン):
+//! 		  BusCapHeader + BusCapRecord × count
+//! 		解析はホストのbusreplay(host/tools)で行う.
+//======================================================================
+#ifndef _BUSCAP_H_
+#define _BUSCAP_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifndef BUSCAP_ENABLE
+#define BUSCAP_ENABLE		0			// 1=バス記録有効
+#endif
+#define BUSCAP_MAX_RECORDS	512			// 記録できる転送数(満杯で記録を止める, 8KiB)
+#define BUSCAP_MAGIC		0x50414342UL	// "BCAP"
+#define BUSCAP_VERSION		1
+
+// 転送相手
+typedef enum
+{
+	BusDevice_None = 0,				// CSなし
+	BusDevice_Sd,					// SDカード(CS=GPIO4)
+	BusDevice_Lcd,					// LCD(CS=GPIO5)
+	BusDevice_Both,					// 両方選択(異常)
+} BusDevice;
+
+// ピン状態(BusCapRecord.pins)
+#define BUSCAP_PIN_SDCS		0x01	// SD CS=H
+#define BUSCAP_PIN_LCDCS	0x02	// LCD CS=H
+#define BUSCAP_PIN_RS		0x04	// GPIO12=H(LCD RS=データ)
+
+// ファイルヘッダ
+typedef struct
+{
+	uint32_t magic;					// BUSCAP_MAGIC
+	uint16_t version;				// BUSCAP_VERSION
+	uint16_t recordSize;			// sizeof(BusCapRecord)
+	uint32_t ticksPerUs;			// 時刻の分解能[tick/us]
+	uint32_t count;					// 記録数
+	uint32_t dropped;				// 満杯で記録できなかった転送数
+} BusCapHeader;
+
+// 1転送の記録
+typedef struct
+{
+	uint32_t start;					// 開始時刻[tick](32bitで折り返す)
+	uint32_t duration;				// 所要時間[tick]
+	uint16_t txBytes;				// 送信バイト数(cmd+addr+mosi)
+	uint16_t rxBytes;				// 受信バイト数(miso)
+	uint16_t clockKhz;				// SPIクロック[kHz]
+	uint8_t device;					// BusDevice
+	uint8_t pins;					// BUSCAP_PIN_*
+} BusCapRecord;
+
+void buscap_Start(void);
+void buscap_Stop(void);
+int buscap_GetRecords(BusCapRecord *records, int maxCount);
+uint32_t buscap_GetCount(void);
+uint32_t buscap_GetDropCount(void);
+int buscap_Save(FILE *fp);
+
+#endif
@@ -3,3 +3,11 @@
 #
 # (Uses default behaviour of compiling all source files in directory, adding 'include' to include path.)
 
+# FatFs LFN work buffers (CONFIG_FATFS_LFN_HEAP) come from pool.c
+COMPONENT_ADD_LDFLAGS += -Wl,--wrap=ff_memalloc -Wl,--wrap=ff_memfree
+
+# SPI transactions pass through buscap.c (recorded only when BUSCAP_ENABLE=1)
+COMPONENT_ADD_LDFLAGS += -Wl,--wrap=spi_trans
+
+# SNTP time updates pass through wifi.c to measure clock drift (rtctime.c)
+COMPONENT_ADD_LDFLAGS += -Wl,--wrap=settimeofday
@@ -0,0 +1,861 @@
+//======================================================================
+//! @file   console.c
+//! @brief  シリアルコンソール(UART0)
+//! @note	1行1コマンド.結果は1行1件のJSONで出力する.
+//! 		コマンドの最後には必ず {"cmd":"<コマンド>","status":"ok"|"error"} 行を出すので、
+//! 		試験装置側はこの行まで読めば1コマンド分の結果がそろう.
+//======================================================================
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/uart.h"
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+
+#include "global.h"
+#include "console.h"
+#include "bench.h"
+#include "buscap.h"
+#include "ds18b20.h"
+#include "hottail.h"
+#include "http.h"
+#include "lcd.h"
+#include "monitor.h"
+#include "pool.h"
+#include "rtctime.h"
+#include "sd.h"
+#include "sleeplog.h"
+#include "trace.h"
+#include "viewer.h"
+
+//----- 定義 -----
+#define LINE_SIZE		64			// 1行の最大文字数
+#define MAX_ARGS		6			// 最大引数数(コマンド名含む)
+#define SECTOR_SIZE		512			// SDランダムアクセス単位[byte]
+
+typedef struct
+{
+	const char *name;								// コマンド名
+	const char *usage;								// 書式
+	int (*function)(int argc, char *argv[]);		// 処理 RET_OK=成功
+} Command;
+
+//----- 定数 -----
+static const char *scratchFile = "/sd/bench.tmp";	// SDベンチマーク用ファイル
+static const char *traceFile = "/sd/trace.json";	// トレース保存先(既定)
+static const char *busCaptureFile = "/sd/bus.cap";	// バス記録保存先(既定)
+static const int sdChunkSize = 4096;				// SDシーケンシャルアクセス単位[byte]
+
+//----- 変数 -----
+static PoolArena s_arena;							// 実行中コマンドの一時領域
+
+//----- プロトタイプ宣言 -----
+static void ConsoleTask(void *arg);
+static int CommandHelp(int argc, char *argv[]);
+static int CommandSdBench(int argc, char *argv[]);
+static int CommandLcdBench(int argc, char *argv[]);
+static int CommandRender(int argc, char *argv[]);
+static int CommandCounters(int argc, char *argv[]);
+static int CommandTasks(int argc, char *argv[]);
+static int CommandHeap(int argc, char *argv[]);
+static int CommandTrace(int argc, char *argv[]);
+static int CommandBusCap(int argc, char *argv[]);
+static int CommandWear(int argc, char *argv[]);
+static int CommandFormat(int argc, char *argv[]);
+static int CommandView(int argc, char *argv[]);
+static int CommandRotate(int argc, char *argv[]);
+static int CommandSleepLog(int argc, char *argv[]);
+static int CommandTime(int argc, char *argv[]);
+static int CommandHttp(int argc, char *argv[]);
+static int CommandCache(int argc, char *argv[]);
+static int CommandTemp(int argc, char *argv[]);
+static int SdSequential(int isWrite, long kiloBytes);
+static int SdRandom(int isWrite, long count);
+
+static const Command commands[] =
+{
+	{"help",     "help",                                  CommandHelp},
+	{"sdbench",  "sdbench seq|rand read|write [kB|count]", CommandSdBench},
+	{"lcdbench", "lcdbench [frames]",                     CommandLcdBench},
+	{"render",   "render [filter] [iterations]",          CommandRender},
+	{"counters", "counters",                              CommandCounters},
+	{"tasks",    "tasks",                                 CommandTasks},
+	{"heap",     "heap",                                  CommandHeap},
+	{"trace",    "trace [clear|save [path]]",             CommandTrace},
+	{"buscap",   "buscap start|stop|save [path]",         CommandBusCap},
+	{"wear",     "wear [clear]",                          CommandWear},
+	{"format",   "format confirm",                        CommandFormat},
+	{"view",     "view <path> [page] [sjis]",             CommandView},
+	{"rotate",   "rotate [0|90|270]",                     CommandRotate},
+	{"sleeplog", "sleeplog [start <sec> [batch]|stop]",   CommandSleepLog},
+	{"time",     "time",                                  CommandTime},
+	{"http",     "http",                                  CommandHttp},
+	{"cache",    "cache",                                 CommandCache},
+	{"temp",     "temp [search]",                         CommandTemp},
+	{NULL, NULL, NULL}
+};
+
+//----------------------------------------------------------------------
+//! @brief  コンソール初期化
+//! @note	UART0はログ出力と共用.起動時に1回だけ呼ぶ.
+//----------------------------------------------------------------------
+void console_Initialize(void)
+{
+	const int rxBufferSize = 256;
+	const uint16_t taskStackSize = 3072;
+	const UBaseType_t taskPriority = 2;
+
+	uart_driver_install(UART_NUM_0, rxBufferSize, 0, 0, NULL);
+	xTaskCreate(ConsoleTask, "console", taskStackSize, NULL, taskPriority, NULL);
+}
+
+//----------------------------------------------------------------------
+//! @brief  1行実行
+//! @param	line	[IO]コマンド行(区切り文字で分割するため書き換える)
+//! @return	RET_OK=成功 RET_NG=失敗/不明なコマンド
+//----------------------------------------------------------------------
+int console_Execute(char *line)
+{
+	char *argv[MAX_ARGS];
+	int argc = 0;
+	char *save;
+	int ret = RET_NG;
+
+	for(char *token = strtok_r(line, " \t", &save); token != NULL && argc < MAX_ARGS; token = strtok_r(NULL, " \t", &save))
+	{
+		argv[argc++] = token;
+	}
+	if(argc == 0)
+	{
+		return RET_OK;
+	}
+
+	const Command *command;
+	for(command = commands; command->name != NULL; command++)
+	{
+		if(strcmp(argv[0], command->name) == 0)
+		{
+			pool_ArenaBegin(&s_arena);
+			ret = command->function(argc, argv);
+			pool_ArenaEnd(&s_arena);
+			break;
+		}
+	}
+	if(command->name == NULL)
+	{
+		printf("{\"error\":\"unknown command\"}\n");
+	}
+	printf("{\"cmd\":\"%s\",\"status\":\"%s\"}\n", argv[0], (ret == RET_OK) ? "ok" : "error");
+	fflush(stdout);
+
+	return ret;
+}
+
+//----------------------------------------------------------------------
+//! @brief  コンソールタスク
+//! @param	arg		[I]パラメータ(未使用)
+//----------------------------------------------------------------------
+void ConsoleTask(void *arg)
+{
+	char line[LINE_SIZE + 1];
+	int length = 0;
+	uint8_t c;
+
+	while(1)
+	{
+		if(uart_read_bytes(UART_NUM_0, &c, 1, portMAX_DELAY) != 1)
+		{
+			continue;
+		}
+		if(c == '\r' || c == '\n')
+		{
+			line[length] = '\0';
+			length = 0;
+			console_Execute(line);
+		}
+		else if(length < LINE_SIZE)
+		{
+			line[length++] = (char)c;
+		}
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  help: コマンド一覧
+//----------------------------------------------------------------------
+int CommandHelp(int argc, char *argv[])
+{
+	for(const Command *command = commands; command->name != NULL; command++)
+	{
+		printf("{\"usage\":\"%s\"}\n", command->usage);
+	}
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  sdbench: SDカード読込/書込速度
+//! @note	seq write [kB]  : スクラッチファイルを指定サイズで作り直す(既定256kB)
+//! 		seq read        : スクラッチファイル全体を読む
+//! 		rand read|write [count] : スクラッチファイル内の512byteをランダムに読む/書く(既定100回)
+//----------------------------------------------------------------------
+int CommandSdBench(int argc, char *argv[])
+{
+	if(argc < 3)
+	{
+		printf("{\"error\":\"missing argument\"}\n");
+		return RET_NG;
+	}
+
+	int isWrite = (strcmp(argv[2], "write") == 0);
+	if(!isWrite && strcmp(argv[2], "read") != 0)
+	{
+		printf("{\"error\":\"read or write\"}\n");
+		return RET_NG;
+	}
+
+	if(strcmp(argv[1], "seq") == 0)
+	{
+		return SdSequential(isWrite, (argc >= 4) ? atol(argv[3]) : 256);
+	}
+	if(strcmp(argv[1], "rand") == 0)
+	{
+		return SdRandom(isWrite, (argc >= 4) ? atol(argv[3]) : 100);
+	}
+	printf("{\"error\":\"seq or rand\"}\n");
+	return RET_NG;
+}
+
+//----------------------------------------------------------------------
+//! @brief  シーケンシャル読込/書込
+//! @param	isWrite		[I]!0=書込
+//! @param	kiloBytes	[I]書込サイズ[kB]
+//! @return	RET_OK=成功
+//----------------------------------------------------------------------
+int SdSequential(int isWrite, long kiloBytes)
+{
+	uint8_t *buff = malloc(sdChunkSize);
+	if(buff == NULL)
+	{
+		printf("{\"error\":\"no memory\"}\n");
+		return RET_NG;
+	}
+	for(int i = 0; i < sdChunkSize; i++)
+	{
+		buff[i] = (uint8_t)i;
+	}
+
+	FILE *fp = fopen(scratchFile, isWrite ? "wb" : "rb");
+	if(fp == NULL)
+	{
+		free(buff);
+		printf("{\"error\":\"cannot open %s\"}\n", scratchFile);
+		return RET_NG;
+	}
+
+	int ret = RET_OK;
+	uint32_t bytes = 0, ops = 0;
+	size_t size;
+	int64_t start = esp_timer_get_time();
+	if(isWrite)
+	{
+		for(long remain = kiloBytes * 1024; remain > 0; remain -= size)
+		{
+			size = (remain < sdChunkSize) ? remain : sdChunkSize;
+			if(fwrite(buff, 1, size, fp) != size)
+			{
+				ret = RET_NG;
+				break;
+			}
+			bytes += size;
+			ops++;
+		}
+	}
+	else
+	{
+		while((size = fread(buff, 1, sdChunkSize, fp)) > 0)
+		{
+			bytes += size;
+			ops++;
+		}
+	}
+	fclose(fp);
+	uint32_t us = (uint32_t)(esp_timer_get_time() - start);
+	free(buff);
+
+	printf("{\"name\":\"sd/seq_%s\",\"bytes\":%u,\"ops\":%u,\"us\":%u,\"kb_per_s\":%u}\n",
+		isWrite ? "write" : "read", bytes, ops, us, (us > 0) ? (uint32_t)((uint64_t)bytes * 1000000 / 1024 / us) : 0);
+	if(ret != RET_OK)
+	{
+		printf("{\"error\":\"write failed\"}\n");
+	}
+	return ret;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ランダム読込/書込(512byte単位)
+//! @param	isWrite		[I]!0=書込
+//! @param	count		[I]回数
+//! @return	RET_OK=成功
+//! @note	位置は固定シードの疑似乱数で決めるので毎回同じ順序になる.
+//----------------------------------------------------------------------
+int SdRandom(int isWrite, long count)
+{
+	uint8_t buff[SECTOR_SIZE];
+	uint32_t seed = 1;
+
+	FILE *fp = fopen(scratchFile, isWrite ? "r+b" : "rb");
+	if(fp == NULL)
+	{
+		printf("{\"error\":\"cannot open %s (run sdbench seq write first)\"}\n", scratchFile);
+		return RET_NG;
+	}
+	fseek(fp, 0, SEEK_END);
+	long sectors = ftell(fp) / SECTOR_SIZE;
+	if(sectors <= 0)
+	{
+		fclose(fp);
+		printf("{\"error\":\"scratch file is empty\"}\n");
+		return RET_NG;
+	}
+	memset(buff, 0x5a, sizeof(buff));
+
+	int ret = RET_OK;
+	uint32_t ops = 0;
+	int64_t start = esp_timer_get_time();
+	for(long i = 0; i < count; i++)
+	{
+		seed = seed * 1103515245UL + 12345UL;
+		fseek(fp, (long)((seed >> 8) % sectors) * SECTOR_SIZE, SEEK_SET);
+		size_t size = isWrite ? fwrite(buff, 1, sizeof(buff), fp) : fread(buff, 1, sizeof(buff), fp);
+		if(size != sizeof(buff))
+		{
+			ret = RET_NG;
+			break;
+		}
+		ops++;
+	}
+	fclose(fp);
+	uint32_t us = (uint32_t)(esp_timer_get_time() - start);
+
+	printf("{\"name\":\"sd/rand_%s\",\"bytes\":%u,\"ops\":%u,\"us\":%u,\"us_per_op\":%u}\n",
+		isWrite ? "write" : "read", ops * SECTOR_SIZE, ops, us, (ops > 0) ? us / ops : 0);
+	if(ret != RET_OK)
+	{
+		printf("{\"error\":\"%s failed\"}\n", isWrite ? "write" : "read");
+	}
+	return ret;
+}
+
+//----------------------------------------------------------------------
+//! @brief  lcdbench: 全画面転送時間
+//! @note	画面は消去される.
+//----------------------------------------------------------------------
+int CommandLcdBench(int argc, char *argv[])
+{
+	int frames = (argc >= 2) ? atoi(argv[1]) : 10;
+	LcdCounters before, after;
+
+	if(frames <= 0)
+	{
+		frames = 1;
+	}
+	lcd_GetCounters(&before);
+	int64_t start = esp_timer_get_time();
+	for(int i = 0; i < frames; i++)
+	{
+		lcd_BeginDrawing();
+		lcd_Cls();
+		lcd_EndDrawing();
+		lcd_Update();
+	}
+	uint32_t us = (uint32_t)(esp_timer_get_time() - start);
+	lcd_GetCounters(&after);
+
+	printf("{\"name\":\"lcd/full_refresh\",\"frames\":%d,\"us\":%u,\"us_per_frame\":%u,\"bytes_per_frame\":%u}\n",
+		frames, us, us / frames,
+		(after.commandBytes + after.dataBytes - before.commandBytes - before.dataBytes) / frames);
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  render: 描画ベンチマーク(bench.c)
+//----------------------------------------------------------------------
+int CommandRender(int argc, char *argv[])
+{
+	const char *filter = (argc >= 2 && strcmp(argv[1], "*") != 0) ? argv[1] : NULL;
+	int iterations = (argc >= 3) ? atoi(argv[2]) : 1000;
+
+	bench_RunRender(filter, iterations);
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  counters: ドライバ統計
+//----------------------------------------------------------------------
+int CommandCounters(int argc, char *argv[])
+{
+	SdCounters sd;
+	LcdCounters lcd;
+
+	sd_GetCounters(&sd);
+	lcd_GetCounters(&lcd);
+	printf("{\"counters\":\"sd\",\"init\":%u,\"read\":%u,\"read_sectors\":%u,\"write\":%u,\"write_sectors\":%u,\"errors\":%u,\"timeouts\":%u}\n",
+		sd.initCount, sd.readCount, sd.readSectors, sd.writeCount, sd.writeSectors, sd.errorCount, sd.timeoutCount);
+	printf("{\"counters\":\"lcd\",\"updates\":%u,\"command_bytes\":%u,\"data_bytes\":%u}\n",
+		lcd.updateCount, lcd.commandBytes, lcd.dataBytes);
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  tasks: タスク一覧(CPU使用率, スタック残量)
+//! @note	CPU使用率は前回のサンプル(監視タスクまたはtasksコマンド)からの区間で計算する.
+//----------------------------------------------------------------------
+int CommandTasks(int argc, char *argv[])
+{
+	MonTaskStats *stats = pool_ArenaAlloc(&s_arena, MON_MAX_TASKS * sizeof(MonTaskStats));
+	int count;
+
+	if(stats == NULL)
+	{
+		printf("{\"error\":\"no memory\"}\n");
+		return RET_NG;
+	}
+	count = mon_Sample(stats, MON_MAX_TASKS);
+	if(count < 0)
+	{
+		printf("{\"error\":\"task statistics unavailable\"}\n");
+		return RET_NG;
+	}
+	for(int i = 0; i < count; i++)
+	{
+		printf("{\"task\":\"%s\",\"number\":%u,\"priority\":%u,\"state\":\"%c\",\"stack_free\":%u,\"cpu_permille\":%u}\n",
+			stats[i].name, stats[i].number, stats[i].priority, stats[i].state, stats[i].stackFree, stats[i].cpuPermille);
+	}
+	printf("{\"stack_warnings\":%u}\n", mon_GetWarningCount());
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  heap: ヒープ/プール使用状況
+//! @note	dram=バイトアクセス可能領域, iram=32bitアクセスのみの領域
+//! 		pool=ブロックサイズごとの使用状況, fallback=プール枯渇でヒープへ回した回数
+//----------------------------------------------------------------------
+int CommandHeap(int argc, char *argv[])
+{
+	size_t total = heap_caps_get_free_size(MALLOC_CAP_32BIT);
+	size_t dram = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+	PoolClassStats poolClass;
+	PoolStats pool;
+
+	printf("{\"heap\":\"total\",\"free\":%u,\"min_free\":%u}\n",
+		(unsigned)esp_get_free_heap_size(), (unsigned)esp_get_minimum_free_heap_size());
+	printf("{\"heap\":\"dram\",\"free\":%u}\n", (unsigned)dram);
+	printf("{\"heap\":\"iram\",\"free\":%u}\n", (unsigned)(total - dram));
+	for(int i = 0; pool_GetClassStats(i, &poolClass) == RET_OK; i++)
+	{
+		printf("{\"pool\":%u,\"blocks\":%u,\"in_use\":%u,\"peak\":%u,\"allocs\":%u,\"exhausted\":%u}\n",
+			poolClass.blockSize, poolClass.blockCount, poolClass.inUse, poolClass.peakInUse, poolClass.allocCount, poolClass.exhaustedCount);
+	}
+	pool_GetStats(&pool);
+	printf("{\"pool\":\"fallback\",\"count\":%u,\"bytes\":%u,\"failed\":%u,\"arena_overflows\":%u}\n",
+		pool.fallbackCount, pool.fallbackBytes, pool.failCount, pool.arenaOverflowCount);
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  trace: イベントトレース出力
+//! @note	trace            : 1行1イベント(Chrome traceのイベント形式)で出力
+//! 		trace clear      : 記録消去
+//! 		trace save [path]: Chrome trace形式(JSON配列)でファイルに保存(既定/sd/trace.json)
+//! 		TRACE_ENABLE=1でビルドしたときのみ使用可能.
+//----------------------------------------------------------------------
+int CommandTrace(int argc, char *argv[])
+{
+#if TRACE_ENABLE
+	if(argc >= 2 && strcmp(argv[1], "clear") == 0)
+	{
+		trace_Clear();
+		return RET_OK;
+	}
+	if(argc >= 2 && strcmp(argv[1], "save") == 0)
+	{
+		const char *path = (argc >= 3) ? argv[2] : traceFile;
+		FILE *fp = fopen(path, "w");
+		if(fp == NULL)
+		{
+			printf("{\"error\":\"cannot open %s\"}\n", path);
+			return RET_NG;
+		}
+		trace_Export(fp, 0);
+		fclose(fp);
+	}
+	else
+	{
+		trace_Export(stdout, 1);
+	}
+	printf("{\"trace_dropped\":%u}\n", trace_GetDropCount());
+	return RET_OK;
+#else
+	printf("{\"error\":\"built without TRACE_ENABLE\"}\n");
+	return RET_NG;
+#endif
+}
+
+//----------------------------------------------------------------------
+//! @brief  buscap: SPIバス転送の記録
+//! @note	buscap start      : 記録開始(それまでの記録は消去)
+//! 		buscap stop       : 記録停止
+//! 		buscap save [path]: 記録を止めてファイルに保存(既定/sd/bus.cap)
+//! 		BUSCAP_ENABLE=1でビルドしたときのみ使用可能.
+//----------------------------------------------------------------------
+int CommandBusCap(int argc, char *argv[])
+{
+#if BUSCAP_ENABLE
+	if(argc < 2)
+	{
+		printf("{\"error\":\"missing argument\"}\n");
+		return RET_NG;
+	}
+	if(strcmp(argv[1], "start") == 0)
+	{
+		buscap_Start();
+		return RET_OK;
+	}
+	if(strcmp(argv[1], "stop") != 0 && strcmp(argv[1], "save") != 0)
+	{
+		printf("{\"error\":\"start, stop or save\"}\n");
+		return RET_NG;
+	}
+
+	buscap_Stop();
+	if(strcmp(argv[1], "save") == 0)
+	{
+		const char *path = (argc >= 3) ? argv[2] : busCaptureFile;
+		FILE *fp = fopen(path, "wb");
+		if(fp == NULL)
+		{
+			printf("{\"error\":\"cannot open %s\"}\n", path);
+			return RET_NG;
+		}
+		int ret = buscap_Save(fp);
+		fclose(fp);
+		if(ret != RET_OK)
+		{
+			printf("{\"error\":\"write failed\"}\n");
+			return RET_NG;
+		}
+	}
+	printf("{\"buscap_records\":%u,\"buscap_dropped\":%u}\n", buscap_GetCount(), buscap_GetDropCount());
+	return RET_OK;
+#else
+	printf("{\"error\":\"built without BUSCAP_ENABLE\"}\n");
+	return RET_NG;
+#endif
+}
+
+//----------------------------------------------------------------------
+//! @brief  wear: SDセクタ書込回数
+//! @note	wear      : 区間ごとの書込セクタ数と、書込回数の上位セクタ(推定)を出力
+//! 		wear clear: 記録消去
+//! 		SD_WEAR_ENABLE=1でビルドしたときのみ使用可能.
+//----------------------------------------------------------------------
+int CommandWear(int argc, char *argv[])
+{
+#if SD_WEAR_ENABLE
+	if(argc >= 2 && strcmp(argv[1], "clear") == 0)
+	{
+		sd_ClearWear();
+		return RET_OK;
+	}
+	SdWear *wear = pool_ArenaAlloc(&s_arena, sizeof(SdWear));
+	if(wear == NULL)
+	{
+		printf("{\"error\":\"no memory\"}\n");
+		return RET_NG;
+	}
+	sd_GetWear(wear);
+	printf("{\"wear\":\"total\",\"sectors_written\":%u,\"bucket_sectors\":%u}\n", wear->sectorsWritten, wear->bucketSectors);
+	for(int i = 0; i < SD_WEAR_BUCKETS; i++)
+	{
+		if(wear->buckets[i] != 0)
+		{
+			printf("{\"wear\":\"bucket\",\"first_sector\":%u,\"writes\":%u}\n", i * wear->bucketSectors, wear->buckets[i]);
+		}
+	}
+	for(int i = 0; i < SD_WEAR_HOT && wear->hot[i].count != 0; i++)
+	{
+		printf("{\"wear\":\"hot\",\"sector\":%u,\"writes\":%u,\"error\":%u}\n", wear->hot[i].sector, wear->hot[i].count, wear->hot[i].error);
+	}
+	return RET_OK;
+#else
+	printf("{\"error\":\"built without SD_WEAR_ENABLE\"}\n");
+	return RET_NG;
+#endif
+}
+
+//----------------------------------------------------------------------
+//! @brief  format: AU境界に合わせてFAT32でフォーマットし、マウントし直す
+//! @note	カードの内容はすべて消える.誤操作防止のため引数confirmが必要.
+//! 		前後の書込速度はsdbench seq writeで比べる.
+//----------------------------------------------------------------------
+int CommandFormat(int argc, char *argv[])
+{
+	SdFormat format;
+
+	if(argc < 2 || strcmp(argv[1], "confirm") != 0)
+	{
+		printf("{\"error\":\"erases the card; run 'format confirm'\"}\n");
+		return RET_NG;
+	}
+	if(sd_Format(&format) != RET_OK)
+	{
+		printf("{\"error\":\"format failed\"}\n");
+		return RET_NG;
+	}
+	printf("{\"format\":\"fat32\",\"align_sectors\":%u,\"volume_sector\":%u,\"volume_sectors\":%u,\"fat_sector\":%u,\"fat_sectors\":%u,"
+		"\"data_sector\":%u,\"cluster_bytes\":%u,\"clusters\":%u}\n",
+		format.alignSectors, format.volumeSector, format.volumeSectors, format.fatSector, format.fatSectors,
+		format.dataSector, format.clusterSectors * SECTOR_SIZE, format.clusters);
+	if(sd_Mount() != RET_OK)
+	{
+		printf("{\"error\":\"mount failed\"}\n");
+		return RET_NG;
+	}
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  view: テキストファイルの1ページをLCDに表示
+//! @note	view <path> [page] [sjis]
+//! 		初回はファイルを1回読んでページ位置の索引(<path>.idx)を作る.2回目からは索引を読むだけ.
+//----------------------------------------------------------------------
+int CommandView(int argc, char *argv[])
+{
+	const Rect area = (lcd_GetRotation() == LcdRotation_0) ? (Rect){0, 0, 128, 64} : (Rect){0, 0, 64, 128};
+	uint32_t page = (argc >= 3) ? (uint32_t)strtoul(argv[2], NULL, 10) : 0;
+	CharCode charCode = (argc >= 4 && strcmp(argv[3], "sjis") == 0) ? Code_Sjis : Code_Utf8;
+	uint32_t offset, length;
+	int ret;
+
+	if(argc < 2)
+	{
+		printf("{\"error\":\"missing path\"}\n");
+		return RET_NG;
+	}
+	Viewer *viewer = pool_ArenaAlloc(&s_arena, sizeof(Viewer));
+	if(viewer == NULL)
+	{
+		printf("{\"error\":\"no memory\"}\n");
+		return RET_NG;
+	}
+	int64_t start = esp_timer_get_time();
+	if(viewer_Open(viewer, argv[1], area, charCode) != RET_OK)
+	{
+		printf("{\"error\":\"cannot open %s\"}\n", argv[1]);
+		return RET_NG;
+	}
+	uint32_t openUs = (uint32_t)(esp_timer_get_time() - start);
+
+	start = esp_timer_get_time();
+	lcd_BeginDrawing();
+	ret = viewer_Show(viewer, page);
+	lcd_EndDrawing();
+	uint32_t showUs = (uint32_t)(esp_timer_get_time() - start);
+	if(ret == RET_OK)
+	{
+		lcd_Update();
+		viewer_GetPageRange(viewer, page, &offset, &length);
+		printf("{\"view\":\"%s\",\"pages\":%u,\"page\":%u,\"offset\":%u,\"bytes\":%u,\"index\":\"%s\",\"open_us\":%u,\"show_us\":%u}\n",
+			argv[1], viewer->pageCount, page, offset, length, viewer->indexBuilt ? "built" : "cached", openUs, showUs);
+	}
+	else
+	{
+		printf("{\"error\":\"no page %u (pages %u)\"}\n", page, viewer->pageCount);
+	}
+	viewer_Close(viewer);
+	return ret;
+}
+
+//----------------------------------------------------------------------
+//! @brief  rotate: LCDの表示の向き
+//! @note	rotate [0|90|270]
+//! 		パネルを縦に取り付けた筐体では90か270にする.画面は消去される.引数なしは今の向きを出す.
+//! 		再起動すると0に戻る.
+//----------------------------------------------------------------------
+int CommandRotate(int argc, char *argv[])
+{
+	static const int degrees[] = {0, 90, 270};		// LcdRotationの順
+	LcdRotation rotation;
+
+	if(argc >= 2)
+	{
+		char *end;
+		long value = strtol(argv[1], &end, 10);
+		for(rotation = LcdRotation_0; rotation <= LcdRotation_270; rotation++)
+		{
+			if(*end == '\0' && value == degrees[rotation])
+			{
+				break;
+			}
+		}
+		if(rotation > LcdRotation_270)
+		{
+			printf("{\"error\":\"usage: rotate [0|90|270]\"}\n");
+			return RET_NG;
+		}
+		lcd_BeginDrawing();
+		lcd_SetRotation(rotation);
+		lcd_EndDrawing();
+		lcd_Update();
+	}
+	rotation = lcd_GetRotation();
+	printf("{\"rotate\":%d,\"width\":%d,\"height\":%d}\n", degrees[rotation],
+		(rotation == LcdRotation_0) ? 128 : 64, (rotation == LcdRotation_0) ? 64 : 128);
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  sleeplog: ディープスリープ間欠記録
+//! @note	sleeplog                     : 記録状況と電池寿命の見積り(前回の記録モードの値も残る)
+//! 		sleeplog start <sec> [batch] : <sec>秒間隔、batch(既定60)サンプルごとに書出す記録モードで眠る
+//! 		sleeplog stop                : 記録モード終了
+//! 		実機のstartは眠るので、cmd/status行は出ない.記録モードはリセットボタンで終わる.
+//----------------------------------------------------------------------
+int CommandSleepLog(int argc, char *argv[])
+{
+	SleepLogReport report;
+
+	if(argc >= 2 && strcmp(argv[1], "start") == 0)
+	{
+		uint32_t seconds = (argc >= 3) ? (uint32_t)strtoul(argv[2], NULL, 10) : 0;
+		uint32_t batchSize = (argc >= 4) ? (uint32_t)strtoul(argv[3], NULL, 10) : 60;
+		if(seconds == 0 || seconds > 3600 || sleeplog_Start(seconds * 1000, batchSize) != RET_OK)
+		{
+			printf("{\"error\":\"usage: sleeplog start <1-3600 sec> [1-%u]\"}\n", SLEEPLOG_BATCH_MAX);
+			return RET_NG;
+		}
+		printf("{\"sleeplog\":\"start\",\"interval_ms\":%u,\"batch\":%u,\"file\":\"%s\"}\n", seconds * 1000, batchSize, SLEEPLOG_FILE);
+		fflush(stdout);
+		sleeplog_Sleep();
+		return RET_OK;
+	}
+	if(argc >= 2 && strcmp(argv[1], "stop") == 0)
+	{
+		sleeplog_Stop();
+		return RET_OK;
+	}
+	if(sleeplog_GetReport(&report) != RET_OK)
+	{
+		printf("{\"sleeplog\":\"none\"}\n");
+		return RET_OK;
+	}
+	printf("{\"sleeplog\":\"report\",\"running\":%d,\"interval_ms\":%u,\"batch\":%u,\"count\":%u,\"logged\":%u,\"dropped\":%u,"
+		"\"sample_wakes\":%u,\"awake_us_avg\":%u,\"awake_us_max\":%u,\"flush_wakes\":%u,\"flush_us_avg\":%u,"
+		"\"average_ua\":%u,\"battery_hours\":%u,\"battery_days\":%u}\n",
+		report.running, report.intervalMs, report.batchSize, report.count, report.sequence, report.dropped,
+		report.sampleWakes, report.awakeAvgUs, report.awakeMaxUs, report.flushWakes, report.flushAvgUs,
+		report.averageUa, report.batteryHours, report.batteryHours / 24);
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  time: 現在時刻とSNTP同期の状態
+//! @note	時刻はRTCメモリから引き継いだもの.sleep_ppmはディープスリープ時間の補正値.
+//----------------------------------------------------------------------
+int CommandTime(int argc, char *argv[])
+{
+	RtcTimeStatus status;
+
+	rtctime_GetStatus(&status);
+	printf("{\"time\":%u,\"valid\":%d,\"syncs\":%u,\"last_sync\":%u,\"last_error_ms\":%d,\"sleep_ppm\":%d,"
+		"\"sync_interval_s\":%u,\"sync_due\":%d}\n",
+		(uint32_t)(status.nowUs / 1000000), status.valid, status.syncCount, (uint32_t)(status.lastSyncUs / 1000000),
+		status.lastErrorMs, status.sleepPpm, status.syncIntervalS, rtctime_IsSyncDue());
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  http: HTTPサーバの接続とリクエストの統計
+//! @note	reusedは同じ接続の2番目以降のリクエスト、pipelinedは前の応答を待たずに届いていたリクエスト.
+//----------------------------------------------------------------------
+int CommandHttp(int argc, char *argv[])
+{
+	HttpStats stats;
+
+	http_GetStats(&stats);
+	printf("{\"http\":\"stats\",\"open\":%u,\"accepted\":%u,\"rejected\":%u,\"evicted\":%u,\"timeouts\":%u,"
+		"\"requests\":%u,\"reused\":%u,\"pipelined\":%u,\"errors\":%u}\n",
+		stats.open, stats.accepted, stats.rejected, stats.evicted, stats.timeouts,
+		stats.requests, stats.reused, stats.pipelined, stats.errors);
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  cache: 記録値のRAMキャッシュの問合せ統計(種類ごとに1行)
+//! @note	hitはSDを読まずに答えた、mergedはSDとRAMを合わせた、missはSDだけで答えた問合せ.
+//----------------------------------------------------------------------
+int CommandCache(int argc, char *argv[])
+{
+	static const char *names[HotTail_QueryTypes] = {"samples", "rollup"};
+	HotTailStats stats;
+
+	for(int i = 0; i < HotTail_QueryTypes; i++)
+	{
+		hottail_GetStats((HotTailQuery)i, &stats);
+		printf("{\"cache\":\"%s\",\"queries\":%u,\"hits\":%u,\"merged\":%u,\"misses\":%u,\"hit_permille\":%u,"
+			"\"ram_items\":%u,\"disk_items\":%u}\n",
+			names[i], stats.queries, stats.hits, stats.merged, stats.misses,
+			(stats.queries > 0) ? stats.hits * 1000 / stats.queries : 0, stats.ramItems, stats.diskItems);
+	}
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  temp: 1-Wire温度センサーを全部同時に変換し、センサーごとの温度を出す
+//! @note	センサーを探していない(見つかっていない)ときとsearch指定時は先に探す.
+//! 		変換中の750msはvTaskDelay()で待つので、他のタスクは止まらない.
+//----------------------------------------------------------------------
+int CommandTemp(int argc, char *argv[])
+{
+	int16_t values[DS18B20_PROBES_MAX];
+	uint8_t rom[8];
+	Ds18b20Stats stats;
+
+	if(ds18b20_GetCount() == 0 || (argc >= 2 && strcmp(argv[1], "search") == 0))
+	{
+		ds18b20_Search();
+	}
+	if(ds18b20_StartConversion() != RET_OK)
+	{
+		printf("{\"error\":\"no DS18B20 on GPIO%d\"}\n", GPIO_ONEWIRE_NUM);
+		return RET_NG;
+	}
+	vTaskDelay(pdMS_TO_TICKS(DS18B20_CONVERT_MS) + 1);
+	if(ds18b20_Read(values) != RET_OK)
+	{
+		printf("{\"error\":\"read failed\"}\n");
+		return RET_NG;
+	}
+	for(int i = 0; i < ds18b20_GetCount(); i++)
+	{
+		ds18b20_GetRom(i, rom);
+		printf("{\"temp\":\"%02x%02x%02x%02x%02x%02x%02x%02x\",", rom[0], rom[1], rom[2], rom[3], rom[4], rom[5], rom[6], rom[7]);
+		if(values[i] == DS18B20_NO_VALUE)
+		{
+			printf("\"celsius\":null}\n");
+		}
+		else
+		{
+			printf("\"celsius\":%.4f}\n", values[i] * DS18B20_SCALE);
+		}
+	}
+	ds18b20_GetStats(&stats);
+	printf("{\"temp\":\"stats\",\"probes\":%d,\"conversions\":%u,\"reads\":%u,\"crc_errors\":%u,\"bus_errors\":%u,"
+		"\"slots\":%u,\"spin_us\":%u}\n",
+		ds18b20_GetCount(), stats.conversions, stats.reads, stats.crcErrors, stats.busErrors, stats.slots, stats.spinUs);
+	return RET_OK;
+}
@@ -0,0 +1,11 @@
+//======================================================================
+//! @file   console.h
+//! @brief  シリアルコンソール
+//======================================================================
+#ifndef _CONSOLE_H_
+#define _CONSOLE_H_
+
+void console_Initialize(void);
+int console_Execute(char *line);
+
+#endif
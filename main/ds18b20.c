@@ -0,0 +1,499 @@
+//======================================================================
+//! @file   ds18b20.c
+//! @brief  1-Wire温度センサー(DS18B20)
+//! @note	GPIO2(オープンドレイン, 4.7kΩでプルアップ)の1-Wireバスを、ハードウェアタイマ(FRC1)の
+//! 		割込みで進む状態機械で動かす. タスクは操作列(リセット, 1byte書込/読込, ROM探索)を作って
+//! 		始め、終わるまでセマフォで待つ(CPUは他のタスクが使う).
+//! 		割込み内でビジーウェイトするのはスロット先頭のLパルスと読取りまでの間(1スロット最大10us)だけで、
+//! 		スロットの残り(約60us)とリセット(約1ms)はタイマで待つ.
+//! 		変換は Skip ROM + Convert T で全センサー同時に始め、750msの間は何も待たない.
+//! 		ds18b20_IsReady()が真になってから ds18b20_Read() で全センサーを1回の操作列で読む.
+//! 		センサーは外部電源(VDD)で動かすこと(寄生電源の強プルアップはしない).
+//! 		GPIO15は起動時にLが必要なので1-Wire(アイドルH)には使えない. GPIO2は起動時にHが必要で合う.
+//======================================================================
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "driver/gpio.h"
+#include "driver/hw_timer.h"
+#include "rom/ets_sys.h"
+#include "esp_timer.h"
+
+#include "global.h"
+#include "ds18b20.h"
+
+//----- 定義 -----
+#define FAMILY_DS18B20	0x28
+#define CMD_SEARCH_ROM	0xf0
+#define CMD_MATCH_ROM	0x55
+#define CMD_SKIP_ROM	0xcc
+#define CMD_CONVERT_T	0x44
+#define CMD_READ		0xbe			// Read Scratchpad
+#define SCRATCHPAD_SIZE	9
+
+// タイミング[us] (データシート: リセットL/H 480以上, スロット60～120, 回復1以上, 読取りは立下りから15未満)
+#define START_US		20				// 開始までの時間(hw_timer_alarm_us()は10より長いこと)
+#define RESET_LOW_US	500				// リセットパルス
+#define PRESENCE_US		70				// 解放からプレゼンスの読取りまで(15～60後から60～240の間L)
+#define RESET_HIGH_US	430				// プレゼンスの読取りから次の操作まで(解放から計500)
+#define PULSE_US		2				// スロット先頭のLパルス
+#define SAMPLE_US		8				// 解放から読取りまで(立下りから約10)
+#define SLOT_US			70				// スロットの周期
+#define WRITE0_US		65				// 書込0のL期間
+#define RECOVERY_US		15				// 書込0の解放から次のスロットまで
+#define RUN_TIMEOUT_MS	500				// 操作列の完了待ち
+
+// 操作
+typedef enum
+{
+	Op_End,
+	Op_Reset,				// リセットとプレゼンス確認
+	Op_Write,				// 1byte書込
+	Op_Read,				// 1byte読込
+	Op_Search,				// ROM探索64bit(1bitごとに読込2スロット + 書込1スロット)
+} OpType;
+
+typedef struct
+{
+	uint8_t type;			// OpType
+	uint8_t data;			// 書くデータ
+} Op;
+
+// 状態機械の段階
+typedef enum
+{
+	Phase_Start,			// 操作の開始
+	Phase_Slot,				// 次のスロット
+	Phase_ResetHigh,		// リセットパルスの終わり
+	Phase_Presence,			// プレゼンスの読取り
+	Phase_Write0,			// 書込0のLの終わり
+} Phase;
+
+#define PROGRAM_MAX		(DS18B20_PROBES_MAX * (2 + 8 + 1 + SCRATCHPAD_SIZE) + 1)	// 全センサーの読出し
+
+//----- 変数 -----
+static xSemaphoreHandle s_mutex;					// バスの使用
+static xSemaphoreHandle s_done;						// 操作列の完了(割込みから与える)
+static Op s_program[PROGRAM_MAX];					// 操作列
+static uint8_t s_read[DS18B20_PROBES_MAX * SCRATCHPAD_SIZE];	// 読んだデータ
+static volatile uint32_t s_pc;						// 実行中の操作
+static volatile uint32_t s_bit;						// 操作内のスロット
+static volatile uint32_t s_readLength;				// 読んだバイト数
+static volatile Phase s_phase;
+static volatile int s_error;						// 1=中断した
+static uint8_t s_searchRom[8];						// 探索中のROM(前回の結果から続ける)
+static int s_searchId;								// 探索: 読んだビット
+static int s_searchCmp;								// 探索: 読んだ補数ビット
+static int s_lastDiscrepancy;						// 探索: 前回0を選んだ分岐(1～64, 0=なし)
+static int s_lastZero;								// 探索: 今回0を選んだ最後の分岐
+static uint8_t s_roms[DS18B20_PROBES_MAX][8];		// 見つけたセンサー
+static int s_count;									// 見つけたセンサー数
+static int64_t s_convertUs;							// 変換開始時刻 0=未変換
+static Ds18b20Stats s_stats;
+
+static int Run(void);
+static void Lock(void);
+static void Unlock(void);
+static void TimerCallback(void *arg);
+static uint32_t Step(void);
+static uint32_t Slot(const Op *op);
+static int SearchDirection(uint32_t bit);
+static void Drive(uint32_t level);
+static uint8_t Crc8(const uint8_t *data, size_t length);
+
+//----------------------------------------------------------------------
+//! @brief  初期化(バスは操作しない)
+//----------------------------------------------------------------------
+void ds18b20_Initialize(void)
+{
+	gpio_config_t config = {1UL << GPIO_ONEWIRE_NUM, GPIO_MODE_OUTPUT_OD, GPIO_PULLUP_ENABLE, GPIO_PULLDOWN_DISABLE, GPIO_INTR_DISABLE};
+
+	if(s_mutex == NULL)
+	{
+		s_mutex = xSemaphoreCreateMutex();
+		s_done = xSemaphoreCreateBinary();
+	}
+	gpio_config(&config);
+	Drive(1);
+	hw_timer_init(TimerCallback, NULL);
+	s_count = 0;
+	s_convertUs = 0;
+	s_lastDiscrepancy = 0;
+	memset(&s_stats, 0, sizeof(s_stats));
+}
+
+//----------------------------------------------------------------------
+//! @brief  バスのセンサーを探す(Search ROM)
+//! @return	見つけたセンサー数
+//! @note	DS18B20以外のデバイスとCRCの合わないROMは数えない.
+//----------------------------------------------------------------------
+int ds18b20_Search(void)
+{
+	Lock();
+	s_stats.searches++;
+	s_count = 0;
+	s_lastDiscrepancy = 0;
+	s_convertUs = 0;
+	do
+	{
+		s_program[0] = (Op){Op_Reset, 0};
+		s_program[1] = (Op){Op_Write, CMD_SEARCH_ROM};
+		s_program[2] = (Op){Op_Search, 0};
+		s_program[3] = (Op){Op_End, 0};
+		s_lastZero = 0;
+		if(Run() != RET_OK)
+		{
+			break;
+		}
+		if(Crc8(s_searchRom, 8) != 0)
+		{
+			s_stats.crcErrors++;
+			break;
+		}
+		if(s_searchRom[0] == FAMILY_DS18B20)
+		{
+			memcpy(s_roms[s_count++], s_searchRom, 8);
+		}
+		s_lastDiscrepancy = s_lastZero;
+	} while(s_lastDiscrepancy != 0 && s_count < DS18B20_PROBES_MAX);
+	int count = s_count;
+	Unlock();
+	return count;
+}
+
+int ds18b20_GetCount(void)
+{
+	return s_count;
+}
+
+void ds18b20_GetRom(int index, uint8_t rom[8])
+{
+	memcpy(rom, s_roms[index], 8);
+}
+
+//----------------------------------------------------------------------
+//! @brief  全センサーの温度変換を同時に始める
+//! @return	RET_OK=成功
+//! @note	コマンドを送るだけ(約2ms)で戻る. 変換の完了はds18b20_IsReady()で調べる.
+//----------------------------------------------------------------------
+int ds18b20_StartConversion(void)
+{
+	int ret = RET_NG;
+
+	Lock();
+	if(s_count > 0)
+	{
+		s_program[0] = (Op){Op_Reset, 0};
+		s_program[1] = (Op){Op_Write, CMD_SKIP_ROM};
+		s_program[2] = (Op){Op_Write, CMD_CONVERT_T};
+		s_program[3] = (Op){Op_End, 0};
+		ret = Run();
+		s_convertUs = (ret == RET_OK) ? esp_timer_get_time() : 0;
+		s_stats.conversions += (ret == RET_OK);
+	}
+	Unlock();
+	return ret;
+}
+
+//----------------------------------------------------------------------
+//! @brief  変換が終わったか
+//! @return	1=DS18B20_CONVERT_MS経った
+//----------------------------------------------------------------------
+int ds18b20_IsReady(void)
+{
+	return s_convertUs != 0 && esp_timer_get_time() - s_convertUs >= (int64_t)DS18B20_CONVERT_MS * 1000;
+}
+
+//----------------------------------------------------------------------
+//! @brief  全センサーの温度を読む
+//! @param	values	[O]センサーごとの温度(DS18B20_SCALE℃単位, ds18b20_GetCount()個) DS18B20_NO_VALUE=読めなかった
+//! @return	RET_OK=成功 RET_NG=変換が終わっていない・バスの異常
+//! @note	センサーごとに Match ROM + Read Scratchpad を並べた1つの操作列で読む.
+//----------------------------------------------------------------------
+int ds18b20_Read(int16_t *values)
+{
+	uint32_t n = 0;
+	int ret;
+
+	if(!ds18b20_IsReady())
+	{
+		return RET_NG;
+	}
+	Lock();
+	for(int i = 0; i < s_count; i++)
+	{
+		s_program[n++] = (Op){Op_Reset, 0};
+		s_program[n++] = (Op){Op_Write, CMD_MATCH_ROM};
+		for(int j = 0; j < 8; j++)
+		{
+			s_program[n++] = (Op){Op_Write, s_roms[i][j]};
+		}
+		s_program[n++] = (Op){Op_Write, CMD_READ};
+		for(int j = 0; j < SCRATCHPAD_SIZE; j++)
+		{
+			s_program[n++] = (Op){Op_Read, 0};
+		}
+	}
+	s_program[n] = (Op){Op_End, 0};
+	ret = Run();
+	if(ret == RET_OK)
+	{
+		s_stats.reads++;
+		for(int i = 0; i < s_count; i++)
+		{
+			const uint8_t *scratchpad = &s_read[i * SCRATCHPAD_SIZE];
+			// 設定レジスタの下位5bitは常に1(バスがLに張り付いたときの全0を除く)
+			if(Crc8(scratchpad, SCRATCHPAD_SIZE) != 0 || (scratchpad[4] & 0x1f) != 0x1f)
+			{
+				s_stats.crcErrors++;
+				values[i] = DS18B20_NO_VALUE;
+				continue;
+			}
+			values[i] = (int16_t)(scratchpad[0] | scratchpad[1] << 8);
+		}
+	}
+	Unlock();
+	return ret;
+}
+
+//----------------------------------------------------------------------
+//! @brief  統計
+//----------------------------------------------------------------------
+void ds18b20_GetStats(Ds18b20Stats *stats)
+{
+	*stats = s_stats;
+}
+
+//----------------------------------------------------------------------
+//! @brief  操作列を実行して終わるまで待つ(ロック中に呼ぶ)
+//! @return	RET_OK=成功
+//! @note	完了は割込みからセマフォで知らせる. 待つタスクは次のtickで起きる.
+//----------------------------------------------------------------------
+int Run(void)
+{
+	s_pc = 0;
+	s_bit = 0;
+	s_readLength = 0;
+	s_phase = Phase_Start;
+	s_error = 0;
+	memset(s_read, 0, sizeof(s_read));
+	xSemaphoreTake(s_done, 0);
+	hw_timer_alarm_us(START_US, false);
+	if(xSemaphoreTake(s_done, pdMS_TO_TICKS(RUN_TIMEOUT_MS)) != pdTRUE)
+	{
+		hw_timer_disarm();
+		s_stats.busErrors++;
+		return RET_NG;
+	}
+	s_stats.busErrors += s_error;
+	return s_error ? RET_NG : RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  バスのロック
+//----------------------------------------------------------------------
+void Lock(void)
+{
+	xSemaphoreTake(s_mutex, portMAX_DELAY);
+}
+
+void Unlock(void)
+{
+	xSemaphoreGive(s_mutex);
+}
+
+//----------------------------------------------------------------------
+//! @brief  タイマ割込み: 状態機械を1段進め、次の段までの時間でタイマを設定する
+//----------------------------------------------------------------------
+void IRAM_ATTR TimerCallback(void *arg)
+{
+	uint32_t us = Step();
+	if(us > 0)
+	{
+		hw_timer_alarm_us(us, false);
+		return;
+	}
+	xSemaphoreGiveFromISR(s_done, NULL);
+}
+
+//----------------------------------------------------------------------
+//! @brief  状態機械を1段進める
+//! @return	次の段までの時間[us] 0=終わり(s_errorが1なら中断)
+//----------------------------------------------------------------------
+uint32_t IRAM_ATTR Step(void)
+{
+	const Op *op = &s_program[s_pc];
+
+	switch(s_phase)
+	{
+	case Phase_ResetHigh:
+		Drive(1);
+		s_phase = Phase_Presence;
+		return PRESENCE_US;
+	case Phase_Presence:
+		if(gpio_get_level(GPIO_ONEWIRE_NUM) != 0)
+		{
+			s_error = 1;						// センサーがない
+			return 0;
+		}
+		s_pc++;
+		s_phase = Phase_Start;
+		return RESET_HIGH_US;
+	case Phase_Write0:
+		Drive(1);
+		s_phase = (s_bit == 0) ? Phase_Start : Phase_Slot;
+		return RECOVERY_US;
+	case Phase_Start:
+		if(op->type == Op_End)
+		{
+			return 0;
+		}
+		if(op->type == Op_Reset)
+		{
+			Drive(0);
+			s_phase = Phase_ResetHigh;
+			return RESET_LOW_US;
+		}
+		s_bit = 0;
+		return Slot(op);
+	default:
+		return Slot(op);
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  タイムスロット1つ
+//! @return	次の段までの時間[us] 0=中断
+//! @note	スロット先頭のLパルスと読取りだけをここで行う. 書込0のLの終わりは次の割込みで.
+//----------------------------------------------------------------------
+uint32_t IRAM_ATTR Slot(const Op *op)
+{
+	uint32_t slots = (op->type == Op_Search) ? 64 * 3 : 8;
+	int bit = -1;								// 書く値 -1=読む
+	uint32_t us;
+
+	if(op->type == Op_Write)
+	{
+		bit = (op->data >> s_bit) & 1;
+	}
+	else if(op->type == Op_Search && s_bit % 3 == 2)
+	{
+		bit = SearchDirection(s_bit / 3);
+		if(bit < 0)
+		{
+			s_error = 1;						// 探索に応答するセンサーがない
+			return 0;
+		}
+	}
+
+	Drive(0);
+	ets_delay_us(PULSE_US);
+	if(bit != 0)
+	{
+		Drive(1);
+	}
+	if(bit < 0)
+	{
+		ets_delay_us(SAMPLE_US);
+		int level = gpio_get_level(GPIO_ONEWIRE_NUM);
+		if(op->type == Op_Read)
+		{
+			s_read[s_readLength] |= (uint8_t)(level << s_bit);
+		}
+		else if(s_bit % 3 == 0)
+		{
+			s_searchId = level;
+		}
+		else
+		{
+			s_searchCmp = level;
+		}
+		s_stats.spinUs += PULSE_US + SAMPLE_US;
+		us = SLOT_US - PULSE_US - SAMPLE_US;
+	}
+	else
+	{
+		s_stats.spinUs += PULSE_US;
+		us = (bit != 0) ? SLOT_US - PULSE_US : WRITE0_US - PULSE_US;
+	}
+	s_stats.slots++;
+
+	s_phase = (bit == 0) ? Phase_Write0 : Phase_Slot;
+	if(++s_bit == slots)
+	{
+		s_bit = 0;
+		s_pc++;
+		s_readLength += (op->type == Op_Read);
+		s_phase = (bit == 0) ? Phase_Write0 : Phase_Start;
+	}
+	return us;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ROM探索の分岐(Maxim AN187)
+//! @param	bit		[I]ROMのビット番号(0～63)
+//! @return	進む方向 -1=応答なし
+//----------------------------------------------------------------------
+int IRAM_ATTR SearchDirection(uint32_t bit)
+{
+	int position = (int)bit + 1;
+	uint8_t mask = (uint8_t)(1 << (bit % 8));
+	int direction;
+
+	if(s_searchId && s_searchCmp)
+	{
+		return -1;
+	}
+	if(s_searchId != s_searchCmp)
+	{
+		direction = s_searchId;					// 全センサーが同じ値
+	}
+	else
+	{
+		if(position < s_lastDiscrepancy)
+		{
+			direction = (s_searchRom[bit / 8] & mask) != 0;
+		}
+		else
+		{
+			direction = (position == s_lastDiscrepancy);
+		}
+		if(!direction)
+		{
+			s_lastZero = position;
+		}
+	}
+	s_searchRom[bit / 8] = direction ? (s_searchRom[bit / 8] | mask) : (s_searchRom[bit / 8] & ~mask);
+	return direction;
+}
+
+//----------------------------------------------------------------------
+//! @brief  バスの出力(1=解放してプルアップでH)
+//----------------------------------------------------------------------
+void IRAM_ATTR Drive(uint32_t level)
+{
+	gpio_set_level(GPIO_ONEWIRE_NUM, level);
+}
+
+//----------------------------------------------------------------------
+//! @brief  1-WireのCRC8 (x^8 + x^5 + x^4 + 1, LSBから)
+//! @return	CRC(末尾にCRCを含めて計算すると0)
+//----------------------------------------------------------------------
+uint8_t Crc8(const uint8_t *data, size_t length)
+{
+	uint8_t crc = 0;
+
+	for(size_t i = 0; i < length; i++)
+	{
+		uint8_t byte = data[i];
+		for(int bit = 0; bit < 8; bit++)
+		{
+			uint8_t mix = (crc ^ byte) & 1;
+			crc >>= 1;
+			crc ^= mix ? 0x8c : 0;
+			byte >>= 1;
+		}
+	}
+	return crc;
+}
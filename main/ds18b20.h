@@ -0,0 +1,36 @@
+//======================================================================
+//! @file   ds18b20.h
+//! @brief  1-Wire温度センサー(DS18B20)
+//======================================================================
+#ifndef _DS18B20_H_
+#define _DS18B20_H_
+
+#include <stdint.h>
+
+#define DS18B20_PROBES_MAX		8				// 1本のバスに繋ぐセンサーの最大
+#define DS18B20_CONVERT_MS		750				// 温度変換時間(12bit)[ms]
+#define DS18B20_SCALE			0.0625f			// 値1あたりの温度[℃]
+#define DS18B20_NO_VALUE		INT16_MIN		// 読めなかった
+
+// 統計
+typedef struct
+{
+	uint32_t searches;			// 探索回数
+	uint32_t conversions;		// 変換開始回数(全センサー同時で1回)
+	uint32_t reads;				// 読出し回数
+	uint32_t crcErrors;			// スクラッチパッドのCRC不一致
+	uint32_t busErrors;			// プレゼンスなし・探索の応答なし・タイムアウト
+	uint32_t slots;				// タイムスロット数
+	uint32_t spinUs;			// 割込み内のビジーウェイト合計[us]
+} Ds18b20Stats;
+
+void ds18b20_Initialize(void);
+int ds18b20_Search(void);
+int ds18b20_GetCount(void);
+void ds18b20_GetRom(int index, uint8_t rom[8]);
+int ds18b20_StartConversion(void);
+int ds18b20_IsReady(void);
+int ds18b20_Read(int16_t *values);
+void ds18b20_GetStats(Ds18b20Stats *stats);
+
+#endif
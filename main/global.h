@@ -9,7 +9,7 @@
 
 // ポート
 #define GPIO_SWITCH_NUM		GPIO_NUM_0		// switch
-#define GPIO_RES0_NUM		GPIO_NUM_2		// -
+#define GPIO_ONEWIRE_NUM	GPIO_NUM_2		// 1-Wire (DS18B20)
 #define GPIO_SDCS_NUM		GPIO_NUM_4		// SD cs
 #define GPIO_LCDCS_NUM		GPIO_NUM_5		// LCD cs
 #define GPIO_MISO_LCDRS_NUM	GPIO_NUM_12		// SD sout / LCD rs
@@ -18,6 +18,14 @@
 #define GPIO_RES1_NUM		GPIO_NUM_15		// -
 #define GPIO_LED_NUM		GPIO_NUM_16		// LED
 
+// RTCユーザーメモリの割り当て(4byteブロック番号, 64～191の512byte)
+#define RTC_BLOCK_SLEEPLOG	64				// 間欠記録(sleeplog.c) 448byte
+#define RTC_BLOCK_RTCTIME	176				// 時刻の引継ぎ(rtctime.c) 64byte
+#define RTC_BLOCK_END		192
+
+// 起床・リセットからapp_main()までの時間[us](esp_timer_get_time()に含まれない.実測して合わせる)
+#define BOOT_TIME_US		70000
+
 // 戻り値
 #define RET_OK			0
 #define RET_NG			1
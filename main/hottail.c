@@ -0,0 +1,462 @@
+//======================================================================
+//! @file   hottail.c
+//! @brief  直近の記録値と時間ごとの集計のRAMキャッシュ
+//! @note	記録ファイル(sleeplogのCSV)の末尾HOTTAIL_SAMPLES個と、直近HOTTAIL_BUCKETS時間分の集計をRAMに持つ.
+//! 		起動時にファイル末尾を読んで作り、以後はhottail_Append()で書いたサンプルを足す.
+//! 		今は起動中にサンプルを取る処理がなく、呼ぶのはsleeplog_Flush()だけ.その起床は応答せずに眠るか、
+//! 		直後のhottail_Load()で作り直すので、キャッシュは起動時に読んだ内容のまま(ファイルと一致する).
+//! 		「この時刻以降はすべてRAMにある」という境界(被覆開始)を持ち、問合せの範囲が
+//! 		境界以降ならRAMだけ(SDを読まないのでSPIバスをロガーやLCDと取り合わない)、
+//! 		境界をまたぐなら境界の前をSDから、以降をRAMから続けて返す.
+//! 		時刻が戻ったサンプルを足したら(時刻の再設定)、次の起動まですべてSDから答える.
+//======================================================================
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "global.h"
+#include "hottail.h"
+
+//----- 定義 -----
+#define INVALID_S		UINT32_MAX		// 被覆開始: RAMは使えない
+#define LINE_SIZE		48				// CSV 1行の最大
+#define LOAD_BLOCK		16				// 起動時に1回に読むサンプル数
+
+// 集計
+typedef struct
+{
+	uint32_t startS;			// 開始時刻(HOTTAIL_BUCKET_Sの倍数)
+	int16_t min;				// 最小値
+	int16_t max;				// 最大値
+	int32_t sum;				// 合計
+	uint32_t count;				// 値のあるサンプル数
+} Bucket;
+
+//----- 変数 -----
+static xSemaphoreHandle s_mutex;					// 以下のキャッシュに対するミューテックス
+static SeriesSample s_samples[HOTTAIL_SAMPLES];		// 直近のサンプル(リング)
+static uint32_t s_sampleTotal;						// 足したサンプル数(次の位置 = s_sampleTotal % HOTTAIL_SAMPLES)
+static uint32_t s_sampleCount;						// リング内のサンプル数
+static uint32_t s_sampleCoverS;						// この時刻以降のサンプルはすべてリングにある
+static Bucket s_buckets[HOTTAIL_BUCKETS];			// 直近の集計(リング)
+static uint32_t s_bucketTotal;
+static uint32_t s_bucketCount;
+static uint32_t s_bucketCoverS;						// この時刻以降の集計はすべてリングにある
+static uint32_t s_lastS;							// 最後に足したサンプルの時刻
+static int s_ready;									// 1=読込済み(読込中と読込前は問合せにRAMを使わない)
+static HotTailStats s_stats[HotTail_QueryTypes];	// 問合せの統計(HTTPタスクだけが書く)
+
+static void Reset(uint32_t coverS);
+static void Lock(void);
+static void Unlock(void);
+static size_t CopySamples(uint32_t fromS, uint32_t *position, SeriesSample *buffer, size_t max);
+static int CopyBucket(uint32_t fromS, uint32_t *position, Bucket *bucket);
+static void AddToBucket(Bucket *bucket, uint32_t startS, int16_t value);
+static int WriteBucket(SeriesSink sink, void *context, const Bucket *bucket, uint32_t index);
+static void Count(HotTailQuery type, int readDisk, uint32_t ramItems, uint32_t diskItems);
+
+//----------------------------------------------------------------------
+//! @brief  初期化(キャッシュは空で使えない状態. hottail_Load()で使えるようになる)
+//----------------------------------------------------------------------
+void hottail_Initialize(void)
+{
+	if(s_mutex == NULL)
+	{
+		s_mutex = xSemaphoreCreateMutex();
+	}
+	Lock();
+	Reset(INVALID_S);
+	s_ready = 0;
+	Unlock();
+	memset(s_stats, 0, sizeof(s_stats));
+}
+
+//----------------------------------------------------------------------
+//! @brief  記録ファイルの末尾を読んでキャッシュを作る
+//! @param	path	[I]記録ファイル
+//! @return	RET_OK=成功(ファイルがないときは空のキャッシュ)
+//! @note	HOTTAIL_LOAD_BYTESより大きいファイルは末尾だけ読み、読んだ最初のサンプルの後を被覆開始にする.
+//! 		集計は最初のサンプルを含む1時間分が途中からなので、その次の時間から作る.
+//! 		SDを最大HOTTAIL_LOAD_BYTES読むので、間欠記録の書出し起床では呼ばない(main.c).
+//----------------------------------------------------------------------
+int hottail_Load(const char *path)
+{
+	SeriesSample block[LOAD_BLOCK];
+	char line[LINE_SIZE];
+	long start = 0;
+	size_t count;
+	int first = 1;
+
+	FILE *fp = fopen(path, "r");
+	Lock();
+	Reset((fp == NULL) ? 0 : INVALID_S);
+	s_ready = (fp == NULL);
+	Unlock();
+	if(fp == NULL)
+	{
+		return RET_OK;
+	}
+
+	if(fseek(fp, 0, SEEK_END) == 0 && ftell(fp) > HOTTAIL_LOAD_BYTES)
+	{
+		start = ftell(fp) - HOTTAIL_LOAD_BYTES;
+	}
+	fseek(fp, start, SEEK_SET);
+	if(start > 0)
+	{
+		fgets(line, sizeof(line), fp);			// 途中からの行は捨てる
+	}
+	while((count = series_ReadCsv(fp, 0, UINT32_MAX, block, LOAD_BLOCK)) > 0)
+	{
+		if(first)
+		{
+			Lock();
+			s_sampleCoverS = (start == 0) ? 0 : block[0].timeS + 1;
+			s_bucketCoverS = (start == 0) ? 0 : block[0].timeS - block[0].timeS % HOTTAIL_BUCKET_S + HOTTAIL_BUCKET_S;
+			Unlock();
+			first = 0;
+		}
+		hottail_Append(block, count);
+	}
+	Lock();
+	if(first && start == 0)
+	{
+		Reset(0);								// 時刻のあるサンプルがない
+	}
+	s_ready = 1;
+	Unlock();
+	fclose(fp);
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  記録ファイルに追記したサンプルを足す
+//! @param	samples	[I]サンプル(時刻順)
+//! @param	count	[I]サンプル数
+//----------------------------------------------------------------------
+void hottail_Append(const SeriesSample *samples, size_t count)
+{
+	if(s_mutex == NULL)
+	{
+		return;									// 初期化前
+	}
+	Lock();
+	for(size_t i = 0; i < count; i++)
+	{
+		const SeriesSample *sample = &samples[i];
+		if(s_sampleTotal > 0 && sample->timeS < s_lastS)
+		{
+			s_sampleCoverS = INVALID_S;
+			s_bucketCoverS = INVALID_S;
+		}
+		s_lastS = sample->timeS;
+
+		// 直近のサンプル(満杯なら最も古いものを捨て、その分だけ被覆開始を進める)
+		uint32_t index = s_sampleTotal % HOTTAIL_SAMPLES;
+		if(s_sampleCount == HOTTAIL_SAMPLES)
+		{
+			if(s_sampleCoverS != INVALID_S && s_sampleCoverS <= s_samples[index].timeS)
+			{
+				s_sampleCoverS = s_samples[index].timeS + 1;
+			}
+		}
+		else
+		{
+			s_sampleCount++;
+		}
+		s_samples[index] = *sample;
+		s_sampleTotal++;
+
+		// 集計
+		if(sample->value == SERIES_NO_VALUE || s_bucketCoverS == INVALID_S || sample->timeS < s_bucketCoverS)
+		{
+			continue;
+		}
+		uint32_t startS = sample->timeS - sample->timeS % HOTTAIL_BUCKET_S;
+		Bucket *newest = (s_bucketCount > 0) ? &s_buckets[(s_bucketTotal - 1) % HOTTAIL_BUCKETS] : NULL;
+		if(newest == NULL || newest->startS != startS)
+		{
+			newest = &s_buckets[s_bucketTotal % HOTTAIL_BUCKETS];
+			if(s_bucketCount == HOTTAIL_BUCKETS)
+			{
+				if(s_bucketCoverS <= newest->startS)
+				{
+					s_bucketCoverS = newest->startS + HOTTAIL_BUCKET_S;
+				}
+			}
+			else
+			{
+				s_bucketCount++;
+			}
+			newest->count = 0;
+			s_bucketTotal++;
+		}
+		AddToBucket(newest, startS, sample->value);
+	}
+	Unlock();
+}
+
+//----------------------------------------------------------------------
+//! @brief  fromS以降のサンプルを書く
+//! @param	path	[I]記録ファイル
+//! @param	fromS	[I]開始時刻(UNIX時間[s])
+//! @param	writer	[IO]書込み先(series_Begin()済み. series_End()は呼出し側)
+//! @param	buffer	[-]作業領域
+//! @param	max		[I]作業領域のサンプル数
+//! @return	RET_OK=成功
+//! @note	RAMから書いている間に256個以上追記されると、その間に捨てたサンプルは抜ける.
+//----------------------------------------------------------------------
+int hottail_QuerySamples(const char *path, uint32_t fromS, SeriesWriter *writer, SeriesSample *buffer, size_t max)
+{
+	uint32_t ramItems = 0, diskItems = 0;
+	uint32_t position = UINT32_MAX;
+	size_t count;
+	int ok = 1;
+
+	Lock();
+	uint32_t coverS = s_ready ? s_sampleCoverS : INVALID_S;
+	Unlock();
+
+	if(fromS < coverS)
+	{
+		FILE *fp = fopen(path, "r");
+		while(ok && fp != NULL && (count = series_ReadCsv(fp, fromS, coverS, buffer, max)) > 0)
+		{
+			ok = (series_Write(writer, buffer, count) == RET_OK);
+			diskItems += count;
+		}
+		if(fp != NULL)
+		{
+			fclose(fp);
+		}
+	}
+	while(ok && coverS != INVALID_S && (count = CopySamples((fromS > coverS) ? fromS : coverS, &position, buffer, max)) > 0)
+	{
+		ok = (series_Write(writer, buffer, count) == RET_OK);
+		ramItems += count;
+	}
+	Count(HotTail_Samples, fromS < coverS, ramItems, diskItems);
+	return ok ? RET_OK : RET_NG;
+}
+
+//----------------------------------------------------------------------
+//! @brief  fromSを含む時間以降の集計をJSONで書く
+//! @param	path	[I]記録ファイル
+//! @param	fromS	[I]開始時刻(UNIX時間[s])
+//! @param	sink	[I]出力先
+//! @param	context	[I]出力先に渡すパラメータ
+//! @param	scale	[I]値の倍率
+//! @param	offset	[I]値のオフセット
+//! @param	buffer	[-]作業領域
+//! @param	max		[I]作業領域のサンプル数
+//! @return	RET_OK=成功
+//! @note	{"scale":s,"offset":o,"step":3600,"buckets":[[開始時刻,最小,最大,平均,個数],...]}
+//----------------------------------------------------------------------
+int hottail_QueryRollup(const char *path, uint32_t fromS, SeriesSink sink, void *context, float scale, float offset, SeriesSample *buffer, size_t max)
+{
+	uint32_t ramItems = 0, diskItems = 0;
+	uint32_t position = UINT32_MAX;
+	uint32_t alignedS = fromS - fromS % HOTTAIL_BUCKET_S;
+	Bucket bucket;
+	char header[96];
+	size_t count;
+
+	Lock();
+	uint32_t coverS = s_ready ? s_bucketCoverS : INVALID_S;
+	Unlock();
+
+	int length = snprintf(header, sizeof(header), "{\"scale\":%g,\"offset\":%g,\"step\":%d,\"buckets\":[", scale, offset, HOTTAIL_BUCKET_S);
+	int ok = (sink(context, header, length) == RET_OK);
+	if(alignedS < coverS)
+	{
+		FILE *fp = fopen(path, "r");
+		bucket.count = 0;
+		while(ok && fp != NULL && (count = series_ReadCsv(fp, alignedS, coverS, buffer, max)) > 0)
+		{
+			for(size_t i = 0; i < count && ok; i++)
+			{
+				uint32_t startS = buffer[i].timeS - buffer[i].timeS % HOTTAIL_BUCKET_S;
+				if(buffer[i].value == SERIES_NO_VALUE)
+				{
+					continue;
+				}
+				if(bucket.count > 0 && bucket.startS != startS)
+				{
+					ok = (WriteBucket(sink, context, &bucket, diskItems++) == RET_OK);
+					bucket.count = 0;
+				}
+				AddToBucket(&bucket, startS, buffer[i].value);
+			}
+		}
+		if(ok && bucket.count > 0)
+		{
+			ok = (WriteBucket(sink, context, &bucket, diskItems++) == RET_OK);
+		}
+		if(fp != NULL)
+		{
+			fclose(fp);
+		}
+	}
+	while(ok && coverS != INVALID_S && CopyBucket((alignedS > coverS) ? alignedS : coverS, &position, &bucket))
+	{
+		ok = (WriteBucket(sink, context, &bucket, diskItems + ramItems++) == RET_OK);
+	}
+	ok = ok && (sink(context, "]}\n", 3) == RET_OK);
+	Count(HotTail_Rollup, alignedS < coverS, ramItems, diskItems);
+	return ok ? RET_OK : RET_NG;
+}
+
+//----------------------------------------------------------------------
+//! @brief  問合せの統計
+//! @param	type	[I]問合せの種類
+//! @param	stats	[O]結果
+//----------------------------------------------------------------------
+void hottail_GetStats(HotTailQuery type, HotTailStats *stats)
+{
+	*stats = s_stats[type];
+}
+
+//----------------------------------------------------------------------
+//! @brief  キャッシュを空にする(ロック中に呼ぶ)
+//! @param	coverS	[I]被覆開始(0=ファイルは空, INVALID_S=使えない)
+//----------------------------------------------------------------------
+void Reset(uint32_t coverS)
+{
+	s_sampleTotal = 0;
+	s_sampleCount = 0;
+	s_sampleCoverS = coverS;
+	s_bucketTotal = 0;
+	s_bucketCount = 0;
+	s_bucketCoverS = coverS;
+	s_lastS = 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  キャッシュのロック
+//----------------------------------------------------------------------
+void Lock(void)
+{
+	xSemaphoreTake(s_mutex, portMAX_DELAY);
+}
+
+void Unlock(void)
+{
+	xSemaphoreGive(s_mutex);
+}
+
+//----------------------------------------------------------------------
+//! @brief  リングからサンプルを取り出す
+//! @param	fromS		[I]開始時刻(最初の呼出しと、捨てられて位置を見失ったときに使う)
+//! @param	position	[IO]次に取り出す通し番号 UINT32_MAX=最初
+//! @param	buffer		[O]サンプル
+//! @param	max			[I]最大サンプル数
+//! @return	取り出したサンプル数 0=終わり
+//----------------------------------------------------------------------
+size_t CopySamples(uint32_t fromS, uint32_t *position, SeriesSample *buffer, size_t max)
+{
+	size_t count = 0;
+
+	Lock();
+	uint32_t oldest = s_sampleTotal - s_sampleCount;
+	if(*position == UINT32_MAX || *position < oldest)
+	{
+		for(*position = oldest; *position < s_sampleTotal && s_samples[*position % HOTTAIL_SAMPLES].timeS < fromS; (*position)++)
+		{
+		}
+	}
+	while(count < max && *position < s_sampleTotal)
+	{
+		buffer[count++] = s_samples[(*position)++ % HOTTAIL_SAMPLES];
+	}
+	Unlock();
+	return count;
+}
+
+//----------------------------------------------------------------------
+//! @brief  リングから集計を1つ取り出す
+//! @param	fromS		[I]開始時刻
+//! @param	position	[IO]次に取り出す通し番号 UINT32_MAX=最初
+//! @param	bucket		[O]集計
+//! @return	1=取り出した 0=終わり
+//----------------------------------------------------------------------
+int CopyBucket(uint32_t fromS, uint32_t *position, Bucket *bucket)
+{
+	int found = 0;
+
+	Lock();
+	uint32_t oldest = s_bucketTotal - s_bucketCount;
+	if(*position == UINT32_MAX || *position < oldest)
+	{
+		for(*position = oldest; *position < s_bucketTotal && s_buckets[*position % HOTTAIL_BUCKETS].startS < fromS; (*position)++)
+		{
+		}
+	}
+	if(*position < s_bucketTotal)
+	{
+		*bucket = s_buckets[(*position)++ % HOTTAIL_BUCKETS];
+		found = 1;
+	}
+	Unlock();
+	return found;
+}
+
+//----------------------------------------------------------------------
+//! @brief  集計に値を足す(count=0なら始める)
+//----------------------------------------------------------------------
+void AddToBucket(Bucket *bucket, uint32_t startS, int16_t value)
+{
+	if(bucket->count == 0)
+	{
+		bucket->startS = startS;
+		bucket->min = value;
+		bucket->max = value;
+		bucket->sum = 0;
+	}
+	bucket->min = (value < bucket->min) ? value : bucket->min;
+	bucket->max = (value > bucket->max) ? value : bucket->max;
+	bucket->sum += value;
+	bucket->count++;
+}
+
+//----------------------------------------------------------------------
+//! @brief  集計を1つJSONで書く
+//! @param	index	[I]何番目か(0なら区切りなし)
+//----------------------------------------------------------------------
+int WriteBucket(SeriesSink sink, void *context, const Bucket *bucket, uint32_t index)
+{
+	char text[64];
+	int32_t half = (int32_t)bucket->count / 2;
+	int32_t mean = ((bucket->sum >= 0) ? bucket->sum + half : bucket->sum - half) / (int32_t)bucket->count;
+	int length = snprintf(text, sizeof(text), "%s[%u,%d,%d,%d,%u]", (index > 0) ? "," : "",
+		bucket->startS, bucket->min, bucket->max, mean, bucket->count);
+	return sink(context, text, length);
+}
+
+//----------------------------------------------------------------------
+//! @brief  問合せの統計を数える
+//! @param	type		[I]問合せの種類
+//! @param	readDisk	[I]1=範囲の一部または全部をSDから読んだ
+//! @param	ramItems	[I]RAMから返した数
+//! @param	diskItems	[I]SDから返した数
+//----------------------------------------------------------------------
+void Count(HotTailQuery type, int readDisk, uint32_t ramItems, uint32_t diskItems)
+{
+	HotTailStats *stats = &s_stats[type];
+	stats->queries++;
+	if(!readDisk)
+	{
+		stats->hits++;
+	}
+	else if(ramItems > 0)
+	{
+		stats->merged++;
+	}
+	else
+	{
+		stats->misses++;
+	}
+	stats->ramItems += ramItems;
+	stats->diskItems += diskItems;
+}
@@ -0,0 +1,44 @@
+//======================================================================
+//! @file   hottail.h
+//! @brief  直近の記録値と時間ごとの集計のRAMキャッシュ
+//======================================================================
+#ifndef _HOTTAIL_H_
+#define _HOTTAIL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "series.h"
+
+#define HOTTAIL_SAMPLES			256				// 直近のサンプル数(1分間隔で4時間強)
+#define HOTTAIL_BUCKET_S		3600			// 集計の単位[s]
+#define HOTTAIL_BUCKETS			48				// 直近の集計数
+#define HOTTAIL_LOAD_BYTES		(72 * 1024)		// 起動時に読むファイル末尾の大きさ(1分間隔で約50時間)[byte]
+
+// 問合せの種類
+typedef enum
+{
+	HotTail_Samples,			// 記録値(/data.json, /data.bin)
+	HotTail_Rollup,				// 時間ごとの集計(/rollup.json)
+	HotTail_QueryTypes
+} HotTailQuery;
+
+// 問合せの統計
+typedef struct
+{
+	uint32_t queries;			// 問合せ数
+	uint32_t hits;				// RAMだけで答えた数
+	uint32_t merged;			// SDとRAMを合わせて答えた数
+	uint32_t misses;			// SDだけで答えた数
+	uint32_t ramItems;			// RAMから返したサンプル/集計の数
+	uint32_t diskItems;			// SDから返したサンプル/集計の数
+} HotTailStats;
+
+void hottail_Initialize(void);
+int hottail_Load(const char *path);
+void hottail_Append(const SeriesSample *samples, size_t count);
+int hottail_QuerySamples(const char *path, uint32_t fromS, SeriesWriter *writer, SeriesSample *buffer, size_t max);
+int hottail_QueryRollup(const char *path, uint32_t fromS, SeriesSink sink, void *context, float scale, float offset, SeriesSample *buffer, size_t max);
+void hottail_GetStats(HotTailQuery type, HotTailStats *stats);
+
+#endif
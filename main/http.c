@@ -0,0 +1,765 @@
+//======================================================================
+//! @file   http.c
+//! @brief  HTTP/1.1サーバ(接続管理・リクエスト処理)
+//! @note	ソケットの待受け・受信はhttpd.c(実機)が行い、ここは受信済みのバイト列を処理する.
+//! 		HTTP/1.1は既定で接続を保持(keep-alive)し、HTTP_IDLE_TIMEOUT_MS無通信で閉じる.
+//! 		1接続の受信バッファに複数のリクエストが届いていれば(パイプライン)、順に処理して応答も順に返す.
+//! 		http_Service()1回で各接続のリクエストを1つずつ処理するので、
+//! 		1つの接続のパイプラインが他の接続を待たせない.
+//! 		接続が満杯のときは、待ちリクエストのない接続のうち最も古いものを閉じて受け付ける.
+//! 		本文のあるリクエスト(POST等)は扱わない.
+//======================================================================
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "esp_system.h"
+#include "esp_timer.h"
+
+#include "global.h"
+#include "http.h"
+#include "hottail.h"
+#include "pool.h"
+#include "series.h"
+#include "sleeplog.h"
+
+//----- 定義 -----
+#define CHUNK_HEADER_SIZE	6				// "XXXX\r\n"(長さは4桁固定の16進)
+#define TX_TRAILER_SIZE		7				// "\r\n" + "0\r\n\r\n"
+
+typedef struct
+{
+	const char *path;											// パス(クエリを除く)
+	int (*handler)(HttpConnection *conn, const HttpRequest *request);	// 処理 RET_OK=成功
+} Route;
+
+//----- 変数 -----
+static HttpIo s_io;											// ソケット操作
+static HttpConnection s_connections[HTTP_MAX_CONNECTIONS];	// 接続
+static HttpStats s_stats;									// 統計
+static int s_next;											// 次に最初に処理する接続
+static PoolArena s_arena;									// 処理中リクエストの一時領域
+static uint8_t s_tx[HTTP_TX_SIZE + TX_TRAILER_SIZE];		// 送信バッファ
+static size_t s_txLength;									// 送信バッファの使用量
+static size_t s_bodyStart;									// 送信バッファ内の本文の先頭
+static int s_chunked;										// 1=chunkedで送る
+static int s_head;											// 1=本文を送らない(HEAD)
+static int s_version;										// 処理中リクエストのHTTPバージョン
+static int s_txError;										// 1=送信失敗
+static HttpConnection *s_conn;								// 応答中の接続
+
+static int ProcessRequest(HttpConnection *conn, int64_t nowUs);
+static size_t FindHeaderEnd(const uint8_t *data, size_t length);
+static int ParseRequest(const char *header, size_t length, HttpRequest *request);
+static int HeaderHasToken(const char *value, size_t length, const char *token);
+static void SendError(HttpConnection *conn, int status);
+static void CloseConnection(HttpConnection *conn);
+static int Flush(int last);
+static const char *StatusText(int status);
+static int RouteIndex(HttpConnection *conn, const HttpRequest *request);
+static int RouteStatus(HttpConnection *conn, const HttpRequest *request);
+static int RouteDataJson(HttpConnection *conn, const HttpRequest *request);
+static int RouteDataBinary(HttpConnection *conn, const HttpRequest *request);
+static int ServeSeries(HttpConnection *conn, const HttpRequest *request, SeriesFormat format);
+static int RouteRollup(HttpConnection *conn, const HttpRequest *request);
+static uint32_t QueryFrom(const HttpRequest *request);
+static int WriteSeries(void *context, const void *data, size_t length);
+
+static const Route routes[] =
+{
+	{"/",       RouteIndex},
+	{"/status", RouteStatus},
+	{"/data.json", RouteDataJson},
+	{"/data.bin",  RouteDataBinary},
+	{"/rollup.json", RouteRollup},
+	{NULL, NULL}
+};
+
+//----------------------------------------------------------------------
+//! @brief  初期化
+//! @param	io		[I]ソケット操作
+//----------------------------------------------------------------------
+void http_Initialize(const HttpIo *io)
+{
+	s_io = *io;
+	memset(s_connections, 0, sizeof(s_connections));
+	memset(&s_stats, 0, sizeof(s_stats));
+	s_next = 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  新しい接続を受け付ける
+//! @param	socket	[I]ソケット
+//! @param	nowUs	[I]現在時刻[us]
+//! @return	接続 NULL=満杯(呼出し側でhttp_Reject()する)
+//----------------------------------------------------------------------
+HttpConnection *http_Accept(int socket, int64_t nowUs)
+{
+	HttpConnection *conn = NULL;
+	HttpConnection *idle = NULL;
+
+	for(int i = 0; i < HTTP_MAX_CONNECTIONS && conn == NULL; i++)
+	{
+		if(!s_connections[i].inUse)
+		{
+			conn = &s_connections[i];
+		}
+		else if(s_connections[i].rxLength == 0 && (idle == NULL || s_connections[i].lastActiveUs < idle->lastActiveUs))
+		{
+			idle = &s_connections[i];
+		}
+	}
+	if(conn == NULL && idle != NULL)
+	{
+		CloseConnection(idle);
+		s_stats.evicted++;
+		conn = idle;
+	}
+	if(conn == NULL)
+	{
+		s_stats.rejected++;
+		return NULL;
+	}
+
+	memset(conn, 0, sizeof(HttpConnection) - sizeof(conn->rx));
+	conn->inUse = 1;
+	conn->socket = socket;
+	conn->lastActiveUs = nowUs;
+	s_stats.accepted++;
+	s_stats.open++;
+	return conn;
+}
+
+//----------------------------------------------------------------------
+//! @brief  受け付けられない接続に503を返して閉じる
+//! @param	socket	[I]ソケット
+//----------------------------------------------------------------------
+void http_Reject(int socket)
+{
+	static const char response[] = "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nRetry-After: 1\r\nConnection: close\r\n\r\n";
+	s_io.send(socket, response, sizeof(response) - 1);
+	s_io.close(socket);
+}
+
+//----------------------------------------------------------------------
+//! @brief  接続の取得
+//! @param	index	[I]0～HTTP_MAX_CONNECTIONS-1
+//! @return	接続 NULL=未使用
+//----------------------------------------------------------------------
+HttpConnection *http_GetConnection(int index)
+{
+	return (index >= 0 && index < HTTP_MAX_CONNECTIONS && s_connections[index].inUse) ? &s_connections[index] : NULL;
+}
+
+//----------------------------------------------------------------------
+//! @brief  受信バッファの空き(ここへ直接受信する)
+//! @param	conn	[I]接続
+//! @param	buffer	[O]空きの先頭
+//! @return	空きバイト数
+//----------------------------------------------------------------------
+size_t http_GetRxSpace(HttpConnection *conn, uint8_t **buffer)
+{
+	*buffer = &conn->rx[conn->rxLength];
+	return HTTP_RX_SIZE - conn->rxLength;
+}
+
+//----------------------------------------------------------------------
+//! @brief  受信の通知
+//! @param	conn	[I]接続
+//! @param	length	[I]http_GetRxSpace()の位置に受信したバイト数
+//! @param	nowUs	[I]現在時刻[us]
+//----------------------------------------------------------------------
+void http_Received(HttpConnection *conn, size_t length, int64_t nowUs)
+{
+	conn->rxLength += length;
+	conn->lastActiveUs = nowUs;
+}
+
+//----------------------------------------------------------------------
+//! @brief  相手が閉じた/エラーの通知
+//----------------------------------------------------------------------
+void http_Disconnected(HttpConnection *conn)
+{
+	CloseConnection(conn);
+}
+
+//----------------------------------------------------------------------
+//! @brief  受信済みリクエストの処理と無通信の接続の切断
+//! @param	nowUs	[I]現在時刻[us]
+//! @return	処理したリクエスト数(>0なら続けて呼ぶとパイプラインの残りを処理する)
+//! @note	各接続のリクエストを最大1つずつ処理する.最初に処理する接続は呼ぶたびに回す.
+//----------------------------------------------------------------------
+int http_Service(int64_t nowUs)
+{
+	int handled = 0;
+
+	for(int i = 0; i < HTTP_MAX_CONNECTIONS; i++)
+	{
+		HttpConnection *conn = &s_connections[(s_next + i) % HTTP_MAX_CONNECTIONS];
+		if(!conn->inUse)
+		{
+			continue;
+		}
+		if(ProcessRequest(conn, nowUs))
+		{
+			handled++;
+		}
+		else if(nowUs - conn->lastActiveUs >= (int64_t)HTTP_IDLE_TIMEOUT_MS * 1000)
+		{
+			CloseConnection(conn);
+			s_stats.timeouts++;
+		}
+	}
+	s_next = (s_next + 1) % HTTP_MAX_CONNECTIONS;
+	return handled;
+}
+
+//----------------------------------------------------------------------
+//! @brief  統計
+//----------------------------------------------------------------------
+void http_GetStats(HttpStats *stats)
+{
+	*stats = s_stats;
+}
+
+//----------------------------------------------------------------------
+//! @brief  応答開始(ステータス行とヘッダ)
+//! @param	conn			[I]接続
+//! @param	status			[I]ステータスコード
+//! @param	contentType		[I]Content-Type
+//! @param	contentLength	[I]本文の長さ -1=不明(HTTP/1.1はchunked, HTTP/1.0は送信後に閉じる)
+//! @return	RET_OK=成功
+//----------------------------------------------------------------------
+int http_BeginResponse(HttpConnection *conn, int status, const char *contentType, int32_t contentLength)
+{
+	char length[32] = "";
+
+	s_conn = conn;
+	s_txLength = 0;
+	s_txError = 0;
+	s_chunked = (contentLength < 0 && s_version >= 11);
+	if(contentLength < 0 && !s_chunked)
+	{
+		conn->closing = 1;
+	}
+	if(s_chunked)
+	{
+		snprintf(length, sizeof(length), "Transfer-Encoding: chunked\r\n");
+	}
+	else if(contentLength >= 0)
+	{
+		snprintf(length, sizeof(length), "Content-Length: %d\r\n", contentLength);
+	}
+
+	if(conn->closing)
+	{
+		s_txLength = snprintf((char *)s_tx, HTTP_TX_SIZE, "HTTP/1.1 %d %s\r\nContent-Type: %s\r\n%sConnection: close\r\n\r\n",
+			status, StatusText(status), contentType, length);
+	}
+	else
+	{
+		s_txLength = snprintf((char *)s_tx, HTTP_TX_SIZE, "HTTP/1.1 %d %s\r\nContent-Type: %s\r\n%sConnection: keep-alive\r\nKeep-Alive: timeout=%d, max=%u\r\n\r\n",
+			status, StatusText(status), contentType, length, HTTP_IDLE_TIMEOUT_MS / 1000, HTTP_MAX_REQUESTS - conn->requests);
+	}
+	s_bodyStart = s_txLength + (s_chunked ? CHUNK_HEADER_SIZE : 0);
+	s_txLength = s_bodyStart;
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  本文の送信(送信バッファが満杯になったら送る)
+//! @param	conn	[I]接続
+//! @param	data	[I]データ
+//! @param	length	[I]バイト数
+//! @return	RET_OK=成功
+//----------------------------------------------------------------------
+int http_Write(HttpConnection *conn, const void *data, size_t length)
+{
+	const uint8_t *p = data;
+
+	while(length > 0 && !s_head && !s_txError)
+	{
+		if(s_txLength == HTTP_TX_SIZE)
+		{
+			Flush(0);
+			continue;
+		}
+		size_t size = HTTP_TX_SIZE - s_txLength;
+		if(size > length)
+		{
+			size = length;
+		}
+		memcpy(&s_tx[s_txLength], p, size);
+		s_txLength += size;
+		p += size;
+		length -= size;
+	}
+	return s_txError ? RET_NG : RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  本文の書式付き送信
+//! @return	RET_OK=成功, RET_NG=送信失敗または書出し後も送信バッファに収まらない
+//! @note	1回の出力はHTTP_TX_SIZEの半分程度までにすること.
+//!			収まらないときは応答を途中で打ち切り、接続を閉じさせる(黙って切り捨てない).
+//----------------------------------------------------------------------
+int http_Printf(HttpConnection *conn, const char *format, ...)
+{
+	va_list args;
+	int length;
+
+	if(s_head || s_txError)
+	{
+		return s_txError ? RET_NG : RET_OK;
+	}
+	for(int retry = 0; retry < 2; retry++)
+	{
+		va_start(args, format);
+		length = vsnprintf((char *)&s_tx[s_txLength], HTTP_TX_SIZE + 1 - s_txLength, format, args);
+		va_end(args);
+		if(length >= 0 && (size_t)length <= HTTP_TX_SIZE - s_txLength)
+		{
+			s_txLength += length;
+			return RET_OK;
+		}
+		if(retry == 0)
+		{
+			Flush(0);
+		}
+	}
+	s_txError = 1;
+	return RET_NG;
+}
+
+//----------------------------------------------------------------------
+//! @brief  応答終了(残りを送る)
+//! @return	RET_OK=成功
+//----------------------------------------------------------------------
+int http_EndResponse(HttpConnection *conn)
+{
+	Flush(1);
+	return s_txError ? RET_NG : RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  処理中リクエストの一時領域(応答後に解放される)
+//----------------------------------------------------------------------
+void *http_Alloc(size_t size)
+{
+	return pool_ArenaAlloc(&s_arena, size);
+}
+
+//----------------------------------------------------------------------
+//! @brief  受信済みのリクエストを1つ処理する
+//! @param	conn	[I]接続
+//! @param	nowUs	[I]現在時刻[us]
+//! @return	1=処理した(応答を返した) 0=完全なリクエストがない
+//----------------------------------------------------------------------
+int ProcessRequest(HttpConnection *conn, int64_t nowUs)
+{
+	HttpRequest request;
+	int status;
+
+	size_t end = FindHeaderEnd(conn->rx, conn->rxLength);
+	if(end == 0 && conn->rxLength < HTTP_RX_SIZE)
+	{
+		return 0;
+	}
+	if(end == 0)
+	{
+		status = 431;
+		memset(&request, 0, sizeof(request));
+		request.version = 11;
+	}
+	else
+	{
+		status = ParseRequest((const char *)conn->rx, end, &request);
+	}
+
+	// 受信バッファから取り除く(後ろに次のリクエストが届いていればパイプライン)
+	conn->rxLength -= (end == 0) ? conn->rxLength : end;
+	memmove(conn->rx, &conn->rx[end], conn->rxLength);
+	if(FindHeaderEnd(conn->rx, conn->rxLength) > 0)
+	{
+		s_stats.pipelined++;
+	}
+	if(conn->requests > 0)
+	{
+		s_stats.reused++;
+	}
+	conn->requests++;
+	s_stats.requests++;
+	conn->closing = (status != 0 || !request.keepAlive || conn->requests >= HTTP_MAX_REQUESTS);
+	s_version = request.version;
+	s_head = request.head;
+
+	pool_ArenaBegin(&s_arena);
+	if(status != 0)
+	{
+		s_stats.errors++;
+		SendError(conn, status);
+	}
+	else
+	{
+		size_t pathLength = strcspn(request.path, "?");
+		const Route *route;
+		for(route = routes; route->path != NULL; route++)
+		{
+			if(strlen(route->path) == pathLength && strncmp(route->path, request.path, pathLength) == 0)
+			{
+				break;
+			}
+		}
+		if(route->path == NULL)
+		{
+			SendError(conn, 404);
+		}
+		else if(route->handler(conn, &request) != RET_OK && !s_txError)
+		{
+			conn->closing = 1;			// 応答の途中で失敗した可能性があるので閉じる
+		}
+	}
+	pool_ArenaEnd(&s_arena);
+
+	conn->lastActiveUs = nowUs;
+	if(conn->closing || s_txError)
+	{
+		CloseConnection(conn);
+	}
+	return 1;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ヘッダの終わり(空行)を探す
+//! @return	空行までの長さ 0=まだない
+//----------------------------------------------------------------------
+size_t FindHeaderEnd(const uint8_t *data, size_t length)
+{
+	for(size_t i = 3; i < length; i++)
+	{
+		if(data[i] == '\n' && data[i - 1] == '\r' && data[i - 2] == '\n' && data[i - 3] == '\r')
+		{
+			return i + 1;
+		}
+	}
+	return 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  リクエストの解析
+//! @param	header	[I]リクエスト行からヘッダの終わりの空行まで
+//! @param	length	[I]バイト数
+//! @param	request	[O]結果
+//! @return	0=成功 それ以外=返すエラーのステータスコード
+//----------------------------------------------------------------------
+int ParseRequest(const char *header, size_t length, HttpRequest *request)
+{
+	const char *end = header + length;
+	const char *line = header;
+	const char *eol = memchr(line, '\r', length);
+
+	memset(request, 0, sizeof(HttpRequest));
+	request->version = 11;
+
+	// リクエスト行 "METHOD PATH HTTP/1.x"
+	const char *sp1 = memchr(line, ' ', eol - line);
+	const char *sp2 = (sp1 != NULL) ? memchr(sp1 + 1, ' ', eol - sp1 - 1) : NULL;
+	if(sp2 == NULL || sp1 == line || (size_t)(sp1 - line) >= sizeof(request->method))
+	{
+		return 400;
+	}
+	if((size_t)(sp2 - sp1 - 1) >= sizeof(request->path))
+	{
+		return 414;
+	}
+	memcpy(request->method, line, sp1 - line);
+	memcpy(request->path, sp1 + 1, sp2 - sp1 - 1);
+	if(eol - sp2 - 1 == 8 && strncmp(sp2 + 1, "HTTP/1.1", 8) == 0)
+	{
+		request->version = 11;
+	}
+	else if(eol - sp2 - 1 == 8 && strncmp(sp2 + 1, "HTTP/1.0", 8) == 0)
+	{
+		request->version = 10;
+	}
+	else
+	{
+		return 505;
+	}
+	request->keepAlive = (request->version >= 11);
+	request->head = (strcmp(request->method, "HEAD") == 0);
+	if(!request->head && strcmp(request->method, "GET") != 0)
+	{
+		return 405;
+	}
+
+	// ヘッダ "Name: value"
+	for(line = eol + 2; line < end - 2; line = eol + 2)
+	{
+		eol = memchr(line, '\r', end - line);
+		const char *colon = memchr(line, ':', eol - line);
+		if(colon == NULL)
+		{
+			return 400;
+		}
+		const char *value = colon + 1;
+		while(value < eol && *value == ' ')
+		{
+			value++;
+		}
+		size_t nameLength = colon - line;
+		size_t valueLength = eol - value;
+		if(nameLength == 10 && strncasecmp(line, "Connection", 10) == 0)
+		{
+			if(HeaderHasToken(value, valueLength, "close"))
+			{
+				request->keepAlive = 0;
+			}
+			else if(HeaderHasToken(value, valueLength, "keep-alive"))
+			{
+				request->keepAlive = 1;
+			}
+		}
+		else if((nameLength == 14 && strncasecmp(line, "Content-Length", 14) == 0 && !(valueLength == 1 && *value == '0'))
+		|| (nameLength == 17 && strncasecmp(line, "Transfer-Encoding", 17) == 0))
+		{
+			return 400;				// 本文は扱わない
+		}
+	}
+	return 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  カンマ区切りのヘッダ値にトークンがあるか(大文字小文字を区別しない)
+//----------------------------------------------------------------------
+int HeaderHasToken(const char *value, size_t length, const char *token)
+{
+	size_t tokenLength = strlen(token);
+	const char *end = value + length;
+
+	while(value < end)
+	{
+		while(value < end && (*value == ' ' || *value == ','))
+		{
+			value++;
+		}
+		const char *next = value;
+		while(next < end && *next != ',' && *next != ' ')
+		{
+			next++;
+		}
+		if((size_t)(next - value) == tokenLength && strncasecmp(value, token, tokenLength) == 0)
+		{
+			return 1;
+		}
+		value = next;
+	}
+	return 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  エラー応答(本文はステータス行の文言)
+//----------------------------------------------------------------------
+void SendError(HttpConnection *conn, int status)
+{
+	const char *text = StatusText(status);
+	http_BeginResponse(conn, status, "text/plain", (int32_t)strlen(text));
+	http_Write(conn, text, strlen(text));
+	http_EndResponse(conn);
+}
+
+//----------------------------------------------------------------------
+//! @brief  接続を閉じる
+//----------------------------------------------------------------------
+void CloseConnection(HttpConnection *conn)
+{
+	if(conn->inUse)
+	{
+		s_io.close(conn->socket);
+		conn->inUse = 0;
+		conn->rxLength = 0;
+		s_stats.open--;
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  送信バッファを送る
+//! @param	last	[I]1=応答の最後(chunkedなら終端を付ける)
+//! @return	RET_OK=成功
+//! @note	chunkedでは本文の前に空けておいた6byteにチャンク長を書き、1回のsendで送る.
+//----------------------------------------------------------------------
+int Flush(int last)
+{
+	size_t bodyLength = s_txLength - s_bodyStart;
+
+	if(s_txError)
+	{
+		return RET_NG;
+	}
+	if(s_chunked && !s_head)
+	{
+		if(bodyLength > 0)
+		{
+			char header[CHUNK_HEADER_SIZE + 1];
+			snprintf(header, sizeof(header), "%04x\r\n", (unsigned int)bodyLength);
+			memcpy(&s_tx[s_bodyStart - CHUNK_HEADER_SIZE], header, CHUNK_HEADER_SIZE);
+			memcpy(&s_tx[s_txLength], "\r\n", 2);
+			s_txLength += 2;
+		}
+		else
+		{
+			s_txLength = s_bodyStart - CHUNK_HEADER_SIZE;
+		}
+		if(last)
+		{
+			memcpy(&s_tx[s_txLength], "0\r\n\r\n", 5);
+			s_txLength += 5;
+		}
+	}
+	else if(s_chunked)
+	{
+		s_txLength = s_bodyStart - CHUNK_HEADER_SIZE;
+	}
+
+	if(s_txLength > 0 && s_io.send(s_conn->socket, s_tx, s_txLength) != RET_OK)
+	{
+		s_txError = 1;
+	}
+	s_bodyStart = s_chunked ? CHUNK_HEADER_SIZE : 0;
+	s_txLength = s_bodyStart;
+	return s_txError ? RET_NG : RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ステータスコードの文言
+//----------------------------------------------------------------------
+const char *StatusText(int status)
+{
+	switch(status)
+	{
+	case 200: return "OK";
+	case 400: return "Bad Request";
+	case 404: return "Not Found";
+	case 405: return "Method Not Allowed";
+	case 414: return "URI Too Long";
+	case 431: return "Request Header Fields Too Large";
+	case 503: return "Service Unavailable";
+	case 505: return "HTTP Version Not Supported";
+	default:  return "Error";
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  "/" 案内ページ(記録値のグラフ)
+//----------------------------------------------------------------------
+int RouteIndex(HttpConnection *conn, const HttpRequest *request)
+{
+	static const char page[] =
+		"<!DOCTYPE html><html><head><meta charset=\"utf-8\"><title>Esp8266Test</title></head>"
+		"<body><h1>Esp8266Test</h1><canvas id=\"g\" width=\"640\" height=\"240\"></canvas><p id=\"s\"></p>"
+		"<p><a href=\"/status\">/status</a> <a href=\"/data.json\">/data.json</a> <a href=\"/rollup.json\">/rollup.json</a></p><script>"
+		// series.cのバイナリ形式のデコーダ
+		"function decode(b){var d=new DataView(b),p=16,r=[];"
+		"if(b.byteLength<16||String.fromCharCode(d.getUint8(0),d.getUint8(1),d.getUint8(2),d.getUint8(3))!=\"SLB1\")return r;"
+		"var t=d.getUint32(4,true),s=d.getFloat32(8,true),o=d.getFloat32(12,true),dt=0,v=0;"
+		"function u(){var x=0,k=1,c;do{c=d.getUint8(p++);x+=(c&127)*k;k*=128}while(c&128);return x}"
+		"function z(x){return x%2?-(x+1)/2:x/2}"
+		"while(p<b.byteLength){dt+=z(u());t+=dt;var c=u();if(c){v+=z(c-1);r.push([t,v*s+o])}else r.push([t,null])}"
+		"return r}"
+		"function draw(r){var c=document.getElementById(\"g\"),x=c.getContext(\"2d\"),v=r.filter(function(e){return e[1]!==null}),lo=1e9,hi=-1e9;"
+		"v.forEach(function(e){lo=Math.min(lo,e[1]);hi=Math.max(hi,e[1])});"
+		"document.getElementById(\"s\").textContent=r.length+\" samples\"+(v.length?\", \"+lo.toFixed(3)+\" - \"+hi.toFixed(3):\"\");"
+		"if(v.length<2)return;if(hi==lo)hi=lo+1;var t0=v[0][0],w=v[v.length-1][0]-t0||1;x.beginPath();"
+		"v.forEach(function(e,i){var px=(e[0]-t0)/w*c.width,py=c.height-(e[1]-lo)/(hi-lo)*c.height;i?x.lineTo(px,py):x.moveTo(px,py)});"
+		"x.stroke()}"
+		"fetch(\"/data.bin?from=\"+(Math.floor(Date.now()/1000)-3600)).then(function(r){return r.arrayBuffer()}).then(function(b){draw(decode(b))})"
+		"</script></body></html>";
+
+	http_BeginResponse(conn, 200, "text/html; charset=utf-8", sizeof(page) - 1);
+	http_Write(conn, page, sizeof(page) - 1);
+	return http_EndResponse(conn);
+}
+
+//----------------------------------------------------------------------
+//! @brief  "/status" 稼働状況(JSON, chunked)
+//----------------------------------------------------------------------
+int RouteStatus(HttpConnection *conn, const HttpRequest *request)
+{
+	http_BeginResponse(conn, 200, "application/json", -1);
+	http_Printf(conn, "{\"uptime_ms\":%lld,\"free_heap\":%u,", (long long)(esp_timer_get_time() / 1000), esp_get_free_heap_size());
+	http_Printf(conn, "\"connections\":%u,\"accepted\":%u,\"requests\":%u,\"reused\":%u,\"pipelined\":%u}\n",
+		s_stats.open, s_stats.accepted, s_stats.requests, s_stats.reused, s_stats.pipelined);
+	return http_EndResponse(conn);
+}
+
+//----------------------------------------------------------------------
+//! @brief  "/data.json?from=<UNIX時間[s]>" 記録値(JSON)
+//----------------------------------------------------------------------
+int RouteDataJson(HttpConnection *conn, const HttpRequest *request)
+{
+	return ServeSeries(conn, request, Series_Json);
+}
+
+//----------------------------------------------------------------------
+//! @brief  "/data.bin?from=<UNIX時間[s]>" 記録値(差分バイナリ)
+//----------------------------------------------------------------------
+int RouteDataBinary(HttpConnection *conn, const HttpRequest *request)
+{
+	return ServeSeries(conn, request, Series_Binary);
+}
+
+//----------------------------------------------------------------------
+//! @brief  sleeplogの記録を送る(chunked)
+//! @param	conn	[I]接続
+//! @param	request	[I]リクエスト
+//! @param	format	[I]形式
+//! @return	RET_OK=成功
+//! @note	直近の範囲はRAMのキャッシュから、古い範囲はSDからSERIES_READ_BLOCKずつ読む(hottail.c).
+//----------------------------------------------------------------------
+int ServeSeries(HttpConnection *conn, const HttpRequest *request, SeriesFormat format)
+{
+	SeriesSample *samples = http_Alloc(SERIES_READ_BLOCK * sizeof(SeriesSample));
+	SeriesWriter writer;
+	int ok = (samples != NULL);
+
+	http_BeginResponse(conn, 200, (format == Series_Json) ? "application/json" : "application/octet-stream", -1);
+	series_Begin(&writer, format, SLEEPLOG_VALUE_SCALE, SLEEPLOG_VALUE_OFFSET, WriteSeries, conn);
+	ok = ok && (hottail_QuerySamples(SLEEPLOG_FILE, QueryFrom(request), &writer, samples, SERIES_READ_BLOCK) == RET_OK);
+	ok = ok && (series_End(&writer) == RET_OK);
+	return (http_EndResponse(conn) == RET_OK && ok) ? RET_OK : RET_NG;
+}
+
+//----------------------------------------------------------------------
+//! @brief  "/rollup.json?from=<UNIX時間[s]>" 記録値の1時間ごとの最小・最大・平均(JSON)
+//----------------------------------------------------------------------
+int RouteRollup(HttpConnection *conn, const HttpRequest *request)
+{
+	SeriesSample *samples = http_Alloc(SERIES_READ_BLOCK * sizeof(SeriesSample));
+	int ok = (samples != NULL);
+
+	http_BeginResponse(conn, 200, "application/json", -1);
+	ok = ok && (hottail_QueryRollup(SLEEPLOG_FILE, QueryFrom(request), WriteSeries, conn,
+		SLEEPLOG_VALUE_SCALE, SLEEPLOG_VALUE_OFFSET, samples, SERIES_READ_BLOCK) == RET_OK);
+	return (http_EndResponse(conn) == RET_OK && ok) ? RET_OK : RET_NG;
+}
+
+//----------------------------------------------------------------------
+//! @brief  クエリの"from="(UNIX時間[s])
+//! @return	開始時刻 0=指定なし
+//----------------------------------------------------------------------
+uint32_t QueryFrom(const HttpRequest *request)
+{
+	const char *query = strchr(request->path, '?');
+	const char *from = (query != NULL) ? strstr(query, "from=") : NULL;
+	return (from != NULL) ? strtoul(from + 5, NULL, 10) : 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  series_Write()の出力先
+//----------------------------------------------------------------------
+int WriteSeries(void *context, const void *data, size_t length)
+{
+	return http_Write(context, data, length);
+}
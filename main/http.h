@@ -0,0 +1,79 @@
+//======================================================================
+//! @file   http.h
+//! @brief  HTTP/1.1サーバ(接続管理・リクエスト処理)
+//======================================================================
+#ifndef _HTTP_H_
+#define _HTTP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HTTP_PORT				80
+#define HTTP_MAX_CONNECTIONS	4			// 同時接続数(lwipのソケット10個のうち)
+#define HTTP_RX_SIZE			768			// 1接続の受信バッファ(リクエストヘッダの最大)[byte]
+#define HTTP_TX_SIZE			1024		// 送信バッファ(満杯で送信, chunkedでは1チャンク)[byte]
+#define HTTP_IDLE_TIMEOUT_MS	5000		// 待ちリクエストのない接続を閉じるまでの時間[ms]
+#define HTTP_MAX_REQUESTS		100			// 1接続で処理するリクエスト数の上限
+#define HTTP_PATH_SIZE			64			// パス(クエリ含む)の最大長
+
+// ソケット操作(実機はlwip, ホストはテスト)
+typedef struct
+{
+	int (*send)(int socket, const void *data, size_t length);	// 全部送れたらRET_OK
+	void (*close)(int socket);
+} HttpIo;
+
+// 接続
+typedef struct
+{
+	int inUse;						// 1=使用中
+	int socket;						// ソケット
+	int64_t lastActiveUs;			// 最後に受信/応答した時刻[us]
+	uint32_t requests;				// 処理したリクエスト数
+	int closing;					// 1=今の応答の後に閉じる
+	size_t rxLength;				// 受信済みバイト数
+	uint8_t rx[HTTP_RX_SIZE];		// 受信バッファ(パイプラインの後続リクエストも入る)
+} HttpConnection;
+
+// リクエスト
+typedef struct
+{
+	char method[8];					// メソッド
+	char path[HTTP_PATH_SIZE];		// パス(クエリ含む)
+	int version;					// 10=HTTP/1.0, 11=HTTP/1.1
+	int keepAlive;					// 1=応答後も接続を使う
+	int head;						// 1=HEAD(本文を送らない)
+} HttpRequest;
+
+// 統計
+typedef struct
+{
+	uint32_t accepted;				// 受け付けた接続数
+	uint32_t rejected;				// 満杯で断った接続数
+	uint32_t evicted;				// 新しい接続のために閉じた待機中の接続数
+	uint32_t timeouts;				// 無通信で閉じた接続数
+	uint32_t requests;				// 処理したリクエスト数
+	uint32_t reused;				// 2番目以降のリクエスト(接続を再利用した)数
+	uint32_t pipelined;				// 前の応答の前に受信済みだったリクエスト数
+	uint32_t errors;				// 不正なリクエスト数
+	uint32_t open;					// 現在の接続数
+} HttpStats;
+
+void http_Initialize(const HttpIo *io);
+HttpConnection *http_Accept(int socket, int64_t nowUs);
+void http_Reject(int socket);
+HttpConnection *http_GetConnection(int index);
+size_t http_GetRxSpace(HttpConnection *conn, uint8_t **buffer);
+void http_Received(HttpConnection *conn, size_t length, int64_t nowUs);
+void http_Disconnected(HttpConnection *conn);
+int http_Service(int64_t nowUs);
+void http_GetStats(HttpStats *stats);
+
+// 応答(ハンドラ用)
+int http_BeginResponse(HttpConnection *conn, int status, const char *contentType, int32_t contentLength);
+int http_Write(HttpConnection *conn, const void *data, size_t length);
+int http_Printf(HttpConnection *conn, const char *format, ...);
+int http_EndResponse(HttpConnection *conn);
+void *http_Alloc(size_t size);
+
+#endif
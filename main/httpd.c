@@ -0,0 +1,156 @@
+//======================================================================
+//! @file   httpd.c
+//! @brief  HTTPサーバのソケット処理(lwip)
+//! @note	待受けと全接続をselect()で1つのタスクが見る.受信したバイト列の処理はhttp.c.
+//! 		パイプラインの残りがあるうちはselect()で待たずにhttp_Service()を続けて呼ぶ.
+//======================================================================
+#include <stdint.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "lwip/sockets.h"
+
+#include "global.h"
+#include "http.h"
+#include "httpd.h"
+
+//----- 定義 -----
+#define SELECT_TIMEOUT_MS	500				// 無通信の接続を閉じる確認の間隔[ms]
+#define LISTEN_BACKLOG		2
+
+static const char *TAG = "httpd";
+
+static int Send(int socket, const void *data, size_t length);
+static void Close(int socket);
+static void ServeHttp(void *arg);
+
+static const HttpIo io = {Send, Close};
+
+//----------------------------------------------------------------------
+//! @brief  HTTPサーバ開始
+//----------------------------------------------------------------------
+void httpd_Start(void)
+{
+	http_Initialize(&io);
+	xTaskCreate(ServeHttp, "http_task", 3072, NULL, 5, NULL);
+}
+
+//----------------------------------------------------------------------
+//! @brief  全部送る
+//----------------------------------------------------------------------
+int Send(int socket, const void *data, size_t length)
+{
+	const uint8_t *p = data;
+
+	while(length > 0)
+	{
+		int sent = send(socket, p, length, 0);
+		if(sent <= 0)
+		{
+			return RET_NG;
+		}
+		p += sent;
+		length -= sent;
+	}
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  閉じる
+//----------------------------------------------------------------------
+void Close(int socket)
+{
+	close(socket);
+}
+
+//----------------------------------------------------------------------
+//! @brief  HTTPサーバタスク
+//! @param	arg			[I]パラメータ
+//----------------------------------------------------------------------
+void ServeHttp(void *arg)
+{
+	struct sockaddr_in address = {0};
+	int listener = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+	int one = 1;
+
+	address.sin_family = AF_INET;
+	address.sin_port = htons(HTTP_PORT);
+	address.sin_addr.s_addr = htonl(INADDR_ANY);
+	if(listener < 0
+		|| setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0
+		|| bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0
+		|| listen(listener, LISTEN_BACKLOG) != 0)
+	{
+		ESP_LOGE(TAG, "listen failed");
+		vTaskDelete(NULL);
+		return;
+	}
+
+	while(1)
+	{
+		fd_set readSet;
+		int maxSocket = listener;
+		struct timeval timeout = {0, SELECT_TIMEOUT_MS * 1000};
+
+		FD_ZERO(&readSet);
+		FD_SET(listener, &readSet);
+		for(int i = 0; i < HTTP_MAX_CONNECTIONS; i++)
+		{
+			HttpConnection *conn = http_GetConnection(i);
+			if(conn != NULL && conn->rxLength < HTTP_RX_SIZE)
+			{
+				FD_SET(conn->socket, &readSet);
+				maxSocket = (conn->socket > maxSocket) ? conn->socket : maxSocket;
+			}
+		}
+		if(select(maxSocket + 1, &readSet, NULL, NULL, &timeout) < 0)
+		{
+			vTaskDelay(SELECT_TIMEOUT_MS / portTICK_RATE_MS);
+			continue;
+		}
+
+		// 受信
+		int64_t nowUs = esp_timer_get_time();
+		for(int i = 0; i < HTTP_MAX_CONNECTIONS; i++)
+		{
+			HttpConnection *conn = http_GetConnection(i);
+			if(conn == NULL || !FD_ISSET(conn->socket, &readSet))
+			{
+				continue;
+			}
+			uint8_t *buffer;
+			size_t space = http_GetRxSpace(conn, &buffer);
+			int length = recv(conn->socket, buffer, space, 0);
+			if(length <= 0)
+			{
+				http_Disconnected(conn);
+			}
+			else
+			{
+				http_Received(conn, length, nowUs);
+			}
+		}
+
+		// 新しい接続(満杯なら待機中の接続を閉じて空ける, それもなければ503)
+		if(FD_ISSET(listener, &readSet))
+		{
+			int socket = accept(listener, NULL, NULL);
+			if(socket >= 0)
+			{
+				setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+				if(http_Accept(socket, nowUs) == NULL)
+				{
+					http_Reject(socket);
+				}
+			}
+		}
+
+		// パイプラインの残りも含めて処理
+		while(http_Service(esp_timer_get_time()) > 0)
+		{
+		}
+	}
+}
@@ -0,0 +1,10 @@
+//======================================================================
+//! @file   httpd.h
+//! @brief  HTTPサーバのソケット処理(lwip)
+//======================================================================
+#ifndef _HTTPD_H_
+#define _HTTPD_H_
+
+void httpd_Start(void);
+
+#endif
@@ -15,7 +15,9 @@
 #include "lcd.h"
 #include "font.h"
 #include "charcode.h"
+#include "uistr.h"
 #include "setup.h"
+#include "trace.h"
 
 // 定義
 #define LCD_W 128									// LCD 横サイズ
@@ -31,9 +33,17 @@ static const uint8_t noUpdate = 0xff;				// 更新箇所のない行
 static uint8_t s_vram[VRAM_SIZE];					// 1画面分のデータ.まずはこのデータを書き換えて、後でまとめてLCDに転送する.
 static uint8_t s_update[LCD_LINES][2];				// vram更新範囲 [行][0]開始位置、[行][1]終了位置
 static xSemaphoreHandle s_lcdDataMutex;				// s_vram, s_updateに対するミューテックス
+static uint8_t s_transfer[LCD_W];					// 転送中の1行分(lcd_Update()のみ使用、通信ミューテックスで保護)
+static LcdCounters s_counters;						// ドライバ統計
+static LcdRotation s_rotation = LcdRotation_0;		// 表示の向き
+static int16_t s_width = LCD_W;						// 描画座標の横サイズ(向きによる)
+static int16_t s_height = LCD_H;					// 描画座標の縦サイズ(向きによる)
 
 // プロトタイプ宣言
 static const uint8_t *GetFont(const char *text, int *width, int *count, CharCode charCode);
+static void PutImageNative(Rect imageRect, const uint8_t *image, const uint8_t *mask);
+static void PutImageRotated(Rect imageRect, const uint8_t *image, const uint8_t *mask);
+static inline void Transpose8x8(uint32_t *upper, uint32_t *lower);
 static void SendData(const uint8_t *data, int size);
 static inline void WaitMs(uint32_t timeMs);
 
@@ -79,6 +89,10 @@ void lcd_Initialize(void)
 
 	//----- 変数初期化 -----
 	s_lcdDataMutex = xSemaphoreCreateMutex();
+	memset(&s_counters, 0, sizeof(s_counters));
+	s_rotation = LcdRotation_0;
+	s_width = LCD_W;
+	s_height = LCD_H;
 
 	//----- リセット -----
 	gpio_set_level(GPIO_LCDCS_NUM, 0);	// LCD RST = L
@@ -117,6 +131,31 @@ void lcd_Cls(void)
 	}
 }
 
+//----------------------------------------------------------------------
+//! @brief  表示の向き設定
+//! @param	rotation	[I]表示の向き
+//! @note	描画中(lcd_BeginDrawing()～lcd_EndDrawing())に呼ぶ.画面を消去する.
+//! 		VRAMはパネルの並び(横128x縦64, 8dot単位のページ)のままで、描画時に座標を変換する.
+//! 		  LcdRotation_90 : 縦64x横128を時計回りに90度回して表示. 描画座標(x, y)→パネル(127 - y, x)
+//! 		  LcdRotation_270: 縦64x横128を反時計回りに90度回して表示. 描画座標(x, y)→パネル(y, 63 - x)
+//----------------------------------------------------------------------
+void lcd_SetRotation(LcdRotation rotation)
+{
+	s_rotation = rotation;
+	s_width = (rotation == LcdRotation_0) ? LCD_W : LCD_H;
+	s_height = (rotation == LcdRotation_0) ? LCD_H : LCD_W;
+	lcd_Cls();
+}
+
+//----------------------------------------------------------------------
+//! @brief  表示の向き取得
+//! @return	表示の向き
+//----------------------------------------------------------------------
+LcdRotation lcd_GetRotation(void)
+{
+	return s_rotation;
+}
+
 //----------------------------------------------------------------------
 //! @brief  直線描画
 //! @param	x0		[I]始点x
@@ -133,23 +172,26 @@ void lcd_DrawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1)
 	int error = dx - dy;
 	int error2;
 	int index;
+	int px, py;							// パネル上の位置
 
 	for(;;)
 	{
 		// 点描画
-		if(y0 >= 0 && y0 < LCD_H && x0 >= 0 && x0 < LCD_W)
+		if(y0 >= 0 && y0 < s_height && x0 >= 0 && x0 < s_width)
 		{
-			index = y0 / 8;
-			s_vram[index * LCD_W + x0] |= 1 << (y0 % 8);
+			px = (s_rotation == LcdRotation_0) ? x0 : (s_rotation == LcdRotation_90) ? LCD_W - 1 - y0 : y0;
+			py = (s_rotation == LcdRotation_0) ? y0 : (s_rotation == LcdRotation_90) ? x0 : LCD_H - 1 - x0;
+			index = py / 8;
+			s_vram[index * LCD_W + px] |= 1 << (py % 8);
 
 			// 更新位置
-			if(s_update[index][0] == noUpdate || x0 < s_update[index][0])
+			if(s_update[index][0] == noUpdate || px < s_update[index][0])
 			{
-				s_update[index][0] = x0;
+				s_update[index][0] = px;
 			}
-			if(s_update[index][1] == noUpdate || x0 > s_update[index][1])
+			if(s_update[index][1] == noUpdate || px > s_update[index][1])
 			{
-				s_update[index][1] = x0;
+				s_update[index][1] = px;
 			}
 		}
 
@@ -189,7 +231,7 @@ void lcd_Puts(Rect area, const char *text, CharCode charCode)
 
 	letter.x = area.x;
 	letter.y = area.y;
-	while(*text != '\0' && letter.y < LCD_H && letter.y < area.y + area.h)
+	while(*text != '\0' && letter.y < s_height && letter.y < area.y + area.h)
 	{
 		if(*text == '\n')
 		{
@@ -208,7 +250,7 @@ void lcd_Puts(Rect area, const char *text, CharCode charCode)
 		else
 		{
 			font = GetFont(text, &width, &count, charCode);
-			text += count;
+			text += (count > 0) ? count : 1;		// UTF-8の不正なバイトは1byteずつ空白として進める
 			width *= 4;
 			if(letter.x + width > area.x + area.w)
 			{
@@ -223,6 +265,23 @@ void lcd_Puts(Rect area, const char *text, CharCode charCode)
 	}
 }
 
+//----------------------------------------------------------------------
+//! @brief  UI文字列描画(uistr.txtからビルド時に作った列データ)
+//! @param	area	[I]文字列表示エリア 1行のみで、はみ出す分は描かない
+//! @param	id		[I]文字列ID
+//! @note	文字コード変換とフォント参照はビルド時に済んでいるので、lcd_PutImage()1回で描く.
+//----------------------------------------------------------------------
+void lcd_PutUiStr(Rect area, UiStrId id)
+{
+	const int fontHeight = 8;
+	const UiStr *str = &uiStrTable[id];
+
+	// 高さ8dot以下なら画像は1行なので、幅を縮めても列の並びは変わらない
+	area.w = (str->width < area.w) ? str->width : area.w;
+	area.h = (fontHeight < area.h) ? fontHeight : area.h;
+	lcd_PutImage(area, &uiStrStrips[str->offset], NULL);
+}
+
 //----------------------------------------------------------------------
 //! @brief  フォントデータ位置取得
 //! @param	text		[I]文字列(Shift-JIS)
@@ -247,8 +306,28 @@ const uint8_t *GetFont(const char *text, int *width, int *count, CharCode charCo
 //! @param	imageRect	[I]表示位置、画像サイズ[dot]
 //! @param	image		[I]画像データ
 //! @param	mask		[I]マスクデータ 表示部=1, NULL指定でマスクなし
+//! @note	画像データは横1byteが縦8dot(LSBが上)で、8dot行ごとに横へ並べる(VRAMと同じ並び).
+//! 		縦向き(lcd_SetRotation())では8x8dotずつ転置してパネルの並びに直してから描く.
 //----------------------------------------------------------------------
 void lcd_PutImage(Rect imageRect, const uint8_t *image, const uint8_t *mask)
+{
+	if(s_rotation == LcdRotation_0)
+	{
+		PutImageNative(imageRect, image, mask);
+	}
+	else
+	{
+		PutImageRotated(imageRect, image, mask);
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  画像描画(パネルの座標)
+//! @param	imageRect	[I]パネル上の表示位置、画像サイズ[dot]
+//! @param	image		[I]画像データ
+//! @param	mask		[I]マスクデータ 表示部=1, NULL指定でマスクなし
+//----------------------------------------------------------------------
+void PutImageNative(Rect imageRect, const uint8_t *image, const uint8_t *mask)
 {
 	int dx, dy;							// LCD上の位置
 	uint8_t dmask, dimage;				// LCD上のマスク、絵
@@ -308,8 +387,126 @@ void lcd_PutImage(Rect imageRect, const uint8_t *image, const uint8_t *mask)
 	}
 }
 
+//----------------------------------------------------------------------
+//! @brief  画像描画(縦向き)
+//! @param	imageRect	[I]表示位置、画像サイズ[dot]
+//! @param	image		[I]画像データ
+//! @param	mask		[I]マスクデータ 表示部=1, NULL指定でマスクなし
+//! @note	画像の8dot行x8列のブロックを転置し、パネル上の8x8ブロックとしてPutImageNative()で描く.
+//! 		ブロックからはみ出す分(画像の端数)は描画範囲を縮めて描かない.
+//! 		90度は列を逆順に詰めて転置すると、そのままパネルの列順になる.
+//! 		270度は列順に詰めて転置し、結果を逆順に取り出す(パネルのビット順が逆になる).
+//----------------------------------------------------------------------
+void PutImageRotated(Rect imageRect, const uint8_t *image, const uint8_t *mask)
+{
+	uint8_t column[8], maskColumn[8];	// 転置前の8列(画像の端数は0)
+	uint8_t block[8], maskBlock[8];		// 転置後の8列(パネルの並び)
+	uint32_t upper, lower, maskUpper = 0, maskLower = 0;
+	int plines = (imageRect.h + 7) / 8;	// 画像上の行数
+	int rows, columns;					// ブロック内の有効な行数、列数
+	int shift;							// 270度: ブロック内の有効なビットをLSBへ寄せる量
+	Rect blockRect;
+
+	for(int y = 0; y < plines; y++)
+	{
+		rows = (imageRect.h - y * 8 < 8) ? imageRect.h - y * 8 : 8;
+		for(int x = 0; x < imageRect.w; x += 8)
+		{
+			columns = (imageRect.w - x < 8) ? imageRect.w - x : 8;
+			memset(column, 0, sizeof(column));
+			memcpy(column, &image[y * imageRect.w + x], columns);
+			if(mask != NULL)
+			{
+				memset(maskColumn, 0, sizeof(maskColumn));
+				memcpy(maskColumn, &mask[y * imageRect.w + x], columns);
+			}
+
+			if(s_rotation == LcdRotation_90)
+			{
+				// 描画座標(x, y)→パネル(127 - y, x)
+				upper = ((uint32_t)column[7] << 24) | (column[6] << 16) | (column[5] << 8) | column[4];
+				lower = ((uint32_t)column[3] << 24) | (column[2] << 16) | (column[1] << 8) | column[0];
+				Transpose8x8(&upper, &lower);
+				for(int i = 0; i < 4; i++)
+				{
+					block[i] = (uint8_t)(upper >> (24 - i * 8));
+					block[i + 4] = (uint8_t)(lower >> (24 - i * 8));
+				}
+				if(mask != NULL)
+				{
+					maskUpper = ((uint32_t)maskColumn[7] << 24) | (maskColumn[6] << 16) | (maskColumn[5] << 8) | maskColumn[4];
+					maskLower = ((uint32_t)maskColumn[3] << 24) | (maskColumn[2] << 16) | (maskColumn[1] << 8) | maskColumn[0];
+					Transpose8x8(&maskUpper, &maskLower);
+					for(int i = 0; i < 4; i++)
+					{
+						maskBlock[i] = (uint8_t)(maskUpper >> (24 - i * 8));
+						maskBlock[i + 4] = (uint8_t)(maskLower >> (24 - i * 8));
+					}
+				}
+				// ブロックの列iは画像の行(7 - i).有効な行は後ろ側
+				blockRect.x = LCD_W - (imageRect.y + y * 8) - rows;
+				blockRect.y = imageRect.x + x;
+				blockRect.w = rows;
+				blockRect.h = columns;
+				PutImageNative(blockRect, &block[8 - rows], (mask != NULL) ? &maskBlock[8 - rows] : NULL);
+			}
+			else
+			{
+				// 描画座標(x, y)→パネル(y, 63 - x)
+				upper = ((uint32_t)column[0] << 24) | (column[1] << 16) | (column[2] << 8) | column[3];
+				lower = ((uint32_t)column[4] << 24) | (column[5] << 16) | (column[6] << 8) | column[7];
+				Transpose8x8(&upper, &lower);
+				shift = 8 - columns;
+				for(int i = 0; i < 4; i++)
+				{
+					block[i] = (uint8_t)(lower >> (i * 8)) >> shift;
+					block[i + 4] = (uint8_t)(upper >> (i * 8)) >> shift;
+				}
+				if(mask != NULL)
+				{
+					maskUpper = ((uint32_t)maskColumn[0] << 24) | (maskColumn[1] << 16) | (maskColumn[2] << 8) | maskColumn[3];
+					maskLower = ((uint32_t)maskColumn[4] << 24) | (maskColumn[5] << 16) | (maskColumn[6] << 8) | maskColumn[7];
+					Transpose8x8(&maskUpper, &maskLower);
+					for(int i = 0; i < 4; i++)
+					{
+						maskBlock[i] = (uint8_t)(maskLower >> (i * 8)) >> shift;
+						maskBlock[i + 4] = (uint8_t)(maskUpper >> (i * 8)) >> shift;
+					}
+				}
+				// ブロックの列iは画像の行i、ビットは画像の列の逆順.有効な列は下側
+				blockRect.x = imageRect.y + y * 8;
+				blockRect.y = LCD_H - (imageRect.x + x) - columns;
+				blockRect.w = rows;
+				blockRect.h = columns;
+				PutImageNative(blockRect, block, (mask != NULL) ? maskBlock : NULL);
+			}
+		}
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  8x8bit行列の転置(32bit SWAR)
+//! @param	upper	[IO]0～3行目(0行目が最上位byte)
+//! @param	lower	[IO]4～7行目(4行目が最上位byte)
+//! @note	行rのビット(7 - c)を、行cのビット(7 - r)へ移す.
+//! 		隣り合う1bit、2bit、4bitの組を順に入れ替える(Hacker's Delight 7-3).
+//----------------------------------------------------------------------
+inline void Transpose8x8(uint32_t *upper, uint32_t *lower)
+{
+	uint32_t x = *upper, y = *lower, t;
+
+	t = (x ^ (x >> 7)) & 0x00aa00aa;	x = x ^ t ^ (t << 7);
+	t = (y ^ (y >> 7)) & 0x00aa00aa;	y = y ^ t ^ (t << 7);
+	t = (x ^ (x >> 14)) & 0x0000cccc;	x = x ^ t ^ (t << 14);
+	t = (y ^ (y >> 14)) & 0x0000cccc;	y = y ^ t ^ (t << 14);
+	*upper = (x & 0xf0f0f0f0) | ((y >> 4) & 0x0f0f0f0f);
+	*lower = ((x << 4) & 0xf0f0f0f0) | (y & 0x0f0f0f0f);
+}
+
 //----------------------------------------------------------------------
 //! @brief  画面更新
+//! @note	行ごとに更新範囲を転送バッファへ写す間だけs_lcdDataMutexを取り、転送中は描画を止めない.
+//! 		転送中に描画された行は次回の更新で送る(行ごとに描画の前後どちらかの内容になる).
 //----------------------------------------------------------------------
 void lcd_Update(void)
 {
@@ -317,14 +514,25 @@ void lcd_Update(void)
 	uint8_t cmd[3];
 
 	set_TakeCommunicationMutex();
+	TRACE_BEGIN(TraceId_LcdUpdate, 0);
 	set_SetPin(PinSetting_LcdMain, NULL);
 	gpio_set_level(GPIO_LCDCS_NUM, 0);	// CS=L
 
-	xSemaphoreTake(s_lcdDataMutex, portMAX_DELAY);
 	for(y = 0; y < LCD_LINES; y++)
 	{
+		xSemaphoreTake(s_lcdDataMutex, portMAX_DELAY);
 		x = s_update[y][0];
-		if(x != noUpdate)
+		w = (x != noUpdate) ? s_update[y][1] - x + 1 : 0;
+		if(w != 0)
+		{
+			memcpy(s_transfer, &s_vram[y * LCD_W + x], w);
+			s_update[y][0] = s_update[y][1] = noUpdate;
+			s_counters.commandBytes += 3;
+			s_counters.dataBytes += w;
+		}
+		xSemaphoreGive(s_lcdDataMutex);
+
+		if(w != 0)
 		{
 			gpio_set_level(GPIO_MISO_LCDRS_NUM, 0);		// CD=L command
 			cmd[0] = 0xb0 | y;					// page
@@ -333,15 +541,15 @@ void lcd_Update(void)
 			SendData(cmd, 3);
 
 			gpio_set_level(GPIO_MISO_LCDRS_NUM, 1);		// CD=H data
-			w = s_update[y][1] - x + 1;
-			SendData(&s_vram[y * LCD_W + x], w);
-
-			s_update[y][0] = s_update[y][1] = noUpdate;
+			SendData(s_transfer, w);
 		}
 	}
+	xSemaphoreTake(s_lcdDataMutex, portMAX_DELAY);
+	s_counters.updateCount++;
 	xSemaphoreGive(s_lcdDataMutex);
 
 	gpio_set_level(GPIO_LCDCS_NUM, 1);	// CS=H
+	TRACE_END(TraceId_LcdUpdate);
 	set_GiveCommunicationMutex();
 }
 
@@ -361,6 +569,17 @@ void lcd_EndDrawing(void)
 	xSemaphoreGive(s_lcdDataMutex);
 }
 
+//----------------------------------------------------------------------
+//! @brief  ドライバ統計取得
+//! @param	counters	[O]統計
+//----------------------------------------------------------------------
+void lcd_GetCounters(LcdCounters *counters)
+{
+	xSemaphoreTake(s_lcdDataMutex, portMAX_DELAY);
+	*counters = s_counters;
+	xSemaphoreGive(s_lcdDataMutex);
+}
+
 //----------------------------------------------------------------------
 //! @brief  データ送信
 //! @param	data	[I]送信データ
@@ -371,7 +590,7 @@ void SendData(const uint8_t *data, int size)
 	const int maxTransferbytes = 64;
 	const int alignmentSize = 4;
 
-	int extraSize = alignmentSize - ((int)(data) & (alignmentSize - 1));	// 4byte境界になるようなbyte数
+	int extraSize = alignmentSize - (int)((uintptr_t)(data) & (alignmentSize - 1));	// 4byte境界になるようなbyte数
 	if(size < extraSize)
 	{
 		extraSize = size;
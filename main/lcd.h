@@ -7,20 +7,35 @@
 
 #include <stdint.h>
 
+#include "uistr.h"
+
 typedef enum {Code_Utf8, Code_Sjis} CharCode;		// キャラクタコード
+typedef enum {LcdRotation_0, LcdRotation_90, LcdRotation_270} LcdRotation;		// 表示の向き(時計回り)
 typedef struct										// 四角形
 {
 	int16_t x, y;		// 座標(x,y)
 	uint16_t w, h;		// サイズ w x h
 } Rect;
 
+// ドライバ統計
+typedef struct
+{
+	uint32_t updateCount;		// 画面更新回数
+	uint32_t commandBytes;		// 送信コマンドバイト数
+	uint32_t dataBytes;			// 送信データバイト数
+} LcdCounters;
+
 void lcd_Initialize(void);
 void lcd_Cls(void);
+void lcd_SetRotation(LcdRotation rotation);
+LcdRotation lcd_GetRotation(void);
 void lcd_DrawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
 void lcd_Puts(Rect area, const char *text, CharCode charCode);
+void lcd_PutUiStr(Rect area, UiStrId id);
 void lcd_PutImage(Rect imageRect, const uint8_t *image, const uint8_t *mask);
 void lcd_Update(void);
 void lcd_BeginDrawing(void);
 void lcd_EndDrawing(void);
+void lcd_GetCounters(LcdCounters *counters);
 
 #endif
@@ -4,6 +4,7 @@
 //======================================================================
 #include <stdint.h>
 #include <stdio.h>
+#include <sys/time.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "driver/gpio.h"
@@ -11,14 +12,49 @@
 #include "global.h"
 #include "setup.h"
 #include "lcd.h"
+#include "bench.h"
+#include "hottail.h"
+#include "rtctime.h"
+#include "sleeplog.h"
 
 //----------------------------------------------------------------------
 //! @brief  エントリポイント
 //----------------------------------------------------------------------
 void app_main()
 {
+	//----- 時刻の復元 -----
+	// ディープスリープ・リセット前の時刻をRTCメモリから引き継ぐ(電源投入時はSNTP同期まで不明)
+	int64_t nowUs;
+	rtctime_Restore();
+
+	//----- 間欠記録モード -----
+	// サンプルを取るだけの起床は初期化せずに眠る(戻らない)
+	SleepLogWake wake = sleeplog_Wake();
+	if(wake == SleepLog_Sleep)
+	{
+		sleeplog_Sleep();
+	}
+
 	//----- 初期化 -----
+	if(rtctime_GetTime(&nowUs) == RET_OK)
+	{
+		struct timeval now = {(time_t)(nowUs / 1000000), (suseconds_t)(nowUs % 1000000)};
+		settimeofday(&now, NULL);
+	}
 	set_Initialize();
+	if(wake != SleepLog_Off)
+	{
+		sleeplog_Flush(SLEEPLOG_FILE);
+		if(wake == SleepLog_Flush)
+		{
+			sleeplog_Sleep();
+		}
+		sleeplog_Stop();		// リセットボタン等で起動したら記録モードを終える
+	}
+	hottail_Load(SLEEPLOG_FILE);	// 直近の記録値をRAMに置く(グラフの問合せでSDを読まない)
+#if BENCH_RUN_ON_BOOT
+	bench_RunRender(NULL, 1000);
+#endif
 
 	//----- テスト -----
 	char str[32 + 1];
@@ -0,0 +1,185 @@
+//======================================================================
+//! @file   monitor.c
+//! @brief  タスク監視(CPU使用率, スタック残量)
+//! @note	監視タスクが一定周期でFreeRTOSの実行時間統計とスタック残量を取得し、
+//! 		ログへ出力する.スタック残量が閾値を下回ったタスクは警告する.
+//! 		CONFIG_FREERTOS_USE_TRACE_FACILITY, CONFIG_FREERTOS_GENERATE_RUN_TIME_STATSが必要.
+//======================================================================
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+
+#include "global.h"
+#include "monitor.h"
+#include "pool.h"
+
+//----- 定数 -----
+static const char *TAG = "MON";					// ログ用タグ
+static const uint32_t samplePeriodMs = 10000;	// サンプル周期[ms]
+static const uint32_t stackWarningBytes = 256;	// スタック残量警告閾値[byte]
+
+//----- 変数 -----
+static xSemaphoreHandle s_monitorMutex;			// サンプル処理のミューテックス
+static struct
+{
+	uint32_t number;							// タスク番号 0=未使用
+	uint32_t runTime;							// 前回の実行時間カウンタ
+	int isWarned;								// スタック残量警告済
+} s_tasks[MON_MAX_TASKS];
+static uint32_t s_prevTotalRunTime;				// 前回の全実行時間カウンタ
+static uint32_t s_warningCount;					// スタック残量警告回数
+
+//----- プロトタイプ宣言 -----
+static void MonitorTask(void *arg);
+
+//----------------------------------------------------------------------
+//! @brief  タスク監視初期化
+//! @note	起動時に1回だけ呼ぶ.
+//----------------------------------------------------------------------
+void mon_Initialize(void)
+{
+	const uint16_t taskStackSize = 2048;
+	const UBaseType_t taskPriority = 1;
+
+	s_monitorMutex = xSemaphoreCreateMutex();
+	memset(s_tasks, 0, sizeof(s_tasks));
+	s_prevTotalRunTime = 0;
+	s_warningCount = 0;
+
+	xTaskCreate(MonitorTask, "monitor", taskStackSize, NULL, taskPriority, NULL);
+}
+
+//----------------------------------------------------------------------
+//! @brief  タスク情報取得
+//! @param	stats		[O]タスク情報 NULL=取得しない(警告判定のみ)
+//! @param	maxCount	[I]statsの要素数
+//! @return	取得したタスク数 -1=取得不可
+//! @note	CPU使用率は前回のmon_Sample()呼び出しからの区間で計算する.
+//! 		スタック残量が閾値を下回ったタスクは1回だけ警告ログを出す.
+//----------------------------------------------------------------------
+int mon_Sample(MonTaskStats *stats, int maxCount)
+{
+#if configUSE_TRACE_FACILITY
+	static const char stateNames[] = "XRBSDI";		// eRunning, eReady, eBlocked, eSuspended, eDeleted, eInvalid
+	UBaseType_t count = uxTaskGetNumberOfTasks();
+	TaskStatus_t *tasks = pool_Alloc(count * sizeof(TaskStatus_t));
+	uint32_t totalRunTime = 0;
+	int ret = 0;
+
+	if(tasks == NULL)
+	{
+		return -1;
+	}
+
+	xSemaphoreTake(s_monitorMutex, portMAX_DELAY);
+	count = uxTaskGetSystemState(tasks, count, &totalRunTime);
+	uint32_t elapsed = totalRunTime - s_prevTotalRunTime;
+	s_prevTotalRunTime = totalRunTime;
+
+	for(UBaseType_t i = 0; i < count; i++)
+	{
+		uint32_t stackFree = tasks[i].usStackHighWaterMark * sizeof(StackType_t);
+		uint32_t prevRunTime = 0;
+		int slot = -1;
+
+		// 前回値を探す(なければ空きを割り当てる)
+		for(int j = 0; j < MON_MAX_TASKS; j++)
+		{
+			if(s_tasks[j].number == tasks[i].xTaskNumber)
+			{
+				slot = j;
+				prevRunTime = s_tasks[j].runTime;
+				break;
+			}
+			if(slot < 0 && s_tasks[j].number == 0)
+			{
+				slot = j;
+			}
+		}
+		if(slot >= 0)
+		{
+			if(s_tasks[slot].number != tasks[i].xTaskNumber)
+			{
+				s_tasks[slot].number = tasks[i].xTaskNumber;
+				s_tasks[slot].isWarned = 0;
+			}
+			s_tasks[slot].runTime = tasks[i].ulRunTimeCounter;
+
+			// スタック残量警告
+			if(stackFree < stackWarningBytes && !s_tasks[slot].isWarned)
+			{
+				ESP_LOGW(TAG, "%s: stack free %u bytes", tasks[i].pcTaskName, stackFree);
+				s_tasks[slot].isWarned = 1;
+				s_warningCount++;
+			}
+		}
+
+		if(stats != NULL && ret < maxCount)
+		{
+			MonTaskStats *stat = &stats[ret++];
+			snprintf(stat->name, sizeof(stat->name), "%s", tasks[i].pcTaskName);
+			stat->number = tasks[i].xTaskNumber;
+			stat->priority = tasks[i].uxCurrentPriority;
+			stat->state = stateNames[(tasks[i].eCurrentState <= eInvalid) ? tasks[i].eCurrentState : eInvalid];
+			stat->stackFree = stackFree;
+			stat->cpuPermille = (elapsed > 0) ? (uint32_t)((uint64_t)(tasks[i].ulRunTimeCounter - prevRunTime) * 1000 / elapsed) : 0;
+		}
+	}
+
+	// 削除されたタスクの枠を空ける
+	for(int j = 0; j < MON_MAX_TASKS; j++)
+	{
+		UBaseType_t i;
+		for(i = 0; i < count && s_tasks[j].number != tasks[i].xTaskNumber; i++)
+		{
+		}
+		if(i == count)
+		{
+			s_tasks[j].number = 0;
+		}
+	}
+	xSemaphoreGive(s_monitorMutex);
+
+	pool_Free(tasks);
+	return ret;
+#else
+	return -1;
+#endif
+}
+
+//----------------------------------------------------------------------
+//! @brief  スタック残量警告回数取得
+//! @return	起動からの警告回数
+//----------------------------------------------------------------------
+uint32_t mon_GetWarningCount(void)
+{
+	return s_warningCount;
+}
+
+//----------------------------------------------------------------------
+//! @brief  監視タスク
+//! @param	arg		[I]パラメータ(未使用)
+//! @note	各タスクのCPU使用率とスタック残量を情報ログへ出す(止めるときはesp_log_level_set("MON", ESP_LOG_WARN)).
+//----------------------------------------------------------------------
+void MonitorTask(void *arg)
+{
+	MonTaskStats stats[MON_MAX_TASKS];
+	int count;
+
+	while(1)
+	{
+		vTaskDelay(samplePeriodMs / portTICK_PERIOD_MS);
+
+		count = mon_Sample(stats, MON_MAX_TASKS);
+		for(int i = 0; i < count; i++)
+		{
+			ESP_LOGI(TAG, "%-16s cpu=%3u.%u%% stack=%u", stats[i].name,
+				stats[i].cpuPermille / 10, stats[i].cpuPermille % 10, stats[i].stackFree);
+		}
+	}
+}
@@ -0,0 +1,28 @@
+//======================================================================
+//! @file   monitor.h
+//! @brief  タスク監視(CPU使用率, スタック残量)
+//======================================================================
+#ifndef _MONITOR_H_
+#define _MONITOR_H_
+
+#include <stdint.h>
+
+#define MON_MAX_TASKS		16			// 監視するタスク数の上限
+#define MON_TASK_NAME_SIZE	16			// タスク名の長さ(終端含む)
+
+// タスク情報
+typedef struct
+{
+	char name[MON_TASK_NAME_SIZE];		// タスク名
+	uint32_t number;					// タスク番号
+	uint32_t priority;					// 優先度
+	char state;							// 状態 X=実行中 R=実行可能 B=待ち S=停止 D=削除済
+	uint32_t stackFree;					// スタック残量の最小値[byte]
+	uint32_t cpuPermille;				// 前回サンプルからのCPU使用率[‰]
+} MonTaskStats;
+
+void mon_Initialize(void);
+int mon_Sample(MonTaskStats *stats, int maxCount);
+uint32_t mon_GetWarningCount(void);
+
+#endif
@@ -0,0 +1,322 @@
+//======================================================================
+//! @file   pool.c
+//! @brief  固定サイズブロックプール / リクエスト単位アリーナ
+//! @note	CONFIG_FATFS_LFN_HEAPではディレクトリ操作のたびにLFN作業バッファを
+//! 		malloc/freeするため、長時間動かすとヒープが断片化する.
+//! 		静的領域のブロックから割り当てて、ヒープの最大空きブロックを安定させる.
+//! 		ブロックは要求サイズが収まる最小のクラスから取り、空きがなければ
+//! 		pool_SetFallback()の設定に従ってヒープから確保するかNULLを返す.
+//! 		FatFsのff_memalloc()/ff_memfree()はリンカの--wrapでここへ差し替える.
+//======================================================================
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+
+#include "global.h"
+#include "pool.h"
+
+//----- 定義 -----
+#define SMALL_BLOCK_SIZE	64			// 小ブロックのサイズ[byte]
+#define SMALL_BLOCK_COUNT	8			// 小ブロック数
+#define LFN_BLOCK_COUNT		2			// LFNブロック数
+#define ARENA_BLOCK_COUNT	2			// アリーナブロック数
+#define WORDS(size)			(((size) + 3) / 4)
+
+typedef struct
+{
+	uint8_t *storage;					// ブロック領域
+	PoolClassStats stats;				// 統計(blockSize, blockCountを含む)
+	uint32_t usedMask;					// 使用中ブロック(bit n=ブロックn)
+} PoolClass;
+
+//----- 変数 -----
+static uint32_t s_smallStorage[SMALL_BLOCK_COUNT][WORDS(SMALL_BLOCK_SIZE)];
+static uint32_t s_lfnStorage[LFN_BLOCK_COUNT][WORDS(POOL_LFN_BLOCK_SIZE)];
+static uint32_t s_arenaStorage[ARENA_BLOCK_COUNT][WORDS(POOL_ARENA_SIZE)];
+static PoolClass s_classes[] =				// ブロックサイズの昇順
+{
+	{(uint8_t *)s_smallStorage, {SMALL_BLOCK_SIZE, SMALL_BLOCK_COUNT}},
+	{(uint8_t *)s_lfnStorage, {WORDS(POOL_LFN_BLOCK_SIZE) * 4, LFN_BLOCK_COUNT}},
+	{(uint8_t *)s_arenaStorage, {POOL_ARENA_SIZE, ARENA_BLOCK_COUNT}},
+};
+#define CLASS_COUNT		((int)(sizeof(s_classes) / sizeof(s_classes[0])))
+static PoolFallback s_fallback = PoolFallback_Heap;	// 枯渇時の動作
+static PoolStats s_stats;							// 全体統計
+
+//----- プロトタイプ宣言 -----
+static void *AllocFromClass(PoolClass *poolClass);
+static void *Fallback(size_t size);
+
+//----------------------------------------------------------------------
+//! @brief  プール初期化
+//! @note	全ブロックを空きにして統計を消去する.使用中のブロックがあるときは呼ばないこと.
+//----------------------------------------------------------------------
+void pool_Initialize(void)
+{
+	for(int i = 0; i < CLASS_COUNT; i++)
+	{
+		PoolClass *poolClass = &s_classes[i];
+		uint32_t blockSize = poolClass->stats.blockSize;
+		uint32_t blockCount = poolClass->stats.blockCount;
+
+		memset(&poolClass->stats, 0, sizeof(poolClass->stats));
+		poolClass->stats.blockSize = blockSize;
+		poolClass->stats.blockCount = blockCount;
+		poolClass->usedMask = 0;
+	}
+	memset(&s_stats, 0, sizeof(s_stats));
+	s_fallback = PoolFallback_Heap;
+}
+
+//----------------------------------------------------------------------
+//! @brief  枯渇時の動作設定
+//! @param	fallback	[I]PoolFallback_Heap=ヒープから確保 PoolFallback_None=NULLを返す
+//----------------------------------------------------------------------
+void pool_SetFallback(PoolFallback fallback)
+{
+	s_fallback = fallback;
+}
+
+//----------------------------------------------------------------------
+//! @brief  確保
+//! @param	size	[I]サイズ[byte]
+//! @return	確保した領域(4byte境界) NULL=確保できない
+//! @note	収まる最小のクラスに空きがなければ次に大きいクラスから取る.
+//! 		どのクラスからも取れなければ枯渇時の動作に従う.
+//----------------------------------------------------------------------
+void *pool_Alloc(size_t size)
+{
+	int isExhausted = 0;
+
+	for(int i = 0; i < CLASS_COUNT; i++)
+	{
+		PoolClass *poolClass = &s_classes[i];
+		if(size > poolClass->stats.blockSize)
+		{
+			continue;
+		}
+
+		void *p = AllocFromClass(poolClass);
+		if(p != NULL)
+		{
+			return p;
+		}
+		// 枯渇は要求サイズに合うクラスでだけ数える
+		if(!isExhausted)
+		{
+			poolClass->stats.exhaustedCount++;
+			isExhausted = 1;
+		}
+	}
+
+	return Fallback(size);
+}
+
+//----------------------------------------------------------------------
+//! @brief  解放
+//! @param	p	[I]pool_Alloc()で確保した領域 NULL=何もしない
+//! @note	プールの領域でなければヒープへ返す.
+//----------------------------------------------------------------------
+void pool_Free(void *p)
+{
+	uint8_t *block = p;
+
+	if(p == NULL)
+	{
+		return;
+	}
+	for(int i = 0; i < CLASS_COUNT; i++)
+	{
+		PoolClass *poolClass = &s_classes[i];
+		uint8_t *end = poolClass->storage + poolClass->stats.blockSize * poolClass->stats.blockCount;
+		if(block >= poolClass->storage && block < end)
+		{
+			uint32_t index = (uint32_t)(block - poolClass->storage) / poolClass->stats.blockSize;
+			vPortEnterCritical();
+			poolClass->usedMask &= ~(1UL << index);
+			poolClass->stats.inUse--;
+			vPortExitCritical();
+			return;
+		}
+	}
+	free(p);
+}
+
+//----------------------------------------------------------------------
+//! @brief  ブロッククラス数取得
+//! @return	クラス数
+//----------------------------------------------------------------------
+int pool_GetClassCount(void)
+{
+	return CLASS_COUNT;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ブロッククラス統計取得
+//! @param	index	[I]クラス番号(0〜pool_GetClassCount()-1, ブロックサイズの昇順)
+//! @param	stats	[O]統計
+//! @return	RET_OK=成功 RET_NG=範囲外
+//----------------------------------------------------------------------
+int pool_GetClassStats(int index, PoolClassStats *stats)
+{
+	if(index < 0 || index >= CLASS_COUNT)
+	{
+		return RET_NG;
+	}
+	vPortEnterCritical();
+	*stats = s_classes[index].stats;
+	vPortExitCritical();
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  全体統計取得
+//! @param	stats	[O]統計
+//----------------------------------------------------------------------
+void pool_GetStats(PoolStats *stats)
+{
+	vPortEnterCritical();
+	*stats = s_stats;
+	vPortExitCritical();
+}
+
+//----------------------------------------------------------------------
+//! @brief  アリーナ開始
+//! @param	arena	[O]アリーナ
+//! @return	RET_OK=成功 RET_NOMEMORY=領域を確保できない
+//! @note	アリーナ用ブロックを1個借りる.pool_ArenaEnd()で一括して返す.
+//----------------------------------------------------------------------
+int pool_ArenaBegin(PoolArena *arena)
+{
+	memset(arena, 0, sizeof(*arena));
+	arena->base = pool_Alloc(POOL_ARENA_SIZE);
+	if(arena->base == NULL)
+	{
+		return RET_NOMEMORY;
+	}
+	arena->size = POOL_ARENA_SIZE;
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  アリーナから確保
+//! @param	arena	[IO]アリーナ
+//! @param	size	[I]サイズ[byte]
+//! @return	確保した領域(4byte境界) NULL=確保できない
+//! @note	個別に解放はできない.容量を超えた分は枯渇時の動作に従ってヒープから借り、
+//! 		pool_ArenaEnd()で返す.
+//----------------------------------------------------------------------
+void *pool_ArenaAlloc(PoolArena *arena, size_t size)
+{
+	size_t aligned = (size + 3) & ~(size_t)3;
+
+	if(arena->base != NULL && aligned <= arena->size - arena->used)
+	{
+		void *p = arena->base + arena->used;
+		arena->used += aligned;
+		return p;
+	}
+
+	vPortEnterCritical();
+	s_stats.arenaOverflowCount++;
+	vPortExitCritical();
+	if(arena->overflowCount >= POOL_ARENA_MAX_OVERFLOWS)
+	{
+		vPortEnterCritical();
+		s_stats.failCount++;
+		vPortExitCritical();
+		return NULL;
+	}
+	void *p = Fallback(size);
+	if(p != NULL)
+	{
+		arena->overflows[arena->overflowCount++] = p;
+	}
+	return p;
+}
+
+//----------------------------------------------------------------------
+//! @brief  アリーナ終了
+//! @param	arena	[IO]アリーナ
+//! @note	アリーナから確保した領域はすべて無効になる.
+//----------------------------------------------------------------------
+void pool_ArenaEnd(PoolArena *arena)
+{
+	for(int i = 0; i < arena->overflowCount; i++)
+	{
+		free(arena->overflows[i]);
+	}
+	pool_Free(arena->base);
+	memset(arena, 0, sizeof(*arena));
+}
+
+//----------------------------------------------------------------------
+//! @brief  FatFs作業バッファ確保(ff_memalloc()の差し替え)
+//! @param	msize	[I]サイズ[byte]
+//! @return	確保した領域 NULL=確保できない(FatFsはFR_NOT_ENOUGH_COREを返す)
+//----------------------------------------------------------------------
+void *__wrap_ff_memalloc(UINT msize)
+{
+	return pool_Alloc(msize);
+}
+
+//----------------------------------------------------------------------
+//! @brief  FatFs作業バッファ解放(ff_memfree()の差し替え)
+//! @param	mblock	[I]__wrap_ff_memalloc()で確保した領域
+//----------------------------------------------------------------------
+void __wrap_ff_memfree(void *mblock)
+{
+	pool_Free(mblock);
+}
+
+//----------------------------------------------------------------------
+//! @brief  クラスからブロック確保
+//! @param	poolClass	[IO]クラス
+//! @return	ブロック NULL=空きなし
+//----------------------------------------------------------------------
+void *AllocFromClass(PoolClass *poolClass)
+{
+	void *p = NULL;
+
+	vPortEnterCritical();
+	for(uint32_t i = 0; i < poolClass->stats.blockCount; i++)
+	{
+		if((poolClass->usedMask & (1UL << i)) == 0)
+		{
+			poolClass->usedMask |= (1UL << i);
+			poolClass->stats.allocCount++;
+			if(++poolClass->stats.inUse > poolClass->stats.peakInUse)
+			{
+				poolClass->stats.peakInUse = poolClass->stats.inUse;
+			}
+			p = poolClass->storage + i * poolClass->stats.blockSize;
+			break;
+		}
+	}
+	vPortExitCritical();
+	return p;
+}
+
+//----------------------------------------------------------------------
+//! @brief  枯渇時の確保
+//! @param	size	[I]サイズ[byte]
+//! @return	確保した領域 NULL=確保しない/できない
+//----------------------------------------------------------------------
+void *Fallback(size_t size)
+{
+	void *p = (s_fallback == PoolFallback_Heap) ? malloc(size) : NULL;
+
+	vPortEnterCritical();
+	if(p != NULL)
+	{
+		s_stats.fallbackCount++;
+		s_stats.fallbackBytes += size;
+	}
+	else
+	{
+		s_stats.failCount++;
+	}
+	vPortExitCritical();
+	return p;
+}
@@ -0,0 +1,70 @@
+//======================================================================
+//! @file   pool.h
+//! @brief  固定サイズブロックプール / リクエスト単位アリーナ
+//======================================================================
+#ifndef _POOL_H_
+#define _POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ff.h"
+
+// FatFs LFN作業バッファのサイズ(ff.cのINIT_NAMBUF()と同じ計算)
+#if FF_FS_EXFAT
+#define POOL_LFN_BLOCK_SIZE		((FF_MAX_LFN + 1) * 2 + (FF_MAX_LFN + 44) / 15 * 32)
+#else
+#define POOL_LFN_BLOCK_SIZE		((FF_MAX_LFN + 1) * 2)
+#endif
+#define POOL_ARENA_SIZE			1024		// アリーナ1個の容量[byte]
+#define POOL_ARENA_MAX_OVERFLOWS	4		// アリーナ容量超過時にヒープから借りられる数
+
+// プール枯渇時の動作
+typedef enum
+{
+	PoolFallback_Heap = 0,			// ヒープから確保する(既定)
+	PoolFallback_None,				// NULLを返す
+} PoolFallback;
+
+// ブロッククラス統計
+typedef struct
+{
+	uint32_t blockSize;				// ブロックサイズ[byte]
+	uint32_t blockCount;			// ブロック数
+	uint32_t inUse;					// 使用中ブロック数
+	uint32_t peakInUse;				// 使用中ブロック数の最大値
+	uint32_t allocCount;			// 確保回数
+	uint32_t exhaustedCount;		// 空きがなく確保できなかった回数
+} PoolClassStats;
+
+// 全体統計
+typedef struct
+{
+	uint32_t fallbackCount;			// ヒープへ回した回数
+	uint32_t fallbackBytes;			// ヒープへ回したバイト数累計
+	uint32_t failCount;				// 確保失敗(NULLを返した)回数
+	uint32_t arenaOverflowCount;	// アリーナ容量超過回数
+} PoolStats;
+
+// アリーナ(pool_ArenaBegin()〜pool_ArenaEnd()の間だけ有効な一時領域)
+typedef struct
+{
+	uint8_t *base;					// 領域先頭
+	size_t size;					// 容量[byte]
+	size_t used;					// 使用量[byte]
+	void *overflows[POOL_ARENA_MAX_OVERFLOWS];	// 容量超過分(ヒープ)
+	int overflowCount;				// overflowsの使用数
+} PoolArena;
+
+void pool_Initialize(void);
+void pool_SetFallback(PoolFallback fallback);
+void *pool_Alloc(size_t size);
+void pool_Free(void *p);
+int pool_GetClassCount(void);
+int pool_GetClassStats(int index, PoolClassStats *stats);
+void pool_GetStats(PoolStats *stats);
+
+int pool_ArenaBegin(PoolArena *arena);
+void *pool_ArenaAlloc(PoolArena *arena, size_t size);
+void pool_ArenaEnd(PoolArena *arena);
+
+#endif
@@ -0,0 +1,205 @@
+//======================================================================
+//! @file   rtctime.c
+//! @brief  RTCメモリによる時刻の引継ぎとSNTP同期間隔の調整
+//! @note	時刻は「esp_timer_get_time()=0の時刻」+esp_timer_get_time()で持つ.
+//! 		時刻と補正値をRTCメモリに置き、ディープスリープとリセット(電源投入以外)の後も起動直後から使えるようにする.
+//! 		ディープスリープ中はRTCスロークロックで時間を測るので精度が悪い.
+//! 		SNTPで同期したときに推定との差をスリープ時間の合計で割って補正値を求め、以後のスリープ時間に掛ける.
+//! 		補正後も残る誤差の速さから、誤差がRTCTIME_MAX_ERROR_MSに届くまでを次の同期間隔にする.
+//======================================================================
+#include <stdint.h>
+#include <string.h>
+#include "esp_system.h"
+#include "esp_timer.h"
+
+#include "global.h"
+#include "rtctime.h"
+
+//----- 定義 -----
+#define STATE_MAGIC		0x54494d45				// "TIME"
+
+// RTCメモリに置く状態
+typedef struct
+{
+	uint32_t magic;				// STATE_MAGIC
+	uint32_t checksum;			// magic, checksum以外の語の和
+	int64_t wallUs;				// 保存した時刻(UNIX時間[us])
+	uint64_t sleepUs;			// 保存後に眠る時間(公称)[us] 0=眠らない
+	uint64_t sleptUs;			// 前回の同期から眠った時間(公称)の合計[us]
+	int64_t syncWallUs;			// 前回の同期時刻(UNIX時間[us])
+	int32_t sleepPpm;			// ディープスリープ時間の補正[ppm]
+	uint32_t syncIntervalS;		// 同期間隔[s]
+	int32_t lastErrorMs;		// 前回の同期で測った誤差[ms]
+	uint32_t syncCount;			// 同期回数
+} TimeState;
+
+_Static_assert(sizeof(TimeState) % 4 == 0, "TimeState must be whole RTC blocks");
+_Static_assert(sizeof(TimeState) <= (RTC_BLOCK_END - RTC_BLOCK_RTCTIME) * 4, "TimeState exceeds its RTC memory");
+
+//----- 変数 -----
+static TimeState s_state;					// 状態(RTCメモリの写し)
+static int s_valid;							// 1=時刻が有効
+static int64_t s_baseUs;					// esp_timer_get_time()=0の時刻(UNIX時間[us])
+
+static void WriteState(void);
+static uint32_t Checksum(const TimeState *state);
+
+//----------------------------------------------------------------------
+//! @brief  起動直後にRTCメモリから時刻を復元する
+//! @return	RET_OK=時刻が有効, RET_NG=電源投入直後などで時刻不明
+//! @note	保存時刻に、その後眠った時間(補正済み)と起動時間を足す.
+//! 		リセットボタン・ウォッチドッグ等のリセットでは最後の保存(約1秒ごと)からリセットまでの分だけ遅れる.
+//----------------------------------------------------------------------
+int rtctime_Restore(void)
+{
+	esp_reset_reason_t reason = esp_reset_reason();
+
+	s_valid = 0;
+	if(reason == ESP_RST_POWERON || reason == ESP_RST_BROWNOUT || reason == ESP_RST_UNKNOWN
+	|| !system_rtc_mem_read(RTC_BLOCK_RTCTIME, &s_state, sizeof(s_state))
+	|| s_state.magic != STATE_MAGIC || s_state.checksum != Checksum(&s_state))
+	{
+		memset(&s_state, 0, sizeof(s_state));
+		return RET_NG;
+	}
+
+	int64_t sleptUs = 0;
+	if(reason == ESP_RST_DEEPSLEEP)
+	{
+		sleptUs = (int64_t)s_state.sleepUs + (int64_t)s_state.sleepUs * s_state.sleepPpm / 1000000;
+		s_state.sleptUs += s_state.sleepUs;
+	}
+	s_baseUs = s_state.wallUs + sleptUs + BOOT_TIME_US;
+	s_valid = 1;
+	rtctime_Save();
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  現在時刻
+//! @param	nowUs	[O]UNIX時間[us]
+//! @return	RET_OK=時刻が有効
+//----------------------------------------------------------------------
+int rtctime_GetTime(int64_t *nowUs)
+{
+	*nowUs = s_valid ? s_baseUs + esp_timer_get_time() : 0;
+	return s_valid ? RET_OK : RET_NG;
+}
+
+//----------------------------------------------------------------------
+//! @brief  現在時刻をRTCメモリに保存する
+//! @note	リセットしたときの遅れを小さくするため定期的(約1秒ごと)に呼ぶ.
+//----------------------------------------------------------------------
+void rtctime_Save(void)
+{
+	rtctime_PrepareSleep(0);
+}
+
+//----------------------------------------------------------------------
+//! @brief  ディープスリープ直前の保存
+//! @param	sleepUs	[I]esp_deep_sleep()に渡すスリープ時間[us]
+//----------------------------------------------------------------------
+void rtctime_PrepareSleep(uint64_t sleepUs)
+{
+	if(!s_valid)
+	{
+		return;
+	}
+	s_state.wallUs = s_baseUs + esp_timer_get_time();
+	s_state.sleepUs = sleepUs;
+	WriteState();
+}
+
+//----------------------------------------------------------------------
+//! @brief  SNTPで得た時刻に合わせる
+//! @param	ntpUs	[I]SNTPの時刻(UNIX時間[us])
+//! @note	前回の同期からのスリープが十分長ければ、推定との差からスリープ時間の補正を更新する.
+//! 		次の同期間隔は、前回の同期からの誤差の速さで許容誤差に届くまでの時間.
+//----------------------------------------------------------------------
+void rtctime_Sync(int64_t ntpUs)
+{
+	int64_t estimateUs;
+
+	if(rtctime_GetTime(&estimateUs) == RET_OK && s_state.syncCount > 0 && ntpUs > s_state.syncWallUs)
+	{
+		int64_t errorUs = ntpUs - estimateUs;
+		uint64_t elapsedS = (uint64_t)(ntpUs - s_state.syncWallUs) / 1000000;
+		uint64_t absErrorUs = (errorUs < 0) ? (uint64_t)-errorUs : (uint64_t)errorUs;
+		uint64_t intervalS = (absErrorUs > 0) ? elapsedS * RTCTIME_MAX_ERROR_MS * 1000 / absErrorUs : RTCTIME_SYNC_MAX_S;
+
+		if(s_state.sleptUs >= (uint64_t)RTCTIME_MIN_SLEPT_S * 1000000)
+		{
+			s_state.sleepPpm += (int32_t)(errorUs * 1000000 / (int64_t)s_state.sleptUs);
+		}
+		s_state.lastErrorMs = (int32_t)(errorUs / 1000);
+		s_state.syncIntervalS = (uint32_t)((intervalS < RTCTIME_SYNC_MIN_S) ? RTCTIME_SYNC_MIN_S
+			: (intervalS > RTCTIME_SYNC_MAX_S) ? RTCTIME_SYNC_MAX_S : intervalS);
+	}
+	else
+	{
+		memset(&s_state, 0, sizeof(s_state));
+		s_state.syncIntervalS = RTCTIME_SYNC_MIN_S;
+	}
+
+	s_baseUs = ntpUs - esp_timer_get_time();
+	s_valid = 1;
+	s_state.syncWallUs = ntpUs;
+	s_state.sleptUs = 0;
+	s_state.syncCount++;
+	rtctime_Save();
+}
+
+//----------------------------------------------------------------------
+//! @brief  SNTP同期が必要か
+//! @return	1=時刻不明または同期間隔が過ぎた
+//----------------------------------------------------------------------
+int rtctime_IsSyncDue(void)
+{
+	int64_t nowUs;
+
+	if(rtctime_GetTime(&nowUs) != RET_OK || s_state.syncCount == 0)
+	{
+		return 1;
+	}
+	return nowUs - s_state.syncWallUs >= (int64_t)s_state.syncIntervalS * 1000000;
+}
+
+//----------------------------------------------------------------------
+//! @brief  時刻の状態
+//! @param	status	[O]結果
+//----------------------------------------------------------------------
+void rtctime_GetStatus(RtcTimeStatus *status)
+{
+	status->valid = (rtctime_GetTime(&status->nowUs) == RET_OK);
+	status->syncCount = s_state.syncCount;
+	status->lastSyncUs = s_state.syncWallUs;
+	status->lastErrorMs = s_state.lastErrorMs;
+	status->sleepPpm = s_state.sleepPpm;
+	status->syncIntervalS = s_state.syncIntervalS;
+}
+
+//----------------------------------------------------------------------
+//! @brief  RTCメモリに状態を書く
+//----------------------------------------------------------------------
+void WriteState(void)
+{
+	s_state.magic = STATE_MAGIC;
+	s_state.checksum = Checksum(&s_state);
+	system_rtc_mem_write(RTC_BLOCK_RTCTIME, &s_state, sizeof(s_state));
+}
+
+//----------------------------------------------------------------------
+//! @brief  状態のチェックサム
+//----------------------------------------------------------------------
+uint32_t Checksum(const TimeState *state)
+{
+	uint32_t words[sizeof(TimeState) / 4];
+	uint32_t sum = 0;
+
+	memcpy(words, state, sizeof(words));
+	for(size_t i = 2; i < sizeof(words) / 4; i++)
+	{
+		sum = (sum << 1 | sum >> 31) + words[i];
+	}
+	return sum;
+}
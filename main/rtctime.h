@@ -0,0 +1,35 @@
+//======================================================================
+//! @file   rtctime.h
+//! @brief  RTCメモリによる時刻の引継ぎとSNTP同期間隔の調整
+//======================================================================
+#ifndef _RTCTIME_H_
+#define _RTCTIME_H_
+
+#include <stdint.h>
+
+#define RTCTIME_MAX_ERROR_MS	1000					// 同期間隔を決める許容誤差[ms]
+#define RTCTIME_SYNC_MIN_S		3600					// 同期間隔の最小[s]
+#define RTCTIME_SYNC_MAX_S		(7 * 24 * 3600)			// 同期間隔の最大[s]
+#define RTCTIME_MIN_SLEPT_S		600						// 補正を求めるのに必要なスリープ時間の合計[s]
+
+// 時刻の状態
+typedef struct
+{
+	int valid;					// 1=時刻が有効
+	int64_t nowUs;				// 現在時刻(UNIX時間[us])
+	uint32_t syncCount;			// SNTP同期回数(記録開始から)
+	int64_t lastSyncUs;			// 前回の同期時刻(UNIX時間[us])
+	int32_t lastErrorMs;		// 前回の同期で測った誤差[ms](SNTP - 推定)
+	int32_t sleepPpm;			// ディープスリープ時間の補正[ppm]
+	uint32_t syncIntervalS;		// 同期間隔[s]
+} RtcTimeStatus;
+
+int rtctime_Restore(void);
+int rtctime_GetTime(int64_t *nowUs);
+void rtctime_Save(void);
+void rtctime_PrepareSleep(uint64_t sleepUs);
+void rtctime_Sync(int64_t ntpUs);
+int rtctime_IsSyncDue(void);
+void rtctime_GetStatus(RtcTimeStatus *status);
+
+#endif
@@ -3,6 +3,8 @@
 //! @brief  SDカードアクセス
 //======================================================================
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/timers.h"
@@ -18,6 +20,7 @@
 #include "global.h"
 #include "sd.h"
 #include "setup.h"
+#include "trace.h"
 
 //----- 定義 -----
 #define CALC_CMD_CRC 0		// CMD転送時のCRCを計算するか 0=計算しない
@@ -50,6 +53,10 @@ static Card_t s_cardType;						// カードタイプ
 static DSTATUS s_cardStatus;					// カード状態
 static uint32_t s_allocationUnitSize;			// カードのアロケーションユニットサイズ[sector]
 static uint32_t s_cardSize;						// カードの容量[sector]
+static SdCounters s_counters;					// ドライバ統計
+#if SD_WEAR_ENABLE
+static SdWear s_wear;							// セクタ書込回数
+#endif
 
 //----- プロトタイプ宣言 -----
 // FatFs要求関数
@@ -66,6 +73,9 @@ static int InitSdCom(InitType_t type);														// SD通信初期化
 static uint8_t SendCom(uint8_t command, uint32_t param, uint32_t *addRes, int csControl);	// コマンド送信
 static uint8_t WaitRes(uint8_t continueValue);												// レスポンス待ち
 static void CallBackTimer(TimerHandle_t timer);
+static void RecordWear(uint32_t sector, uint32_t count);												// 書込回数の記録
+static void PutLe(uint8_t *buff, int offset, uint32_t value, int bytes);								// リトルエンディアン書込
+static int WriteZeros(uint8_t *buff, int buffSectors, uint32_t sector, uint32_t count);			// 0埋め
 static inline void SetRxMode(void);															// 受信モード(MOSIピンをH出力固定にする)
 static inline void SetTxMode(void);															// 送信モード(MOSIピンをMOSI機能にする)
 static inline void StartCommunication(void);												// 通信開始(CSピンをLにする)
@@ -105,7 +115,7 @@ int sd_Initialize(void)
 	ff_diskio_register(s_pdrv, &sdImpl);
 
 	//----- FATFSをVFSに接続 -----
-	const size_t maxFiles = 1;
+	const size_t maxFiles = 2;			// viewerが本文と索引(.idx)を同時に開く(FIL 1個ごとにバッファ込み約550byte)
 	char drv[3] = {(char)('0' + s_pdrv), ':', '\0'};
 	esp_err_t err = esp_vfs_fat_register(basePath, drv, maxFiles, &s_fatFs);
 	if(err == ESP_ERR_INVALID_STATE)
@@ -119,6 +129,7 @@ int sd_Initialize(void)
 
 	//----- ドライバ初期化 -----
 	s_cardStatus = STA_NOINIT;
+	memset(&s_counters, 0, sizeof(s_counters));
 
 	return RET_OK;
 
@@ -174,6 +185,7 @@ int sd_Mount(void)
 	FRESULT res = f_mount(s_fatFs, drv, 1);
 	if(res != FR_OK)
 	{
+		// SDXCの出荷時フォーマット(exFAT)はFF_FS_EXFAT=0なのでマウントできない(formatコマンドでFAT32にする)
 		ESP_LOGW(TAG, "failed to mount card (%d)", res);
 		ret = RET_NG;
 	}
@@ -183,7 +195,7 @@ int sd_Mount(void)
 
 //----------------------------------------------------------------------
 //! @brief  アンマウント
-//! @note	未使用.動作未チェック
+//! @note	sd_Format()の前に使う
 //----------------------------------------------------------------------
 void sd_Unmount(void)
 {
@@ -195,6 +207,234 @@ void sd_Unmount(void)
 	f_unmount(drv);
 }
 
+//----------------------------------------------------------------------
+//! @brief  ドライバ統計取得
+//! @param	counters	[O]統計
+//----------------------------------------------------------------------
+void sd_GetCounters(SdCounters *counters)
+{
+	set_TakeCommunicationMutex();
+	*counters = s_counters;
+	set_GiveCommunicationMutex();
+}
+
+//----------------------------------------------------------------------
+//! @brief  セクタ書込回数取得
+//! @param	wear	[O]書込回数(上位セクタはcountの降順) SD_WEAR_ENABLE=0では全て0
+//----------------------------------------------------------------------
+void sd_GetWear(SdWear *wear)
+{
+#if SD_WEAR_ENABLE
+	set_TakeCommunicationMutex();
+	*wear = s_wear;
+	set_GiveCommunicationMutex();
+
+	// 降順に並べる(記録中は並びを保たない)
+	for(int i = 1; i < SD_WEAR_HOT; i++)
+	{
+		SdWearHot hot = wear->hot[i];
+		int j = i;
+		for(; j > 0 && wear->hot[j - 1].count < hot.count; j--)
+		{
+			wear->hot[j] = wear->hot[j - 1];
+		}
+		wear->hot[j] = hot;
+	}
+#else
+	memset(wear, 0, sizeof(*wear));
+#endif
+}
+
+//----------------------------------------------------------------------
+//! @brief  セクタ書込回数クリア
+//----------------------------------------------------------------------
+void sd_ClearWear(void)
+{
+#if SD_WEAR_ENABLE
+	set_TakeCommunicationMutex();
+	memset(&s_wear, 0, sizeof(s_wear));
+	set_GiveCommunicationMutex();
+#endif
+}
+
+//----------------------------------------------------------------------
+//! @brief  AU境界に合わせたFAT32配置の計算
+//! @param	cardSectors	[I]カード容量[sector]
+//! @param	auSectors	[I]アロケーションユニット[sector] 0/奇数=不明(4MiBとする)
+//! @param	format		[O]配置
+//! @return	RET_OK=成功 RET_NG=FAT32にできない(小さすぎる)
+//! @note	パーティション先頭・FAT先頭・データ領域先頭をAU境界に置く(SDアソシエーションの規格と同じ考え方).
+//! 		AUが32768セクタを超えるときは予約領域のセクタ数(16bit)に収まらないので、FAT先頭は合わせない.
+//! 		クラスタはログの追記向けに、FAT32の最小クラスタ数(65526)を満たす範囲で最大(32KiB)にする.
+//! 		クラスタが大きいほどFATの更新とFAT連鎖の追跡が減る.クラスタはAUをまたがない.
+//----------------------------------------------------------------------
+int sd_CalcFormat(uint32_t cardSectors, uint32_t auSectors, SdFormat *format)
+{
+	const uint32_t defaultAlign = 8192;			// 4MiB (SDHCの標準的なAU)
+	const uint32_t minReserved = 32;			// VBR, FSINFO, バックアップ(6, 7)
+	const uint32_t maxClusterSectors = 64;		// 32KiB
+	const uint32_t minFat32Clusters = 65526;	// これ未満はFAT16と判定される
+	const uint32_t fatPerSector = 512 / 4;
+
+	memset(format, 0, sizeof(*format));
+	uint32_t align = (auSectors == 0 || (auSectors % 2) != 0) ? defaultAlign : auSectors;
+	uint32_t reserved = (minReserved + align - 1) / align * align;
+	if(reserved > 0xffff)
+	{
+		reserved = minReserved;
+	}
+	if(cardSectors / 4 < align + reserved)
+	{
+		return RET_NG;
+	}
+
+	const uint32_t fatSector = align + reserved;
+	for(uint32_t clusterSectors = maxClusterSectors; clusterSectors >= 1; clusterSectors /= 2)
+	{
+		if(align % clusterSectors != 0)
+		{
+			continue;
+		}
+		// FATの大きさは多めに見積もり、2個の後ろがAU境界になるまで伸ばす
+		uint32_t fatSectors = ((cardSectors - fatSector) / clusterSectors + 2 + fatPerSector - 1) / fatPerSector;
+		uint32_t dataSector = (fatSector + 2 * fatSectors + align - 1) / align * align;
+		if(dataSector >= cardSectors)
+		{
+			continue;
+		}
+		uint32_t clusters = (cardSectors - dataSector) / clusterSectors;
+		if(clusters >= minFat32Clusters)
+		{
+			format->alignSectors = align;
+			format->volumeSector = align;
+			format->volumeSectors = cardSectors - align;
+			format->reservedSectors = reserved;
+			format->fatSector = fatSector;
+			format->fatSectors = (dataSector - fatSector) / 2;
+			format->dataSector = dataSector;
+			format->clusterSectors = clusterSectors;
+			format->clusters = clusters;
+			return RET_OK;
+		}
+	}
+	return RET_NG;
+}
+
+//----------------------------------------------------------------------
+//! @brief  AU境界に合わせてFAT32でフォーマット
+//! @param	format	[O]配置
+//! @return	RET_OK=成功 RET_NG=未初期化/小さすぎる/書込失敗
+//! @note	MBR(パーティション1個), VBR, FSINFO, バックアップ, FAT2個, ルートディレクトリを書く.
+//! 		アンマウントしてから書くので、終わったらsd_Mount()でマウントし直すこと.
+//! 		開いているファイルがあるときは呼ばないこと.
+//----------------------------------------------------------------------
+int sd_Format(SdFormat *format)
+{
+	const int buffSectors = 8;
+
+	if(s_pdrv == noPdrv || (s_cardStatus & STA_NOINIT) != 0)
+	{
+		return RET_NG;
+	}
+	if(sd_CalcFormat(s_cardSize, s_allocationUnitSize, format) != RET_OK)
+	{
+		return RET_NG;
+	}
+	uint8_t *buff = malloc(buffSectors * bytePerSector);
+	if(buff == NULL)
+	{
+		return RET_NG;
+	}
+	sd_Unmount();
+	ESP_LOGI(TAG, "format: volume=%u fat=%u data=%u cluster=%u", format->volumeSector, format->fatSector, format->dataSector, format->clusterSectors);
+
+	int ret = RET_NG;
+	uint8_t *sector = buff;
+
+	//----- MBR -----
+	memset(sector, 0, bytePerSector);
+	uint8_t *entry = &sector[446];
+	entry[1] = 0xfe;	entry[2] = 0xff;	entry[3] = 0xff;	// CHS(LBAを使う)
+	entry[4] = 0x0c;											// FAT32(LBA)
+	entry[5] = 0xfe;	entry[6] = 0xff;	entry[7] = 0xff;
+	PutLe(entry, 8, format->volumeSector, 4);
+	PutLe(entry, 12, format->volumeSectors, 4);
+	sector[510] = 0x55;
+	sector[511] = 0xaa;
+	if(WriteBlock(s_pdrv, sector, 0, 1) != RES_OK)
+	{
+		goto sd_Format_End;
+	}
+
+	//----- 予約領域(0埋め後にVBR, FSINFOとそのバックアップ) -----
+	if(WriteZeros(buff, buffSectors, format->volumeSector, format->reservedSectors) != RET_OK)
+	{
+		goto sd_Format_End;
+	}
+	memset(sector, 0, bytePerSector);
+	memcpy(&sector[0], "\xeb\x58\x90" "MSDOS5.0", 11);
+	PutLe(sector, 11, bytePerSector, 2);				// BPB_BytsPerSec
+	sector[13] = (uint8_t)format->clusterSectors;		// BPB_SecPerClus
+	PutLe(sector, 14, format->reservedSectors, 2);		// BPB_RsvdSecCnt
+	sector[16] = 2;										// BPB_NumFATs
+	sector[21] = 0xf8;									// BPB_Media
+	PutLe(sector, 24, 63, 2);							// BPB_SecPerTrk
+	PutLe(sector, 26, 255, 2);							// BPB_NumHeads
+	PutLe(sector, 28, format->volumeSector, 4);			// BPB_HiddSec
+	PutLe(sector, 32, format->volumeSectors, 4);		// BPB_TotSec32
+	PutLe(sector, 36, format->fatSectors, 4);			// BPB_FATSz32
+	PutLe(sector, 44, 2, 4);							// BPB_RootClus
+	PutLe(sector, 48, 1, 2);							// BPB_FSInfo
+	PutLe(sector, 50, 6, 2);							// BPB_BkBootSec
+	sector[64] = 0x80;									// BS_DrvNum
+	sector[66] = 0x29;									// BS_BootSig
+	PutLe(sector, 67, format->volumeSectors ^ format->dataSector, 4);	// BS_VolID
+	memcpy(&sector[71], "NO NAME    FAT32   ", 19);		// BS_VolLab, BS_FilSysType
+	sector[510] = 0x55;
+	sector[511] = 0xaa;
+	uint8_t *fsinfo = &buff[bytePerSector];
+	memset(fsinfo, 0, bytePerSector);
+	PutLe(fsinfo, 0, 0x41615252UL, 4);
+	PutLe(fsinfo, 484, 0x61417272UL, 4);
+	PutLe(fsinfo, 488, format->clusters - 1, 4);		// 空きクラスタ数(ルートディレクトリ以外)
+	PutLe(fsinfo, 492, 2, 4);							// 最後に割り当てたクラスタ
+	PutLe(fsinfo, 508, 0xaa550000UL, 4);
+	if(WriteBlock(s_pdrv, buff, format->volumeSector, 2) != RES_OK
+	|| WriteBlock(s_pdrv, buff, format->volumeSector + 6, 2) != RES_OK)
+	{
+		goto sd_Format_End;
+	}
+
+	//----- FAT(先頭にメディア, EOC, ルートディレクトリ) -----
+	for(int fat = 0; fat < 2; fat++)
+	{
+		uint32_t first = format->fatSector + fat * format->fatSectors;
+		if(WriteZeros(buff, buffSectors, first + 1, format->fatSectors - 1) != RET_OK)
+		{
+			goto sd_Format_End;
+		}
+		memset(sector, 0, bytePerSector);
+		PutLe(sector, 0, 0x0ffffff8UL, 4);
+		PutLe(sector, 4, 0x0fffffffUL, 4);
+		PutLe(sector, 8, 0x0fffffffUL, 4);
+		if(WriteBlock(s_pdrv, sector, first, 1) != RES_OK)
+		{
+			goto sd_Format_End;
+		}
+	}
+
+	//----- ルートディレクトリ -----
+	if(WriteZeros(buff, buffSectors, format->dataSector, format->clusterSectors) != RET_OK)
+	{
+		goto sd_Format_End;
+	}
+	ret = RET_OK;
+
+sd_Format_End:
+	free(buff);
+	return ret;
+}
+
 //----------------------------------------------------------------------
 //! @brief  SDカード初期化(FatFs要求)
 //! @param	pdrv		[I]ドライブ番号
@@ -209,6 +449,7 @@ DSTATUS Initialize(BYTE pdrv)
 	}
 
 	set_TakeCommunicationMutex();
+	s_counters.initCount++;
 
 	//----- SPI設定 -----
 	set_SetPin(PinSetting_SdMount, NULL);
@@ -394,6 +635,7 @@ DRESULT ReadBlock(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
 	}
 
 	set_TakeCommunicationMutex();
+	TRACE_BEGIN(TraceId_SdRead, count);
 	SetNormalSpi();
 
 	//----- コマンド転送 -----
@@ -447,7 +689,7 @@ DRESULT ReadBlock(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
 		}
 
 		// データ読み込み(4byte境界まで)
-		int align = 3 - (((int)buff + 3) % 4);	// 4byte境界までに必要なバイト数 buff=0,1,2,3 -> align=0,3,2,1
+		int align = 3 - (int)(((uintptr_t)buff + 3) % 4);	// 4byte境界までに必要なバイト数 buff=0,1,2,3 -> align=0,3,2,1
 		if(align != 0)
 		{
 			trans.bits.miso = align * bitPerByte;
@@ -527,6 +769,16 @@ DRESULT ReadBlock(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
 sd_Read_End:
 	SetTxMode();
 	StopCommunication();
+	s_counters.readCount++;
+	if(res == RES_OK)
+	{
+		s_counters.readSectors += count;
+	}
+	else
+	{
+		s_counters.errorCount++;
+	}
+	TRACE_END(TraceId_SdRead);
 	set_GiveCommunicationMutex();
 
 	return res;
@@ -544,6 +796,7 @@ DRESULT WriteBlock(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
 {
 	const int minMultiBlockAccessCount = 2;		// マルチブロックアクセスを行う回数(この回数以上の時マルチブロックアクセスを行う)
 
+	const DWORD firstSector = sector;
 	DRESULT res = RES_ERROR;
 
 	//----- 準備 -----
@@ -563,6 +816,7 @@ DRESULT WriteBlock(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
 	}
 
 	set_TakeCommunicationMutex();
+	TRACE_BEGIN(TraceId_SdWrite, count);
 	SetNormalSpi();
 	StartCommunication();
 
@@ -625,9 +879,9 @@ DRESULT WriteBlock(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
 		for(int i = 0; i < 4; i++)
 		{
 			addressData <<= bitPerByte;
-			addressData |= buff[i];
+			addressData |= buff[index + i];
 		}
-		int align = 3 - (((int)buff + 3) % 4);	// 4byte境界までに必要なバイト数 buff=0,1,2,3 -> align=0,3,2,1
+		int align = 3 - (int)(((uintptr_t)buff + 3) % 4);	// 4byte境界までに必要なバイト数 buff=0,1,2,3 -> align=0,3,2,1
 		index += align;
 		trans.bits.val = 0;
 		trans.bits.cmd = 2 * bitPerByte;
@@ -701,7 +955,7 @@ DRESULT WriteBlock(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
 
 		//----- CRC転送 -----
 #if CALC_RW_CRC
-		crc = CalcCrc16(buff, bytePerSector);
+		crc = CalcCrc16((uint8_t *)&buff[packet * bytePerSector], bytePerSector);
 #else
 		crc = 0;
 #endif
@@ -715,9 +969,9 @@ DRESULT WriteBlock(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
 		//----- SD側データ受信待ち -----
 		SetRxMode();
 		// データレスポンス待ち
-		res = WaitRes(dataDummy) & 0x1f;
-		if(res != rdAccepted)
+		if((WaitRes(dataDummy) & 0x1f) != rdAccepted)
 		{
+			res = RES_ERROR;
 			SetTxMode();
 			goto sd_Write_End;
 		}
@@ -725,6 +979,7 @@ DRESULT WriteBlock(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
 		// SD側データ書き込み待ち
 		if(WaitRes(0x00) == r1Invalid)
 		{
+			res = RES_ERROR;
 			SetTxMode();
 			goto sd_Write_End;
 		}
@@ -746,6 +1001,7 @@ DRESULT WriteBlock(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
 		SetRxMode();
 		if(WaitRes(0x00) == r1Invalid)
 		{
+			res = RES_ERROR;
 			SetTxMode();
 			goto sd_Write_End;
 		}
@@ -756,6 +1012,17 @@ DRESULT WriteBlock(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
 
 sd_Write_End:
 	StopCommunication();
+	s_counters.writeCount++;
+	if(res == RES_OK)
+	{
+		s_counters.writeSectors += count;
+		RecordWear(firstSector, count);
+	}
+	else
+	{
+		s_counters.errorCount++;
+	}
+	TRACE_END(TraceId_SdWrite);
 	set_GiveCommunicationMutex();
 
 	return res;
@@ -973,6 +1240,7 @@ int InitSdCom(InitType_t type)
 			break;
 		}
 	}
+	xTimerDelete(timer, 0);
 
 	return ret;
 }
@@ -996,6 +1264,8 @@ uint8_t SendCom(uint8_t command, uint32_t param, uint32_t *addRes, int csControl
 	uint16_t commandData;			// 実際送信するコマンドのデータ
 	uint8_t ret;					// 戻り値
 
+	TRACE_BEGIN(TraceId_SdCommand, command & 0x3f);
+
 	//----- 転送設定 -----
 	spi_trans_t trans = {0};
 	trans.cmd = &commandData;
@@ -1105,6 +1375,7 @@ sendCom_End:
 	{
 		StopCommunication();
 	}
+	TRACE_END(TraceId_SdCommand);
 
 	return ret;
 }
@@ -1137,10 +1408,102 @@ uint8_t WaitRes(uint8_t continueValue)
 			break;
 		}
 	}
+	xTimerDelete(timer, 0);
+	if(ret == r1Invalid)
+	{
+		s_counters.timeoutCount++;
+	}
 
 	return ret;
 }
 
+//----------------------------------------------------------------------
+//! @brief  書込回数の記録
+//! @param	sector	[I]先頭セクタ
+//! @param	count	[I]セクタ数
+//! @note	区間ごとの回数は正確に数える.上位セクタはSpace-Saving法で、
+//! 		表にないセクタは最少回数のものと入れ替えて、その回数+1から数える.
+//! 		通信ピンmutexを取得した状態で呼ぶこと.
+//----------------------------------------------------------------------
+void RecordWear(uint32_t sector, uint32_t count)
+{
+#if SD_WEAR_ENABLE
+	if(s_wear.bucketSectors == 0 && s_cardSize != 0)
+	{
+		s_wear.bucketSectors = (s_cardSize + SD_WEAR_BUCKETS - 1) / SD_WEAR_BUCKETS;
+	}
+	s_wear.sectorsWritten += count;
+	for(uint32_t n = 0; n < count; n++, sector++)
+	{
+		if(s_wear.bucketSectors != 0 && sector / s_wear.bucketSectors < SD_WEAR_BUCKETS)
+		{
+			s_wear.buckets[sector / s_wear.bucketSectors]++;
+		}
+
+		SdWearHot *min = &s_wear.hot[0];
+		int i;
+		for(i = 0; i < SD_WEAR_HOT; i++)
+		{
+			SdWearHot *hot = &s_wear.hot[i];
+			if(hot->count != 0 && hot->sector == sector)
+			{
+				hot->count++;
+				break;
+			}
+			if(hot->count < min->count)
+			{
+				min = hot;
+			}
+		}
+		if(i == SD_WEAR_HOT)
+		{
+			min->sector = sector;
+			min->error = min->count;
+			min->count++;
+		}
+	}
+#endif
+}
+
+//----------------------------------------------------------------------
+//! @brief  リトルエンディアン書込
+//! @param	buff	[O]書込先
+//! @param	offset	[I]位置[byte]
+//! @param	value	[I]値
+//! @param	bytes	[I]バイト数(2/4)
+//----------------------------------------------------------------------
+void PutLe(uint8_t *buff, int offset, uint32_t value, int bytes)
+{
+	for(int i = 0; i < bytes; i++)
+	{
+		buff[offset + i] = (uint8_t)(value >> (i * bitPerByte));
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  連続セクタの0埋め
+//! @param	buff		[-]作業バッファ(buffSectorsセクタ, 内容は壊す)
+//! @param	buffSectors	[I]作業バッファのセクタ数(1回のマルチブロック書込の大きさ)
+//! @param	sector		[I]先頭セクタ
+//! @param	count		[I]セクタ数
+//! @return	RET_OK=成功 RET_NG=書込失敗
+//----------------------------------------------------------------------
+int WriteZeros(uint8_t *buff, int buffSectors, uint32_t sector, uint32_t count)
+{
+	memset(buff, 0, buffSectors * bytePerSector);
+	while(count > 0)
+	{
+		UINT n = (count < (uint32_t)buffSectors) ? count : (UINT)buffSectors;
+		if(WriteBlock(s_pdrv, buff, sector, n) != RES_OK)
+		{
+			return RET_NG;
+		}
+		sector += n;
+		count -= n;
+	}
+	return RET_OK;
+}
+
 //----------------------------------------------------------------------
 //! @brief  タイマーコールバック関数.呼ばれたことを通知する.
 //! @param  timer	[I]タイマーハンドラ
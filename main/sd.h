@@ -1,9 +1,65 @@
 #ifndef _SD_H_
 #define _SD_H_
 
+#include <stdint.h>
+
+#ifndef SD_WEAR_ENABLE
+#define SD_WEAR_ENABLE		0		// 1=セクタ書込回数の記録有効
+#endif
+#define SD_WEAR_BUCKETS		64		// 容量を等分した区間の数
+#define SD_WEAR_HOT			32		// 書込回数の上位として追跡するセクタ数
+
+// ドライバ統計
+typedef struct
+{
+	uint32_t initCount;			// カード初期化回数
+	uint32_t readCount;			// 読込要求回数
+	uint32_t readSectors;		// 読込成功セクタ数
+	uint32_t writeCount;		// 書込要求回数
+	uint32_t writeSectors;		// 書込成功セクタ数
+	uint32_t errorCount;		// 読込/書込エラー回数
+	uint32_t timeoutCount;		// レスポンス待ちタイムアウト回数
+} SdCounters;
+
+// 書込回数の上位セクタ(Space-Saving法による推定)
+typedef struct
+{
+	uint32_t sector;			// セクタ番号
+	uint32_t count;				// 書込回数(推定値, 実際の回数以上)
+	uint32_t error;				// 推定誤差の上限(実際の回数 >= count - error)
+} SdWearHot;
+
+// セクタ書込回数
+typedef struct
+{
+	uint32_t sectorsWritten;				// 書込セクタ数
+	uint32_t bucketSectors;					// 1区間のセクタ数 0=容量不明
+	uint32_t buckets[SD_WEAR_BUCKETS];		// 区間ごとの書込セクタ数
+	SdWearHot hot[SD_WEAR_HOT];				// 上位セクタ(countの降順, count=0は空き)
+} SdWear;
+
+// フォーマット配置(FAT32, セクタ番号はカード先頭から)
+typedef struct
+{
+	uint32_t alignSectors;		// 境界合わせの単位(AU)[sector]
+	uint32_t volumeSector;		// パーティション先頭
+	uint32_t volumeSectors;		// パーティションのセクタ数
+	uint32_t reservedSectors;	// 予約領域のセクタ数(VBR, FSINFO, バックアップ)
+	uint32_t fatSector;			// FAT先頭
+	uint32_t fatSectors;		// FAT1個のセクタ数
+	uint32_t dataSector;		// データ領域先頭(クラスタ2)
+	uint32_t clusterSectors;	// クラスタサイズ[sector]
+	uint32_t clusters;			// クラスタ数
+} SdFormat;
+
 int sd_Initialize(void);
 void sd_Deinitialize(void);
 int sd_Mount(void);
 void sd_Unmount(void);
+void sd_GetCounters(SdCounters *counters);
+void sd_GetWear(SdWear *wear);
+void sd_ClearWear(void);
+int sd_CalcFormat(uint32_t cardSectors, uint32_t auSectors, SdFormat *format);
+int sd_Format(SdFormat *format);
 
 #endif //_SD_H_
@@ -0,0 +1,216 @@
+//======================================================================
+//! @file   series.c
+//! @brief  グラフ用時系列データの送信形式(JSON, 差分バイナリ)
+//! @note	バイナリ形式(リトルエンディアン):
+//! 		  ヘッダ16byte  "SLB1", 先頭サンプルの時刻(uint32 UNIX時間[s]), scale(float32), offset(float32)
+//! 		  サンプルごと  varint zigzag(時刻差 - 前の時刻差), varint 値トークン
+//! 		値トークンは0=値なし, それ以外はzigzag(値 - 前の値) + 1.
+//! 		一定間隔・ゆっくり変わる値なら1サンプル2byteになる(JSONでは約18byte).
+//! 		デコーダはhttp.cの"/"ページのJavaScript.
+//======================================================================
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "global.h"
+#include "series.h"
+
+//----- 定義 -----
+#define OUT_SIZE		256				// 出力先へまとめて渡す大きさ[byte]
+#define SAMPLE_MAX		32				// 1サンプルの最大出力[byte]
+#define LINE_SIZE		48				// CSV 1行の最大
+
+static int WriteHeader(SeriesWriter *writer, uint32_t timeS);
+static size_t PutVarint(uint8_t *out, uint32_t value);
+static uint32_t ZigZag(int32_t value);
+
+//----------------------------------------------------------------------
+//! @brief  書込み開始
+//! @param	writer	[O]書込み状態
+//! @param	format	[I]形式
+//! @param	scale	[I]値の倍率(物理量 = 値 * scale + offset)
+//! @param	offset	[I]値のオフセット
+//! @param	sink	[I]出力先
+//! @param	context	[I]出力先に渡すパラメータ
+//! @note	ヘッダは先頭サンプルの時刻が決まってから(series_Write()かseries_End()で)書く.
+//----------------------------------------------------------------------
+void series_Begin(SeriesWriter *writer, SeriesFormat format, float scale, float offset, SeriesSink sink, void *context)
+{
+	memset(writer, 0, sizeof(SeriesWriter));
+	writer->format = format;
+	writer->scale = scale;
+	writer->offset = offset;
+	writer->sink = sink;
+	writer->context = context;
+}
+
+//----------------------------------------------------------------------
+//! @brief  サンプルを書く
+//! @param	writer	[IO]書込み状態
+//! @param	samples	[I]サンプル(時刻順)
+//! @param	count	[I]サンプル数
+//! @return	RET_OK=成功
+//----------------------------------------------------------------------
+int series_Write(SeriesWriter *writer, const SeriesSample *samples, size_t count)
+{
+	uint8_t out[OUT_SIZE];
+	size_t length = 0;
+
+	if(count > 0 && writer->count == 0 && WriteHeader(writer, samples[0].timeS) != RET_OK)
+	{
+		return RET_NG;
+	}
+	for(size_t i = 0; i < count; i++)
+	{
+		const SeriesSample *sample = &samples[i];
+		if(writer->format == Series_Json)
+		{
+			const char *separator = (writer->count > 0) ? "," : "";
+			if(sample->value == SERIES_NO_VALUE)
+			{
+				length += sprintf((char *)&out[length], "%s[%u,null]", separator, sample->timeS);
+			}
+			else
+			{
+				length += sprintf((char *)&out[length], "%s[%u,%d]", separator, sample->timeS, sample->value);
+			}
+		}
+		else
+		{
+			int32_t deltaS = (int32_t)(sample->timeS - writer->prevTimeS);
+			length += PutVarint(&out[length], ZigZag(deltaS - writer->prevDeltaS));
+			if(sample->value == SERIES_NO_VALUE)
+			{
+				out[length++] = 0;
+			}
+			else
+			{
+				length += PutVarint(&out[length], ZigZag(sample->value - writer->prevValue) + 1);
+				writer->prevValue = sample->value;
+			}
+			writer->prevDeltaS = deltaS;
+		}
+		writer->prevTimeS = sample->timeS;
+		writer->count++;
+
+		if(length > OUT_SIZE - SAMPLE_MAX || i == count - 1)
+		{
+			if(writer->sink(writer->context, out, length) != RET_OK)
+			{
+				return RET_NG;
+			}
+			length = 0;
+		}
+	}
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  書込み終了
+//! @return	RET_OK=成功
+//----------------------------------------------------------------------
+int series_End(SeriesWriter *writer)
+{
+	if(writer->count == 0 && WriteHeader(writer, 0) != RET_OK)
+	{
+		return RET_NG;
+	}
+	return (writer->format == Series_Json) ? writer->sink(writer->context, "]}\n", 3) : RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  sleeplogのCSV("sequence,elapsed_s,unix_s,value")からサンプルを読む
+//! @param	fp		[I]ファイル(続きから読む)
+//! @param	fromS	[I]これより前の時刻のサンプルは飛ばす
+//! @param	toS		[I]この時刻以降のサンプルが出たら終わる(含まない)
+//! @param	samples	[O]サンプル
+//! @param	max		[I]最大サンプル数
+//! @return	読んだサンプル数 0=終わり
+//! @note	時刻のない行(時刻不明のまま記録した)と見出し行は飛ばす.
+//! 		行は時刻順なので、toSに届いたらファイル末尾へ移って以後の呼出しで読まない.
+//----------------------------------------------------------------------
+size_t series_ReadCsv(FILE *fp, uint32_t fromS, uint32_t toS, SeriesSample *samples, size_t max)
+{
+	char line[LINE_SIZE];
+	size_t count = 0;
+
+	while(count < max && fgets(line, sizeof(line), fp) != NULL)
+	{
+		char *p = line;
+		strtoul(p, &p, 10);						// sequence
+		if(*p++ != ',')
+		{
+			continue;
+		}
+		strtoul(p, &p, 10);						// elapsed_s
+		if(*p++ != ',' || *p < '0' || *p > '9')
+		{
+			continue;
+		}
+		uint32_t timeS = strtoul(p, &p, 10);
+		if(*p++ != ',' || timeS < fromS)
+		{
+			continue;
+		}
+		if(timeS >= toS)
+		{
+			fseek(fp, 0, SEEK_END);
+			break;
+		}
+		samples[count].timeS = timeS;
+		samples[count].value = (*p == '-' || (*p >= '0' && *p <= '9')) ? (int16_t)strtol(p, NULL, 10) : SERIES_NO_VALUE;
+		count++;
+	}
+	return count;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ヘッダを書く
+//! @param	timeS	[I]先頭サンプルの時刻(時刻差の基準)
+//----------------------------------------------------------------------
+int WriteHeader(SeriesWriter *writer, uint32_t timeS)
+{
+	if(writer->format == Series_Json)
+	{
+		char header[64];
+		int length = snprintf(header, sizeof(header), "{\"scale\":%g,\"offset\":%g,\"samples\":[", writer->scale, writer->offset);
+		return writer->sink(writer->context, header, length);
+	}
+
+	uint8_t header[SERIES_HEADER_SIZE];
+	memcpy(&header[0], SERIES_MAGIC, 4);
+	for(int i = 0; i < 4; i++)
+	{
+		header[4 + i] = (uint8_t)(timeS >> (8 * i));
+	}
+	memcpy(&header[8], &writer->scale, 4);		// ESP8266, x86ともリトルエンディアン
+	memcpy(&header[12], &writer->offset, 4);
+	writer->prevTimeS = timeS;
+	return writer->sink(writer->context, header, sizeof(header));
+}
+
+//----------------------------------------------------------------------
+//! @brief  符号なし可変長整数(下位7bitずつ, 続きがあれば最上位bit=1)
+//! @return	書いたバイト数(1～5)
+//----------------------------------------------------------------------
+size_t PutVarint(uint8_t *out, uint32_t value)
+{
+	size_t length = 0;
+
+	while(value >= 0x80)
+	{
+		out[length++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	out[length++] = (uint8_t)value;
+	return length;
+}
+
+//----------------------------------------------------------------------
+//! @brief  符号付きを0, -1, 1, -2, ...の順の符号なしにする
+//----------------------------------------------------------------------
+uint32_t ZigZag(int32_t value)
+{
+	return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
@@ -0,0 +1,53 @@
+//======================================================================
+//! @file   series.h
+//! @brief  グラフ用時系列データの送信形式(JSON, 差分バイナリ)
+//======================================================================
+#ifndef _SERIES_H_
+#define _SERIES_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define SERIES_NO_VALUE			INT16_MIN		// 値なし(センサーを読めなかった)
+#define SERIES_MAGIC			"SLB1"			// バイナリ形式の識別子
+#define SERIES_HEADER_SIZE		16				// バイナリ形式のヘッダ[byte]
+#define SERIES_READ_BLOCK		64				// CSVから1回に読むサンプル数
+
+// 形式
+typedef enum
+{
+	Series_Json,			// {"scale":s,"offset":o,"samples":[[t,v],...]}
+	Series_Binary,			// ヘッダ + サンプルごとに時刻差の差と値の差(zigzag varint)
+} SeriesFormat;
+
+// サンプル
+typedef struct
+{
+	uint32_t timeS;			// 時刻(UNIX時間[s])
+	int16_t value;			// 生の値(物理量 = value * scale + offset) SERIES_NO_VALUE=なし
+} SeriesSample;
+
+// 出力先 RET_OK=成功
+typedef int (*SeriesSink)(void *context, const void *data, size_t length);
+
+// 書込み状態
+typedef struct
+{
+	SeriesFormat format;
+	SeriesSink sink;
+	void *context;
+	float scale;			// 値の倍率
+	float offset;			// 値のオフセット
+	uint32_t count;			// 書いたサンプル数
+	uint32_t prevTimeS;		// 前のサンプルの時刻
+	int32_t prevDeltaS;		// 前のサンプルとその前の時刻差
+	int16_t prevValue;		// 前の値(値なしは飛ばす)
+} SeriesWriter;
+
+void series_Begin(SeriesWriter *writer, SeriesFormat format, float scale, float offset, SeriesSink sink, void *context);
+int series_Write(SeriesWriter *writer, const SeriesSample *samples, size_t count);
+int series_End(SeriesWriter *writer);
+size_t series_ReadCsv(FILE *fp, uint32_t fromS, uint32_t toS, SeriesSample *samples, size_t max);
+
+#endif
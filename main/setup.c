@@ -18,13 +18,18 @@
 #include "lcd.h"
 #include "sd.h"
 #include "wifi.h"
+#include "hottail.h"
+#include "ds18b20.h"
+#include "console.h"
+#include "monitor.h"
+#include "trace.h"
 
 static const gpio_config_t pinInitialSettings[] =			// pin初期設定
 {
 	// pin mask,   mode,              pull-up,             pull-down,             interrupt type
 	{GPIO_Pin_0,   GPIO_MODE_INPUT,   GPIO_PULLUP_ENABLE,  GPIO_PULLDOWN_DISABLE, GPIO_INTR_DISABLE},	// boot mode 1 / Switch
 	//{GPIO_Pin_1,   GPIO_MODE_OUTPUT,  GPIO_PULLUP_DISABLE, GPIO_PULLDOWN_DISABLE, GPIO_INTR_DISABLE},	// TXD
-	{GPIO_Pin_2,   GPIO_MODE_OUTPUT,  GPIO_PULLUP_DISABLE, GPIO_PULLDOWN_DISABLE, GPIO_INTR_DISABLE},	// boot mode 0 / -
+	{GPIO_Pin_2,   GPIO_MODE_OUTPUT_OD, GPIO_PULLUP_ENABLE, GPIO_PULLDOWN_DISABLE, GPIO_INTR_DISABLE},	// boot mode 0 / 1-Wire
 	//{GPIO_Pin_3,   GPIO_MODE_OUTPUT,  GPIO_PULLUP_DISABLE, GPIO_PULLDOWN_DISABLE, GPIO_INTR_DISABLE},	// RXD
 	{GPIO_Pin_4,   GPIO_MODE_OUTPUT,  GPIO_PULLUP_DISABLE, GPIO_PULLDOWN_DISABLE, GPIO_INTR_DISABLE},	// SD CS / LCD RST
 	{GPIO_Pin_5,   GPIO_MODE_OUTPUT,  GPIO_PULLUP_DISABLE, GPIO_PULLDOWN_DISABLE, GPIO_INTR_DISABLE},	// LCD CS / LCD RST
@@ -52,7 +57,7 @@ typedef struct
 static const function_config_t functionInitialSettings[] =	// pin機能初期設定
 {
 	{PERIPHS_IO_MUX_GPIO0_U, FUNC_GPIO0},		// boot mode 1 / Switch
-	{PERIPHS_IO_MUX_GPIO2_U, FUNC_GPIO2},		// boot mode 0 / -
+	{PERIPHS_IO_MUX_GPIO2_U, FUNC_GPIO2},		// boot mode 0 / 1-Wire
 	{PERIPHS_IO_MUX_GPIO4_U, FUNC_GPIO4},		// SD CS / LCD RST
 	{PERIPHS_IO_MUX_GPIO5_U, FUNC_GPIO5},		// LCD CS / LCD RST
 	{PERIPHS_IO_MUX_MTDI_U, FUNC_GPIO12},		// MISO / LCD RS
@@ -93,7 +98,7 @@ int set_Initialize(void)
 
 	// 初期出力状態
 	gpio_set_level(GPIO_SWITCH_NUM, 0);		// ずっと入力ピンなのでどうでもよい
-	gpio_set_level(GPIO_RES0_NUM, 0);
+	gpio_set_level(GPIO_ONEWIRE_NUM, 1);		// 解放(アイドル)
 	gpio_set_level(GPIO_SDCS_NUM, 1);
 	gpio_set_level(GPIO_LCDCS_NUM, 1);
 	gpio_set_level(GPIO_MISO_LCDRS_NUM, 0);
@@ -139,8 +144,12 @@ int set_Initialize(void)
 	//----- モジュールの初期化 -----
 	sd_Initialize();
 	sd_Mount();
+	hottail_Initialize();
+	ds18b20_Initialize();
 	lcd_Initialize();
 	wifi_Initialize();
+	mon_Initialize();
+	console_Initialize();
 
 	return 1;
 }
@@ -158,6 +167,7 @@ void set_SetPin(enum PinSetting setting, void *param)
 
 	if(setting != s_pinStatus)
 	{
+		TRACE_INSTANT(TraceId_SetPin, setting);
 		s_pinStatus = setting;
 		switch(setting)
 		{
@@ -319,7 +329,10 @@ void set_SetSpiTransFlag(int value)
 //----------------------------------------------------------------------
 void set_TakeCommunicationMutex(void)
 {
+	TRACE_BEGIN(TraceId_BusWait, 0);
 	xSemaphoreTake(s_communicationPinMutex, portMAX_DELAY);
+	TRACE_END(TraceId_BusWait);
+	TRACE_BEGIN(TraceId_BusHeld, 0);
 }
 
 //----------------------------------------------------------------------
@@ -327,6 +340,7 @@ void set_TakeCommunicationMutex(void)
 //----------------------------------------------------------------------
 void set_GiveCommunicationMutex(void)
 {
+	TRACE_END(TraceId_BusHeld);
 	xSemaphoreGive(s_communicationPinMutex);
 }
 
@@ -0,0 +1,364 @@
+//======================================================================
+//! @file   sleeplog.c
+//! @brief  ディープスリープ間欠記録(電池駆動用)
+//! @note	RTCタイマで起床してセンサーを1回読み、RTCユーザーメモリのバッチに追加してすぐ眠る.
+//! 		この起床ではset_Initialize()を呼ばず、SD・LCD・Wi-Fiを使わない(RFも止めて起床する).
+//! 		バッチが満杯になった起床だけ全体を初期化し、SDカードのCSVにまとめて書出す.
+//! 		RTCメモリ: 先頭に状態(SleepState)、続けてサンプル(int16_t)を2つずつ4byteブロックに置く.
+//! 		状態は起床ごとに書き直し、サンプルは追加した1ブロックだけ書く.
+//======================================================================
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_system.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "driver/adc.h"
+
+#include "global.h"
+#include "hottail.h"
+#include "rtctime.h"
+#include "sleeplog.h"
+
+//----- 定義 -----
+#define STATE_MAGIC		0x534c4f47				// "SLOG"
+#define NO_VALUE		INT16_MIN				// センサーを読めなかったサンプル
+#define APPEND_BLOCK	16						// キャッシュに1回に足すサンプル数
+#define RF_OFF			4						// esp_deep_sleep_set_rf_option: 起床後RFを使わない
+#define RF_ON			2						// esp_deep_sleep_set_rf_option: 起床後RFを使う(キャリブレーションなし)
+
+// RTCメモリに置く状態
+typedef struct
+{
+	uint32_t magic;				// STATE_MAGIC
+	uint32_t checksum;			// magic, checksum以外の語の和
+	uint32_t running;			// 1=記録モード中
+	uint32_t intervalMs;		// サンプル間隔[ms]
+	uint16_t batchSize;			// バッチのサンプル数
+	uint16_t count;				// バッチ内のサンプル数
+	uint32_t sequence;			// バッチ先頭の通し番号
+	uint32_t batchTime;			// バッチ先頭の時刻(UNIX時間[s]) 0=不明
+	uint32_t dropped;			// 書出せずに捨てたサンプル数
+	uint32_t sampleWakes;		// サンプル起床回数
+	uint64_t sampleAwakeUs;		// サンプル起床時間の合計[us]
+	uint32_t sampleAwakeMaxUs;	// サンプル起床時間の最大[us]
+	uint32_t flushWakes;		// 書出し起床回数
+	uint64_t flushAwakeUs;		// 書出し起床時間の合計[us]
+} SleepState;
+
+#define SAMPLE_BLOCK	(RTC_BLOCK_SLEEPLOG + sizeof(SleepState) / 4)	// サンプルの先頭ブロック
+
+_Static_assert(sizeof(SleepState) % 4 == 0, "SleepState must be whole RTC blocks");
+_Static_assert(sizeof(SleepState) + SLEEPLOG_BATCH_MAX * sizeof(int16_t) <= (RTC_BLOCK_RTCTIME - RTC_BLOCK_SLEEPLOG) * 4, "batch exceeds its RTC memory");
+
+//----- 変数 -----
+static const char *TAG = "SLOG";			// ログ用タグ
+static SleepState s_state;					// 状態(RTCメモリの写し)
+static int s_valid;							// 1=s_stateが有効
+static SleepLogWake s_wake;					// 今回の起床の種類
+static int16_t s_samples[SLEEPLOG_BATCH_MAX];	// 書出し用
+
+static int ReadState(void);
+static void WriteState(void);
+static uint32_t Checksum(const SleepState *state);
+static int16_t ReadSensor(void);
+static void StoreSample(uint32_t index, int16_t value);
+
+//----------------------------------------------------------------------
+//! @brief  記録モード開始
+//! @param	intervalMs	[I]サンプル間隔[ms] (1000以上)
+//! @param	batchSize	[I]バッチのサンプル数 (1～SLEEPLOG_BATCH_MAX)
+//! @return	RET_OK=成功
+//! @note	続けてsleeplog_Sleep()を呼ぶと最初のサンプルまで眠る.統計は消去する.
+//----------------------------------------------------------------------
+int sleeplog_Start(uint32_t intervalMs, uint32_t batchSize)
+{
+	if(intervalMs < 1000 || batchSize < 1 || batchSize > SLEEPLOG_BATCH_MAX)
+	{
+		return RET_NG;
+	}
+	memset(&s_state, 0, sizeof(s_state));
+	s_state.magic = STATE_MAGIC;
+	s_state.running = 1;
+	s_state.intervalMs = intervalMs;
+	s_state.batchSize = (uint16_t)batchSize;
+	s_valid = 1;
+	s_wake = SleepLog_Off;
+	WriteState();
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  起動直後の処理(set_Initialize()より前に呼ぶ)
+//! @return	起床の種類
+//! @note	ディープスリープからの起床ならセンサーを読んでバッチに追加する.
+//! 		バッチが満杯のまま(前回の書出し失敗)なら、サンプルを捨てて書出しをやり直させる.
+//----------------------------------------------------------------------
+SleepLogWake sleeplog_Wake(void)
+{
+	s_wake = SleepLog_Off;
+	if(ReadState() != RET_OK || !s_state.running)
+	{
+		return s_wake;
+	}
+	if(esp_reset_reason() != ESP_RST_DEEPSLEEP)
+	{
+		s_wake = SleepLog_Stopped;
+		return s_wake;
+	}
+
+	int16_t value = ReadSensor();
+	if(s_state.count < s_state.batchSize)
+	{
+		int64_t nowUs;
+		if(s_state.count == 0)
+		{
+			s_state.batchTime = (rtctime_GetTime(&nowUs) == RET_OK) ? (uint32_t)(nowUs / 1000000) : 0;
+		}
+		StoreSample(s_state.count, value);
+		s_state.count++;
+	}
+	else
+	{
+		s_state.dropped++;
+	}
+	s_wake = (s_state.count >= s_state.batchSize) ? SleepLog_Flush : SleepLog_Sleep;
+	WriteState();
+	return s_wake;
+}
+
+//----------------------------------------------------------------------
+//! @brief  バッチをCSVファイルに追記して空にする
+//! @param	path	[I]ファイル
+//! @return	RET_OK=成功(バッチが空のときも成功)
+//! @note	1行1サンプル "sequence,elapsed_s,unix_s,value".
+//! 		elapsed_sは記録開始からの時間、unix_sはバッチ先頭の時刻から間隔で求めた時刻(時刻不明なら空).
+//----------------------------------------------------------------------
+int sleeplog_Flush(const char *path)
+{
+	if(!s_valid || s_state.count == 0)
+	{
+		return RET_OK;
+	}
+	if(!system_rtc_mem_read(SAMPLE_BLOCK, s_samples, (s_state.count + 1) / 2 * 4))
+	{
+		return RET_NG;
+	}
+	FILE *fp = fopen(path, "a");
+	if(fp == NULL)
+	{
+		return RET_NG;
+	}
+
+	int ok = (fseek(fp, 0, SEEK_END) == 0);
+	if(ok && ftell(fp) == 0)
+	{
+		ok = (fprintf(fp, "sequence,elapsed_s,unix_s,value\n") > 0);
+	}
+	for(uint32_t i = 0; i < s_state.count && ok; i++)
+	{
+		uint32_t sequence = s_state.sequence + i;
+		uint32_t elapsed = (uint32_t)((uint64_t)sequence * s_state.intervalMs / 1000);
+		char time[10 + 1] = "";
+		char value[6 + 1] = "";
+		if(s_state.batchTime != 0)
+		{
+			snprintf(time, sizeof(time), "%u", s_state.batchTime + (uint32_t)((uint64_t)i * s_state.intervalMs / 1000));
+		}
+		if(s_samples[i] != NO_VALUE)
+		{
+			snprintf(value, sizeof(value), "%d", s_samples[i]);
+		}
+		ok = (fprintf(fp, "%u,%u,%s,%s\n", sequence, elapsed, time, value) > 0);
+	}
+	if(fclose(fp) != 0 || !ok)
+	{
+		return RET_NG;
+	}
+
+	// 直近の記録値のキャッシュにも足す(時刻不明のサンプルはファイルと同じく問合せの対象外)
+	for(uint32_t i = 0; i < s_state.count && s_state.batchTime != 0; )
+	{
+		SeriesSample samples[APPEND_BLOCK];
+		size_t count = 0;
+		for(; count < APPEND_BLOCK && i < s_state.count; count++, i++)
+		{
+			samples[count].timeS = s_state.batchTime + (uint32_t)((uint64_t)i * s_state.intervalMs / 1000);
+			samples[count].value = (s_samples[i] != NO_VALUE) ? s_samples[i] : SERIES_NO_VALUE;
+		}
+		hottail_Append(samples, count);
+	}
+
+	s_state.sequence += s_state.count;
+	s_state.count = 0;
+	WriteState();
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  次のサンプルまでディープスリープ(実機では戻らない)
+//! @note	今回の起床時間を統計に加え、サンプル間隔が一定になるよう起床時間を差し引いて眠る.
+//! 		次の起床が書出しならRFを使える状態で、それ以外はRFを止めて起床する.
+//! 		時刻はスリープ時間とともにRTCメモリに残し、起床後にrtctime_Restore()で復元する.
+//----------------------------------------------------------------------
+void sleeplog_Sleep(void)
+{
+	uint32_t awakeUs = (uint32_t)esp_timer_get_time();
+	uint64_t intervalUs = (uint64_t)s_state.intervalMs * 1000;
+	uint64_t usedUs = 0;
+
+	if(!s_valid || !s_state.running)
+	{
+		return;
+	}
+	if(s_wake == SleepLog_Sleep)
+	{
+		s_state.sampleWakes++;
+		s_state.sampleAwakeUs += awakeUs;
+		if(awakeUs > s_state.sampleAwakeMaxUs)
+		{
+			s_state.sampleAwakeMaxUs = awakeUs;
+		}
+		usedUs = awakeUs + BOOT_TIME_US;
+	}
+	else if(s_wake == SleepLog_Flush)
+	{
+		s_state.flushWakes++;
+		s_state.flushAwakeUs += awakeUs;
+		usedUs = awakeUs + BOOT_TIME_US;
+	}
+	WriteState();
+
+	if(s_wake == SleepLog_Flush)
+	{
+		SleepLogReport report;
+		sleeplog_GetReport(&report);
+		ESP_LOGI(TAG, "%u samples logged, awake %u us/sample (max %u), flush %u us, %u uA, %u h",
+			report.sequence, report.awakeAvgUs, report.awakeMaxUs, awakeUs, report.averageUa, report.batteryHours);
+	}
+	uint64_t sleepUs = (usedUs < intervalUs) ? intervalUs - usedUs : intervalUs;
+	rtctime_PrepareSleep(sleepUs);
+	esp_deep_sleep_set_rf_option((s_state.count + 1 >= s_state.batchSize) ? RF_ON : RF_OFF);
+	esp_deep_sleep(sleepUs);
+}
+
+//----------------------------------------------------------------------
+//! @brief  記録モード終了(統計とバッチの位置は残す)
+//----------------------------------------------------------------------
+void sleeplog_Stop(void)
+{
+	if(s_valid)
+	{
+		s_state.running = 0;
+		WriteState();
+	}
+}
+
+//----------------------------------------------------------------------
+//! @brief  記録状況と電池寿命の見積り
+//! @param	report	[O]結果
+//! @return	RET_OK=成功, RET_NG=RTCメモリに記録がない
+//! @note	バッチ1周期(batchSize×間隔)の電荷から平均電流を求める.
+//! 		起床時間にはBOOT_TIME_USを足し、書出し起床の実測がなければSLEEPLOG_FLUSH_USを使う.
+//----------------------------------------------------------------------
+int sleeplog_GetReport(SleepLogReport *report)
+{
+	memset(report, 0, sizeof(SleepLogReport));
+	if(ReadState() != RET_OK)
+	{
+		return RET_NG;
+	}
+
+	report->running = (int)s_state.running;
+	report->intervalMs = s_state.intervalMs;
+	report->batchSize = s_state.batchSize;
+	report->count = s_state.count;
+	report->sequence = s_state.sequence;
+	report->dropped = s_state.dropped;
+	report->sampleWakes = s_state.sampleWakes;
+	report->awakeAvgUs = (s_state.sampleWakes > 0) ? (uint32_t)(s_state.sampleAwakeUs / s_state.sampleWakes) : 0;
+	report->awakeMaxUs = s_state.sampleAwakeMaxUs;
+	report->flushWakes = s_state.flushWakes;
+	report->flushAvgUs = (s_state.flushWakes > 0) ? (uint32_t)(s_state.flushAwakeUs / s_state.flushWakes) : 0;
+
+	uint64_t periodUs = (uint64_t)s_state.intervalMs * 1000 * s_state.batchSize;
+	uint64_t sampleUs = (uint64_t)(report->awakeAvgUs + BOOT_TIME_US) * (s_state.batchSize - 1);
+	uint64_t flushUs = ((s_state.flushWakes > 0) ? report->flushAvgUs : SLEEPLOG_FLUSH_US) + BOOT_TIME_US;
+	uint64_t sleepUs = (periodUs > sampleUs + flushUs) ? periodUs - sampleUs - flushUs : 0;
+	uint64_t charge = sampleUs * SLEEPLOG_AWAKE_UA + flushUs * SLEEPLOG_FLUSH_UA + sleepUs * SLEEPLOG_SLEEP_UA;	// [uA*us]
+	report->averageUa = (uint32_t)(charge / periodUs);
+	report->batteryHours = (report->averageUa > 0) ? SLEEPLOG_BATTERY_MAH * 1000 / report->averageUa : 0;
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  RTCメモリから状態を読む
+//! @return	RET_OK=有効な状態があった
+//----------------------------------------------------------------------
+int ReadState(void)
+{
+	s_valid = (system_rtc_mem_read(RTC_BLOCK_SLEEPLOG, &s_state, sizeof(s_state))
+		&& s_state.magic == STATE_MAGIC
+		&& s_state.checksum == Checksum(&s_state)
+		&& s_state.intervalMs >= 1000
+		&& s_state.batchSize >= 1 && s_state.batchSize <= SLEEPLOG_BATCH_MAX
+		&& s_state.count <= s_state.batchSize);
+	return s_valid ? RET_OK : RET_NG;
+}
+
+//----------------------------------------------------------------------
+//! @brief  RTCメモリに状態を書く
+//----------------------------------------------------------------------
+void WriteState(void)
+{
+	s_state.checksum = Checksum(&s_state);
+	system_rtc_mem_write(RTC_BLOCK_SLEEPLOG, &s_state, sizeof(s_state));
+}
+
+//----------------------------------------------------------------------
+//! @brief  状態のチェックサム
+//----------------------------------------------------------------------
+uint32_t Checksum(const SleepState *state)
+{
+	uint32_t words[sizeof(SleepState) / 4];
+	uint32_t sum = 0;
+
+	memcpy(words, state, sizeof(words));
+	for(size_t i = 2; i < sizeof(words) / 4; i++)
+	{
+		sum = (sum << 1 | sum >> 31) + words[i];
+	}
+	return sum;
+}
+
+//----------------------------------------------------------------------
+//! @brief  センサーを1回読む
+//! @return	読込値(読めなければNO_VALUE)
+//! @note	気温センサーがつくまではTOUT(ADC)の値を記録する.
+//----------------------------------------------------------------------
+int16_t ReadSensor(void)
+{
+	adc_config_t config = {ADC_READ_TOUT_MODE, 8};
+	uint16_t value;
+
+	if(adc_init(&config) != ESP_OK || adc_read(&value) != ESP_OK)
+	{
+		return NO_VALUE;
+	}
+	return (int16_t)value;
+}
+
+//----------------------------------------------------------------------
+//! @brief  サンプルを1つRTCメモリに書く(そのサンプルを含む1ブロックだけ書き直す)
+//! @param	index	[I]バッチ内の位置
+//! @param	value	[I]値
+//----------------------------------------------------------------------
+void StoreSample(uint32_t index, int16_t value)
+{
+	int16_t pair[2] = {0, 0};
+
+	system_rtc_mem_read(SAMPLE_BLOCK + index / 2, pair, sizeof(pair));
+	pair[index % 2] = value;
+	system_rtc_mem_write(SAMPLE_BLOCK + index / 2, pair, sizeof(pair));
+}
@@ -0,0 +1,56 @@
+//======================================================================
+//! @file   sleeplog.h
+//! @brief  ディープスリープ間欠記録(電池駆動用)
+//======================================================================
+#ifndef _SLEEPLOG_H_
+#define _SLEEPLOG_H_
+
+#include <stdint.h>
+
+#define SLEEPLOG_FILE			"/sd/sleeplog.csv"	// バッチの書出し先
+#define SLEEPLOG_BATCH_MAX		192					// バッチの最大サンプル数(RTCメモリの割り当てに収める)
+#define SLEEPLOG_VALUE_SCALE	(1.0f / 1024)		// 値の倍率(TOUT: 1LSB=1/1024V)
+#define SLEEPLOG_VALUE_OFFSET	0.0f				// 値のオフセット
+
+// 電池寿命の見積りに使う値(実測して合わせる)
+#define SLEEPLOG_AWAKE_UA		20000				// サンプル起床中(RF停止)の電流[uA]
+#define SLEEPLOG_FLUSH_UA		80000				// 書出し起床中(SD, LCD, Wi-Fi)の電流[uA]
+#define SLEEPLOG_SLEEP_UA		150					// ディープスリープ中の基板全体の電流[uA]
+#define SLEEPLOG_FLUSH_US		3000000				// 書出し起床の時間[us](実測がまだないとき)
+#define SLEEPLOG_BATTERY_MAH	2000				// 電池容量[mAh]
+
+// 起床の種類(sleeplog_Wake)
+typedef enum
+{
+	SleepLog_Off,			// 記録モードでない.通常どおり起動する
+	SleepLog_Sleep,			// サンプルをバッチに追加した.初期化せずにsleeplog_Sleep()で眠る
+	SleepLog_Flush,			// バッチが満杯.set_Initialize()後にsleeplog_Flush(), sleeplog_Sleep()
+	SleepLog_Stopped		// ディープスリープ以外で起動した.set_Initialize()後にsleeplog_Flush(), sleeplog_Stop()
+} SleepLogWake;
+
+// 記録状況と電池寿命の見積り
+typedef struct
+{
+	int running;				// 1=記録モード中
+	uint32_t intervalMs;		// サンプル間隔[ms]
+	uint32_t batchSize;			// バッチのサンプル数
+	uint32_t count;				// バッチ内のサンプル数
+	uint32_t sequence;			// バッチ先頭の通し番号
+	uint32_t dropped;			// 書出せずに捨てたサンプル数
+	uint32_t sampleWakes;		// サンプル起床回数
+	uint32_t awakeAvgUs;		// サンプル起床の平均時間[us](app_main()から)
+	uint32_t awakeMaxUs;		// サンプル起床の最大時間[us]
+	uint32_t flushWakes;		// 書出し起床回数
+	uint32_t flushAvgUs;		// 書出し起床の平均時間[us]
+	uint32_t averageUa;			// 平均電流の見積り[uA]
+	uint32_t batteryHours;		// 電池寿命の見積り[h]
+} SleepLogReport;
+
+int sleeplog_Start(uint32_t intervalMs, uint32_t batchSize);
+SleepLogWake sleeplog_Wake(void);
+int sleeplog_Flush(const char *path);
+void sleeplog_Sleep(void);
+void sleeplog_Stop(void);
+int sleeplog_GetReport(SleepLogReport *report);
+
+#endif
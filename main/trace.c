@@ -0,0 +1,182 @@
+//======================================================================
+//! @file   trace.c
+//! @brief  イベントトレース
+//! @note	時刻は実機ではCCOUNT(CPUクロック)、ホストでは仮想時計[us].
+//======================================================================
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "trace.h"
+
+#if TRACE_ENABLE
+
+#if defined(__XTENSA__)
+#include "bench.h"
+#define TRACE_TICKS_PER_US	BENCH_CYCLES_PER_US
+#define GetTimestamp()		bench_GetCycleCount()
+#else
+#include "esp_timer.h"
+#define TRACE_TICKS_PER_US	1
+#define GetTimestamp()		((uint32_t)esp_timer_get_time())
+#endif
+
+#define MAX_TASKS			16			// 出力時に区別するタスク数
+
+//----- 定数 -----
+static const char *const eventNames[TraceId_Count] =
+{
+	"BusWait", "BusHeld", "SetPin", "SdCommand", "SdRead", "SdWrite", "LcdUpdate", "WifiEvent", "IpEvent",
+};
+static const char *const eventCategories[TraceId_Count] =
+{
+	"bus", "bus", "bus", "sd", "sd", "sd", "lcd", "wifi", "wifi",
+};
+
+//----- 変数 -----
+static TraceEvent s_ring[TRACE_RING_SIZE];		// リングバッファ
+static uint32_t s_head;							// 記録した総数(次の書込位置)
+static uint32_t s_tail;							// 最も古い記録の番号
+
+//----------------------------------------------------------------------
+//! @brief  イベント記録
+//! @param	id		[I]イベント種別
+//! @param	phase	[I]開始/終了/瞬間
+//! @param	arg		[I]付加情報
+//! @note	割り込みからも呼べる.満杯のときは最も古い記録を上書きする.
+//----------------------------------------------------------------------
+void IRAM_ATTR trace_Record(TraceId id, TracePhase phase, uint16_t arg)
+{
+	vPortEnterCritical();
+	TraceEvent *event = &s_ring[s_head & (TRACE_RING_SIZE - 1)];
+	event->timestamp = GetTimestamp();
+	event->task = xTaskGetCurrentTaskHandle();
+	event->id = (uint8_t)id;
+	event->phase = (uint8_t)phase;
+	event->arg = arg;
+	s_head++;
+	if(s_head - s_tail > TRACE_RING_SIZE)
+	{
+		s_tail = s_head - TRACE_RING_SIZE;
+	}
+	vPortExitCritical();
+}
+
+//----------------------------------------------------------------------
+//! @brief  記録消去
+//----------------------------------------------------------------------
+void trace_Clear(void)
+{
+	vPortEnterCritical();
+	s_head = s_tail = 0;
+	vPortExitCritical();
+}
+
+//----------------------------------------------------------------------
+//! @brief  記録取得(古い順)
+//! @param	events		[O]記録
+//! @param	maxCount	[I]eventsの要素数
+//! @return	取得数
+//----------------------------------------------------------------------
+int trace_GetEvents(TraceEvent *events, int maxCount)
+{
+	int count = 0;
+
+	vPortEnterCritical();
+	for(uint32_t i = s_tail; i != s_head && count < maxCount; i++)
+	{
+		events[count++] = s_ring[i & (TRACE_RING_SIZE - 1)];
+	}
+	vPortExitCritical();
+
+	return count;
+}
+
+//----------------------------------------------------------------------
+//! @brief  上書きで失われた記録数
+//! @return	起動(または消去)からの数
+//----------------------------------------------------------------------
+uint32_t trace_GetDropCount(void)
+{
+	return s_tail;
+}
+
+//----------------------------------------------------------------------
+//! @brief  Chrome trace形式で出力
+//! @param	fp		[I]出力先
+//! @param	isLines	[I]!0=1行1イベントのみ(配列の括弧なし) 0=JSON配列
+//! @note	記録はそのまま残す.出力中の新しい記録は含まない.
+//! 		時刻は32bitで折り返すので、連続する記録の間隔が折り返し周期未満である前提で補正する.
+//! 		tidはタスクごとに1から順に割り当てる.
+//----------------------------------------------------------------------
+void trace_Export(FILE *fp, int isLines)
+{
+	void *tasks[MAX_TASKS];
+	int taskCount = 0;
+	TraceEvent event;
+	uint32_t prev = 0;
+	uint64_t ticks = 0;
+	uint32_t head, index;
+
+	vPortEnterCritical();
+	head = s_head;
+	index = s_tail;
+	vPortExitCritical();
+
+	if(!isLines)
+	{
+		fprintf(fp, "[\n");
+	}
+	for(int first = 1; ; index++, first = 0)
+	{
+		vPortEnterCritical();
+		if((int32_t)(index - s_tail) < 0)
+		{
+			// 出力中に上書きされた(出力先への書込みも記録するので、開始時の末尾を追い越すことがある)
+			index = s_tail;
+		}
+		if((int32_t)(index - head) >= 0)
+		{
+			vPortExitCritical();
+			break;
+		}
+		event = s_ring[index & (TRACE_RING_SIZE - 1)];
+		vPortExitCritical();
+
+		ticks += first ? 0 : (uint32_t)(event.timestamp - prev);
+		prev = event.timestamp;
+
+		int tid;
+		for(tid = 0; tid < taskCount && tasks[tid] != event.task; tid++)
+		{
+		}
+		if(tid == taskCount && taskCount < MAX_TASKS)
+		{
+			tasks[taskCount++] = event.task;
+		}
+
+		const char *name = (event.id < TraceId_Count) ? eventNames[event.id] : "?";
+		const char *category = (event.id < TraceId_Count) ? eventCategories[event.id] : "?";
+		uint32_t us = (uint32_t)(ticks / TRACE_TICKS_PER_US);
+		uint32_t fraction = (uint32_t)((ticks % TRACE_TICKS_PER_US) * 1000 / TRACE_TICKS_PER_US);
+		fprintf(fp, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%u.%03u,\"pid\":1,\"tid\":%d",
+			(!isLines && !first) ? ",\n" : "", name, category, event.phase, us, fraction, tid + 1);
+		if(event.phase == TracePhase_Instant)
+		{
+			fprintf(fp, ",\"s\":\"t\"");
+		}
+		if(event.phase != TracePhase_End)
+		{
+			fprintf(fp, ",\"args\":{\"arg\":%u}", event.arg);
+		}
+		fprintf(fp, "}%s", isLines ? "\n" : "");
+	}
+	if(!isLines)
+	{
+		fprintf(fp, "\n]\n");
+	}
+}
+
+#endif
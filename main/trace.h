@@ -0,0 +1,63 @@
+//======================================================================
+//! @file   trace.h
+//! @brief  イベントトレース
+//! @note	TRACE_ENABLEを1にしたときだけ記録処理が組み込まれる.
+//! 		記録はRAM上のリングバッファ(古いものから上書き)に行い、
+//! 		Chrome trace形式(chrome://tracing, Perfetto)で出力する.
+//======================================================================
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifndef TRACE_ENABLE
+#define TRACE_ENABLE	0			// 1=トレース有効
+#endif
+#define TRACE_RING_SIZE	256			// 記録できるイベント数(2のべき乗)
+
+// イベント種別
+typedef enum
+{
+	TraceId_BusWait = 0,			// 通信ピンのミューテックス待ち
+	TraceId_BusHeld,				// 通信ピンのミューテックス保持
+	TraceId_SetPin,					// ピン設定切替 arg=PinSetting
+	TraceId_SdCommand,				// SDコマンド arg=コマンド番号
+	TraceId_SdRead,					// SDセクタ読込 arg=セクタ数
+	TraceId_SdWrite,				// SDセクタ書込 arg=セクタ数
+	TraceId_LcdUpdate,				// LCD転送
+	TraceId_WifiEvent,				// Wi-Fiイベント arg=イベントID
+	TraceId_IpEvent,				// IPイベント arg=イベントID
+	TraceId_Count
+} TraceId;
+
+// 記録の種類(Chrome traceのph)
+typedef enum {TracePhase_Begin = 'B', TracePhase_End = 'E', TracePhase_Instant = 'i'} TracePhase;
+
+// 記録
+typedef struct
+{
+	uint32_t timestamp;				// 時刻[tick] (TRACE_TICKS_PER_US)
+	void *task;						// 記録したタスク
+	uint8_t id;						// TraceId
+	uint8_t phase;					// TracePhase
+	uint16_t arg;					// 付加情報
+} TraceEvent;
+
+#if TRACE_ENABLE
+#define TRACE_BEGIN(id, arg)		trace_Record((id), TracePhase_Begin, (arg))
+#define TRACE_END(id)				trace_Record((id), TracePhase_End, 0)
+#define TRACE_INSTANT(id, arg)		trace_Record((id), TracePhase_Instant, (arg))
+#else
+#define TRACE_BEGIN(id, arg)		((void)0)
+#define TRACE_END(id)				((void)0)
+#define TRACE_INSTANT(id, arg)		((void)0)
+#endif
+
+void trace_Record(TraceId id, TracePhase phase, uint16_t arg);
+void trace_Clear(void);
+int trace_GetEvents(TraceEvent *events, int maxCount);
+uint32_t trace_GetDropCount(void);
+void trace_Export(FILE *fp, int isLines);
+
+#endif
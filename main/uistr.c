@@ -0,0 +1,39 @@
+//======================================================================
+//! @file   uistr.c
+//! @brief  UI文字列表(uistr.txtからhost/tools/uistrgen.cで生成.直接編集しない)
+//======================================================================
+#include <stdint.h>
+
+#include "uistr.h"
+
+const UiStr uiStrTable[UiStr_Count] =
+{
+	{0, 20},		// UiStr_TimeUnset
+	{20, 28},		// UiStr_IpLost
+	{48, 16},		// UiStr_Temperature
+	{64, 8},		// UiStr_Celsius
+	{72, 24},		// UiStr_Logging
+	{96, 56},		// UiStr_SdError
+};
+
+const uint8_t uiStrStrips[152] =
+{
+	// --:--
+	0x08, 0x08, 0x08, 0x00, 0x08, 0x08, 0x08, 0x00, 0x00, 0x24, 0x00, 0x00, 0x08, 0x08, 0x08, 0x00,
+	0x08, 0x08, 0x08, 0x00,
+	// -.-.-.-
+	0x08, 0x08, 0x08, 0x00, 0x00, 0x40, 0x00, 0x00, 0x08, 0x08, 0x08, 0x00, 0x00, 0x40, 0x00, 0x00,
+	0x08, 0x08, 0x08, 0x00, 0x00, 0x40, 0x00, 0x00, 0x08, 0x08, 0x08, 0x00,
+	// 気温
+	0x44, 0x5b, 0x2e, 0x5e, 0x0e, 0x3a, 0x42, 0x00, 0x75, 0x40, 0x77, 0x55, 0x75, 0x77, 0x40, 0x00,
+	// ℃
+	0x02, 0x05, 0x02, 0x3c, 0x42, 0x42, 0x24, 0x00,
+	// 記録中
+	0x6a, 0x6b, 0x02, 0x79, 0x49, 0x49, 0x6f, 0x00, 0x56, 0x7d, 0x56, 0x25, 0x7d, 0x27, 0x54, 0x00,
+	0x1e, 0x12, 0x12, 0x7f, 0x12, 0x12, 0x1e, 0x00,
+	// SDカードエラー
+	0x26, 0x49, 0x32, 0x00, 0x7f, 0x41, 0x3e, 0x00, 0x42, 0x22, 0x1f, 0x02, 0x42, 0x42, 0x3e, 0x00,
+	0x04, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x00, 0x00, 0x7f, 0x08, 0x09, 0x10, 0x11, 0x00,
+	0x42, 0x42, 0x42, 0x7e, 0x42, 0x42, 0x42, 0x00, 0x04, 0x05, 0x45, 0x45, 0x25, 0x25, 0x1c, 0x00,
+	0x04, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00,
+};
@@ -0,0 +1,32 @@
+//======================================================================
+//! @file   uistr.h
+//! @brief  UI文字列表(uistr.txtからhost/tools/uistrgen.cで生成.直接編集しない)
+//======================================================================
+#ifndef _UISTR_H_
+#define _UISTR_H_
+
+#include <stdint.h>
+
+// 文字列ID
+typedef enum
+{
+	UiStr_TimeUnset,		// --:--
+	UiStr_IpLost,		// -.-.-.-
+	UiStr_Temperature,		// 気温
+	UiStr_Celsius,		// ℃
+	UiStr_Logging,		// 記録中
+	UiStr_SdError,		// SDカードエラー
+	UiStr_Count
+} UiStrId;
+
+// 文字列の列データ(高さ8dot, 1byte=1列)
+typedef struct
+{
+	uint16_t offset;		// uiStrStrips内の位置
+	uint16_t width;			// 幅[dot]
+} UiStr;
+
+extern const UiStr uiStrTable[UiStr_Count];
+extern const uint8_t uiStrStrips[];
+
+#endif
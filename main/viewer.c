@@ -0,0 +1,323 @@
+//======================================================================
+//! @file   viewer.c
+//! @brief  SDカード上のテキストファイルのページ表示
+//! @note	開くときにファイルを1回だけ先頭から読み、lcd_Puts()と同じ規則(改行・折り返し・文字幅)で
+//! 		各ページの先頭位置を求めて索引ファイル(<ファイル名>.idx)に保存する.
+//! 		次に開くときはファイルのサイズ・更新時刻と表示エリアが同じなら索引を読むだけで済む.
+//! 		ページの表示は索引の位置へ1回シークし、1ページ分(VIEWER_PAGE_BYTES以下)だけ読んで描く.
+//! 		索引はVIEWER_WINDOWページ分をRAMに置き、範囲外のページを表示するときに読み直す.
+//======================================================================
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "global.h"
+#include "charcode.h"
+#include "lcd.h"
+#include "viewer.h"
+
+//----- 定義 -----
+#define INDEX_MAGIC		0x58444956		// "VIDX"
+#define INDEX_VERSION	1
+#define PATH_SIZE		64				// 索引ファイル名の最大長
+#define CHAR_BYTES_MAX	4				// 1文字の最大バイト数(UTF-8)
+
+// 索引ファイルのヘッダ(この後にページ先頭位置uint32_t[pageCount + 1]が続く)
+typedef struct
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t charCode;			// キャラクタコード
+	uint16_t width;				// 表示エリアの大きさ(位置は描画に影響しない)
+	uint16_t height;
+	uint32_t pageBytes;			// VIEWER_PAGE_BYTES
+	uint32_t fileSize;			// 作成時のファイルサイズ
+	uint32_t fileTime;			// 作成時のファイル更新時刻
+	uint32_t pageCount;			// ページ数
+} IndexHeader;
+
+//----- 変数 -----
+static char s_text[VIEWER_PAGE_BYTES + CHAR_BYTES_MAX];	// 読込バッファ(末尾はNUL.最後の文字が欠けても終端を越えない)
+
+//----- プロトタイプ宣言 -----
+static int BuildIndex(Viewer *viewer, IndexHeader *header);
+static int LoadWindow(Viewer *viewer, uint32_t page);
+
+//----------------------------------------------------------------------
+//! @brief  ファイルを開いてページ位置の索引を用意する
+//! @param	viewer		[O]ビューア
+//! @param	path		[I]表示するファイル
+//! @param	area		[I]表示エリア 高さは8dotの倍数
+//! @param	charCode	[I]キャラクタコード
+//! @return	RET_OK=成功
+//! @note	索引ファイルが使えなければファイルを先頭から読んで作り直す.
+//----------------------------------------------------------------------
+int viewer_Open(Viewer *viewer, const char *path, Rect area, CharCode charCode)
+{
+	char indexPath[PATH_SIZE];
+	struct stat info;
+	IndexHeader header, saved;
+
+	memset(viewer, 0, sizeof(Viewer));
+	viewer->area = area;
+	viewer->charCode = charCode;
+	if(area.w < 8 || area.h < 8
+	|| snprintf(indexPath, sizeof(indexPath), "%s%s", path, VIEWER_INDEX_SUFFIX) >= (int)sizeof(indexPath)
+	|| stat(path, &info) != 0
+	|| (viewer->fp = fopen(path, "rb")) == NULL)
+	{
+		return RET_NG;
+	}
+
+	memset(&header, 0, sizeof(header));
+	header.magic = INDEX_MAGIC;
+	header.version = INDEX_VERSION;
+	header.charCode = (uint16_t)charCode;
+	header.width = area.w;
+	header.height = area.h;
+	header.pageBytes = VIEWER_PAGE_BYTES;
+	header.fileSize = (uint32_t)info.st_size;
+	header.fileTime = (uint32_t)info.st_mtime;
+
+	// 保存済みの索引が同じファイル・同じ表示エリアのものなら使う
+	viewer->index = fopen(indexPath, "r+b");
+	if(viewer->index != NULL && fread(&saved, sizeof(saved), 1, viewer->index) == 1)
+	{
+		header.pageCount = saved.pageCount;
+		viewer->pageCount = saved.pageCount;
+		if(memcmp(&header, &saved, sizeof(header)) == 0 && LoadWindow(viewer, 0) == RET_OK)
+		{
+			return RET_OK;
+		}
+	}
+
+	if(viewer->index != NULL)
+	{
+		fclose(viewer->index);
+	}
+	viewer->index = fopen(indexPath, "w+b");
+	if(viewer->index == NULL || BuildIndex(viewer, &header) != RET_OK || LoadWindow(viewer, 0) != RET_OK)
+	{
+		viewer_Close(viewer);
+		return RET_NG;
+	}
+	viewer->indexBuilt = 1;
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  1ページ表示
+//! @param	viewer		[IO]ビューア
+//! @param	page		[I]ページ(0～)
+//! @return	RET_OK=成功
+//! @note	表示エリアを消してからページを描く.描画中(lcd_BeginDrawing()～lcd_EndDrawing())に呼ぶ.
+//----------------------------------------------------------------------
+int viewer_Show(Viewer *viewer, uint32_t page)
+{
+	uint32_t offset, length;
+	uint8_t blank[8] = {0};
+
+	if(viewer_GetPageRange(viewer, page, &offset, &length) != RET_OK
+	|| fseek(viewer->fp, (long)offset, SEEK_SET) != 0
+	|| fread(s_text, 1, length, viewer->fp) != length)
+	{
+		return RET_NG;
+	}
+	memset(&s_text[length], '\0', CHAR_BYTES_MAX);
+	for(uint32_t i = 0; i < length; i++)
+	{
+		if(s_text[i] == '\0')
+		{
+			s_text[i] = ' ';		// 索引では空白(1byte)として数えている
+		}
+	}
+
+	// エリアを消す(1行ずつ空白の画像で塗る)
+	for(int y = 0; y < viewer->area.h; y += 8)
+	{
+		for(int x = 0; x < viewer->area.w; x += 8)
+		{
+			Rect rect = {viewer->area.x + x, viewer->area.y + y, (viewer->area.w - x < 8) ? viewer->area.w - x : 8, 8};
+			lcd_PutImage(rect, blank, NULL);
+		}
+	}
+	lcd_Puts(viewer->area, s_text, viewer->charCode);
+	viewer->page = page;
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ページのファイル上の範囲
+//! @param	viewer		[IO]ビューア
+//! @param	page		[I]ページ(0～)
+//! @param	offset		[O]ページ先頭の位置[byte]
+//! @param	length		[O]ページのバイト数
+//! @return	RET_OK=成功
+//----------------------------------------------------------------------
+int viewer_GetPageRange(Viewer *viewer, uint32_t page, uint32_t *offset, uint32_t *length)
+{
+	if(page >= viewer->pageCount)
+	{
+		return RET_NG;
+	}
+	if(page < viewer->windowFirst || page >= viewer->windowFirst + viewer->windowCount)
+	{
+		// 前へ戻るときも窓に入るよう、表示するページを窓の中ほどに置く
+		uint32_t first = (page > VIEWER_WINDOW / 2) ? page - VIEWER_WINDOW / 2 : 0;
+		if(LoadWindow(viewer, first) != RET_OK)
+		{
+			return RET_NG;
+		}
+	}
+	*offset = viewer->window[page - viewer->windowFirst];
+	*length = viewer->window[page - viewer->windowFirst + 1] - *offset;
+	return (*length <= VIEWER_PAGE_BYTES) ? RET_OK : RET_NG;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ファイルを閉じる
+//! @param	viewer		[IO]ビューア
+//----------------------------------------------------------------------
+void viewer_Close(Viewer *viewer)
+{
+	if(viewer->fp != NULL)
+	{
+		fclose(viewer->fp);
+		viewer->fp = NULL;
+	}
+	if(viewer->index != NULL)
+	{
+		fclose(viewer->index);
+		viewer->index = NULL;
+	}
+	viewer->pageCount = 0;
+	viewer->windowCount = 0;
+}
+
+//----------------------------------------------------------------------
+//! @brief  ファイルを先頭から読んでページ位置の索引を作る
+//! @param	viewer		[IO]ビューア(fp, indexを開いたもの)
+//! @param	header		[IO]索引ファイルのヘッダ(pageCountを書き込む)
+//! @return	RET_OK=成功
+//! @note	lcd_Puts()と同じ規則で1文字ずつ配置し、次の文字が表示エリアの下にはみ出す位置でページを分ける.
+//! 		  '\n' : 行頭でなければ改行(空行は詰まる)
+//! 		  '\r' : 行頭へ戻る
+//! 		  その他: 文字幅(4dot/8dot)が残りの幅を越えれば改行してから置く
+//! 		1ページがVIEWER_PAGE_BYTESを越える(改行ばかりが続く)ときは、その文字でページを分ける.
+//----------------------------------------------------------------------
+int BuildIndex(Viewer *viewer, IndexHeader *header)
+{
+	const int fontHeight = 8;
+	uint32_t position = 0, pageStart = 0;
+	size_t filled = 0, next = 0;		// s_textの有効なバイト数、次の文字の位置
+	int x = 0, y = 0;					// 表示エリア内の位置
+	int width, count;
+
+	header->pageCount = 0;
+	if(fseek(viewer->index, sizeof(IndexHeader), SEEK_SET) != 0
+	|| fwrite(&pageStart, sizeof(pageStart), 1, viewer->index) != 1)
+	{
+		return RET_NG;
+	}
+
+	for(;;)
+	{
+		// 1文字分そろうように読み足す
+		if(filled - next < CHAR_BYTES_MAX)
+		{
+			memmove(s_text, &s_text[next], filled - next);
+			filled -= next;
+			next = 0;
+			filled += fread(&s_text[filled], 1, VIEWER_PAGE_BYTES - filled, viewer->fp);
+			memset(&s_text[filled], '\0', CHAR_BYTES_MAX);
+			if(filled == 0)
+			{
+				break;
+			}
+		}
+
+		const char *text = &s_text[next];
+		if(*text == '\n' || *text == '\r')
+		{
+			count = 1;
+			width = 0;
+		}
+		else
+		{
+			width = 1;
+			count = 1;
+			if(*text != '\0' && viewer->charCode == Code_Sjis)
+			{
+				char_TransSjisToSerial(text, &width, &count);
+			}
+			else if(*text != '\0')
+			{
+				char_TransUtf8ToSerial(text, &width, &count);
+			}
+			count = (count <= 0) ? 1 : (count > (int)(filled - next)) ? (int)(filled - next) : count;
+			width *= 4;
+			if(x + width > viewer->area.w)
+			{
+				x = 0;
+				y += fontHeight;
+			}
+		}
+
+		// 下にはみ出す、または1ページのバイト数を越えるならこの文字から次のページ
+		if(y >= viewer->area.h || position + count - pageStart > VIEWER_PAGE_BYTES)
+		{
+			pageStart = position;
+			header->pageCount++;
+			if(fwrite(&pageStart, sizeof(pageStart), 1, viewer->index) != 1)
+			{
+				return RET_NG;
+			}
+			x = 0;
+			y = 0;
+		}
+
+		if(*text == '\n' && x != 0)
+		{
+			y += fontHeight;
+		}
+		x = (*text == '\n' || *text == '\r') ? 0 : x + width;
+		position += count;
+		next += count;
+	}
+
+	// 最後のページ(空のファイルも1ページ)と終端
+	header->pageCount++;
+	if(ferror(viewer->fp)
+	|| fwrite(&position, sizeof(position), 1, viewer->index) != 1
+	|| fseek(viewer->index, 0, SEEK_SET) != 0
+	|| fwrite(header, sizeof(IndexHeader), 1, viewer->index) != 1
+	|| fflush(viewer->index) != 0)
+	{
+		return RET_NG;
+	}
+	viewer->pageCount = header->pageCount;
+	return RET_OK;
+}
+
+//----------------------------------------------------------------------
+//! @brief  索引ファイルからページ位置を読む
+//! @param	viewer		[IO]ビューア
+//! @param	page		[I]先頭のページ
+//! @return	RET_OK=成功
+//! @note	viewer->pageCountを設定してから呼ぶ.
+//----------------------------------------------------------------------
+int LoadWindow(Viewer *viewer, uint32_t page)
+{
+	uint32_t count = (viewer->pageCount - page < VIEWER_WINDOW) ? viewer->pageCount - page : VIEWER_WINDOW;
+
+	if(page >= viewer->pageCount
+	|| fseek(viewer->index, (long)(sizeof(IndexHeader) + page * sizeof(uint32_t)), SEEK_SET) != 0
+	|| fread(viewer->window, sizeof(uint32_t), count + 1, viewer->index) != count + 1)
+	{
+		return RET_NG;
+	}
+	viewer->windowFirst = page;
+	viewer->windowCount = count;
+	return RET_OK;
+}
@@ -0,0 +1,37 @@
+//======================================================================
+//! @file   viewer.h
+//! @brief  SDカード上のテキストファイルのページ表示
+//======================================================================
+#ifndef _VIEWER_H_
+#define _VIEWER_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "lcd.h"
+
+#define VIEWER_PAGE_BYTES		512			// 1ページの最大バイト数(超える分は次のページ)
+#define VIEWER_WINDOW			32			// RAMに置くページ位置の数
+#define VIEWER_INDEX_SUFFIX		".idx"		// ページ位置の索引ファイル(表示するファイル名に付ける)
+
+// ビューア
+typedef struct
+{
+	FILE *fp;								// 表示するファイル
+	FILE *index;							// ページ位置の索引ファイル
+	Rect area;								// 表示エリア
+	CharCode charCode;						// キャラクタコード
+	uint32_t pageCount;						// ページ数
+	uint32_t page;							// 表示中のページ
+	uint32_t windowFirst;					// window[0]のページ
+	uint32_t windowCount;					// windowの有効なページ数
+	uint32_t window[VIEWER_WINDOW + 1];		// ページ先頭位置(最後のページは次の位置=ファイルサイズまで)
+	int indexBuilt;							// 1=開くときに索引を作り直した
+} Viewer;
+
+int viewer_Open(Viewer *viewer, const char *path, Rect area, CharCode charCode);
+int viewer_Show(Viewer *viewer, uint32_t page);
+int viewer_GetPageRange(Viewer *viewer, uint32_t page, uint32_t *offset, uint32_t *length);
+void viewer_Close(Viewer *viewer);
+
+#endif
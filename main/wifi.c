@@ -6,10 +6,12 @@
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
+#include <sys/time.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_err.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "esp_netif.h"
 #include "esp_event.h"
 #include "esp_wifi.h"
@@ -20,7 +22,10 @@
 
 #include "global.h"
 #include "wifi.h"
+#include "httpd.h"
 #include "lcd.h"
+#include "rtctime.h"
+#include "trace.h"
 
 //----- 定義 -----
 #define WIFI_SSID		"ssid-hogehoge"
@@ -38,13 +43,35 @@ static const uint8_t statusIcon[] =
 //----- 変数 -----
 static int s_retry_num = 0;
 static int s_isWifiInitialized = 0;
+static volatile int s_sntpRunning = 0;		// SNTP動作中
+static volatile int s_sntpSynced = 0;		// SNTP動作中に時刻が設定された
+static int64_t s_sntpTimeUs;				// SNTPが設定した時刻(UNIX時間[us])
+static int64_t s_sntpTimerUs;				// 設定したときのesp_timer_get_time()
 
+int __real_settimeofday(const struct timeval *tv, const struct timezone *tz);
 static void PerformSntp(void *arg);
 static void HandleWifiEvent(void* arg, esp_event_base_t eventBase, int32_t eventId, void* eventData);
 
+//----------------------------------------------------------------------
+//! @brief	時刻設定(リンカの--wrapで差し替え)
+//! @note	SNTP動作中の設定はSNTPの応答なので、時刻を控えてSNTPタスクからrtctimeに知らせる.
+//----------------------------------------------------------------------
+int __wrap_settimeofday(const struct timeval *tv, const struct timezone *tz)
+{
+	if(s_sntpRunning && !s_sntpSynced && tv != NULL)
+	{
+		s_sntpTimeUs = (int64_t)tv->tv_sec * 1000000 + tv->tv_usec;
+		s_sntpTimerUs = esp_timer_get_time();
+		s_sntpSynced = 1;
+	}
+	return __real_settimeofday(tv, tz);
+}
+
 //----------------------------------------------------------------------
 //! @brief	SNTPタスク
 //! @param	arg			[I]パラメータ
+//! @note	時刻は起動時にRTCメモリから引き継ぐので、SNTPは同期間隔(rtctime)が過ぎたときだけ動かし、
+//! 		1回同期したら止める.
 //----------------------------------------------------------------------
 void PerformSntp(void *arg)
 {
@@ -55,7 +82,6 @@ void PerformSntp(void *arg)
 	// SNTP設定
 	sntp_setoperatingmode(SNTP_OPMODE_POLL);
 	sntp_setservername(0, SNTP_SERVER);
-	sntp_init();
 
 	time_t now;
 	struct tm timeinfo;
@@ -63,20 +89,34 @@ void PerformSntp(void *arg)
 	char timeStr[5+1];
 	while(1)
 	{
+		if(!s_sntpRunning && rtctime_IsSyncDue())
+		{
+			s_sntpSynced = 0;
+			s_sntpRunning = 1;
+			sntp_init();
+		}
+		else if(s_sntpRunning && s_sntpSynced)
+		{
+			sntp_stop();
+			s_sntpRunning = 0;
+			rtctime_Sync(s_sntpTimeUs + (esp_timer_get_time() - s_sntpTimerUs));
+		}
+		rtctime_Save();						// リセットしても時刻を引き継ぐ
+
 		time(&now);
 		localtime_r(&now, &timeinfo);
 
+		lcd_BeginDrawing();
 		if(timeinfo.tm_year < (2016 - 1900))
 		{
 			// 時刻未設定時
-			strcpy(timeStr, "--:--");
+			lcd_PutUiStr(timeArea, UiStr_TimeUnset);
 		}
 		else
 		{
 			snprintf(timeStr, 5+1, "%2d:%02d", timeinfo.tm_hour, timeinfo.tm_min);
+			lcd_Puts(timeArea, timeStr, Code_Sjis);
 		}
-		lcd_BeginDrawing();
-		lcd_Puts(timeArea, timeStr, Code_Sjis);
 		lcd_EndDrawing();
 		//lcd_Update();
 
@@ -97,6 +137,7 @@ void HandleWifiEvent(void* arg, esp_event_base_t eventBase, int32_t eventId, voi
 	Rect textArea = {8, 0, 15 * 4, 8};
 	if(eventBase == WIFI_EVENT)
 	{
+		TRACE_INSTANT(TraceId_WifiEvent, eventId);
 		switch(eventId)
 		{
 		case WIFI_EVENT_STA_START:					// Stationスタート
@@ -153,6 +194,7 @@ void HandleWifiEvent(void* arg, esp_event_base_t eventBase, int32_t eventId, voi
 	}
 	else if(eventBase == IP_EVENT)
 	{
+		TRACE_INSTANT(TraceId_IpEvent, eventId);
 		ip_event_got_ip_t* event;
 		switch(eventId)
 		{
@@ -167,7 +209,7 @@ void HandleWifiEvent(void* arg, esp_event_base_t eventBase, int32_t eventId, voi
 
 		case IP_EVENT_STA_LOST_IP:				// StationがIPを失いIPが0にリセットされた
 			lcd_BeginDrawing();
-			lcd_Puts(textArea, "-.-.-.-", Code_Utf8);
+			lcd_PutUiStr(textArea, UiStr_IpLost);
 			lcd_EndDrawing();
 			break;
 
@@ -210,5 +252,8 @@ int wifi_Initialize(void)
 	// SNTPサービス開始
 	xTaskCreate(PerformSntp, "sntp_task", 2048, NULL, 10, NULL);
 
+	// HTTPサーバ開始
+	httpd_Start();
+
 	return 1;
 }